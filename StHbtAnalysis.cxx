@@ -39,6 +39,8 @@
 #include "StHbtV0Cut.h"
 #include "StHbtXiCut.h"
 #include "StHbtKinkCut.h"
+#include "StHbtCheckpoint.h"
+#include "StHbtPicoEventCollectionVectorHideAway.h"
 
 /// ROOT headers
 #include "TObject.h"
@@ -88,6 +90,31 @@ void doFillParticleCollection(TrackCutType *cut,
   } //for (const auto &track : *track_collection)
 }
 
+/// Track-specific filler working on the columnar track batch of the event
+///
+/// The cut is evaluated once for all tracks via passBatch() and the
+/// resulting selection mask is then used to fill cut monitors and to
+/// create particles from the passed tracks. The mask is cached by the
+/// event, so a cut shared with other analyses or writers is evaluated once.
+template <class TrackCutType>
+void doFillParticleCollection(TrackCutType *cut,
+                              const StHbtEvent *event,
+                              StHbtParticleCollection *output) {
+
+  const StHbtTrackBatch& batch = event->trackBatch();
+  const StHbtSelectionMask& mask = event->trackSelection(cut);
+
+  for (unsigned int iTrk=0; iTrk<batch.size(); iTrk++) {
+
+    const Bool_t track_passes = ( mask[iTrk] != 0 );
+    cut->fillCutMonitor(batch.track(iTrk), track_passes);
+
+    if (track_passes) {
+      output->push_back( new StHbtParticle(batch.track(iTrk), cut->mass() ) );
+    } //if (track_passes)
+  } //for (unsigned int iTrk=0; iTrk<batch.size(); iTrk++)
+}
+
 // This little function is used to apply ParticleCuts (TrackCuts or V0Cuts) and
 // fill ParticleCollections from tacks in picoEvent. It is called from
 // StHbtAnalysis::processEvent().
@@ -105,7 +132,7 @@ void fillHbtParticleCollection(StHbtParticleCut*         partCut,
     {
       /// Cut is cutting on Tracks
       doFillParticleCollection( (StHbtTrackCut*)partCut,
-				hbtEvent->trackCollection(),
+				(const StHbtEvent*)hbtEvent,
 				partCollection );
     }
     break;
@@ -150,7 +177,8 @@ StHbtAnalysis::StHbtAnalysis() : mPicoEventCollectionVectorHideAway(nullptr),
 				 mEventCut(nullptr), mFirstParticleCut(nullptr),
 				 mSecondParticleCut(nullptr), mMixingBuffer(nullptr),
 				 mPicoEvent(nullptr), mNumEventsToMix(0),mNeventsProcessed(0),
-				 mMinSizePartCollection(0), mVerbose(false) {
+				 mMinSizePartCollection(0), mVerbose(false),
+				 mRandomSeed(0), mIsRandomSeedSet(false), mPairIndex(0) {
   mCorrFctnCollection = new StHbtCorrFctnCollection;
   mMixingBuffer = new StHbtPicoEventCollection;
 }
@@ -168,7 +196,10 @@ StHbtAnalysis::StHbtAnalysis(const StHbtAnalysis& a) : StHbtBaseAnalysis(),
 						       mNumEventsToMix(a.mNumEventsToMix),
 						       mNeventsProcessed(0),
 						       mMinSizePartCollection(a.mMinSizePartCollection),
-						       mVerbose(a.mVerbose) {
+						       mVerbose(a.mVerbose),
+						       mRandomSeed(a.mRandomSeed),
+						       mIsRandomSeedSet(a.mIsRandomSeedSet),
+						       mPairIndex(0) {
 
   const char msg_template[] = " StHbtAnalysis::StHbtAnalysis(const StHbtAnalysis& a) - %s";
   const char warn_template[] = " [WARNING] StHbtAnalysis::StHbtAnalysis(const StHbtAnalysis& a)] %s";
@@ -338,6 +369,8 @@ StHbtAnalysis& StHbtAnalysis::operator=(const StHbtAnalysis& ana) {
     mNumEventsToMix = ana.mNumEventsToMix;
     mMinSizePartCollection = ana.mMinSizePartCollection;
     mVerbose = ana.mVerbose;
+    mRandomSeed = ana.mRandomSeed;
+    mIsRandomSeedSet = ana.mIsRandomSeedSet;
   } //if ( this != &ana )
 
   return *this;
@@ -430,6 +463,7 @@ void StHbtAnalysis::processEvent(const StHbtEvent* hbtEvent) {
   /// We will get a new pico event, if not prevent corr. fctn to access old pico event
   mPicoEvent = nullptr; 
   addEventProcessed();
+  mPairIndex = 0;
 
   /// Startup for EbyE 
   eventBegin(hbtEvent);  
@@ -572,6 +606,7 @@ void StHbtAnalysis::makePairs(const char* typeIn,
 
   /// Create the pair outside  the loop
   StHbtPair* ThePair = new StHbtPair;
+  ThePair->setRandomKey( mRandomSeed );
 
   StHbtCorrFctnIterator CorrFctnIter;
   StHbtParticleIterator PartIter1, PartIter2;
@@ -625,6 +660,7 @@ void StHbtAnalysis::makePairs(const char* typeIn,
 	ThePair->setTrack2( swpart ? *PartIter1 : *PartIter2 );
 	swpart = !swpart;
       }
+      ThePair->setRandomCounter( mNeventsProcessed, mPairIndex++ );
 
       /// Check if the pair passes the cut
       bool tmpPassPair = mPairCut->pass( ThePair );
@@ -752,6 +788,24 @@ TList* StHbtAnalysis::listSettings() {
 TList* StHbtAnalysis::getOutputList() {
   
   /// Collect the list of output objects to be written
+  TList *tOutputList = cutOutputList();
+
+  for (auto &cf : *mCorrFctnCollection) {
+    TList *tListCf = cf->getOutputList();
+
+    TIter nextListCf(tListCf);
+    while (TObject *obj = nextListCf()) {
+      tOutputList->Add(obj);
+    }
+    delete tListCf;
+  }
+
+  return tOutputList;
+}
+
+//_________________________
+TList* StHbtAnalysis::cutOutputList() {
+
   TList *tOutputList = new TList();
 
   TList *p1Cut = mFirstParticleCut->getOutputList();
@@ -785,15 +839,168 @@ TList* StHbtAnalysis::getOutputList() {
   }
   delete eventCut;
 
+  return tOutputList;
+}
+
+//_________________
+void StHbtAnalysis::writeCheckpoint(StHbtCheckpoint& checkpoint) {
+
+  /// Histograms of the cut monitors and content of the correlation
+  /// functions (their output histograms are not created for it)
+  TList *outputList = cutOutputList();
+  checkpoint.writeHistograms( outputList );
+  delete outputList;
   for (auto &cf : *mCorrFctnCollection) {
-    TList *tListCf = cf->getOutputList();
+    cf->writeCheckpoint( checkpoint );
+  }
 
-    TIter nextListCf(tListCf);
-    while (TObject *obj = nextListCf()) {
-      tOutputList->Add(obj);
+  /// Counters
+  checkpoint.write( mNeventsProcessed );
+  mEventCut->writeCheckpoint( checkpoint );
+  mFirstParticleCut->writeCheckpoint( checkpoint );
+  if ( !analyzeIdenticalParticles() ) {
+    mSecondParticleCut->writeCheckpoint( checkpoint );
+  }
+  mPairCut->writeCheckpoint( checkpoint );
+
+  if ( checkpoint.withMixingBuffers() ) {
+    writeMixingBuffers( checkpoint );
+  }
+}
+
+//_________________
+bool StHbtAnalysis::readCheckpoint(StHbtCheckpoint& checkpoint) {
+
+  TList *outputList = cutOutputList();
+  bool isGood = checkpoint.readHistograms( outputList );
+  delete outputList;
+  for (auto &cf : *mCorrFctnCollection) {
+    isGood = isGood && cf->readCheckpoint( checkpoint );
+  }
+
+  isGood = isGood && checkpoint.read( mNeventsProcessed );
+  isGood = isGood && mEventCut->readCheckpoint( checkpoint );
+  isGood = isGood && mFirstParticleCut->readCheckpoint( checkpoint );
+  if ( !analyzeIdenticalParticles() ) {
+    isGood = isGood && mSecondParticleCut->readCheckpoint( checkpoint );
+  }
+  isGood = isGood && mPairCut->readCheckpoint( checkpoint );
+
+  if ( isGood && checkpoint.withMixingBuffers() ) {
+    isGood = readMixingBuffers( checkpoint );
+  }
+  return isGood;
+}
+
+//_________________
+void StHbtAnalysis::mixingBuffers(std::vector<StHbtPicoEventCollection*>& buffers) {
+  buffers.clear();
+  if ( mPicoEventCollectionVectorHideAway ) {
+    for ( int iBin=0; iBin<mPicoEventCollectionVectorHideAway->numberOfBins(); iBin++ ) {
+      buffers.push_back( mPicoEventCollectionVectorHideAway->binCollection( iBin ) );
     }
-    delete tListCf;
   }
+  else if ( mMixingBuffer ) {
+    buffers.push_back( mMixingBuffer );
+  }
+}
 
-  return tOutputList;
+//_________________
+void StHbtAnalysis::writeMixingBuffers(StHbtCheckpoint& checkpoint) {
+
+  std::vector<StHbtPicoEventCollection*> buffers;
+  mixingBuffers( buffers );
+  checkpoint.write( (unsigned int)buffers.size() );
+
+  for ( unsigned int iBuf=0; iBuf<buffers.size(); iBuf++ ) {
+
+    /// Particles are rebuilt from their tracks: buffers with other
+    /// particle types are not stored
+    bool isStorable = true;
+    for ( StHbtPicoEventIterator iter = buffers[iBuf]->begin();
+	  isStorable && iter != buffers[iBuf]->end(); iter++ ) {
+      StHbtParticleCollection *collections[2] = { (*iter)->firstParticleCollection(),
+						   (*iter)->secondParticleCollection() };
+      for ( unsigned int iColl=0; iColl<2; iColl++ ) {
+	for ( StHbtParticleIterator pIter = collections[iColl]->begin();
+	      pIter != collections[iColl]->end(); pIter++ ) {
+	  if ( !(*pIter)->track() ) {
+	    isStorable = false;
+	    break;
+	  }
+	}
+      }
+    } //for ( iter = buffers[iBuf]->begin(); ...
+    if ( !isStorable && mVerbose ) {
+      std::cout << "[WARNING] StHbtAnalysis::writeMixingBuffers - mixing buffer " << iBuf
+		<< " contains non-track particles and is not stored" << std::endl;
+    }
+
+    checkpoint.write( (unsigned int)( isStorable ? buffers[iBuf]->size() : 0 ) );
+    if ( !isStorable ) continue;
+
+    for ( StHbtPicoEventIterator iter = buffers[iBuf]->begin();
+	  iter != buffers[iBuf]->end(); iter++ ) {
+      StHbtParticleCollection *collections[2] = { (*iter)->firstParticleCollection(),
+						   (*iter)->secondParticleCollection() };
+      for ( unsigned int iColl=0; iColl<2; iColl++ ) {
+	checkpoint.write( (unsigned int)collections[iColl]->size() );
+	for ( StHbtParticleIterator pIter = collections[iColl]->begin();
+	      pIter != collections[iColl]->end(); pIter++ ) {
+	  checkpoint.writeTrack( (*pIter)->track() );
+	}
+      }
+    } //for ( iter = buffers[iBuf]->begin(); ...
+  } //for ( unsigned int iBuf=0; iBuf<buffers.size(); iBuf++ )
+}
+
+//_________________
+bool StHbtAnalysis::readMixingBuffers(StHbtCheckpoint& checkpoint) {
+
+  std::vector<StHbtPicoEventCollection*> buffers;
+  mixingBuffers( buffers );
+
+  unsigned int nBuffers = 0;
+  if ( !checkpoint.read( nBuffers ) ) return false;
+  if ( nBuffers != buffers.size() ) {
+    std::cout << "[ERROR] StHbtAnalysis::readMixingBuffers - " << nBuffers
+	      << " mixing buffers stored, " << buffers.size() << " expected" << std::endl;
+    return false;
+  }
+
+  /// Particles are built with the masses of the particle cuts,
+  /// exactly as in fillHbtParticleCollection
+  const double masses[2] = { mFirstParticleCut->mass(), mSecondParticleCut->mass() };
+
+  for ( unsigned int iBuf=0; iBuf<buffers.size(); iBuf++ ) {
+
+    /// Replace the current content
+    for ( StHbtPicoEventIterator iter = buffers[iBuf]->begin();
+	  iter != buffers[iBuf]->end(); iter++ ) {
+      delete *iter;
+    }
+    buffers[iBuf]->clear();
+
+    unsigned int nEvents = 0;
+    if ( !checkpoint.read( nEvents ) ) return false;
+
+    for ( unsigned int iEvent=0; iEvent<nEvents; iEvent++ ) {
+      StHbtPicoEvent *picoEvent = new StHbtPicoEvent;
+      buffers[iBuf]->push_back( picoEvent );
+      StHbtParticleCollection *collections[2] = { picoEvent->firstParticleCollection(),
+						   picoEvent->secondParticleCollection() };
+      for ( unsigned int iColl=0; iColl<2; iColl++ ) {
+	unsigned int nParticles = 0;
+	if ( !checkpoint.read( nParticles ) ) return false;
+	for ( unsigned int iPart=0; iPart<nParticles; iPart++ ) {
+	  StHbtTrack *track = checkpoint.readTrack();
+	  if ( !track ) return false;
+	  collections[iColl]->push_back( new StHbtParticle( track, masses[iColl] ) );
+	  delete track;
+	}
+      } //for ( unsigned int iColl=0; iColl<2; iColl++ )
+    } //for ( unsigned int iEvent=0; iEvent<nEvents; iEvent++ )
+  } //for ( unsigned int iBuf=0; iBuf<buffers.size(); iBuf++ )
+
+  return true;
 }
@@ -30,6 +30,9 @@
 #ifndef StHbtAnalysis_h
 #define StHbtAnalysis_h
 
+/// C++ headers
+#include <vector>
+
 /// StHbtMaker headers
 // Base classes
 #include "StHbtBaseAnalysis.h"
@@ -100,6 +103,14 @@ class StHbtAnalysis : public StHbtBaseAnalysis {
 
   void setMinSizePartCollection(unsigned int& minSize) { mMinSizePartCollection = minSize; }
   void setVerboseMode(bool isVerbose);
+  /// Key of the per-pair random decisions (see StHbtPair::setRandomCounter).
+  /// The same seed gives the same decisions in every run. If it is not set,
+  /// StHbtManager::addAnalysis uses the index of the analysis
+  void setRandomSeed(const unsigned long long& seed)
+  { mRandomSeed = seed; mIsRandomSeedSet = true; }
+  virtual void setDefaultRandomSeed(const unsigned long long& seed)
+  { if ( !mIsRandomSeedSet ) mRandomSeed = seed; }
+  unsigned long long randomSeed() const                { return mRandomSeed; }
 
   /// Event mixing buffer size
   unsigned int numEventsToMix()                        { return mNumEventsToMix; }
@@ -143,6 +154,14 @@ class StHbtAnalysis : public StHbtBaseAnalysis {
   /// Returns number of events which have been passed to processEvent.
   int nEventsProcessed()                                { return mNeventsProcessed; }
 
+  /// Histograms of the cuts, content of the correlation functions (see
+  /// StHbtCorrFctn::writeCheckpoint), counters of the analysis and its cuts
+  /// and, if requested by the checkpoint, the mixing buffers. Only track
+  /// particles are stored in the mixing buffers: a buffer that holds V0,
+  /// Xi or kink particles is saved empty and refills after the restart
+  virtual void writeCheckpoint(StHbtCheckpoint& checkpoint);
+  virtual bool readCheckpoint(StHbtCheckpoint& checkpoint);
+
   virtual void finish();
   
   friend class StHbtLikeSignAnalysis;
@@ -160,6 +179,16 @@ protected:
   ///             to call (AddRealPair or AddMixedPair)
   void makePairs(const char* type, StHbtParticleCollection*, StHbtParticleCollection* p2=0);
 
+  /// Output objects of the event, particle and pair cuts
+  TList* cutOutputList();
+
+  /// All mixing buffers of the analysis (one per bin if the buffers
+  /// are kept in mPicoEventCollectionVectorHideAway)
+  void mixingBuffers(std::vector<StHbtPicoEventCollection*>& buffers);
+  /// Write and read the mixing buffers of the checkpoint
+  void writeMixingBuffers(StHbtCheckpoint& checkpoint);
+  bool readMixingBuffers(StHbtCheckpoint& checkpoint);
+
   /// Mixing Buffer used for Analyses which wrap this one
   StHbtPicoEventCollectionVectorHideAway* mPicoEventCollectionVectorHideAway;
 
@@ -180,6 +209,12 @@ protected:
   unsigned int mMinSizePartCollection;
   /// Print info
   bool mVerbose;
+  /// Key of the per-pair random decisions
+  unsigned long long mRandomSeed;
+  /// True if the seed was set with setRandomSeed
+  bool mIsRandomSeedSet;
+  /// Number of pairs made in the current event
+  unsigned long long mPairIndex;
 
 #ifdef __ROOT__
   ClassDef(StHbtAnalysis, 0)
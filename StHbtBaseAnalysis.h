@@ -7,6 +7,9 @@
 #ifndef StHbtBaseAnalysis_h
 #define StHbtBaseAnalysis_h
 
+/// C++ headers
+#include <iostream>
+
 /// StHbtMaker headers
 #include "StHbtTypes.h"
 
@@ -14,8 +17,10 @@
 #include "TList.h"
 #include "TObjString.h"
 
-/// Forward declaration of StHbtEvent
+/// Forward declarations
 class StHbtEvent;
+class StHbtEventCut;
+class StHbtCheckpoint;
 
 //_________________
 class StHbtBaseAnalysis {
@@ -39,6 +44,24 @@ class StHbtBaseAnalysis {
   /// Main machinery
   virtual void processEvent(const StHbtEvent*) = 0;
 
+  /// Event cut of the analysis. Used by StHbtManager to build the event
+  /// pre-filter of the reader; nullptr means that every event is needed
+  virtual StHbtEventCut* eventCut()  { return nullptr; }
+
+  /// Seed of the random decisions if none was set explicitly. Called by
+  /// StHbtManager::addAnalysis with the index of the analysis, so that
+  /// analyses of one manager do not share the random sequence
+  virtual void setDefaultRandomSeed(const unsigned long long&) { /* no-op */ }
+
+  /// Save the analysis state (histograms, counters and optionally the
+  /// mixing buffers) to the checkpoint, see StHbtManager::setCheckpoint
+  virtual void writeCheckpoint(StHbtCheckpoint&) { /* no-op */ }
+  /// Restore the state saved by writeCheckpoint. Returns false if the
+  /// state can not be restored: analyses that do not implement
+  /// checkpointing can not resume, and the manager then refuses to restore
+  virtual bool readCheckpoint(StHbtCheckpoint&)
+  { std::cout << "[ERROR] StHbtBaseAnalysis: checkpointing is not implemented" << std::endl; return false; }
+
   /// Finish
   virtual void finish() = 0;
   
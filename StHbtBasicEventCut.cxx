@@ -7,9 +7,14 @@
 /// C++ headers
 #include <limits>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
 
 /// StHbtMaker headers
 #include "StHbtBasicEventCut.h"
+#include "StHbtCheckpoint.h"
 
 /// ROOT headers
 #include "TObjString.h"
@@ -59,13 +64,18 @@ StHbtBasicEventCut::StHbtBasicEventCut():
   if( !mTriggersToSelect.empty() ) {
     mTriggersToSelect.clear();
   }
+  fillDefaultBadRunList();
 }
 
 //_________________
 StHbtBasicEventCut::StHbtBasicEventCut(const StHbtBasicEventCut& c):
   StHbtEventCut(c),
   mNEventsPassed(0),
-  mNEventsFailed(0) {
+  mNEventsFailed(0),
+  mTriggersToSelect(c.mTriggersToSelect),
+  mBadRunList(c.mBadRunList),
+  mLastRunNumber(-1),
+  mLastRunIsBad(false) {
   /// Copy constructor
   mCheckBadRun = c.mCheckBadRun;
   mRefMult[0] = c.mRefMult[0];
@@ -88,30 +98,6 @@ StHbtBasicEventCut::StHbtBasicEventCut(const StHbtBasicEventCut& c):
   mCent9[1] = c.mCent9[1];
   mPsiEP[0] = c.mPsiEP[0];
   mPsiEP[1] = c.mPsiEP[1];
-  if( mTriggersToSelect.empty() ) {
-    for( unsigned int iIter=0; iIter<c.mTriggersToSelect.size(); iIter++ ) {
-      mTriggersToSelect.push_back( c.mTriggersToSelect.at( iIter ) );
-    }
-  } // if( mTriggersToSelect.empty() )
-  else {
-    bool notInList = false;
-    for( unsigned int iIter1=0; iIter1<c.mTriggersToSelect.size(); iIter1++) {
-      for( unsigned int iIter2=0; iIter2<mTriggersToSelect.size(); iIter2++ ) {
-	if( mTriggersToSelect.at( iIter2 ) == c.mTriggersToSelect.at( iIter1 ) ) {
-	  continue;
-	}
-	else {
-	  notInList = true;
-	  break;
-	}
-      } // for( unsigned int iIter2=0; iIter2<mTriggersToSelect.size(); iIter2+ )
-
-      /// Add trigger that is not in the list
-      if( notInList ) {
-	mTriggersToSelect.push_back( c.mTriggersToSelect.at( iIter1 ) );
-      }
-    } // for( unsigned int iIter1=0; iIter1<c.mTriggersToSelect.size(); iIter1++)
-  } // else
 }
 
 //_________________
@@ -140,30 +126,10 @@ StHbtBasicEventCut& StHbtBasicEventCut::operator=(const StHbtBasicEventCut& c) {
     mCent9[1] = c.mCent9[1];
     mPsiEP[0] = c.mPsiEP[0];
     mPsiEP[1] = c.mPsiEP[1];
-    if( mTriggersToSelect.empty() ) {
-      for( unsigned int iIter=0; iIter<c.mTriggersToSelect.size(); iIter++ ) {
-	mTriggersToSelect.push_back( c.mTriggersToSelect.at( iIter ) );
-      }
-    } // if( mTriggersToSelect.empty() )
-    else {
-      bool notInList = false;
-      for( unsigned int iIter1=0; iIter1<c.mTriggersToSelect.size(); iIter1++ ) {
-	for( unsigned int iIter2=0; iIter2<mTriggersToSelect.size(); iIter2++ ) {
-	  if( mTriggersToSelect.at( iIter2 ) == c.mTriggersToSelect.at( iIter1 ) ) {
-	    continue;
-	  }
-	  else {
-	    notInList = true;
-	    break;
-	  }
-	} // for( unsigned int iIter2=0; iIter2<mTriggersToSelect.size(); iIter2+ )
-
-	/// Add trigger that is not in the list
-	if( notInList ) {
-	  mTriggersToSelect.push_back( c.mTriggersToSelect.at( iIter1 ) );
-	}
-      } // for( unsigned int iIter1=0; iIter1<c.mTriggersToSelect.size(); iIter1++)
-    } // else
+    mTriggersToSelect = c.mTriggersToSelect;
+    mBadRunList = c.mBadRunList;
+    mLastRunNumber = -1;
+    mLastRunIsBad = false;
   } // if ( this != &c )
 
   return *this;
@@ -206,27 +172,17 @@ bool StHbtBasicEventCut::pass(const StHbtEvent* ev) {
   const bool passes_ep = ( ( mPsiEP[0] <= ev->eventPlaneAngle() ) &&
 			   ( ( ev->eventPlaneAngle() <= mPsiEP[1] ) ) ) ;
 
-  const bool passes_run = !mCheckBadRun ? true :
- 			  ( isInBadRunList( ev->runNumber(), bad_run_list_7GeV,   n_bad_run_numbers[0] ) ||
-			    isInBadRunList( ev->runNumber(), bad_run_list_11GeV,  n_bad_run_numbers[1] ) ||
-			    isInBadRunList( ev->runNumber(), bad_run_list_19GeV,  n_bad_run_numbers[2] ) ||
-			    isInBadRunList( ev->runNumber(), bad_run_list_27GeV,  n_bad_run_numbers[3] ) ||
-			    isInBadRunList( ev->runNumber(), bad_run_list_39GeV,  n_bad_run_numbers[4] ) ||
-			    isInBadRunList( ev->runNumber(), bad_run_list_62GeV,  n_bad_run_numbers[5] ) ||
-			    isInBadRunList( ev->runNumber(), bad_run_list_200GeV, n_bad_run_numbers[6] ) );
-
-  bool passes_trigger = false;
-  if ( mTriggersToSelect.empty() ) {
-    passes_trigger = true;
-  } // if ( mTriggersToSelect.empty() )
-  else {
-    for ( unsigned int iIter=0; iIter<mTriggersToSelect.size(); iIter++ ) {
-      if( ev->isTrigger( mTriggersToSelect.at( iIter ) ) ) {
-	passes_trigger = true;
-	break;
-      } // if( ev->isTrigger( mTriggersToSelect.at( iIter ) ) )
-    } // for ( unsigned int iIter=0; iIter<mTriggersToSelect.size(); iIter++ )
-  } // else
+  const bool passes_run = !mCheckBadRun ? true : !isBadRun( ev->runNumber() );
+
+  /// Both trigger lists are short: look up each trigger of the event
+  /// in the sorted list of triggers to select
+  bool passes_trigger = mTriggersToSelect.empty();
+  const std::vector<unsigned int>& eventTriggers = ev->triggerIds();
+  for ( unsigned int iIter=0; !passes_trigger && iIter<eventTriggers.size(); iIter++ ) {
+    passes_trigger = std::binary_search( mTriggersToSelect.begin(),
+					 mTriggersToSelect.end(),
+					 eventTriggers[iIter] );
+  }
 
   const bool goodEvent =  ( passes_refMult &&
 			    passes_z &&
@@ -305,24 +261,123 @@ StHbtString StHbtBasicEventCut::report() {
   for ( unsigned int iIter=0; iIter<mTriggersToSelect.size(); iIter++ ) {
     report += TString::Format(" %u ", mTriggersToSelect.at( iIter ) );
   }
+  report += TString::Format( "\nNumber of bad runs   :\t %u (check: %d)\n",
+			     (unsigned int)mBadRunList.size(), mCheckBadRun );
   report += TString::Format( "Number of events which passed:\t%u  Number which failed:\t%u\n",
 			     mNEventsPassed, mNEventsFailed );
   return StHbtString( (const char *)report );
 }
 
 //_________________
-bool StHbtBasicEventCut::isInBadRunList(int runNumber, const int *list, int listSize) {
-  /// Compare current run number with the bad run list
-  for( int iSize=0; iSize<listSize; iSize++ ) {
-    if( list[iSize] == runNumber ) {
-      return true;
-    } // if( list[iSize] == runNumber )
-  } // for( int iSize=0; iSize<listSize; iSize++ )
-  return false;
+bool StHbtBasicEventCut::fillPreFilterClause(StHbtEventPreFilter::Clause& clause) const {
+  /// Sphericity, TOF multiplicities, centrality and event plane are
+  /// left to pass(): the clause is a superset of the full cut
+  clause.setRefMult( mRefMult[0], mRefMult[1] );
+  clause.setVertZPos( mVertZPos[0], mVertZPos[1] );
+  clause.setVertRPos( mVertRPos[0], mVertRPos[1], mVertXShift, mVertYShift );
+  clause.setVpdVzDiff( mVpdVzDiff[0], mVpdVzDiff[1] );
+  clause.setTriggerIds( mTriggersToSelect );
+  if ( mCheckBadRun ) {
+    clause.setBadRuns( mBadRunList );
+  }
+  return true;
+}
+
+//_________________
+void StHbtBasicEventCut::addTriggerId(const unsigned int& id) {
+  /// Keep the list sorted and unique
+  std::vector<unsigned int>::iterator iter =
+    std::lower_bound( mTriggersToSelect.begin(), mTriggersToSelect.end(), id );
+  if ( iter == mTriggersToSelect.end() || *iter != id ) {
+    mTriggersToSelect.insert( iter, id );
+  }
+}
+
+//_________________
+bool StHbtBasicEventCut::isBadRun(const int& runNumber) {
+  /// Events come ordered in runs, so the result for the last
+  /// run is cached and the sorted list is searched only on run change
+  if ( runNumber != mLastRunNumber ) {
+    mLastRunNumber = runNumber;
+    mLastRunIsBad = std::binary_search( mBadRunList.begin(), mBadRunList.end(), runNumber );
+  }
+  return mLastRunIsBad;
+}
+
+//_________________
+void StHbtBasicEventCut::addBadRun(const int& runNumber) {
+  /// Keep the list sorted and unique
+  std::vector<int>::iterator iter =
+    std::lower_bound( mBadRunList.begin(), mBadRunList.end(), runNumber );
+  if ( iter == mBadRunList.end() || *iter != runNumber ) {
+    mBadRunList.insert( iter, runNumber );
+  }
+  mLastRunNumber = -1;
+}
+
+//_________________
+void StHbtBasicEventCut::clearBadRunList() {
+  mBadRunList.clear();
+  mLastRunNumber = -1;
 }
 
 //_________________
-const int StHbtBasicEventCut::n_bad_run_numbers[7] = {328,27,38,105,35,34,219};
+int StHbtBasicEventCut::loadBadRunList(const char* fileName) {
+
+  std::ifstream inFile( fileName );
+  if ( !inFile.is_open() ) {
+    std::cout << "[WARNING] StHbtBasicEventCut::loadBadRunList - can not open file: "
+	      << fileName << std::endl;
+    return -1;
+  }
+
+  int nRuns = 0;
+  std::string line;
+  while ( std::getline( inFile, line ) ) {
+    if ( line.empty() || line[0] == '#' ) continue;
+    std::istringstream lineStream( line );
+    int runNumber;
+    while ( lineStream >> runNumber ) {
+      mBadRunList.push_back( runNumber );
+      nRuns++;
+    }
+  } //while ( std::getline( inFile, line ) )
+  inFile.close();
+
+  std::sort( mBadRunList.begin(), mBadRunList.end() );
+  mBadRunList.erase( std::unique( mBadRunList.begin(), mBadRunList.end() ),
+		     mBadRunList.end() );
+  mLastRunNumber = -1;
+
+  return nRuns;
+}
+
+//_________________
+void StHbtBasicEventCut::fillDefaultBadRunList() {
+
+  const int* lists[7] = { bad_run_list_7GeV, bad_run_list_11GeV, bad_run_list_19GeV,
+			  bad_run_list_27GeV, bad_run_list_39GeV, bad_run_list_62GeV,
+			  bad_run_list_200GeV };
+  const int sizes[7] = { sizeof(bad_run_list_7GeV) / sizeof(int),
+			 sizeof(bad_run_list_11GeV) / sizeof(int),
+			 sizeof(bad_run_list_19GeV) / sizeof(int),
+			 sizeof(bad_run_list_27GeV) / sizeof(int),
+			 sizeof(bad_run_list_39GeV) / sizeof(int),
+			 sizeof(bad_run_list_62GeV) / sizeof(int),
+			 sizeof(bad_run_list_200GeV) / sizeof(int) };
+
+  for ( int iList=0; iList<7; iList++ ) {
+    mBadRunList.insert( mBadRunList.end(), lists[iList], lists[iList] + sizes[iList] );
+  }
+
+  /// Arrays are not fully filled: drop the zero padding
+  mBadRunList.erase( std::remove( mBadRunList.begin(), mBadRunList.end(), 0 ),
+		     mBadRunList.end() );
+  std::sort( mBadRunList.begin(), mBadRunList.end() );
+  mBadRunList.erase( std::unique( mBadRunList.begin(), mBadRunList.end() ),
+		     mBadRunList.end() );
+  mLastRunNumber = -1;
+}
 
 //_________________
 const int StHbtBasicEventCut::bad_run_list_7GeV[328]  = {11114084,11114085,11114086,11114088,11114089,11114094,
@@ -420,3 +475,14 @@ const int StHbtBasicEventCut::bad_run_list_200GeV[219]  = { 11002120, 11002121,
 						       11061038, 11061095, 11063006, 11063007, 11063008, 11063011, 11063013, 11063014, 11063015, 11063016, 
 						       11063017, 11063036, 11063083, 11064003, 11064023, 11065038, 11066024, 11066045, 11071056, 11072032, 
 						       11072044, 11072045, 11073001, 11073002, 11073003, 11073049, 11075039, 11075045, 11075048 };
+
+//_________________
+void StHbtBasicEventCut::writeCheckpoint(StHbtCheckpoint& checkpoint) const {
+  checkpoint.write( mNEventsPassed );
+  checkpoint.write( mNEventsFailed );
+}
+
+//_________________
+bool StHbtBasicEventCut::readCheckpoint(StHbtCheckpoint& checkpoint) {
+  return ( checkpoint.read( mNEventsPassed ) && checkpoint.read( mNEventsFailed ) );
+}
@@ -34,6 +34,16 @@ class StHbtBasicEventCut : public StHbtEventCut {
   
   /// Check bad run flag
   void setCheckBadRun(bool check) { mCheckBadRun = check; }
+  /// Add run number to the bad run list
+  void addBadRun(const int& runNumber);
+  /// Read bad run numbers from a text file (whitespace-separated, lines
+  /// starting with '#' are skipped) and add them to the bad run list.
+  /// Returns the number of runs read or -1 if the file can not be opened
+  int loadBadRunList(const char* fileName);
+  /// Remove all runs (including the built-in ones) from the bad run list
+  void clearBadRunList();
+  /// Return true if the run is in the bad run list
+  bool isBadRun(const int& runNumber);
   /// Set min and max acceptable event multiplicity
   void setEventMult(const int& lo, const int& hi)     { mRefMult[0] = lo; mRefMult[1] = hi; }
   /// Set min and max acceptable vertex z-coordinate
@@ -65,6 +75,11 @@ class StHbtBasicEventCut : public StHbtEventCut {
   virtual TList* appendSettings(TList*, const TString& prefix="") const;
   virtual StHbtString report();
   virtual bool pass(const StHbtEvent* event);
+  /// Vertex, multiplicity, (Vz-VpdVz), trigger and bad run windows
+  virtual bool fillPreFilterClause(StHbtEventPreFilter::Clause& clause) const;
+  /// Passed and failed event counters
+  virtual void writeCheckpoint(StHbtCheckpoint& checkpoint) const;
+  virtual bool readCheckpoint(StHbtCheckpoint& checkpoint);
 
   virtual StHbtEventCut* clone() const
   { StHbtBasicEventCut* c = new StHbtBasicEventCut(*this); return c; }
@@ -97,13 +112,18 @@ class StHbtBasicEventCut : public StHbtEventCut {
   unsigned int mNEventsPassed;
   /// Number of events checked by this cut that failed
   unsigned int mNEventsFailed;
-  /// If set, only given trigger will be selected
+  /// If set, only given trigger will be selected (kept sorted)
   std::vector<unsigned int> mTriggersToSelect;
+  /// Sorted list of bad runs. The built-in lists below are merged
+  /// into it at construction
+  std::vector<int> mBadRunList;
+  /// Last checked run number and its status
+  int mLastRunNumber;  //!
+  bool mLastRunIsBad;  //!
 
-  /// Method that looks at the bad run lists
-  bool isInBadRunList(int, const Int_t*, int);
+  /// Merge the built-in bad run lists into mBadRunList
+  void fillDefaultBadRunList();
 
-  static const int n_bad_run_numbers[7];
   static const int bad_run_list_7GeV[328];
   static const int bad_run_list_11GeV[27];
   static const int bad_run_list_19GeV[35];
@@ -113,7 +133,7 @@ class StHbtBasicEventCut : public StHbtEventCut {
   static const int bad_run_list_200GeV[219];
 
 #ifdef __ROOT__
-  ClassDef(StHbtBasicEventCut, 1);
+  ClassDef(StHbtBasicEventCut, 2);
 #endif
 };
 
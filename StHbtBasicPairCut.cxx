@@ -1,4 +1,5 @@
 #include "StHbtBasicPairCut.h"
+#include "StHbtCheckpoint.h"
 
 #ifdef __ROOT__
 ClassImp(StHbtBasicPairCut)
@@ -186,3 +187,14 @@ TList *StHbtBasicPairCut::listSettings() {
 
   return settings_list;
 }
+
+//_________________
+void StHbtBasicPairCut::writeCheckpoint(StHbtCheckpoint& checkpoint) const {
+  checkpoint.write( mNPairsPassed );
+  checkpoint.write( mNPairsFailed );
+}
+
+//_________________
+bool StHbtBasicPairCut::readCheckpoint(StHbtCheckpoint& checkpoint) {
+  return ( checkpoint.read( mNPairsPassed ) && checkpoint.read( mNPairsFailed ) );
+}
@@ -35,6 +35,10 @@ class StHbtBasicPairCut : public StHbtPairCut {
   void setRValue(const float& lo);
   virtual StHbtString report();
 
+  /// Passed and failed pair counters
+  virtual void writeCheckpoint(StHbtCheckpoint& checkpoint) const;
+  virtual bool readCheckpoint(StHbtCheckpoint& checkpoint);
+
  private:
 
   TVector3 mPrimaryVertex;
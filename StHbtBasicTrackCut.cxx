@@ -7,13 +7,17 @@
 
 /// C++ headers
 #include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <limits>
 
 /// StHbtMaker headers
 #include "StHbtBasicTrackCut.h"
+#include "StHbtCheckpoint.h"
 
 /// ROOT headers
 #include "TString.h"
-#include "TLorentzVector.h"
+#include "TVector3.h"
 
 #ifdef __ROOT__
 ClassImp(StHbtBasicTrackCut);
@@ -28,7 +32,8 @@ StHbtBasicTrackCut::StHbtBasicTrackCut():
   mDetSelection(3),
   mPidSelection(HbtPID::Pion),
   mNTracksPassed(0),
-  mNTracksFailed(0) {
+  mNTracksFailed(0),
+  mPidTableValid(false) {
   /// Default constructor
 
   mNHits[0] = 10;
@@ -81,7 +86,8 @@ StHbtBasicTrackCut::StHbtBasicTrackCut(const StHbtBasicTrackCut& c) :
   mDetSelection(c.mDetSelection),
   mPidSelection(c.mPidSelection),
   mNTracksPassed(0),
-  mNTracksFailed(0) {
+  mNTracksFailed(0),
+  mPidTableValid(false) {
   /// Copy constructor
   
   mNHits[0] = c.mNHits[0];
@@ -179,6 +185,7 @@ StHbtBasicTrackCut& StHbtBasicTrackCut::operator=(const StHbtBasicTrackCut& c) {
       
     mNTracksPassed = 0;
     mNTracksFailed = 0;
+    mPidTableValid = false;
   }
 
   return *this;
@@ -189,31 +196,108 @@ StHbtBasicTrackCut::~StHbtBasicTrackCut() {
   /* emtpy */
 }
 
+//_________________
+void StHbtBasicTrackCut::compilePidTable() {
+
+  /// Translate the nSigma settings into per-species windows. Species index:
+  /// 0 - electron, 1 - pion, 2 - kaon, 3 - proton. The selected species gets
+  /// its TPC and TPC+TOF windows, while the other species get the exclusion
+  /// (nSigmaOther) window. Unused windows are fully open, so pidPass() can
+  /// check all four species without knowing which one is selected.
+  const float kMax = std::numeric_limits<float>::max();
+  const float *tpcWindow[4] = { mNSigmaElectron, mNSigmaPion, mNSigmaKaon, mNSigmaProton };
+  const float *tntWindow[4] = { mTnTNSigmaElectron, mTnTNSigmaPion, mTnTNSigmaKaon, mTnTNSigmaProton };
+  const int selected = (int)mPidSelection - (int)HbtPID::Electron;
+
+  if ( selected < 0 || selected > 3 ) {
+    std::cout << "[ERROR] StHbtBasicTrackCut: Wrong HbtPID " << mPidSelection << std::endl;
+  }
+
+  for ( int iSpec=0; iSpec<4; iSpec++ ) {
+    if ( iSpec == selected ) {
+      mPidTpcLo[iSpec] = tpcWindow[iSpec][0];
+      mPidTpcHi[iSpec] = tpcWindow[iSpec][1];
+      mPidVetoLo[iSpec] = kMax;
+      mPidVetoHi[iSpec] = kMax;
+      mPidTnTLo[iSpec] = tntWindow[iSpec][0];
+      mPidTnTHi[iSpec] = tntWindow[iSpec][1];
+    }
+    else if ( selected >= 0 && selected <= 3 ) {
+      mPidTpcLo[iSpec] = -kMax;
+      mPidTpcHi[iSpec] = kMax;
+      mPidVetoLo[iSpec] = mNSigmaOther[0];
+      mPidVetoHi[iSpec] = mNSigmaOther[1];
+      mPidTnTLo[iSpec] = -kMax;
+      mPidTnTHi[iSpec] = kMax;
+    }
+    else {
+      /// Wrong PID selection: close all windows so nothing passes
+      mPidTpcLo[iSpec] = kMax;
+      mPidTpcHi[iSpec] = -kMax;
+      mPidVetoLo[iSpec] = -kMax;
+      mPidVetoHi[iSpec] = kMax;
+      mPidTnTLo[iSpec] = kMax;
+      mPidTnTHi[iSpec] = -kMax;
+    }
+  } //for ( int iSpec=0; iSpec<4; iSpec++ )
+
+  mPidTableValid = true;
+}
+
+//_________________
+template <unsigned char Det>
+inline bool StHbtBasicTrackCut::pidPass(const float* nSigma, const float& p,
+					const float& massSqr, const bool& hasTof) const {
+
+  /// TPC and TPC+TOF windows for all species (see compilePidTable)
+  bool tpcPid = ( mTpcMom[0] <= p ) & ( p <= mTpcMom[1] );
+  bool tntPid = true;
+  for ( int iSpec=0; iSpec<4; iSpec++ ) {
+    tpcPid &= ( ( mPidTpcLo[iSpec] <= nSigma[iSpec] ) & ( nSigma[iSpec] <= mPidTpcHi[iSpec] ) &
+		( ( nSigma[iSpec] <= mPidVetoLo[iSpec] ) | ( nSigma[iSpec] >= mPidVetoHi[iSpec] ) ) );
+    tntPid &= ( mPidTnTLo[iSpec] <= nSigma[iSpec] ) & ( nSigma[iSpec] <= mPidTnTHi[iSpec] );
+  }
+
+  /// TOF window. Must be a TOF-matched track
+  const bool tofPid = ( hasTof &
+			( mTofMassSqr[0] <= massSqr ) & ( massSqr <= mTofMassSqr[1] ) &
+			( mTofMom[0] <= p ) & ( p <= mTofMom[1] ) );
+
+  /// Det is a compile-time constant, so only one of the lines below survives
+  if ( Det == 0 ) return tpcPid;                    /// TPC
+  if ( Det == 1 ) return tofPid;                    /// TOF
+  if ( Det == 2 ) return ( tofPid & tntPid );       /// TPC+TOF
+  return ( ( tofPid & tntPid ) | ( !hasTof & tpcPid ) ); /// if(TOF) {TPC+TOF} else {TPC}
+}
+
 //_________________
 bool StHbtBasicTrackCut::pass(const StHbtTrack* t) {
   // Test the particle and return true if it meets all the criteria
   // false if it doesn't meet at least one of the criteria
 
+  if ( !mPidTableValid ) compilePidTable();
+
   const bool goodType = ( mType == t->type() );
   const bool primTrk = ( goodType && t->isPrimary() );
 
-  TLorentzVector vec;
-  if( primTrk ) {
-    vec.SetXYZM( t->pMom().X(), t->pMom().Y(), t->pMom().Z(), mMass );
-  }
-  else {
-    vec.SetXYZM( t->gMom().X(), t->gMom().Y(), t->gMom().Z(), mMass );
-  }
-
+  /// Kinematics is computed directly from the momentum components
+  const TVector3 mom = primTrk ? t->pMom() : t->gMom();
+  const float pz = mom.Z();
+  const float pt = mom.Perp();
+  const float p = mom.Mag();
+  const float energy = std::sqrt( p * p + mMass * mMass );
+  const float rapidity = 0.5 * std::log( ( energy + pz ) / ( energy - pz ) );
+  const float eta = 0.5 * std::log( ( p + pz ) / ( p - pz ) );
+  const float dca = t->gDCA().Mag();
 
   const bool goodCharge = ( mCharge == (char)t->charge() );
-  const bool goodKine = ( ( mNHits[0] <= t->nHits() ) && ( t->nHits() <= mNHits[1] ) &&
-			  ( t->nHitsFit2PossRatio() >= mNHitsRat ) &&
-			  ( mPt[0] <= vec.Pt() ) && ( vec.Pt() <= mPt[1] ) &&
-			  ( mP[0] <= vec.P() ) && ( vec.P() <= mP[1] ) &&
-			  ( mRapidity[0] <= vec.Rapidity() ) && ( vec.Rapidity() <= mRapidity[1] ) &&
-			  ( mEta[0] <= vec.Eta() ) && ( vec.Eta() <= mEta[1] ) &&
-			  ( mDCA[0] <= t->gDCA().Mag() ) && ( t->gDCA().Mag() <= mDCA[1] ) );
+  const bool goodKine = ( ( mNHits[0] <= t->nHits() ) & ( t->nHits() <= mNHits[1] ) &
+			  ( t->nHitsFit2PossRatio() >= mNHitsRat ) &
+			  ( mPt[0] <= pt ) & ( pt <= mPt[1] ) &
+			  ( mP[0] <= p ) & ( p <= mP[1] ) &
+			  ( mRapidity[0] <= rapidity ) & ( rapidity <= mRapidity[1] ) &
+			  ( mEta[0] <= eta ) & ( eta <= mEta[1] ) &
+			  ( mDCA[0] <= dca ) & ( dca <= mDCA[1] ) );
 
   /// Check just first particles cuts withou PID (fasten track processing)
   if( !goodType || !goodCharge || !goodKine ) {
@@ -221,174 +305,116 @@ bool StHbtBasicTrackCut::pass(const StHbtTrack* t) {
     return false;
   }
 
-  bool goodPID = false;
+  const float nSigma[4] = { t->nSigmaElectron(), t->nSigmaPion(),
+			    t->nSigmaKaon(), t->nSigmaProton() };
+  const float massSqr = t->massSqr();
+  const bool hasTof = t->isTofTrack();
 
   /// Choose identification scheme
-  if( mDetSelection == 0 ) {          /// TPC selection
-    
-    if ( mPidSelection == HbtPID::Electron ) {    /// Electron
-      goodPID = ( ( mNSigmaElectron[0] <= t->nSigmaElectron() ) &&
-		  ( t->nSigmaElectron() <= mNSigmaElectron[1] ) &&
-		  ( mTpcMom[0] <= vec.P() ) && ( vec.P() <= mTpcMom[1] ) &&
-		  ( ( t->nSigmaPion() <= mNSigmaOther[0] ) || ( t->nSigmaPion() >= mNSigmaOther[1] ) ) &&
-		  ( ( t->nSigmaKaon() <= mNSigmaOther[0] ) || ( t->nSigmaKaon() >= mNSigmaOther[1] ) ) &&
-		  ( ( t->nSigmaProton() <= mNSigmaOther[0] ) || ( t->nSigmaProton() >= mNSigmaOther[1] ) ) );
-    }
-    else if ( mPidSelection == HbtPID::Pion ) {   /// Pion
-      goodPID = ( ( mNSigmaPion[0] <= t->nSigmaPion() ) &&
-		  ( t->nSigmaPion() <= mNSigmaPion[1] ) &&
-		  ( mTpcMom[0] <= vec.P() ) && ( vec.P() <= mTpcMom[1] ) &&
-		  ( ( t->nSigmaElectron() <= mNSigmaOther[0] ) || ( t->nSigmaElectron() >= mNSigmaOther[1] ) ) &&
-		  ( ( t->nSigmaKaon() <= mNSigmaOther[0] ) || ( t->nSigmaKaon() >= mNSigmaOther[1] ) ) &&
-		  ( ( t->nSigmaProton() <= mNSigmaOther[0] ) || ( t->nSigmaProton() >= mNSigmaOther[1] ) ) );
-    }
-    else if ( mPidSelection == HbtPID::Kaon ) {   /// Kaon
-      goodPID = ( ( mNSigmaKaon[0] <= t->nSigmaKaon() ) &&
-		  ( t->nSigmaKaon() <= mNSigmaKaon[1] ) &&
-		  ( mTpcMom[0] <= vec.P() ) && ( vec.P() <= mTpcMom[1] ) &&
-		  ( ( t->nSigmaElectron() <= mNSigmaOther[0] ) || ( t->nSigmaElectron() >= mNSigmaOther[1] ) ) &&
-		  ( ( t->nSigmaPion() <= mNSigmaOther[0] ) || ( t->nSigmaPion() >= mNSigmaOther[1] ) ) &&
-		  ( ( t->nSigmaProton() <= mNSigmaOther[0] ) || ( t->nSigmaProton() >= mNSigmaOther[1] ) ) );
-    }
-    else if ( mPidSelection == HbtPID::Proton ) { /// Proton
-      goodPID = ( ( mNSigmaProton[0] <= t->nSigmaProton() ) &&
-		  ( t->nSigmaProton() <= mNSigmaProton[1] ) &&
-		  ( mTpcMom[0] <= vec.P() ) && ( vec.P() <= mTpcMom[1] ) &&
-		  ( ( t->nSigmaElectron() <= mNSigmaOther[0] ) || ( t->nSigmaElectron() >= mNSigmaOther[1] ) ) &&
-		  ( ( t->nSigmaPion() <= mNSigmaOther[0] ) || ( t->nSigmaPion() >= mNSigmaOther[1] ) ) &&
-		  ( ( t->nSigmaKaon() <= mNSigmaOther[0] ) || ( t->nSigmaKaon() >= mNSigmaOther[1] ) ) );
-    }
-    else {
-      std::cout << "[ERROR] StHbtBasicTrackCut: Wrong HbtPID " << mPidSelection << std::endl;
-      return false;
-    }
-    
-  }
-  else if ( mDetSelection == 1 ) {    /// TOF selection
-    /// Must be a TOF-matched track
-    if( t->isTofTrack() ) {
-      goodPID = ( ( mTofMassSqr[0] <= t->massSqr() ) && ( t->massSqr() <= mTofMassSqr[1] ) &&
-		  ( mTofMom[0] <= vec.P() ) && ( vec.P() <= mTofMom[1] ) );
-    } // if( t->isTofTrack() )
-  }
-  else if ( mDetSelection == 2 ) {    /// TPC+TOF selection
-    /// Must be a TOF-matched track
-    if( t->isTofTrack() ) {
-
-      if( mPidSelection == HbtPID::Electron ) {        /// Electron
-	goodPID = ( ( mTofMassSqr[0] <= t->massSqr() ) && ( t->massSqr() <= mTofMassSqr[1] ) &&
-		    ( mTofMom[0] <= vec.P() ) && ( vec.P() <= mTofMom[1] ) &&
-		    ( mTnTNSigmaElectron[0] <= t->nSigmaElectron() ) &&
-		    ( t->nSigmaElectron() <= mTnTNSigmaElectron[1] ) );
-      }
-      else if ( mPidSelection == HbtPID::Pion ) {      /// Pion
-	goodPID = ( ( mTofMassSqr[0] <= t->massSqr() ) && ( t->massSqr() <= mTofMassSqr[1] ) &&
-		    ( mTofMom[0] <= vec.P() ) && ( vec.P() <= mTofMom[1] ) &&
-		    ( mTnTNSigmaPion[0] <= t->nSigmaPion() ) &&
-		    ( t->nSigmaPion() <= mTnTNSigmaPion[1] ) );
-      }
-      else if ( mPidSelection == HbtPID::Kaon ) {      /// Kaon
-	goodPID = ( ( mTofMassSqr[0] <= t->massSqr() ) && ( t->massSqr() <= mTofMassSqr[1] ) &&
-		    ( mTofMom[0] <= vec.P() ) && ( vec.P() <= mTofMom[1] ) &&
-		    ( mTnTNSigmaKaon[0] <= t->nSigmaKaon() ) &&
-		    ( t->nSigmaKaon() <= mTnTNSigmaKaon[1] ) );
-      }
-      else if ( mPidSelection == HbtPID::Proton ) {    /// Proton
-	goodPID = ( ( mTofMassSqr[0] <= t->massSqr() ) && ( t->massSqr() <= mTofMassSqr[1] ) &&
-		    ( mTofMom[0] <= vec.P() ) && ( vec.P() <= mTofMom[1] ) &&
-		    ( mTnTNSigmaProton[0] <= t->nSigmaProton() ) &&
-		    ( t->nSigmaProton() <= mTnTNSigmaProton[1] ) );
-      }
-      else {
-	std::cout << "[ERROR] StHbtBasicTrackCut: Wrong HbtPID " << mPidSelection << std::endl;
-	return false;
-      }
-    } // if( t->isTofTrack() )
-  }
-  else if ( mDetSelection == 3 ) {    /// if(TOF) {TPC+TOF} else {TPC}
-
-    /// If there is a TOF hit, then use TPC+TOF identification
-    if( t->isTofTrack() ) {
-      if( mPidSelection == HbtPID::Electron ) {        /// Electron
-	goodPID = ( ( mTofMassSqr[0] <= t->massSqr() ) && ( t->massSqr() <= mTofMassSqr[1] ) &&
-		    ( mTofMom[0] <= vec.P() ) && ( vec.P() <= mTofMom[1] ) &&
-		    ( mTnTNSigmaElectron[0] <= t->nSigmaElectron() ) &&
-		    ( t->nSigmaElectron() <= mTnTNSigmaElectron[1] ) );
-      }
-      else if ( mPidSelection == HbtPID::Pion ) {      /// Pion
-	goodPID = ( ( mTofMassSqr[0] <= t->massSqr() ) && ( t->massSqr() <= mTofMassSqr[1] ) &&
-		    ( mTofMom[0] <= vec.P() ) && ( vec.P() <= mTofMom[1] ) &&
-		    ( mTnTNSigmaPion[0] <= t->nSigmaPion() ) &&
-		    ( t->nSigmaPion() <= mTnTNSigmaPion[1] ) );
-      }
-      else if ( mPidSelection == HbtPID::Kaon ) {      /// Kaon
-	goodPID = ( ( mTofMassSqr[0] <= t->massSqr() ) && ( t->massSqr() <= mTofMassSqr[1] ) &&
-		    ( mTofMom[0] <= vec.P() ) && ( vec.P() <= mTofMom[1] ) &&
-		    ( mTnTNSigmaKaon[0] <= t->nSigmaKaon() ) &&
-		    ( t->nSigmaKaon() <= mTnTNSigmaKaon[1] ) );
-      }
-      else if ( mPidSelection == HbtPID::Proton ) {    /// Proton
-	goodPID = ( ( mTofMassSqr[0] <= t->massSqr() ) && ( t->massSqr() <= mTofMassSqr[1] ) &&
-		    ( mTofMom[0] <= vec.P() ) && ( vec.P() <= mTofMom[1] ) &&
-		    ( mTnTNSigmaProton[0] <= t->nSigmaProton() ) &&
-		    ( t->nSigmaProton() <= mTnTNSigmaProton[1] ) );
-      }
-      else {
-	std::cout << "[ERROR] StHbtBasicTrackCut: Wrong HbtPID " << mPidSelection << std::endl;
-	return false;
-      }
-    } // if( t->isTofTrack() )
-    else {  /// When no TOF hit is available check TPC only
-      if ( mPidSelection == HbtPID::Electron ) {    /// Electron
-	goodPID = ( ( mNSigmaElectron[0] <= t->nSigmaElectron() ) &&
-		    ( t->nSigmaElectron() <= mNSigmaElectron[1] ) &&
-		    ( mTpcMom[0] <= vec.P() ) && ( vec.P() <= mTpcMom[1] ) &&
-		    ( ( t->nSigmaPion() <= mNSigmaOther[0] ) || ( t->nSigmaPion() >= mNSigmaOther[1] ) ) &&
-		    ( ( t->nSigmaKaon() <= mNSigmaOther[0] ) || ( t->nSigmaKaon() >= mNSigmaOther[1] ) ) &&
-		    ( ( t->nSigmaProton() <= mNSigmaOther[0] ) || ( t->nSigmaProton() >= mNSigmaOther[1] ) ) );
-      }
-      else if ( mPidSelection == HbtPID::Pion ) {   /// Pion
-	goodPID = ( ( mNSigmaPion[0] <= t->nSigmaPion() ) &&
-		    ( t->nSigmaPion() <= mNSigmaPion[1] ) &&
-		    ( mTpcMom[0] <= vec.P() ) && ( vec.P() <= mTpcMom[1] ) &&
-		    ( ( t->nSigmaElectron() <= mNSigmaOther[0] ) || ( t->nSigmaElectron() >= mNSigmaOther[1] ) ) &&
-		    ( ( t->nSigmaKaon() <= mNSigmaOther[0] ) || ( t->nSigmaKaon() >= mNSigmaOther[1] ) ) &&
-		    ( ( t->nSigmaProton() <= mNSigmaOther[0] ) || ( t->nSigmaProton() >= mNSigmaOther[1] ) ) );
-      }
-      else if ( mPidSelection == HbtPID::Kaon ) {   /// Kaon
-	goodPID = ( ( mNSigmaKaon[0] <= t->nSigmaKaon() ) &&
-		    ( t->nSigmaKaon() <= mNSigmaKaon[1] ) &&
-		    ( mTpcMom[0] <= vec.P() ) && ( vec.P() <= mTpcMom[1] ) &&
-		    ( ( t->nSigmaElectron() <= mNSigmaOther[0] ) || ( t->nSigmaElectron() >= mNSigmaOther[1] ) ) &&
-		    ( ( t->nSigmaPion() <= mNSigmaOther[0] ) || ( t->nSigmaPion() >= mNSigmaOther[1] ) ) &&
-		    ( ( t->nSigmaProton() <= mNSigmaOther[0] ) || ( t->nSigmaProton() >= mNSigmaOther[1] ) ) );
-      }
-      else if ( mPidSelection == HbtPID::Proton ) { /// Proton
-	goodPID = ( ( mNSigmaProton[0] <= t->nSigmaProton() ) &&
-		    ( t->nSigmaProton() <= mNSigmaProton[1] ) &&
-		    ( mTpcMom[0] <= vec.P() ) && ( vec.P() <= mTpcMom[1] ) &&
-		    ( ( t->nSigmaElectron() <= mNSigmaOther[0] ) || ( t->nSigmaElectron() >= mNSigmaOther[1] ) ) &&
-		    ( ( t->nSigmaPion() <= mNSigmaOther[0] ) || ( t->nSigmaPion() >= mNSigmaOther[1] ) ) &&
-		    ( ( t->nSigmaKaon() <= mNSigmaOther[0] ) || ( t->nSigmaKaon() >= mNSigmaOther[1] ) ) );
-      }
-      else {
-	std::cout << "[ERROR] StHbtBasicTrackCut: Wrong HbtPID " << mPidSelection << std::endl;
-	return false;
-      }
-    } // else
-  }
-  else {
+  bool goodPID = false;
+  switch ( mDetSelection ) {
+  case 0: goodPID = pidPass<0>( nSigma, p, massSqr, hasTof ); break;
+  case 1: goodPID = pidPass<1>( nSigma, p, massSqr, hasTof ); break;
+  case 2: goodPID = pidPass<2>( nSigma, p, massSqr, hasTof ); break;
+  case 3: goodPID = pidPass<3>( nSigma, p, massSqr, hasTof ); break;
+  default:
     std::cout << "[ERROR] StHbtBasicTrackCut: Wrong particle identification scheme "
 	      << mDetSelection << std::endl;
     return false;
   }
 
-  /// Final calculation
-  const bool goodTrack = goodCharge && goodType && goodKine && goodPID;
-
   /// Choose your destiny
-  goodTrack ? mNTracksPassed++ : mNTracksFailed++;
-  return goodTrack;
+  goodPID ? mNTracksPassed++ : mNTracksFailed++;
+  return goodPID;
+}
+
+//_________________
+template <unsigned char Det>
+unsigned int StHbtBasicTrackCut::batchLoop(const StHbtTrackBatch& b, unsigned char* result) const {
+
+  /// Every window is evaluated for every track with bitwise logic only,
+  /// so the loop has no data-dependent branches and can be vectorized
+  const unsigned int nTracks = b.size();
+  const unsigned char type = mType ? 1 : 0;
+  const signed char charge = (signed char)mCharge;
+  const float mass2 = mMass * mMass;
+
+  /// Columns
+  const float *pt = b.pt();
+  const float *ptot = b.ptot();
+  const float *pz = b.pz();
+  const float *dca = b.dca();
+  const unsigned short *nHits = b.nHits();
+  const float *nHitsRatio = b.nHitsRatio();
+  const float *massSqr = b.massSqr();
+  const unsigned char *isTof = b.isTofTrack();
+  const signed char *trkCharge = b.charge();
+  const unsigned char *trkType = b.type();
+  const float *nSigmaColumn[4] = { b.nSigmaElectron(), b.nSigmaPion(),
+				   b.nSigmaKaon(), b.nSigmaProton() };
+
+  unsigned int nPassed = 0;
+  for ( unsigned int i=0; i<nTracks; i++ ) {
+
+    const float p = ptot[i];
+    const float energy = std::sqrt( p * p + mass2 );
+    const float rapidity = 0.5f * std::log( ( energy + pz[i] ) / ( energy - pz[i] ) );
+    const float eta = 0.5f * std::log( ( p + pz[i] ) / ( p - pz[i] ) );
+
+    const bool goodType = ( trkType[i] == type );
+    const bool goodCharge = ( trkCharge[i] == charge );
+    const bool goodKine = ( ( mNHits[0] <= nHits[i] ) & ( nHits[i] <= mNHits[1] ) &
+			    ( nHitsRatio[i] >= mNHitsRat ) &
+			    ( mPt[0] <= pt[i] ) & ( pt[i] <= mPt[1] ) &
+			    ( mP[0] <= p ) & ( p <= mP[1] ) &
+			    ( mRapidity[0] <= rapidity ) & ( rapidity <= mRapidity[1] ) &
+			    ( mEta[0] <= eta ) & ( eta <= mEta[1] ) &
+			    ( mDCA[0] <= dca[i] ) & ( dca[i] <= mDCA[1] ) );
+
+    const float nSigma[4] = { nSigmaColumn[0][i], nSigmaColumn[1][i],
+			      nSigmaColumn[2][i], nSigmaColumn[3][i] };
+    const bool goodPID = pidPass<Det>( nSigma, p, massSqr[i], isTof[i] != 0 );
+
+    const unsigned char good = ( goodType & goodCharge & goodKine & goodPID ) ? 1 : 0;
+    result[i] = good;
+    nPassed += good;
+  } //for ( unsigned int i=0; i<nTracks; i++ )
+
+  return nPassed;
+}
+
+//_________________
+void StHbtBasicTrackCut::passBatch(const StHbtTrackBatch& b, StHbtSelectionMask& mask) {
+
+  /// Columnar version of pass()
+  const unsigned int nTracks = b.size();
+  mask.resize( nTracks );
+  if ( nTracks == 0 ) return;
+
+  if ( !mPidTableValid ) compilePidTable();
+
+  unsigned int nPassed = 0;
+  switch ( mDetSelection ) {
+  case 0: nPassed = batchLoop<0>( b, mask.data() ); break;
+  case 1: nPassed = batchLoop<1>( b, mask.data() ); break;
+  case 2: nPassed = batchLoop<2>( b, mask.data() ); break;
+  case 3: nPassed = batchLoop<3>( b, mask.data() ); break;
+  default:
+    std::cout << "[ERROR] StHbtBasicTrackCut: Wrong particle identification scheme "
+	      << mDetSelection << std::endl;
+    std::fill( mask.begin(), mask.end(), 0 );
+  }
+
+  mNTracksPassed += nPassed;
+  mNTracksFailed += ( nTracks - nPassed );
+}
+
+//_________________
+void StHbtBasicTrackCut::countBatch(const StHbtSelectionMask& mask) {
+  const unsigned int nPassed = std::count_if( mask.begin(), mask.end(),
+					      [](unsigned char m) { return m != 0; } );
+  mNTracksPassed += nPassed;
+  mNTracksFailed += ( mask.size() - nPassed );
 }
 
 //_________________
@@ -492,3 +518,14 @@ TList *StHbtBasicTrackCut::listSettings() {
   
   return settings_list;
 }
+
+//_________________
+void StHbtBasicTrackCut::writeCheckpoint(StHbtCheckpoint& checkpoint) const {
+  checkpoint.write( mNTracksPassed );
+  checkpoint.write( mNTracksFailed );
+}
+
+//_________________
+bool StHbtBasicTrackCut::readCheckpoint(StHbtCheckpoint& checkpoint) {
+  return ( checkpoint.read( mNTracksPassed ) && checkpoint.read( mNTracksFailed ) );
+}
@@ -26,10 +26,19 @@ class StHbtBasicTrackCut : public StHbtTrackCut {
 
   /// Test the particle and return true if it meets all criteria. false otherwise.
   virtual bool pass(const StHbtTrack* tr);
+  /// Evaluate all cut windows over the columnar track batch at once.
+  /// The result is identical to calling pass() for each track.
+  virtual void passBatch(const StHbtTrackBatch& batch, StHbtSelectionMask& mask);
+  /// Count the passed and failed tracks of a reused mask
+  virtual void countBatch(const StHbtSelectionMask& mask);
 
   virtual StHbtString report();
   virtual TList *listSettings();
 
+  /// Passed and failed track counters
+  virtual void writeCheckpoint(StHbtCheckpoint& checkpoint) const;
+  virtual bool readCheckpoint(StHbtCheckpoint& checkpoint);
+
   enum HbtPID { Electron=1, Pion, Kaon, Proton };
 
   /// Select track type: false (0) - global, true (1) - primary
@@ -68,15 +77,15 @@ class StHbtBasicTrackCut : public StHbtTrackCut {
   }
   
   /// Set min and max range of electron nSigma to select
-  void setNSigmaElectron(const float& lo, const float& hi)   { mNSigmaElectron[0]=lo; mNSigmaElectron[1]=hi; }
+  void setNSigmaElectron(const float& lo, const float& hi)   { mNSigmaElectron[0]=lo; mNSigmaElectron[1]=hi; mPidTableValid = false; }
   /// Set min and max range of pion nSigma to select
-  void setNSigmaPion(const float& lo, const float& hi)       { mNSigmaPion[0] = lo; mNSigmaPion[1] = hi; }
+  void setNSigmaPion(const float& lo, const float& hi)       { mNSigmaPion[0] = lo; mNSigmaPion[1] = hi; mPidTableValid = false; }
   /// Set min and max range of kaon nSigma to select
-  void setNSigmaKaon(const float& lo, const float& hi)       { mNSigmaKaon[0] = lo; mNSigmaKaon[1] = hi; }
+  void setNSigmaKaon(const float& lo, const float& hi)       { mNSigmaKaon[0] = lo; mNSigmaKaon[1] = hi; mPidTableValid = false; }
   /// Set min and max range of proton nSigma to select
-  void setNSigmaProton(const float& lo, const float& hi)     { mNSigmaProton[0] = lo; mNSigmaProton[1] = hi; }
+  void setNSigmaProton(const float& lo, const float& hi)     { mNSigmaProton[0] = lo; mNSigmaProton[1] = hi; mPidTableValid = false; }
   /// Set low and hight values for the exclusion cut
-  void setNSigmaOther(const float& lo, const float& hi)      { mNSigmaOther[0] = lo; mNSigmaOther[1] = hi; }
+  void setNSigmaOther(const float& lo, const float& hi)      { mNSigmaOther[0] = lo; mNSigmaOther[1] = hi; mPidTableValid = false; }
   /// Set min and max momentum of the track for TPC identification
   void setTpcP(const float& lo, const float& hi)             { mTpcMom[0] = lo; mTpcMom[1] = hi; }
   void setTpcMomentum(const float& lo, const float& hi)      { setTpcP( lo , hi ); }
@@ -90,16 +99,16 @@ class StHbtBasicTrackCut : public StHbtTrackCut {
   void setTofMom(const float& lo, const float& hi)           { setTofP( lo , hi ); }
 
   /// Set min and max values of electron nSigma for TPC+TOF identification
-  void setTnTNSigmaElectron(const float& lo, const float& hi){ mTnTNSigmaElectron[0] = lo; mTnTNSigmaElectron[1] = hi; }
+  void setTnTNSigmaElectron(const float& lo, const float& hi){ mTnTNSigmaElectron[0] = lo; mTnTNSigmaElectron[1] = hi; mPidTableValid = false; }
   /// Set min and max values of pion nSigma for TPC+TOF identification
-  void setTnTNSigmaPion(const float& lo, const float& hi){ mTnTNSigmaPion[0] = lo; mTnTNSigmaPion[1] = hi; }
+  void setTnTNSigmaPion(const float& lo, const float& hi){ mTnTNSigmaPion[0] = lo; mTnTNSigmaPion[1] = hi; mPidTableValid = false; }
   /// Set min and max values of kaon nSigma for TPC+TOF identification
-  void setTnTNSigmaKaon(const float& lo, const float& hi){ mTnTNSigmaKaon[0] = lo; mTnTNSigmaKaon[1] = hi; }
+  void setTnTNSigmaKaon(const float& lo, const float& hi){ mTnTNSigmaKaon[0] = lo; mTnTNSigmaKaon[1] = hi; mPidTableValid = false; }
   /// Set min and max values of proton nSigma for TPC+TOF identification
-  void setTnTNSigmaProton(const float& lo, const float& hi)  { mTnTNSigmaProton[0] = lo; mTnTNSigmaProton[1] = hi; }
+  void setTnTNSigmaProton(const float& lo, const float& hi)  { mTnTNSigmaProton[0] = lo; mTnTNSigmaProton[1] = hi; mPidTableValid = false; }
 
   /// Set PID to select: 1-electron, 2-pion, 3-kaon, 4-proton
-  void setHbtPid(const HbtPID& pid)                          { mPidSelection = pid; }
+  void setHbtPid(const HbtPID& pid)                          { mPidSelection = pid; mPidTableValid = false; }
   
  protected:
 
@@ -168,6 +177,27 @@ class StHbtBasicTrackCut : public StHbtTrackCut {
   /// Falied tracks counter
   unsigned int mNTracksFailed;
 
+  /// Compiled PID table: windows per species (0 - electron, 1 - pion,
+  /// 2 - kaon, 3 - proton) built from the settings above by compilePidTable()
+  float mPidTpcLo[4];     //!
+  float mPidTpcHi[4];     //!
+  float mPidVetoLo[4];    //!
+  float mPidVetoHi[4];    //!
+  float mPidTnTLo[4];     //!
+  float mPidTnTHi[4];     //!
+  bool  mPidTableValid;   //!
+
+ private:
+
+  /// Fill the PID table from the current nSigma windows and PID selection
+  void compilePidTable();
+  /// Branch-free PID predicate for the detector selection Det (0-3)
+  template <unsigned char Det>
+  bool pidPass(const float* nSigma, const float& p, const float& massSqr, const bool& hasTof) const;
+  /// Column loop of passBatch for the detector selection Det (0-3)
+  template <unsigned char Det>
+  unsigned int batchLoop(const StHbtTrackBatch& batch, unsigned char* result) const;
+
 #ifdef __ROOT__
   ClassDef(StHbtBasicTrackCut, 1);
 #endif
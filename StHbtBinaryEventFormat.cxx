@@ -0,0 +1,251 @@
+/**
+ * Description: Compact columnar binary format for cached femto events.
+ */
+
+/// C++ headers
+#include <iostream>
+#include <algorithm>
+#include <cstddef>
+
+/// StHbtMaker headers
+#include "StHbtEvent.h"
+#include "StHbtTrack.h"
+#include "StHbtV0.h"
+#include "StHbtBinaryEventFormat.h"
+
+/// ROOT headers
+#include "RVersion.h"
+#include "RZip.h"
+
+/// Column helpers used with the field lists
+#define STHBT_COUNT_FIELD(f)  +1
+#define STHBT_SIZE_FIELD(f)   sizes.push_back( sizeof( obj->f ) );
+#define STHBT_APPEND_FIELD(f) appendValue( columns[iCol++], obj->f );
+#define STHBT_READ_FIELD(f)   readValue( columns[iCol++], i, obj->f );
+
+//_________________
+void StHbtBinaryEventFormat::fillFileHeader(FileHeader& header, const bool& trackRecords) {
+  std::memset( &header, 0, sizeof(FileHeader) );
+  std::memcpy( header.magic, "STHBTCOL", 8 );
+  header.version = kVersion;
+  header.nEventColumns = numberOfColumns( kEvent );
+  header.nTrackColumns = numberOfColumns( kTrack );
+  header.nV0Columns = numberOfColumns( kV0 );
+
+  std::vector<unsigned int> sizes;
+  for ( int kind=kEvent; kind<=kV0; kind++ ) {
+    fieldSizes( (Kind)kind, sizes );
+    for ( unsigned int iCol=0; iCol<sizes.size(); iCol++ ) {
+      header.fieldBytes += sizes[iCol];
+    }
+  }
+  header.trackRecordSize = trackRecords ? trackRecordSize() : 0;
+}
+
+//_________________
+bool StHbtBinaryEventFormat::checkFileHeader(const FileHeader& header) {
+  FileHeader expected;
+  fillFileHeader( expected, header.trackRecordSize != 0 );
+  if ( std::memcmp( header.magic, expected.magic, 8 ) != 0 ) {
+    std::cout << "[ERROR] StHbtBinaryEventFormat: not a columnar event file" << std::endl;
+    return false;
+  }
+  if ( header.version != expected.version ||
+       header.nEventColumns != expected.nEventColumns ||
+       header.nTrackColumns != expected.nTrackColumns ||
+       header.nV0Columns != expected.nV0Columns ||
+       header.fieldBytes != expected.fieldBytes ||
+       header.trackRecordSize != expected.trackRecordSize ) {
+    std::cout << "[ERROR] StHbtBinaryEventFormat: file layout (version "
+	      << header.version << ") does not match the current one (version "
+	      << expected.version << ")" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//_________________
+unsigned int StHbtBinaryEventFormat::trackRecordSize() {
+  /// Records are padded to keep every record aligned
+  return paddedSize( sizeof(StHbtTrack) );
+}
+
+//_________________
+void StHbtBinaryEventFormat::appendRecord(const StHbtTrack* track, StHbtByteColumn& column) {
+  const unsigned long long pos = column.size();
+  column.resize( pos + trackRecordSize(), 0 );
+  std::memcpy( &column[pos], reinterpret_cast<const char*>( track ), sizeof(StHbtTrack) );
+  /// The hidden info is not stored
+  std::memset( &column[pos + offsetof(StHbtTrack, mHiddenInfo)], 0, sizeof(StHbtHiddenInfo*) );
+}
+
+//_________________
+unsigned int StHbtBinaryEventFormat::numberOfColumns(const Kind& kind) {
+  switch ( kind ) {
+  case kEvent: return 0 STHBT_BINARY_EVENT_FIELDS( STHBT_COUNT_FIELD );
+  case kTrack: return 0 STHBT_BINARY_TRACK_FIELDS( STHBT_COUNT_FIELD );
+  case kV0:    return 0 STHBT_BINARY_V0_FIELDS( STHBT_COUNT_FIELD );
+  }
+  return 0;
+}
+
+//_________________
+void StHbtBinaryEventFormat::fieldSizes(const Kind& kind, std::vector<unsigned int>& sizes) {
+  sizes.clear();
+  switch ( kind ) {
+  case kEvent:
+    {
+      const StHbtEvent *obj = nullptr;
+      STHBT_BINARY_EVENT_FIELDS( STHBT_SIZE_FIELD );
+    }
+    break;
+  case kTrack:
+    {
+      const StHbtTrack *obj = nullptr;
+      STHBT_BINARY_TRACK_FIELDS( STHBT_SIZE_FIELD );
+    }
+    break;
+  case kV0:
+    {
+      const StHbtV0 *obj = nullptr;
+      STHBT_BINARY_V0_FIELDS( STHBT_SIZE_FIELD );
+    }
+    break;
+  }
+}
+
+//_________________
+void StHbtBinaryEventFormat::append(const StHbtEvent* obj, std::vector<StHbtByteColumn>& columns) {
+  unsigned int iCol = 0;
+  STHBT_BINARY_EVENT_FIELDS( STHBT_APPEND_FIELD );
+}
+
+//_________________
+void StHbtBinaryEventFormat::append(const StHbtTrack* obj, std::vector<StHbtByteColumn>& columns) {
+  unsigned int iCol = 0;
+  STHBT_BINARY_TRACK_FIELDS( STHBT_APPEND_FIELD );
+}
+
+//_________________
+void StHbtBinaryEventFormat::append(const StHbtV0* obj, std::vector<StHbtByteColumn>& columns) {
+  unsigned int iCol = 0;
+  STHBT_BINARY_V0_FIELDS( STHBT_APPEND_FIELD );
+}
+
+//_________________
+void StHbtBinaryEventFormat::read(const std::vector<const char*>& columns,
+				  const unsigned int& i, StHbtEvent* obj) {
+  unsigned int iCol = 0;
+  STHBT_BINARY_EVENT_FIELDS( STHBT_READ_FIELD );
+}
+
+//_________________
+void StHbtBinaryEventFormat::read(const std::vector<const char*>& columns,
+				  const unsigned int& i, StHbtTrack* obj) {
+  unsigned int iCol = 0;
+  STHBT_BINARY_TRACK_FIELDS( STHBT_READ_FIELD );
+}
+
+//_________________
+void StHbtBinaryEventFormat::read(const std::vector<const char*>& columns,
+				  const unsigned int& i, StHbtV0* obj) {
+  unsigned int iCol = 0;
+  STHBT_BINARY_V0_FIELDS( STHBT_READ_FIELD );
+}
+
+//_________________
+void StHbtBinaryEventFormat::pack(const std::vector<StHbtByteColumn>& columns,
+				  std::vector<char>& section) {
+  for ( unsigned int iCol=0; iCol<columns.size(); iCol++ ) {
+    section.insert( section.end(), columns[iCol].begin(), columns[iCol].end() );
+    section.resize( paddedSize( section.size() ), 0 );
+  }
+}
+
+//_________________
+const char* StHbtBinaryEventFormat::columnPointers(const char* base, const Kind& kind,
+						  const unsigned int& n,
+						  std::vector<const char*>& columns) {
+  std::vector<unsigned int> sizes;
+  fieldSizes( kind, sizes );
+  columns.resize( sizes.size() );
+  for ( unsigned int iCol=0; iCol<sizes.size(); iCol++ ) {
+    columns[iCol] = base;
+    base += paddedSize( (unsigned long long)sizes[iCol] * n );
+  }
+  return base;
+}
+
+//_________________
+bool StHbtBinaryEventFormat::compress(const std::vector<char>& input, const int& setting,
+				      std::vector<char>& output) {
+
+  output.clear();
+  const int algorithm = setting / 100;
+  const int level = setting % 100;
+  if ( level <= 0 || input.empty() ) return false;
+
+  /// ROOT compresses at most kMAXZIPBUF bytes per call: compress in blocks,
+  /// each of them carries its own header
+  const unsigned long long kBlock = 0xffffff;
+  output.resize( input.size() );
+  unsigned long long inPos = 0;
+  unsigned long long outPos = 0;
+  while ( inPos < input.size() ) {
+    int srcSize = (int)std::min( kBlock, (unsigned long long)input.size() - inPos );
+    int tgtSize = (int)( output.size() - outPos );
+    int irep = 0;
+    if ( tgtSize <= 0 ) {
+      output.clear();
+      return false;
+    }
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,20,0)
+    R__zipMultipleAlgorithm( level, &srcSize, const_cast<char*>( &input[inPos] ), &tgtSize,
+			     &output[outPos], &irep,
+			     static_cast<ROOT::RCompressionSetting::EAlgorithm::EValues>( algorithm ) );
+#else
+    R__zipMultipleAlgorithm( level, &srcSize, const_cast<char*>( &input[inPos] ), &tgtSize,
+			     &output[outPos], &irep,
+			     static_cast<ROOT::ECompressionAlgorithm>( algorithm ) );
+#endif
+    if ( irep <= 0 ) {
+      /// Does not fit: the data are incompressible
+      output.clear();
+      return false;
+    }
+    inPos += srcSize;
+    outPos += irep;
+  } //while ( inPos < input.size() )
+
+  output.resize( outPos );
+  return true;
+}
+
+//_________________
+bool StHbtBinaryEventFormat::decompress(const char* input, const unsigned long long& bytes,
+					const unsigned long long& rawBytes,
+					std::vector<char>& output) {
+  output.resize( rawBytes );
+  unsigned long long inPos = 0;
+  unsigned long long outPos = 0;
+  while ( inPos < bytes && outPos < rawBytes ) {
+    int srcSize = 0;
+    int tgtSize = 0;
+    unsigned char *src = (unsigned char*)( input + inPos );
+    if ( R__unzip_header( &srcSize, src, &tgtSize ) != 0 ||
+	 inPos + srcSize > bytes || outPos + tgtSize > rawBytes ) {
+      std::cout << "[ERROR] StHbtBinaryEventFormat::decompress - corrupted block" << std::endl;
+      return false;
+    }
+    int irep = 0;
+    R__unzip( &srcSize, src, &tgtSize, (unsigned char*)( &output[outPos] ), &irep );
+    if ( irep != tgtSize ) {
+      std::cout << "[ERROR] StHbtBinaryEventFormat::decompress - failed to decompress block" << std::endl;
+      return false;
+    }
+    inPos += srcSize;
+    outPos += tgtSize;
+  } //while ( inPos < bytes && outPos < rawBytes )
+
+  return ( outPos == rawBytes );
+}
@@ -0,0 +1,196 @@
+/**
+ * Description: Compact columnar binary format for cached femto events.
+ *
+ * The file starts with a FileHeader followed by chunks of events. Each chunk
+ * has a ChunkHeader and two sections:
+ *
+ *  - header section: one column per StHbtEvent field (nEvents entries each),
+ *    the number of tracks, V0s and trigger ids of each event and the
+ *    flat list of trigger ids;
+ *  - data section: one column per StHbtTrack field (nTracks entries each)
+ *    followed by one column per StHbtV0 field (nV0s entries each).
+ *
+ * Alternatively the tracks of the data section may be stored as records
+ * (rows) with the in-memory layout of StHbtTrack. Such files can be read
+ * with memory-mapped StHbtTrack views (see StHbtBinaryEventReader), but
+ * they are only portable between builds with the same StHbtTrack layout,
+ * which is checked via the record size kept in the file header.
+ *
+ * The fields are stored exactly as they are kept in memory (including the
+ * compressed integer representations of nSigma, dE/dx, beta etc.), so a
+ * write/read cycle reproduces the objects bit by bit. Xis and kinks are not
+ * stored. Columns are padded to 8 bytes, so an uncompressed section can be
+ * used in place from a memory-mapped file. The byte order is the native one.
+ *
+ * Each section may be compressed with any of the ROOT compression algorithms
+ * (setting = 100*algorithm + level, e.g. 101 - zlib, 404 - LZ4, 505 - ZSTD,
+ * 0 - none). A section is stored uncompressed if compression does not reduce
+ * its size, which is indicated by equal stored and raw sizes.
+ *
+ * The reader can read the header section of a chunk and skip the data
+ * section when no event of the chunk is needed.
+ */
+
+#ifndef StHbtBinaryEventFormat_h
+#define StHbtBinaryEventFormat_h
+
+/// C++ headers
+#include <vector>
+#include <cstring>
+
+/// Forward declarations
+class StHbtEvent;
+class StHbtTrack;
+class StHbtV0;
+
+/// Stored fields of StHbtEvent. Changing any of the lists below changes
+/// the format: kVersion must be increased
+#define STHBT_BINARY_EVENT_FIELDS(X) \
+  X(mEventNumber) X(mRunNumber) X(mMagneticField) \
+  X(mRefMult) X(mRefMultPos) X(mRefMultCorr) X(mRefMultCorrWeight) \
+  X(mRefMult2) X(mRefMult2Pos) X(mGRefMult) X(mGRefMultPos) \
+  X(mBTofTrayMultiplicity) X(mNBTOFMatch) X(mNBEMCMatch) \
+  X(mNumberOfPrimaryTracks) X(mNumberOfGlobalTracks) \
+  X(mZdcSumAdcEast) X(mZdcSumAdcWest) X(mZdcCoincidenceRate) X(mBbcCoincidenceRate) \
+  X(mSphericity) X(mSphericity2) X(mEventPlaneAngle) X(mEventPlaneResolution) X(mCent16) \
+  X(mPrimaryVertexPositionX) X(mPrimaryVertexPositionY) X(mPrimaryVertexPositionZ) \
+  X(mVpdVz) X(mRanking) \
+  X(mL3TriggerAlgorithm[0]) X(mL3TriggerAlgorithm[1]) \
+  X(mL3TriggerAlgorithm[2]) X(mL3TriggerAlgorithm[3])
+
+/// Stored fields of StHbtTrack
+#define STHBT_BINARY_TRACK_FIELDS(X) \
+  X(mId) X(mFlag) X(mNHits) X(mNHitsPoss) X(mNHitsDedx) X(mChi2) X(mDedx) \
+  X(mNSigmaElectron) X(mNSigmaPion) X(mNSigmaKaon) X(mNSigmaProton) \
+  X(mPidProbElectron) X(mPidProbPion) X(mPidProbKaon) X(mPidProbProton) \
+  X(mMap[0]) X(mMap[1]) X(mTofBeta) \
+  X(mPrimaryPx) X(mPrimaryPy) X(mPrimaryPz) \
+  X(mGlobalPx) X(mGlobalPy) X(mGlobalPz) \
+  X(mDcaX) X(mDcaY) X(mDcaZ) \
+  X(mPrimaryVertexX) X(mPrimaryVertexY) X(mPrimaryVertexZ) X(mBField) \
+  X(mXfr) X(mYfr) X(mZfr) X(mTfr) X(mPdgId)
+
+/// Stored fields of StHbtV0
+#define STHBT_BINARY_V0_FIELDS(X) \
+  X(mPrimaryVertexX) X(mPrimaryVertexY) X(mPrimaryVertexZ) X(mBField) \
+  X(mV0DecayPointX) X(mV0DecayPointY) X(mV0DecayPointZ) \
+  X(mV0MomX) X(mV0MomY) X(mV0MomZ) X(mV0PtotPos) X(mV0PtotNeg) \
+  X(mV0DcaDaughters) X(mV0DcaToPrimVertex) X(mChi2V0) X(mClV0) X(mAlphaV0) X(mPtArmV0) \
+  X(mPosId) X(mPosMomX) X(mPosMomY) X(mPosMomZ) \
+  X(mPosDca2PrimVertexX) X(mPosDca2PrimVertexY) X(mPosDca2PrimVertexZ) \
+  X(mPosNHits) X(mPosNHitsPoss) X(mPosNHitsDedx) \
+  X(mPosTopologyMap[0]) X(mPosTopologyMap[1]) X(mPosChi2) X(mPosDedx) \
+  X(mPosNSigmaElectron) X(mPosNSigmaPion) X(mPosNSigmaKaon) X(mPosNSigmaProton) X(mPosTofBeta) \
+  X(mNegId) X(mNegMomX) X(mNegMomY) X(mNegMomZ) \
+  X(mNegDca2PrimVertexX) X(mNegDca2PrimVertexY) X(mNegDca2PrimVertexZ) \
+  X(mNegNHits) X(mNegNHitsPoss) X(mNegNHitsDedx) \
+  X(mNegTopologyMap[0]) X(mNegTopologyMap[1]) X(mNegChi2) X(mNegDedx) \
+  X(mNegNSigmaElectron) X(mNegNSigmaPion) X(mNegNSigmaKaon) X(mNegNSigmaProton) X(mNegTofBeta)
+
+/// Growable column of bytes
+typedef std::vector<char> StHbtByteColumn;
+
+//_________________
+class StHbtBinaryEventFormat {
+
+ public:
+
+  /// Format version
+  static const unsigned int kVersion = 1;
+  /// Column alignment (bytes)
+  static const unsigned int kAlignment = 8;
+
+  /// Object kinds (column sets)
+  enum Kind { kEvent = 0, kTrack, kV0 };
+
+  /// Beginning of the file
+  struct FileHeader {
+    /// "STHBTCOL"
+    char magic[8];
+    unsigned int version;
+    unsigned int nEventColumns;
+    unsigned int nTrackColumns;
+    unsigned int nV0Columns;
+    /// Sum of the sizes of all stored fields (layout fingerprint)
+    unsigned int fieldBytes;
+    /// 0 - columnar tracks, otherwise size of the StHbtTrack record
+    unsigned int trackRecordSize;
+  };
+
+  /// Beginning of each chunk
+  struct ChunkHeader {
+    /// kChunkMagic
+    unsigned int magic;
+    unsigned int nEvents;
+    unsigned int nTracks;
+    unsigned int nV0s;
+    unsigned int nTriggerIds;
+    /// ROOT compression setting used for the sections
+    unsigned int compression;
+    /// Stored (possibly compressed) and raw sizes of the sections
+    unsigned long long headerBytes;
+    unsigned long long headerRawBytes;
+    unsigned long long dataBytes;
+    unsigned long long dataRawBytes;
+  };
+
+  /// "CHNK"
+  static const unsigned int kChunkMagic = 0x4b4e4843;
+
+  /// Fill the file header for the current layout
+  static void fillFileHeader(FileHeader& header, const bool& trackRecords = false);
+  /// Check that the file header matches the current layout
+  static bool checkFileHeader(const FileHeader& header);
+
+  /// Append the StHbtTrack record (its memory image, with the hidden
+  /// info link cleared) to the column
+  static void appendRecord(const StHbtTrack* track, StHbtByteColumn& column);
+  /// Size of the StHbtTrack record
+  static unsigned int trackRecordSize();
+
+  /// Number of columns and per-column field sizes for the kind
+  static unsigned int numberOfColumns(const Kind& kind);
+  static void fieldSizes(const Kind& kind, std::vector<unsigned int>& sizes);
+
+  /// Append the fields of the object to the columns (one column per field)
+  static void append(const StHbtEvent* event, std::vector<StHbtByteColumn>& columns);
+  static void append(const StHbtTrack* track, std::vector<StHbtByteColumn>& columns);
+  static void append(const StHbtV0* v0, std::vector<StHbtByteColumn>& columns);
+
+  /// Set the fields of the object from the i-th entry of the columns
+  static void read(const std::vector<const char*>& columns, const unsigned int& i, StHbtEvent* event);
+  static void read(const std::vector<const char*>& columns, const unsigned int& i, StHbtTrack* track);
+  static void read(const std::vector<const char*>& columns, const unsigned int& i, StHbtV0* v0);
+
+  /// Concatenate columns into a section, padding each to kAlignment
+  static void pack(const std::vector<StHbtByteColumn>& columns, std::vector<char>& section);
+  /// Size of the column with n entries of size bytes in a section
+  static unsigned long long paddedSize(const unsigned long long& bytes)
+  { return ( bytes + kAlignment - 1 ) / kAlignment * kAlignment; }
+  /// Set pointers to the columns of the kind with n entries starting at base.
+  /// Returns pointer to the end of the last column
+  static const char* columnPointers(const char* base, const Kind& kind, const unsigned int& n,
+				    std::vector<const char*>& columns);
+
+  /// Compress the section with the ROOT compression setting. Returns false
+  /// (and leaves output empty) if the compression does not reduce the size
+  static bool compress(const std::vector<char>& input, const int& setting,
+		       std::vector<char>& output);
+  /// Decompress the section to rawBytes bytes. Returns false on error
+  static bool decompress(const char* input, const unsigned long long& bytes,
+			 const unsigned long long& rawBytes, std::vector<char>& output);
+
+  /// Append value to the column
+  template <class T>
+  static void appendValue(StHbtByteColumn& column, const T& value) {
+    const char *bytes = reinterpret_cast<const char*>( &value );
+    column.insert( column.end(), bytes, bytes + sizeof(T) );
+  }
+  /// Read the i-th value of the column
+  template <class T>
+  static void readValue(const char* column, const unsigned int& i, T& value) {
+    std::memcpy( &value, column + (unsigned long long)i * sizeof(T), sizeof(T) );
+  }
+};
+
+#endif // #define StHbtBinaryEventFormat_h
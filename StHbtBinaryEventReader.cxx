@@ -0,0 +1,423 @@
+/**
+ * Description: Reader of StHbtEvents from the columnar binary format.
+ */
+
+/// C++ headers
+#include <cstdio>
+
+/// System headers
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/// StHbtMaker headers
+#include "StHbtTrack.h"
+#include "StHbtV0.h"
+#include "StHbtEventCut.h"
+#include "StHbtTrackCut.h"
+#include "StHbtV0Cut.h"
+#include "StHbtEventPool.h"
+#include "StHbtBinaryEventReader.h"
+
+#ifdef __ROOT__
+ClassImp(StHbtBinaryEventReader)
+#endif
+
+//_________________
+StHbtBinaryEventReader::StHbtBinaryEventReader() : StHbtBinaryEventReader( "" ) {
+  /* empty */
+}
+
+//_________________
+StHbtBinaryEventReader::StHbtBinaryEventReader(const char* fileName) :
+  StHbtEventReader(), mFileName( fileName ? fileName : "" ), mFile(),
+  mMemoryMapped(false), mMap(nullptr), mMapSize(0), mMapPos(0),
+  mHeaderBuffer(), mDataBuffer(), mStoredBuffer(),
+  mEventColumns(), mTrackColumns(), mV0Columns(),
+  mTrackRecordSize(0), mTrackRecords(nullptr), mTrackViews(false),
+  mFirstTrack(), mFirstV0(), mFirstTriggerId(), mTriggerIds(nullptr),
+  mEventPasses(), mCurrentEvent(0), mDataLoaded(false), mHeaderEvent(),
+  mNEventsRead(0), mNChunksRead(0), mNChunksSkipped(0), mNTrackViews(0) {
+  std::memset( &mChunk, 0, sizeof(mChunk) );
+}
+
+//_________________
+StHbtBinaryEventReader::~StHbtBinaryEventReader() {
+  closeFile();
+}
+
+//_________________
+bool StHbtBinaryEventReader::mapFile() {
+
+  int fd = open( mFileName.c_str(), O_RDONLY );
+  if ( fd < 0 ) return false;
+
+  struct stat st;
+  if ( fstat( fd, &st ) != 0 || st.st_size <= 0 ) {
+    close( fd );
+    return false;
+  }
+
+  /// Private writable mapping: pages are shared with the page cache until
+  /// a view is modified (copy-on-write), the file itself is never changed
+  void *addr = mmap( nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+  close( fd );
+  if ( addr == MAP_FAILED ) return false;
+
+  madvise( addr, st.st_size, MADV_SEQUENTIAL );
+  mMap = static_cast<char*>( addr );
+  mMapSize = st.st_size;
+  mMapPos = 0;
+  return true;
+}
+
+//_________________
+void StHbtBinaryEventReader::unmapFile() {
+  if ( mMap ) {
+    munmap( mMap, mMapSize );
+  }
+  mMap = nullptr;
+  mMapSize = 0;
+  mMapPos = 0;
+}
+
+//_________________
+void StHbtBinaryEventReader::closeFile() {
+  if ( mFile.is_open() ) {
+    mFile.close();
+  }
+  unmapFile();
+  mTrackRecords = nullptr;
+  mTrackViews = false;
+  mDataLoaded = false;
+}
+
+//_________________
+bool StHbtBinaryEventReader::isOpen() const {
+  return ( mMap || mFile.is_open() );
+}
+
+//_________________
+bool StHbtBinaryEventReader::readBytes(void* dst, const unsigned long long& bytes) {
+  if ( mMap ) {
+    if ( mMapPos + bytes > mMapSize ) return false;
+    std::memcpy( dst, mMap + mMapPos, bytes );
+    mMapPos += bytes;
+    return true;
+  }
+  mFile.read( static_cast<char*>( dst ), bytes );
+  return mFile.good();
+}
+
+//_________________
+bool StHbtBinaryEventReader::skipBytes(const unsigned long long& bytes) {
+  if ( mMap ) {
+    if ( mMapPos + bytes > mMapSize ) return false;
+    mMapPos += bytes;
+    return true;
+  }
+  mFile.seekg( bytes, std::ios::cur );
+  return mFile.good();
+}
+
+//_________________
+int StHbtBinaryEventReader::init(const char* ReadWrite, StHbtString& Message) {
+
+  closeFile();
+  if ( mMemoryMapped ) {
+    if ( !mapFile() ) {
+      std::cout << "[ERROR] StHbtBinaryEventReader::init - can not map file: "
+		<< mFileName << std::endl;
+      mReaderStatus = 1;
+      return 1;
+    }
+  }
+  else {
+    mFile.open( mFileName.c_str(), std::ios::in | std::ios::binary );
+    if ( !mFile.is_open() ) {
+      std::cout << "[ERROR] StHbtBinaryEventReader::init - can not open file: "
+		<< mFileName << std::endl;
+      mReaderStatus = 1;
+      return 1;
+    }
+  }
+
+  StHbtBinaryEventFormat::FileHeader header;
+  if ( !readBytes( &header, sizeof(header) ) ||
+       !StHbtBinaryEventFormat::checkFileHeader( header ) ) {
+    std::cout << "[ERROR] StHbtBinaryEventReader::init - bad file header: "
+	      << mFileName << std::endl;
+    closeFile();
+    mReaderStatus = 1;
+    return 1;
+  }
+  mTrackRecordSize = header.trackRecordSize;
+
+  std::memset( &mChunk, 0, sizeof(mChunk) );
+  mCurrentEvent = 0;
+  mReaderStatus = 0;
+  return 0;
+}
+
+//_________________
+bool StHbtBinaryEventReader::readSection(const unsigned long long& bytes,
+					 const unsigned long long& rawBytes,
+					 std::vector<char>& buffer, const char*& data) {
+  data = nullptr;
+
+  if ( mMap ) {
+    /// Mapped file: uncompressed sections are used in place
+    if ( mMapPos + bytes > mMapSize ) return false;
+    const char *stored = mMap + mMapPos;
+    mMapPos += bytes;
+    if ( bytes == rawBytes ) {
+      data = stored;
+      return true;
+    }
+    if ( !StHbtBinaryEventFormat::decompress( stored, bytes, rawBytes, buffer ) ) return false;
+    data = buffer.empty() ? nullptr : &buffer[0];
+    return true;
+  }
+
+  if ( bytes == rawBytes ) {
+    /// Stored uncompressed
+    buffer.resize( rawBytes );
+    if ( rawBytes > 0 && !readBytes( &buffer[0], rawBytes ) ) return false;
+    data = buffer.empty() ? nullptr : &buffer[0];
+    return true;
+  }
+
+  mStoredBuffer.resize( bytes );
+  if ( !readBytes( &mStoredBuffer[0], bytes ) ) return false;
+  if ( !StHbtBinaryEventFormat::decompress( &mStoredBuffer[0], bytes, rawBytes, buffer ) ) return false;
+  data = buffer.empty() ? nullptr : &buffer[0];
+  return true;
+}
+
+//_________________
+bool StHbtBinaryEventReader::readChunkHeader() {
+
+  /// End of the input
+  if ( mMap ) {
+    if ( mMapPos >= mMapSize ) return false;
+  }
+  else if ( mFile.peek() == std::char_traits<char>::eof() ) {
+    return false;
+  }
+
+  if ( !readBytes( &mChunk, sizeof(mChunk) ) ||
+       mChunk.magic != StHbtBinaryEventFormat::kChunkMagic ) {
+    std::cout << "[ERROR] StHbtBinaryEventReader::readChunkHeader - corrupted chunk in "
+	      << mFileName << std::endl;
+    return false;
+  }
+
+  const char *headerData = nullptr;
+  if ( !readSection( mChunk.headerBytes, mChunk.headerRawBytes, mHeaderBuffer, headerData ) ) {
+    std::cout << "[ERROR] StHbtBinaryEventReader::readChunkHeader - can not read header section"
+	      << std::endl;
+    return false;
+  }
+  mNChunksRead++;
+
+  /// Event columns, followed by the counts and the trigger ids
+  const unsigned int nEvents = mChunk.nEvents;
+  const char *counts = StHbtBinaryEventFormat::columnPointers( headerData,
+							      StHbtBinaryEventFormat::kEvent,
+							      nEvents, mEventColumns );
+  const unsigned long long countBytes =
+    StHbtBinaryEventFormat::paddedSize( (unsigned long long)nEvents * sizeof(unsigned int) );
+  const unsigned int *nTracks = reinterpret_cast<const unsigned int*>( counts );
+  const unsigned int *nV0s = reinterpret_cast<const unsigned int*>( counts + countBytes );
+  const unsigned int *nTriggerIds = reinterpret_cast<const unsigned int*>( counts + 2 * countBytes );
+  mTriggerIds = reinterpret_cast<const unsigned int*>( counts + 3 * countBytes );
+
+  mFirstTrack.resize( nEvents + 1 );
+  mFirstV0.resize( nEvents + 1 );
+  mFirstTriggerId.resize( nEvents + 1 );
+  mFirstTrack[0] = mFirstV0[0] = mFirstTriggerId[0] = 0;
+  for ( unsigned int iEvent=0; iEvent<nEvents; iEvent++ ) {
+    mFirstTrack[iEvent+1] = mFirstTrack[iEvent] + nTracks[iEvent];
+    mFirstV0[iEvent+1] = mFirstV0[iEvent] + nV0s[iEvent];
+    mFirstTriggerId[iEvent+1] = mFirstTriggerId[iEvent] + nTriggerIds[iEvent];
+  }
+
+  /// Evaluate the pre-filter on the header columns only
+  unsigned int nPassed = 0;
+  mEventPasses.assign( nEvents, 1 );
+  if ( mPreFilter.isActive() ) {
+    std::vector<unsigned int> triggerIds;
+    for ( unsigned int iEvent=0; iEvent<nEvents; iEvent++ ) {
+      StHbtBinaryEventFormat::read( mEventColumns, iEvent, &mHeaderEvent );
+      triggerIds.assign( mTriggerIds + mFirstTriggerId[iEvent],
+			 mTriggerIds + mFirstTriggerId[iEvent+1] );
+      const TVector3 vtx = mHeaderEvent.primaryVertex();
+      mEventPasses[iEvent] = passPreFilter( mHeaderEvent.runNumber(), triggerIds,
+					    mHeaderEvent.refMult(), vtx.X(), vtx.Y(), vtx.Z(),
+					    mHeaderEvent.vpdVzDiff() ) ? 1 : 0;
+      nPassed += mEventPasses[iEvent];
+    }
+  }
+  else {
+    nPassed = nEvents;
+  }
+
+  mCurrentEvent = 0;
+  mDataLoaded = false;
+  return readChunkData( nPassed == 0 );
+}
+
+//_________________
+bool StHbtBinaryEventReader::readChunkData(const bool& skip) {
+
+  if ( skip ) {
+    /// No event of the chunk is needed: the tracks are not touched
+    mNChunksSkipped++;
+    mDataLoaded = false;
+    return skipBytes( mChunk.dataBytes );
+  }
+
+  const char *base = nullptr;
+  if ( !readSection( mChunk.dataBytes, mChunk.dataRawBytes, mDataBuffer, base ) ) {
+    std::cout << "[ERROR] StHbtBinaryEventReader::readChunkData - can not read data section"
+	      << std::endl;
+    return false;
+  }
+
+  if ( mTrackRecordSize > 0 ) {
+    /// Track records followed by the V0 columns
+    mTrackRecords = base;
+    base += StHbtBinaryEventFormat::paddedSize( (unsigned long long)mChunk.nTracks * mTrackRecordSize );
+    /// Records are used in place only if they are in the mapped file
+    /// (not in the decompression buffer, which is reused by the next chunk)
+    /// and properly aligned
+    mTrackViews = ( mMap && mChunk.dataBytes == mChunk.dataRawBytes &&
+		    reinterpret_cast<std::size_t>( mTrackRecords ) % alignof(StHbtTrack) == 0 );
+  }
+  else {
+    base = StHbtBinaryEventFormat::columnPointers( base, StHbtBinaryEventFormat::kTrack,
+						   mChunk.nTracks, mTrackColumns );
+    mTrackRecords = nullptr;
+    mTrackViews = false;
+  }
+  StHbtBinaryEventFormat::columnPointers( base, StHbtBinaryEventFormat::kV0,
+					  mChunk.nV0s, mV0Columns );
+  mDataLoaded = true;
+  return true;
+}
+
+//_________________
+void StHbtBinaryEventReader::dropTrack(StHbtTrack* track) {
+  if ( mEventPool ) {
+    mEventPool->releaseTrack( track );
+  }
+  else {
+    delete track;
+  }
+}
+
+//_________________
+StHbtEvent* StHbtBinaryEventReader::returnHbtEvent() {
+
+  if ( !isOpen() ) {
+    mReaderStatus = 1;
+    return nullptr;
+  }
+
+  while ( true ) {
+
+    /// Next chunk
+    if ( mCurrentEvent >= mChunk.nEvents ) {
+      if ( !readChunkHeader() ) {
+	/// End of file (or error)
+	mReaderStatus = 1;
+	return nullptr;
+      }
+      continue;
+    }
+
+    const unsigned int iEvent = mCurrentEvent++;
+    if ( !mEventPasses[iEvent] || !mDataLoaded ) continue;
+
+    StHbtEvent *event = newHbtEvent();
+    StHbtBinaryEventFormat::read( mEventColumns, iEvent, event );
+    event->setTriggerIds( std::vector<unsigned int>( mTriggerIds + mFirstTriggerId[iEvent],
+						     mTriggerIds + mFirstTriggerId[iEvent+1] ) );
+
+    if ( mTrackViews ) {
+      /// Tracks point into the mapped file and are not owned by the event
+      event->setOwnsTracks( false );
+      for ( unsigned int iTrk=mFirstTrack[iEvent]; iTrk<mFirstTrack[iEvent+1]; iTrk++ ) {
+	StHbtTrack *track =
+	  reinterpret_cast<StHbtTrack*>( const_cast<char*>( mTrackRecords ) +
+					 (unsigned long long)iTrk * mTrackRecordSize );
+	if ( mTrackCut && !mTrackCut->pass( track ) ) continue;
+	event->trackCollection()->push_back( track );
+	mNTrackViews++;
+      }
+    }
+
+    for ( unsigned int iTrk=mFirstTrack[iEvent];
+	  !mTrackViews && iTrk<mFirstTrack[iEvent+1]; iTrk++ ) {
+      StHbtTrack *track = newHbtTrack();
+      if ( mTrackRecords ) {
+	*track = *reinterpret_cast<const StHbtTrack*>( mTrackRecords +
+						       (unsigned long long)iTrk * mTrackRecordSize );
+      }
+      else {
+	StHbtBinaryEventFormat::read( mTrackColumns, iTrk, track );
+      }
+      if ( mTrackCut && !mTrackCut->pass( track ) ) {
+	dropTrack( track );
+	continue;
+      }
+      event->trackCollection()->push_back( track );
+    }
+
+    for ( unsigned int iV0=mFirstV0[iEvent]; iV0<mFirstV0[iEvent+1]; iV0++ ) {
+      StHbtV0 *v0 = new StHbtV0();
+      StHbtBinaryEventFormat::read( mV0Columns, iV0, v0 );
+      if ( mV0Cut && !mV0Cut->pass( v0 ) ) {
+	delete v0;
+	continue;
+      }
+      event->v0Collection()->push_back( v0 );
+    }
+
+    if ( mEventCut && !mEventCut->pass( event ) ) {
+      releaseHbtEvent( event );
+      continue;
+    }
+
+    mNEventsRead++;
+    mReaderStatus = 0;
+    return event;
+  } //while ( true )
+}
+
+//_________________
+void StHbtBinaryEventReader::finish() {
+  closeFile();
+  if ( mDebug ) {
+    std::cout << "StHbtBinaryEventReader::finish - " << mNEventsRead << " events read from "
+	      << mNChunksRead << " chunks (" << mNChunksSkipped << " chunks skipped, "
+	      << mNEventsPreFiltered << " events rejected by the pre-filter)" << std::endl;
+  }
+}
+
+//_________________
+StHbtString StHbtBinaryEventReader::report() {
+  StHbtString temp = "\n This is StHbtBinaryEventReader reporting";
+  char ctemp[200];
+  temp += "\n---> File: ";
+  temp += mFileName;
+  snprintf( ctemp, sizeof(ctemp), ", memory mapped: %d, track views: %llu",
+	    mMemoryMapped, mNTrackViews );
+  temp += ctemp;
+  snprintf( ctemp, sizeof(ctemp), "\n---> Events read: %u, chunks read: %u, chunks skipped: %u, pre-filtered events: %u",
+	    mNEventsRead, mNChunksRead, mNChunksSkipped, mNEventsPreFiltered );
+  temp += ctemp;
+  temp += StHbtEventReader::report();
+  return temp;
+}
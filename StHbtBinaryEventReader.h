@@ -0,0 +1,142 @@
+/**
+ * Description: Reader of StHbtEvents from the columnar binary format.
+ *
+ * Reads files written by StHbtBinaryEventWriter chunk by chunk. The header
+ * section of each chunk is read first and the event pre-filter (see
+ * StHbtEventReader::setPreFilter) is evaluated on the event header columns.
+ * The data section (tracks and V0s) is read only if at least one event of
+ * the chunk passes, otherwise it is skipped without reading. Rejected
+ * events are skipped inside returnHbtEvent(), so every returned event has
+ * passed the pre-filter and the front-loaded cuts of the reader.
+ *
+ * Events and tracks are created with newHbtEvent()/newHbtTrack(), so they
+ * are recycled when the event pool of the reader is enabled.
+ *
+ * With setMemoryMapped(true) the file is mapped into memory (copy-on-write)
+ * instead of being read through a stream. If the tracks were written as
+ * records (StHbtBinaryEventWriter::setTrackRecords) and the chunk is not
+ * compressed, the tracks of the returned events are views directly into
+ * the mapped file: nothing is copied or allocated per track. Such events
+ * do not own their tracks (StHbtEvent::ownsTracks() is false) and stay
+ * valid until the reader is finished. Compressed chunks and columnar
+ * files are decoded into regular tracks as usual.
+ */
+
+#ifndef StHbtBinaryEventReader_h
+#define StHbtBinaryEventReader_h
+
+/// C++ headers
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// StHbtMaker headers
+#include "StHbtEventReader.h"
+#include "StHbtBinaryEventFormat.h"
+#include "StHbtEvent.h"
+
+//_________________
+class StHbtBinaryEventReader : public StHbtEventReader {
+
+ public:
+  /// Default constructor
+  StHbtBinaryEventReader();
+  /// Constructor with the input file name
+  StHbtBinaryEventReader(const char* fileName);
+  /// Destructor
+  virtual ~StHbtBinaryEventReader();
+
+  /// Open the file and check the file header
+  virtual int init(const char* ReadWrite, StHbtString& Message);
+  /// Return the next event that passes the pre-filter and the cuts.
+  /// Returns nullptr and sets status to 1 at the end of the file
+  virtual StHbtEvent* returnHbtEvent();
+  /// Close the file
+  virtual void finish();
+  virtual StHbtString report();
+
+  void setFileName(const char* fileName)        { mFileName = fileName; }
+  /// Map the file into memory instead of reading it (call before init)
+  void setMemoryMapped(const bool& mapped)      { mMemoryMapped = mapped; }
+
+  /// Number of events read and number of chunks whose data were skipped
+  unsigned int nEventsRead() const              { return mNEventsRead; }
+  unsigned int nChunksSkipped() const           { return mNChunksSkipped; }
+  /// Number of tracks returned as views into the mapped file
+  unsigned long long nTrackViews() const        { return mNTrackViews; }
+
+ private:
+  /// Not copyable: owns the input file
+  StHbtBinaryEventReader(const StHbtBinaryEventReader&);
+  StHbtBinaryEventReader& operator=(const StHbtBinaryEventReader&);
+
+  /// Read the next chunk header and header section.
+  /// Returns false at the end of the file or on error
+  bool readChunkHeader();
+  /// Read (or skip) the data section of the current chunk
+  bool readChunkData(const bool& skip);
+  /// Read the stored section, decompressing into buffer if needed. On
+  /// success data points to the raw section (buffer or the mapped file)
+  bool readSection(const unsigned long long& bytes, const unsigned long long& rawBytes,
+		   std::vector<char>& buffer, const char*& data);
+  /// Read or skip bytes of the input (stream or mapped file)
+  bool readBytes(void* dst, const unsigned long long& bytes);
+  bool skipBytes(const unsigned long long& bytes);
+  /// Map and unmap the input file
+  bool mapFile();
+  void unmapFile();
+  /// Close the input
+  void closeFile();
+  bool isOpen() const;
+  /// Release the track (to the pool if enabled)
+  void dropTrack(StHbtTrack* track);
+
+  /// Input file name and stream
+  std::string mFileName;
+  std::ifstream mFile;                               //!
+  /// Memory-mapped input
+  bool mMemoryMapped;
+  char *mMap;                                        //!
+  unsigned long long mMapSize;                       //!
+  unsigned long long mMapPos;                        //!
+
+  /// Current chunk
+  StHbtBinaryEventFormat::ChunkHeader mChunk;        //!
+  std::vector<char> mHeaderBuffer;                   //!
+  std::vector<char> mDataBuffer;                     //!
+  std::vector<char> mStoredBuffer;                   //!
+  std::vector<const char*> mEventColumns;            //!
+  std::vector<const char*> mTrackColumns;            //!
+  std::vector<const char*> mV0Columns;               //!
+  /// Track records of the chunk (0 size - columnar tracks)
+  unsigned int mTrackRecordSize;                     //!
+  const char *mTrackRecords;                         //!
+  /// Tracks of the chunk can be used in place
+  bool mTrackViews;                                  //!
+  /// First track, V0 and trigger id of each event (n+1 entries)
+  std::vector<unsigned int> mFirstTrack;             //!
+  std::vector<unsigned int> mFirstV0;                //!
+  std::vector<unsigned int> mFirstTriggerId;         //!
+  const unsigned int *mTriggerIds;                   //!
+  /// Pre-filter decision for each event of the chunk
+  std::vector<unsigned char> mEventPasses;           //!
+  /// Current event in the chunk
+  unsigned int mCurrentEvent;
+  /// Data section of the chunk is in mDataBuffer
+  bool mDataLoaded;
+
+  /// Scratch event used to evaluate the pre-filter on the header columns
+  StHbtEvent mHeaderEvent;                           //!
+
+  /// Statistics
+  unsigned int mNEventsRead;
+  unsigned int mNChunksRead;
+  unsigned int mNChunksSkipped;
+  unsigned long long mNTrackViews;
+
+#ifdef __ROOT__
+  ClassDef(StHbtBinaryEventReader, 0)
+#endif
+};
+
+#endif // #define StHbtBinaryEventReader_h
@@ -0,0 +1,236 @@
+/**
+ * Description: Writer of StHbtEvents to the columnar binary format.
+ */
+
+/// C++ headers
+#include <cstdio>
+
+/// StHbtMaker headers
+#include "StHbtEvent.h"
+#include "StHbtTrack.h"
+#include "StHbtV0.h"
+#include "StHbtEventCut.h"
+#include "StHbtTrackCut.h"
+#include "StHbtV0Cut.h"
+#include "StHbtBinaryEventWriter.h"
+
+#ifdef __ROOT__
+ClassImp(StHbtBinaryEventWriter)
+#endif
+
+//_________________
+StHbtBinaryEventWriter::StHbtBinaryEventWriter() :
+  StHbtBinaryEventWriter( "", 500, 0 ) {
+  /* empty */
+}
+
+//_________________
+StHbtBinaryEventWriter::StHbtBinaryEventWriter(const char* fileName,
+					       const unsigned int& eventsPerChunk,
+					       const int& compression) :
+  StHbtEventReader(), mFileName( fileName ? fileName : "" ), mFile(),
+  mEventsPerChunk( ( eventsPerChunk > 0 ) ? eventsPerChunk : 1 ),
+  mCompression( compression ), mTrackRecords( false ),
+  mEventColumns( StHbtBinaryEventFormat::numberOfColumns( StHbtBinaryEventFormat::kEvent ) ),
+  mTrackColumns( StHbtBinaryEventFormat::numberOfColumns( StHbtBinaryEventFormat::kTrack ) ),
+  mTrackRecordColumn(),
+  mV0Columns( StHbtBinaryEventFormat::numberOfColumns( StHbtBinaryEventFormat::kV0 ) ),
+  mCountColumns( 3 ), mTriggerColumn(),
+  mNEvents(0), mNTracks(0), mNV0s(0), mNTriggerIds(0),
+  mSection(), mCompressed(),
+  mNEventsWritten(0), mNChunksWritten(0), mNBytesWritten(0) {
+  /* empty */
+}
+
+//_________________
+StHbtBinaryEventWriter::~StHbtBinaryEventWriter() {
+  if ( mFile.is_open() ) {
+    finish();
+  }
+}
+
+//_________________
+int StHbtBinaryEventWriter::init(const char* ReadWrite, StHbtString& Message) {
+
+  mFile.open( mFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+  if ( !mFile.is_open() ) {
+    std::cout << "[ERROR] StHbtBinaryEventWriter::init - can not open file: "
+	      << mFileName << std::endl;
+    mReaderStatus = 1;
+    return 1;
+  }
+
+  StHbtBinaryEventFormat::FileHeader header;
+  StHbtBinaryEventFormat::fillFileHeader( header, mTrackRecords );
+  mFile.write( reinterpret_cast<const char*>( &header ), sizeof(header) );
+  mNBytesWritten = sizeof(header);
+
+  if ( mDebug ) {
+    std::cout << "StHbtBinaryEventWriter::init - writing to " << mFileName
+	      << " (" << mEventsPerChunk << " events per chunk, compression "
+	      << mCompression << ")" << std::endl;
+  }
+  return 0;
+}
+
+//_________________
+int StHbtBinaryEventWriter::writeHbtEvent(StHbtEvent* event) {
+
+  if ( !event || !mFile.is_open() ) return 1;
+  if ( mEventCut && !mEventCut->pass( event ) ) return 0;
+
+  StHbtBinaryEventFormat::append( event, mEventColumns );
+
+  /// Tracks. The mask of the track cut is shared with the analyses
+  unsigned int nTracks = 0;
+  const StHbtSelectionMask *trackMask = mTrackCut ? &event->trackSelection( mTrackCut ) : nullptr;
+  unsigned int iTrk = 0;
+  for ( StHbtTrackIterator iter=event->trackCollection()->begin();
+	iter!=event->trackCollection()->end(); iter++, iTrk++ ) {
+    if ( trackMask && !(*trackMask)[iTrk] ) continue;
+    if ( mTrackRecords ) {
+      StHbtBinaryEventFormat::appendRecord( *iter, mTrackRecordColumn );
+    }
+    else {
+      StHbtBinaryEventFormat::append( *iter, mTrackColumns );
+    }
+    nTracks++;
+  }
+
+  /// V0s
+  unsigned int nV0s = 0;
+  for ( StHbtV0Iterator iter=event->v0Collection()->begin();
+	iter!=event->v0Collection()->end(); iter++ ) {
+    if ( mV0Cut && !mV0Cut->pass( *iter ) ) continue;
+    StHbtBinaryEventFormat::append( *iter, mV0Columns );
+    nV0s++;
+  }
+
+  /// Trigger ids
+  const std::vector<unsigned int>& triggerIds = event->triggerIds();
+  for ( unsigned int iTrig=0; iTrig<triggerIds.size(); iTrig++ ) {
+    StHbtBinaryEventFormat::appendValue( mTriggerColumn, triggerIds[iTrig] );
+  }
+  const unsigned int nTriggerIds = triggerIds.size();
+
+  StHbtBinaryEventFormat::appendValue( mCountColumns[0], nTracks );
+  StHbtBinaryEventFormat::appendValue( mCountColumns[1], nV0s );
+  StHbtBinaryEventFormat::appendValue( mCountColumns[2], nTriggerIds );
+
+  mNEvents++;
+  mNTracks += nTracks;
+  mNV0s += nV0s;
+  mNTriggerIds += nTriggerIds;
+  mNEventsWritten++;
+
+  if ( mNEvents >= mEventsPerChunk ) {
+    return flushChunk() ? 0 : 1;
+  }
+  return 0;
+}
+
+//_________________
+unsigned long long StHbtBinaryEventWriter::writeSection(const std::vector<char>& section) {
+  if ( StHbtBinaryEventFormat::compress( section, mCompression, mCompressed ) &&
+       mCompressed.size() < section.size() ) {
+    mFile.write( &mCompressed[0], mCompressed.size() );
+    return mCompressed.size();
+  }
+  if ( !section.empty() ) {
+    mFile.write( &section[0], section.size() );
+  }
+  return section.size();
+}
+
+//_________________
+bool StHbtBinaryEventWriter::flushChunk() {
+
+  if ( mNEvents == 0 ) return true;
+
+  StHbtBinaryEventFormat::ChunkHeader chunk;
+  std::memset( &chunk, 0, sizeof(chunk) );
+  chunk.magic = StHbtBinaryEventFormat::kChunkMagic;
+  chunk.nEvents = mNEvents;
+  chunk.nTracks = mNTracks;
+  chunk.nV0s = mNV0s;
+  chunk.nTriggerIds = mNTriggerIds;
+  chunk.compression = ( mCompression > 0 ) ? mCompression : 0;
+
+  /// Chunk header is rewritten after the sections, when their stored
+  /// sizes are known
+  const std::streampos chunkPos = mFile.tellp();
+  mFile.write( reinterpret_cast<const char*>( &chunk ), sizeof(chunk) );
+
+  /// Header section: event columns, counts and trigger ids
+  mSection.clear();
+  StHbtBinaryEventFormat::pack( mEventColumns, mSection );
+  StHbtBinaryEventFormat::pack( mCountColumns, mSection );
+  mSection.insert( mSection.end(), mTriggerColumn.begin(), mTriggerColumn.end() );
+  mSection.resize( StHbtBinaryEventFormat::paddedSize( mSection.size() ), 0 );
+  chunk.headerRawBytes = mSection.size();
+  chunk.headerBytes = writeSection( mSection );
+
+  /// Data section: track columns (or records) and V0 columns
+  mSection.clear();
+  if ( mTrackRecords ) {
+    mSection.insert( mSection.end(), mTrackRecordColumn.begin(), mTrackRecordColumn.end() );
+  }
+  else {
+    StHbtBinaryEventFormat::pack( mTrackColumns, mSection );
+  }
+  StHbtBinaryEventFormat::pack( mV0Columns, mSection );
+  chunk.dataRawBytes = mSection.size();
+  chunk.dataBytes = writeSection( mSection );
+
+  const std::streampos endPos = mFile.tellp();
+  mFile.seekp( chunkPos );
+  mFile.write( reinterpret_cast<const char*>( &chunk ), sizeof(chunk) );
+  mFile.seekp( endPos );
+
+  mNBytesWritten += sizeof(chunk) + chunk.headerBytes + chunk.dataBytes;
+  mNChunksWritten++;
+
+  /// Clear columns (the capacity is kept)
+  for ( unsigned int iCol=0; iCol<mEventColumns.size(); iCol++ ) mEventColumns[iCol].clear();
+  for ( unsigned int iCol=0; iCol<mTrackColumns.size(); iCol++ ) mTrackColumns[iCol].clear();
+  mTrackRecordColumn.clear();
+  for ( unsigned int iCol=0; iCol<mV0Columns.size(); iCol++ ) mV0Columns[iCol].clear();
+  for ( unsigned int iCol=0; iCol<mCountColumns.size(); iCol++ ) mCountColumns[iCol].clear();
+  mTriggerColumn.clear();
+  mNEvents = mNTracks = mNV0s = mNTriggerIds = 0;
+
+  if ( !mFile.good() ) {
+    std::cout << "[ERROR] StHbtBinaryEventWriter::flushChunk - write to "
+	      << mFileName << " failed" << std::endl;
+    mReaderStatus = 1;
+    return false;
+  }
+  return true;
+}
+
+//_________________
+void StHbtBinaryEventWriter::finish() {
+  if ( !mFile.is_open() ) return;
+  flushChunk();
+  mFile.close();
+  if ( mDebug ) {
+    std::cout << "StHbtBinaryEventWriter::finish - " << mNEventsWritten << " events in "
+	      << mNChunksWritten << " chunks (" << mNBytesWritten << " bytes) written to "
+	      << mFileName << std::endl;
+  }
+}
+
+//_________________
+StHbtString StHbtBinaryEventWriter::report() {
+  StHbtString temp = "\n This is StHbtBinaryEventWriter reporting";
+  char ctemp[200];
+  temp += "\n---> File: ";
+  temp += mFileName;
+  snprintf( ctemp, sizeof(ctemp), ", events per chunk: %u, compression: %d, track records: %d",
+	    mEventsPerChunk, mCompression, mTrackRecords );
+  temp += ctemp;
+  snprintf( ctemp, sizeof(ctemp), "\n---> Events written: %u, chunks written: %u\n",
+	    mNEventsWritten, mNChunksWritten );
+  temp += ctemp;
+  return temp;
+}
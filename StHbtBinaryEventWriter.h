@@ -0,0 +1,114 @@
+/**
+ * Description: Writer of StHbtEvents to the columnar binary format.
+ *
+ * Events passed to writeHbtEvent() are accumulated column by column and
+ * written in chunks of a given number of events (see StHbtBinaryEventFormat
+ * for the layout). The front-loaded cuts of the writer are applied: events
+ * that fail the event cut are not written, and only the tracks and V0s that
+ * pass the track and V0 cuts are stored.
+ *
+ * Usage:
+ *   StHbtBinaryEventWriter *writer = new StHbtBinaryEventWriter("events.hbt");
+ *   writer->setCompression(404);   // LZ4, level 4 (0 - no compression)
+ *   hbtManager->addEventWriter( writer );
+ */
+
+#ifndef StHbtBinaryEventWriter_h
+#define StHbtBinaryEventWriter_h
+
+/// C++ headers
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// StHbtMaker headers
+#include "StHbtEventReader.h"
+#include "StHbtBinaryEventFormat.h"
+
+//_________________
+class StHbtBinaryEventWriter : public StHbtEventReader {
+
+ public:
+  /// Default constructor
+  StHbtBinaryEventWriter();
+  /// Constructor with the output file name
+  StHbtBinaryEventWriter(const char* fileName, const unsigned int& eventsPerChunk = 500,
+			 const int& compression = 0);
+  /// Destructor. Writes the last chunk if the writer was not finished
+  virtual ~StHbtBinaryEventWriter();
+
+  /// Open the file and write the file header
+  virtual int init(const char* ReadWrite, StHbtString& Message);
+  /// Add event to the current chunk
+  virtual int writeHbtEvent(StHbtEvent* event);
+  /// Write the last chunk and close the file
+  virtual void finish();
+  /// The writer does not read
+  virtual StHbtEvent* returnHbtEvent()               { return nullptr; }
+  virtual StHbtString report();
+
+  /**
+   * Setters
+   **/
+  void setFileName(const char* fileName)             { mFileName = fileName; }
+  /// Number of events in a chunk (the unit of reading and compression)
+  void setEventsPerChunk(const unsigned int& n)      { mEventsPerChunk = ( n > 0 ) ? n : 1; }
+  /// ROOT compression setting: 100*algorithm + level (0 - none)
+  void setCompression(const int& setting)            { mCompression = setting; }
+  /// Store tracks as StHbtTrack records instead of columns, so that they
+  /// can be read as memory-mapped views (use without compression)
+  void setTrackRecords(const bool& records)          { mTrackRecords = records; }
+
+  /// Number of events and chunks written
+  unsigned int nEventsWritten() const                { return mNEventsWritten; }
+  unsigned int nChunksWritten() const                { return mNChunksWritten; }
+
+ private:
+  /// Not copyable: owns the output file
+  StHbtBinaryEventWriter(const StHbtBinaryEventWriter&);
+  StHbtBinaryEventWriter& operator=(const StHbtBinaryEventWriter&);
+
+  /// Write the accumulated events and clear the columns
+  bool flushChunk();
+  /// Write the section (compressed if possible), return stored size
+  unsigned long long writeSection(const std::vector<char>& section);
+
+  /// Output file name and stream
+  std::string mFileName;
+  std::ofstream mFile;                           //!
+  /// Number of events per chunk and compression setting
+  unsigned int mEventsPerChunk;
+  int mCompression;
+  /// Tracks are stored as records
+  bool mTrackRecords;
+
+  /// Columns of the current chunk
+  std::vector<StHbtByteColumn> mEventColumns;    //!
+  std::vector<StHbtByteColumn> mTrackColumns;    //!
+  StHbtByteColumn mTrackRecordColumn;            //!
+  std::vector<StHbtByteColumn> mV0Columns;       //!
+  /// Number of tracks, V0s and trigger ids of each event, and trigger ids
+  std::vector<StHbtByteColumn> mCountColumns;    //!
+  StHbtByteColumn mTriggerColumn;                //!
+
+  /// Entries of the current chunk
+  unsigned int mNEvents;
+  unsigned int mNTracks;
+  unsigned int mNV0s;
+  unsigned int mNTriggerIds;
+
+  /// Section buffers (reused)
+  std::vector<char> mSection;                    //!
+  std::vector<char> mCompressed;                 //!
+
+  /// Statistics
+  unsigned int mNEventsWritten;
+  unsigned int mNChunksWritten;
+  unsigned long long mNBytesWritten;
+
+#ifdef __ROOT__
+  ClassDef(StHbtBinaryEventWriter, 0)
+#endif
+};
+
+#endif // #define StHbtBinaryEventWriter_h
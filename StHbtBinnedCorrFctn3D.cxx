@@ -0,0 +1,433 @@
+/**
+ * Description: 3D correlation function binned in pair and event variables
+ */
+
+/// C++ headers
+#include <cmath>
+
+/// StHbtMaker headers
+#include "StHbtBinnedCorrFctn3D.h"
+#include "StHbtPairCut.h"
+#include "StHbtCheckpoint.h"
+
+/// ROOT headers
+#include "TH3F.h"
+#include "TString.h"
+#include "TMath.h"
+
+#ifdef __ROOT__
+ClassImp(StHbtBinnedCorrFctn3D);
+#endif
+
+//_________________
+StHbtBinnedCorrFctn3D::StHbtBinnedCorrFctn3D(const char* title, const int& nBins,
+					     const float& qLo, const float& qHi) :
+  StHbtCorrFctn(), mTitle( title ), mNQBins( nBins ), mQLo( qLo ), mQHi( qHi ),
+  mAxes(), mUseLCMS( true ), mAbsoluteQ( false ), mFineQRange( 0 ),
+  mEventPlaneAngle( 0 ), mCentrality( 0 ), mRefMult( 0 ) {
+  /// Constructor: a single bin until axes are added
+  resizeBins();
+}
+
+//_________________
+StHbtBinnedCorrFctn3D::StHbtBinnedCorrFctn3D(const StHbtBinnedCorrFctn3D& copy) :
+  StHbtCorrFctn( copy ), mTitle( copy.mTitle ), mNQBins( copy.mNQBins ),
+  mQLo( copy.mQLo ), mQHi( copy.mQHi ), mAxes( copy.mAxes ),
+  mUseLCMS( copy.mUseLCMS ), mAbsoluteQ( copy.mAbsoluteQ ),
+  mFineQRange( copy.mFineQRange ), mEventPlaneAngle( 0 ), mCentrality( 0 ), mRefMult( 0 ) {
+  /// Copy constructor: same binning, histograms and accumulated pairs
+  resizeBins();
+  for ( unsigned int iBin = 0; iBin < copy.numberOfBins(); iBin++ ) {
+    if ( copy.mNumeratorFill[iBin] ) {
+      mNumeratorFill[iBin] = new StHbtDenseHist3D( *copy.mNumeratorFill[iBin] );
+      mDenominatorFill[iBin] = new StHbtDenseHist3D( *copy.mDenominatorFill[iBin] );
+    }
+    if ( copy.mNumerator[iBin] ) {
+      mNumerator[iBin] = new TH3F( *copy.mNumerator[iBin] );
+      mDenominator[iBin] = new TH3F( *copy.mDenominator[iBin] );
+      mQinvHisto[iBin] = new TH3F( *copy.mQinvHisto[iBin] );
+    }
+  } //for ( iBin )
+}
+
+//_________________
+StHbtBinnedCorrFctn3D::~StHbtBinnedCorrFctn3D() {
+  /// Destructor
+  for ( unsigned int iBin = 0; iBin < numberOfBins(); iBin++ ) {
+    delete mNumeratorFill[iBin];
+    delete mDenominatorFill[iBin];
+    delete mNumerator[iBin];
+    delete mDenominator[iBin];
+    delete mQinvHisto[iBin];
+  }
+}
+
+//_________________
+void StHbtBinnedCorrFctn3D::addAxis(const PairVariable& variable, const int& nBins,
+				    const double& lo, const double& hi) {
+  if ( nBins < 1 || !( hi > lo ) ) {
+    std::cout << "[WARNING] StHbtBinnedCorrFctn3D::addAxis - wrong binning: "
+	      << nBins << " bins in [" << lo << ", " << hi << "). Axis is not added"
+	      << std::endl;
+    return;
+  }
+  if ( numberOfFilledBins() > 0 ) {
+    std::cout << "[WARNING] StHbtBinnedCorrFctn3D::addAxis - pairs were already filled. "
+	      << "Axis is not added" << std::endl;
+    return;
+  }
+
+  Axis axis;
+  axis.mVariable = variable;
+  axis.mNBins = nBins;
+  axis.mLo = lo;
+  axis.mHi = hi;
+  axis.mInvWidth = nBins / ( hi - lo );
+  /// The first axis runs fastest
+  axis.mStride = numberOfBins();
+  mAxes.push_back( axis );
+  resizeBins();
+}
+
+//_________________
+void StHbtBinnedCorrFctn3D::resizeBins() {
+  int nBins = 1;
+  for ( unsigned int iAxis = 0; iAxis < mAxes.size(); iAxis++ ) {
+    nBins *= mAxes[iAxis].mNBins;
+  }
+  for ( unsigned int iBin = 0; iBin < numberOfBins(); iBin++ ) {
+    delete mNumerator[iBin];
+    delete mDenominator[iBin];
+    delete mQinvHisto[iBin];
+  }
+  mNumeratorFill.assign( nBins, nullptr );
+  mDenominatorFill.assign( nBins, nullptr );
+  mNumerator.assign( nBins, nullptr );
+  mDenominator.assign( nBins, nullptr );
+  mQinvHisto.assign( nBins, nullptr );
+}
+
+//_________________
+void StHbtBinnedCorrFctn3D::setFineQRange(const float& qFine) {
+  if ( numberOfFilledBins() > 0 ) {
+    std::cout << "[WARNING] StHbtBinnedCorrFctn3D::setFineQRange - pairs were already filled. "
+	      << "Range is not changed" << std::endl;
+    return;
+  }
+  mFineQRange = qFine;
+}
+
+//_________________
+unsigned int StHbtBinnedCorrFctn3D::numberOfFilledBins() const {
+  unsigned int nFilled = 0;
+  for ( unsigned int iBin = 0; iBin < numberOfBins(); iBin++ ) {
+    if ( mNumeratorFill[iBin] ) nFilled++;
+  }
+  return nFilled;
+}
+
+//_________________
+double StHbtBinnedCorrFctn3D::value(const PairVariable& variable,
+				    const StHbtPair* pair) const {
+  switch ( variable ) {
+  case kKt:
+    return pair->kT();
+  case kPhiToEventPlane: {
+    const double angle = pair->phi() - mEventPlaneAngle;
+    return angle - TMath::TwoPi() * std::floor( angle / TMath::TwoPi() );
+  }
+  case kRapidity:
+    return pair->rap();
+  case kCentrality:
+    return mCentrality;
+  case kRefMult:
+    return mRefMult;
+  }
+  return 0.;
+}
+
+//_________________
+int StHbtBinnedCorrFctn3D::findBin(const StHbtPair* pair) const {
+  /// Every axis adds stride * bin to the index and clears the valid flag
+  /// if the value is out of range (NaN included). Out-of-range values are
+  /// clamped so that the conversion to int is always defined
+  bool valid = true;
+  int index = 0;
+  for ( unsigned int iAxis = 0; iAxis < mAxes.size(); iAxis++ ) {
+    const Axis &axis = mAxes[iAxis];
+    const double t = ( value( axis.mVariable, pair ) - axis.mLo ) * axis.mInvWidth;
+    const bool inRange = ( t >= 0. ) & ( t < axis.mNBins );
+    valid &= inRange;
+    index += axis.mStride * (int)( inRange ? t : 0. );
+  }
+  return valid ? index : -1;
+}
+
+//_________________
+void StHbtBinnedCorrFctn3D::qComponents(const StHbtPair* pair, double& qOut,
+					double& qSide, double& qLong) const {
+  if ( mUseLCMS ) {
+    qOut = pair->qOutCMS();
+    qSide = pair->qSideCMS();
+    qLong = pair->qLongCMS();
+  }
+  else {
+    qOut = pair->qOutPf();
+    qSide = pair->qSidePf();
+    qLong = pair->qLongPf();
+  }
+  if ( mAbsoluteQ ) {
+    qOut = std::fabs( qOut );
+    qSide = std::fabs( qSide );
+    qLong = std::fabs( qLong );
+  }
+}
+
+//_________________
+void StHbtBinnedCorrFctn3D::createBin(const int& bin) {
+  mNumeratorFill[bin] = new StHbtDenseHist3D( mNQBins, mQLo, mQHi,
+					      mNQBins, mQLo, mQHi,
+					      mNQBins, mQLo, mQHi );
+  mNumeratorFill[bin]->setFineRange( mFineQRange );
+  mDenominatorFill[bin] = mNumeratorFill[bin]->cloneEmpty();
+}
+
+//_________________
+void StHbtBinnedCorrFctn3D::eventBegin(const StHbtEvent* event) {
+  mEventPlaneAngle = event->eventPlaneAngle();
+  mCentrality = event->cent16();
+  mRefMult = event->refMult();
+}
+
+//_________________
+void StHbtBinnedCorrFctn3D::addRealPair(const StHbtPair* pair) {
+  /// Perform operations on real pairs
+  if ( mPairCut && !mPairCut->pass( pair ) ) {
+    return;
+  }
+
+  const int bin = findBin( pair );
+  if ( bin < 0 ) return;
+  if ( !mNumeratorFill[bin] ) createBin( bin );
+
+  double qOut, qSide, qLong;
+  qComponents( pair, qOut, qSide, qLong );
+  mNumeratorFill[bin]->fill( qOut, qSide, qLong );
+}
+
+//_________________
+void StHbtBinnedCorrFctn3D::addMixedPair(const StHbtPair* pair) {
+  /// Perform operations on mixed pairs
+  if ( mPairCut && !mPairCut->pass( pair ) ) {
+    return;
+  }
+
+  const int bin = findBin( pair );
+  if ( bin < 0 ) return;
+  if ( !mNumeratorFill[bin] ) createBin( bin );
+
+  double qOut, qSide, qLong;
+  qComponents( pair, qOut, qSide, qLong );
+  mDenominatorFill[bin]->fillCountAndWeight( qOut, qSide, qLong, pair->qInv() );
+}
+
+//_________________
+std::string StHbtBinnedCorrFctn3D::histogramName(const char* kind, const int& bin) const {
+  static const char* axisNames[] = { "kt", "phiEP", "y", "cent", "mult" };
+  TString name = TString::Format( "%s_%s", mTitle.c_str(), kind );
+  for ( unsigned int iAxis = 0; iAxis < mAxes.size(); iAxis++ ) {
+    const Axis &axis = mAxes[iAxis];
+    name += TString::Format( "_%s_%d", axisNames[axis.mVariable],
+			     ( bin / axis.mStride ) % axis.mNBins );
+  }
+  return std::string( name.Data() );
+}
+
+//_________________
+TH3F* StHbtBinnedCorrFctn3D::makeHistogram(const char* kind, const int& bin) const {
+  TString title = TString::Format( "%s; q_{out} (GeV/c); q_{side} (GeV/c); q_{long} (GeV/c)",
+				   mTitle.c_str() );
+  TH3F *hist = new TH3F( histogramName( kind, bin ).c_str(), title,
+			 mNQBins, mQLo, mQHi, mNQBins, mQLo, mQHi,
+			 mNQBins, mQLo, mQHi );
+  hist->Sumw2();
+  return hist;
+}
+
+//_________________
+void StHbtBinnedCorrFctn3D::flushHistograms() {
+  /// Histograms of the bins without pairs are created as well, so that
+  /// the output always has the same structure
+  for ( unsigned int iBin = 0; iBin < numberOfBins(); iBin++ ) {
+    if ( !mNumerator[iBin] ) {
+      mNumerator[iBin] = makeHistogram( "Num", iBin );
+      mDenominator[iBin] = makeHistogram( "Den", iBin );
+      mQinvHisto[iBin] = makeHistogram( "Qinv", iBin );
+    }
+    if ( mNumeratorFill[iBin] ) {
+      mNumeratorFill[iBin]->flush( mNumerator[iBin] );
+      mDenominatorFill[iBin]->flush( mDenominator[iBin], mQinvHisto[iBin] );
+    }
+  } //for ( iBin )
+}
+
+//_________________
+StHbtCorrFctn* StHbtBinnedCorrFctn3D::createShard() {
+  StHbtBinnedCorrFctn3D *shard = new StHbtBinnedCorrFctn3D( mTitle.c_str(), mNQBins, mQLo, mQHi );
+  shard->mBaseAnalysis = mBaseAnalysis;
+  shard->mPairCut = mPairCut;
+  shard->mAxes = mAxes;
+  shard->mUseLCMS = mUseLCMS;
+  shard->mAbsoluteQ = mAbsoluteQ;
+  shard->mFineQRange = mFineQRange;
+  shard->resizeBins();
+  return shard;
+}
+
+//_________________
+void StHbtBinnedCorrFctn3D::mergeShard(StHbtCorrFctn* shard) {
+  StHbtBinnedCorrFctn3D *cf = dynamic_cast<StHbtBinnedCorrFctn3D*>( shard );
+  if ( !cf || cf == this || cf->numberOfBins() != numberOfBins() ) {
+    std::cout << "[WARNING] StHbtBinnedCorrFctn3D::mergeShard - not a shard of this function"
+	      << std::endl;
+    return;
+  }
+  for ( unsigned int iBin = 0; iBin < numberOfBins(); iBin++ ) {
+    if ( !cf->mNumeratorFill[iBin] ) continue;
+    if ( !mNumeratorFill[iBin] ) createBin( iBin );
+    mNumeratorFill[iBin]->merge( *cf->mNumeratorFill[iBin] );
+    mDenominatorFill[iBin]->merge( *cf->mDenominatorFill[iBin] );
+  }
+}
+
+//_________________
+void StHbtBinnedCorrFctn3D::writeCheckpoint(StHbtCheckpoint& checkpoint) {
+  /// The histograms of all bins are created together, the accumulators
+  /// only for the bins with pairs
+  checkpoint.write( numberOfBins() );
+  checkpoint.write( (unsigned char)( mNumerator[0] ? 1 : 0 ) );
+  for ( unsigned int iBin = 0; iBin < numberOfBins(); iBin++ ) {
+    if ( mNumerator[0] ) {
+      checkpoint.writeHistogram( mNumerator[iBin] );
+      checkpoint.writeHistogram( mDenominator[iBin] );
+      checkpoint.writeHistogram( mQinvHisto[iBin] );
+    }
+    checkpoint.write( (unsigned char)( mNumeratorFill[iBin] ? 1 : 0 ) );
+    if ( mNumeratorFill[iBin] ) {
+      mNumeratorFill[iBin]->writeCheckpoint( checkpoint );
+      mDenominatorFill[iBin]->writeCheckpoint( checkpoint );
+    }
+  } //for ( iBin )
+}
+
+//_________________
+bool StHbtBinnedCorrFctn3D::readCheckpoint(StHbtCheckpoint& checkpoint) {
+  unsigned int nBins = 0;
+  unsigned char withHistograms = 0;
+  if ( !checkpoint.read( nBins ) || !checkpoint.read( withHistograms ) ) return false;
+  if ( nBins != numberOfBins() ) {
+    std::cout << "[ERROR] StHbtBinnedCorrFctn3D::readCheckpoint - " << nBins
+	      << " bins instead of " << numberOfBins() << std::endl;
+    return false;
+  }
+  /// Creates the missing histograms, the content is replaced below
+  if ( withHistograms ) flushHistograms();
+  for ( unsigned int iBin = 0; iBin < numberOfBins(); iBin++ ) {
+    if ( withHistograms ) {
+      if ( !checkpoint.readHistogram( mNumerator[iBin] ) ||
+	   !checkpoint.readHistogram( mDenominator[iBin] ) ||
+	   !checkpoint.readHistogram( mQinvHisto[iBin] ) ) return false;
+    }
+    else if ( mNumerator[iBin] ) {
+      mNumerator[iBin]->Reset();
+      mDenominator[iBin]->Reset();
+      mQinvHisto[iBin]->Reset();
+    }
+    unsigned char withPairs = 0;
+    if ( !checkpoint.read( withPairs ) ) return false;
+    if ( withPairs ) {
+      if ( !mNumeratorFill[iBin] ) createBin( iBin );
+      if ( !mNumeratorFill[iBin]->readCheckpoint( checkpoint ) ||
+	   !mDenominatorFill[iBin]->readCheckpoint( checkpoint ) ) return false;
+    }
+    else if ( mNumeratorFill[iBin] ) {
+      mNumeratorFill[iBin]->reset();
+      mDenominatorFill[iBin]->reset();
+    }
+  } //for ( iBin )
+  return true;
+}
+
+//_________________
+void StHbtBinnedCorrFctn3D::writeOutHistos() {
+  /// Write out all histograms to file
+  if ( mNumerator[0] ) {
+    flushHistograms();
+    for ( unsigned int iBin = 0; iBin < numberOfBins(); iBin++ ) {
+      mNumerator[iBin]->Write();
+      mDenominator[iBin]->Write();
+      mQinvHisto[iBin]->Write();
+    }
+    return;
+  }
+
+  /// Only one TH3F at a time is in memory
+  const char* kinds[] = { "Num", "Den", "Qinv" };
+  for ( unsigned int iBin = 0; iBin < numberOfBins(); iBin++ ) {
+    for ( int iKind = 0; iKind < 3; iKind++ ) {
+      TH3F *hist = makeHistogram( kinds[iKind], iBin );
+      if ( mNumeratorFill[iBin] ) {
+	if ( iKind == 0 )      mNumeratorFill[iBin]->addTo( hist );
+	else if ( iKind == 1 ) mDenominatorFill[iBin]->addTo( hist );
+	else                   mDenominatorFill[iBin]->addTo( nullptr, hist );
+      }
+      hist->Write();
+      delete hist;
+    }
+  } //for ( iBin )
+}
+
+//_________________
+TList* StHbtBinnedCorrFctn3D::getOutputList() {
+  /// Prepare the list of objects to be written to the output
+  TList *outputList = new TList();
+
+  flushHistograms();
+  for ( unsigned int iBin = 0; iBin < numberOfBins(); iBin++ ) {
+    outputList->Add( mNumerator[iBin] );
+    outputList->Add( mDenominator[iBin] );
+    outputList->Add( mQinvHisto[iBin] );
+  }
+
+  return outputList;
+}
+
+//_________________
+void StHbtBinnedCorrFctn3D::finish() {
+  /* empty */
+}
+
+//_________________
+StHbtString StHbtBinnedCorrFctn3D::report() {
+  /// Construct the report
+  static const char* variableNames[] = { "kT", "phi - Psi_EP", "rapidity",
+					 "centrality", "refMult" };
+  TString report = "Binned 3D Correlation Function Report:\n";
+  report += TString::Format( "Frame:\t%s\n", ( mUseLCMS ) ? "LCMS" : "PRF" );
+  for ( unsigned int iAxis = 0; iAxis < mAxes.size(); iAxis++ ) {
+    report += TString::Format( "Axis %d:\t%s, %d bins in [%f, %f)\n", iAxis,
+			       variableNames[mAxes[iAxis].mVariable], mAxes[iAxis].mNBins,
+			       mAxes[iAxis].mLo, mAxes[iAxis].mHi );
+  }
+  report += TString::Format( "Bins filled:\t%d of %d\n", numberOfFilledBins(), numberOfBins() );
+
+  if ( mPairCut ) {
+    report += "Here is the PairCut specific to this CorrFctn\n";
+    report += mPairCut->report();
+  }
+  else {
+    report += "No PairCut specific to this CorrFctn\n";
+  }
+
+  return StHbtString( (const char *)report );
+}
@@ -0,0 +1,156 @@
+/**
+ * Description: 3D correlation function binned in pair and event variables
+ *
+ * StHbtBinnedCorrFctn3D fills numerator, denominator and qinv-weighted
+ * denominator of the Bertsch-Pratt q_out, q_side, q_long correlation
+ * function separately for every bin of an arbitrary list of axes added
+ * with addAxis(): pair kT, pair azimuth relative to the event plane, pair
+ * rapidity, centrality or reference multiplicity. One object replaces a
+ * set of analyses (or the fixed kT x angle arrays of
+ * yunoBPLCMSFrame3DCorrFctnKt) that differ only in these bins.
+ *
+ * The bin of a pair is found with precomputed inverse widths and strides
+ * of all axes and without branches on the individual axes. Accumulators
+ * (StHbtDenseHist3D) are created on the first pair of a bin, so bins that
+ * are never filled do not cost memory during the run. The TH3F histograms
+ * are created when the output is requested: getOutputList() returns the
+ * histograms of all bins, named <title>_Num, _Den and _Qinv followed by
+ * _<axis>_<bin> for each axis (e.g. cf_Num_kt_2_phiEP_5). The accumulators
+ * release their memory once the pairs are transferred. writeOutHistos()
+ * without the TH3F histograms writes them one at a time, so that only one
+ * of them is in memory.
+ *
+ * With setFineQRange() the q bins are exact only for |q| components below
+ * the given value, further out the pairs are accumulated in groups of
+ * 4x4x4 bins (see StHbtDenseHist3D::setFineRange).
+ */
+
+#ifndef StHbtBinnedCorrFctn3D_h
+#define StHbtBinnedCorrFctn3D_h
+
+/// C++ headers
+#include <vector>
+#include <string>
+
+/// StHbtMaker headers
+#include "StHbtCorrFctn.h"
+#include "StHbtDenseHist3D.h"
+
+/// Forward declarations
+class TH3F;
+
+//_________________
+class StHbtBinnedCorrFctn3D : public StHbtCorrFctn {
+
+ public:
+
+  /// Variables that can be used as binning axes
+  enum PairVariable { kKt = 0, kPhiToEventPlane, kRapidity, kCentrality, kRefMult };
+
+  /// Constructor with the q_out, q_side and q_long binning
+  StHbtBinnedCorrFctn3D(const char* title, const int& nBins, const float& qLo, const float& qHi);
+  /// Copy constructor
+  StHbtBinnedCorrFctn3D(const StHbtBinnedCorrFctn3D& copy);
+  /// Destructor
+  virtual ~StHbtBinnedCorrFctn3D();
+
+  /// Add a binning axis. Pairs outside [lo, hi) of any axis are not used.
+  /// The azimuth relative to the event plane is taken in [0, 2pi)
+  void addAxis(const PairVariable& variable, const int& nBins,
+	       const double& lo, const double& hi);
+  /// Use LCMS (default) or pair rest frame q components
+  void setUseLCMS(const bool& useLCMS)           { mUseLCMS = useLCMS; }
+  /// Fill |q_out|, |q_side| and |q_long| (default: false)
+  void setAbsoluteQ(const bool& absQ)            { mAbsoluteQ = absQ; }
+  /// Exact bins only for |q_out|, |q_side|, |q_long| below qFine (<= 0 -
+  /// all bins, default). Must be set before the first pair
+  void setFineQRange(const float& qFine);
+
+  /// Total number of bins and number of bins with accumulated pairs
+  unsigned int numberOfBins() const              { return mNumeratorFill.size(); }
+  unsigned int numberOfFilledBins() const;
+
+  virtual StHbtString report();
+  virtual void eventBegin(const StHbtEvent* event);
+  virtual void addRealPair(const StHbtPair* pair);
+  virtual void addMixedPair(const StHbtPair* pair);
+  virtual void finish();
+
+  void writeOutHistos();
+  virtual TList* getOutputList();
+
+  virtual StHbtCorrFctn* clone()                 { return new StHbtBinnedCorrFctn3D( *this ); }
+  /// Shard with the same axes and empty accumulators (no TH3F histograms).
+  /// eventBegin must be called on the shard as well
+  virtual StHbtCorrFctn* createShard();
+  virtual void mergeShard(StHbtCorrFctn* shard);
+
+  /// Checkpoint of the accumulators (and of the TH3F histograms if they
+  /// were already created)
+  virtual void writeCheckpoint(StHbtCheckpoint& checkpoint);
+  virtual bool readCheckpoint(StHbtCheckpoint& checkpoint);
+
+ private:
+
+  /// Not assignable
+  StHbtBinnedCorrFctn3D& operator=(const StHbtBinnedCorrFctn3D&);
+
+  /// Binning axis
+  struct Axis {
+    PairVariable mVariable;
+    int mNBins;
+    double mLo;
+    double mHi;
+    double mInvWidth;
+    int mStride;
+  };
+
+  /// Bin of the pair, -1 if outside of the axes
+  int findBin(const StHbtPair* pair) const;
+  /// Value of the variable for the pair in the current event
+  double value(const PairVariable& variable, const StHbtPair* pair) const;
+  /// q components of the pair
+  void qComponents(const StHbtPair* pair, double& qOut, double& qSide, double& qLong) const;
+  /// Accumulators of the bin (created on first use)
+  void createBin(const int& bin);
+  /// Histogram name of the bin
+  std::string histogramName(const char* kind, const int& bin) const;
+  /// New TH3F histogram of the bin
+  TH3F* makeHistogram(const char* kind, const int& bin) const;
+  /// Create the missing TH3F histograms and transfer the accumulated pairs
+  void flushHistograms();
+  /// Resize the bin arrays after a change of the axes
+  void resizeBins();
+
+  /// Title and q binning
+  std::string mTitle;
+  int mNQBins;
+  float mQLo;
+  float mQHi;
+
+  /// Binning axes
+  std::vector<Axis> mAxes;
+  bool mUseLCMS;
+  bool mAbsoluteQ;
+  /// Range of the exact q bins (<= 0 - all)
+  float mFineQRange;
+
+  /// Accumulators and histograms of each bin (nullptr until needed).
+  /// The denominator accumulator also keeps the qinv weights
+  std::vector<StHbtDenseHist3D*> mNumeratorFill;   //!
+  std::vector<StHbtDenseHist3D*> mDenominatorFill; //!
+  std::vector<TH3F*> mNumerator;                   //!
+  std::vector<TH3F*> mDenominator;                 //!
+  std::vector<TH3F*> mQinvHisto;                   //!
+
+  /// Event variables of the current event
+  double mEventPlaneAngle;
+  double mCentrality;
+  double mRefMult;
+
+#ifdef __ROOT__
+  ClassDef(StHbtBinnedCorrFctn3D, 1)
+#endif
+};
+
+#endif // #define StHbtBinnedCorrFctn3D_h
@@ -0,0 +1,310 @@
+/**
+ * Description: Checkpoint of the analysis state for resumable jobs.
+ */
+
+/// C++ headers
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+
+/// StHbtMaker headers
+#include "StHbtTrack.h"
+#include "StHbtBinaryEventFormat.h"
+#include "StHbtCheckpoint.h"
+
+/// ROOT headers
+#include "TH1.h"
+#include "TList.h"
+
+/// Checkpoint file identification
+static const char kCheckpointMagic[8] = { 'S', 'T', 'H', 'B', 'T', 'C', 'K', 'P' };
+static const unsigned int kCheckpointVersion = 5;
+
+//_________________
+StHbtCheckpoint::StHbtCheckpoint() : mBuffer(), mPos(0),
+  mWithMixingBuffers(false), mGood(true) {
+  /* empty */
+}
+
+//_________________
+bool StHbtCheckpoint::fail(const char* message) {
+  if ( mGood ) {
+    std::cout << "[ERROR] StHbtCheckpoint: " << message << std::endl;
+  }
+  mGood = false;
+  return false;
+}
+
+//_________________
+void StHbtCheckpoint::beginWrite() {
+  mBuffer.clear();
+  mPos = 0;
+  mGood = true;
+  writeBytes( kCheckpointMagic, sizeof(kCheckpointMagic) );
+  write( kCheckpointVersion );
+  write( (unsigned char)( mWithMixingBuffers ? 1 : 0 ) );
+
+  /// Track field layout
+  unsigned int nTrackFields = 0;
+  unsigned int trackFieldBytes = 0;
+  trackLayout( nTrackFields, trackFieldBytes );
+  write( nTrackFields );
+  write( trackFieldBytes );
+}
+
+//_________________
+void StHbtCheckpoint::trackLayout(unsigned int& nFields, unsigned int& bytes) {
+  std::vector<unsigned int> sizes;
+  StHbtBinaryEventFormat::fieldSizes( StHbtBinaryEventFormat::kTrack, sizes );
+  nFields = sizes.size();
+  bytes = 0;
+  for ( unsigned int iField=0; iField<sizes.size(); iField++ ) {
+    bytes += sizes[iField];
+  }
+}
+
+//_________________
+bool StHbtCheckpoint::save(const char* fileName) const {
+
+  /// Write the temporary file first and replace the old checkpoint only
+  /// when the new one is complete
+  const std::string tmpName = std::string( fileName ) + ".tmp";
+  std::ofstream out( tmpName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+  if ( !out.is_open() ) {
+    std::cout << "[ERROR] StHbtCheckpoint::save - can not open file: " << tmpName << std::endl;
+    return false;
+  }
+  if ( !mBuffer.empty() ) {
+    out.write( &mBuffer[0], mBuffer.size() );
+  }
+  out.close();
+  if ( out.fail() ) {
+    std::cout << "[ERROR] StHbtCheckpoint::save - can not write file: " << tmpName << std::endl;
+    std::remove( tmpName.c_str() );
+    return false;
+  }
+
+  if ( std::rename( tmpName.c_str(), fileName ) != 0 ) {
+    std::cout << "[ERROR] StHbtCheckpoint::save - can not rename " << tmpName
+	      << " to " << fileName << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//_________________
+bool StHbtCheckpoint::load(const char* fileName) {
+
+  mBuffer.clear();
+  mPos = 0;
+  mGood = true;
+
+  std::ifstream in( fileName, std::ios::in | std::ios::binary );
+  if ( !in.is_open() ) {
+    mGood = false;
+    return false;
+  }
+  in.seekg( 0, std::ios::end );
+  const std::streamoff fileSize = in.tellg();
+  in.seekg( 0, std::ios::beg );
+  if ( fileSize > 0 ) {
+    mBuffer.resize( fileSize );
+    in.read( &mBuffer[0], fileSize );
+  }
+  if ( !in.good() ) {
+    return fail( "can not read the checkpoint file" );
+  }
+
+  char magic[8];
+  unsigned int version = 0;
+  unsigned char withMixingBuffers = 0;
+  if ( !readBytes( magic, sizeof(magic) ) ||
+       std::memcmp( magic, kCheckpointMagic, sizeof(magic) ) != 0 ) {
+    return fail( "not a checkpoint file" );
+  }
+  if ( !read( version ) || version != kCheckpointVersion ) {
+    return fail( "unsupported checkpoint version" );
+  }
+  if ( !read( withMixingBuffers ) ) return false;
+  mWithMixingBuffers = ( withMixingBuffers != 0 );
+
+  unsigned int nTrackFields = 0, trackFieldBytes = 0;
+  unsigned int nExpectedFields = 0, expectedFieldBytes = 0;
+  trackLayout( nExpectedFields, expectedFieldBytes );
+  if ( !read( nTrackFields ) || !read( trackFieldBytes ) ) return false;
+  if ( nTrackFields != nExpectedFields || trackFieldBytes != expectedFieldBytes ) {
+    return fail( "track layout of the checkpoint does not match the current one" );
+  }
+  return true;
+}
+
+//_________________
+void StHbtCheckpoint::writeBytes(const void* data, const unsigned long long& bytes) {
+  const unsigned long long pos = mBuffer.size();
+  mBuffer.resize( pos + bytes );
+  if ( bytes > 0 ) {
+    std::memcpy( &mBuffer[pos], data, bytes );
+  }
+}
+
+//_________________
+bool StHbtCheckpoint::readBytes(void* data, const unsigned long long& bytes) {
+  if ( !mGood ) return false;
+  if ( mPos + bytes > mBuffer.size() ) {
+    return fail( "unexpected end of the checkpoint" );
+  }
+  if ( bytes > 0 ) {
+    std::memcpy( data, &mBuffer[mPos], bytes );
+  }
+  mPos += bytes;
+  return true;
+}
+
+//_________________
+void StHbtCheckpoint::writeString(const std::string& str) {
+  write( (unsigned int)str.size() );
+  writeBytes( str.data(), str.size() );
+}
+
+//_________________
+bool StHbtCheckpoint::readString(std::string& str) {
+  unsigned int length = 0;
+  if ( !read( length ) ) return false;
+  if ( mPos + length > mBuffer.size() ) {
+    return fail( "unexpected end of the checkpoint" );
+  }
+  str.assign( &mBuffer[0] + mPos, length );
+  mPos += length;
+  return true;
+}
+
+//_________________
+void StHbtCheckpoint::writeHistogram(const TH1* hist) {
+
+  writeString( hist->GetName() );
+
+  /// Bin contents including under- and overflows
+  const int nCells = hist->GetNcells();
+  write( nCells );
+  for ( int iCell=0; iCell<nCells; iCell++ ) {
+    write( hist->GetBinContent( iCell ) );
+  }
+
+  /// Sum of weight squares
+  const int nSumw2 = hist->GetSumw2N();
+  write( nSumw2 );
+  if ( nSumw2 > 0 ) {
+    writeBytes( hist->GetSumw2()->GetArray(), nSumw2 * sizeof(double) );
+  }
+
+  /// Entries and statistics
+  double stats[TH1::kNstat];
+  std::memset( stats, 0, sizeof(stats) );
+  hist->GetStats( stats );
+  write( hist->GetEntries() );
+  writeBytes( stats, sizeof(stats) );
+}
+
+//_________________
+bool StHbtCheckpoint::readHistogram(TH1* hist) {
+
+  std::string name;
+  int nCells = 0;
+  if ( !readString( name ) || !read( nCells ) ) return false;
+  if ( name != hist->GetName() || nCells != hist->GetNcells() ) {
+    std::cout << "[ERROR] StHbtCheckpoint::readHistogram - stored histogram " << name
+	      << " (" << nCells << " cells) does not match " << hist->GetName()
+	      << " (" << hist->GetNcells() << " cells)" << std::endl;
+    return fail( "histogram mismatch" );
+  }
+
+  double content = 0;
+  for ( int iCell=0; iCell<nCells; iCell++ ) {
+    if ( !read( content ) ) return false;
+    hist->SetBinContent( iCell, content );
+  }
+
+  int nSumw2 = 0;
+  if ( !read( nSumw2 ) ) return false;
+  if ( nSumw2 > 0 ) {
+    if ( hist->GetSumw2N() == 0 ) {
+      hist->Sumw2();
+    }
+    if ( hist->GetSumw2N() != nSumw2 ) {
+      return fail( "sum of weight squares size mismatch" );
+    }
+    if ( !readBytes( hist->GetSumw2()->GetArray(), nSumw2 * sizeof(double) ) ) return false;
+  }
+
+  double entries = 0;
+  double stats[TH1::kNstat];
+  if ( !read( entries ) || !readBytes( stats, sizeof(stats) ) ) return false;
+  /// SetBinContent changes the number of entries: restore it last
+  hist->PutStats( stats );
+  hist->SetEntries( entries );
+  return true;
+}
+
+//_________________
+void StHbtCheckpoint::writeHistograms(TList* list) {
+  std::vector<const TH1*> hists;
+  TIter next( list );
+  while ( TObject *obj = next() ) {
+    if ( obj->InheritsFrom( TH1::Class() ) ) {
+      hists.push_back( static_cast<const TH1*>( obj ) );
+    }
+  }
+  write( (unsigned int)hists.size() );
+  for ( unsigned int iHist=0; iHist<hists.size(); iHist++ ) {
+    writeHistogram( hists[iHist] );
+  }
+}
+
+//_________________
+bool StHbtCheckpoint::readHistograms(TList* list) {
+  std::vector<TH1*> hists;
+  TIter next( list );
+  while ( TObject *obj = next() ) {
+    if ( obj->InheritsFrom( TH1::Class() ) ) {
+      hists.push_back( static_cast<TH1*>( obj ) );
+    }
+  }
+  unsigned int nHists = 0;
+  if ( !read( nHists ) ) return false;
+  if ( nHists != hists.size() ) {
+    return fail( "number of histograms does not match the analysis" );
+  }
+  for ( unsigned int iHist=0; iHist<hists.size(); iHist++ ) {
+    if ( !readHistogram( hists[iHist] ) ) return false;
+  }
+  return true;
+}
+
+//_________________
+void StHbtCheckpoint::writeTrack(const StHbtTrack* track) {
+  /// One-entry columns, written one after another
+  std::vector<StHbtByteColumn> fields( StHbtBinaryEventFormat::numberOfColumns( StHbtBinaryEventFormat::kTrack ) );
+  StHbtBinaryEventFormat::append( track, fields );
+  for ( unsigned int iField=0; iField<fields.size(); iField++ ) {
+    writeBytes( &fields[iField][0], fields[iField].size() );
+  }
+}
+
+//_________________
+StHbtTrack* StHbtCheckpoint::readTrack() {
+  std::vector<unsigned int> sizes;
+  StHbtBinaryEventFormat::fieldSizes( StHbtBinaryEventFormat::kTrack, sizes );
+  std::vector<const char*> fields( sizes.size() );
+  for ( unsigned int iField=0; iField<sizes.size(); iField++ ) {
+    if ( mPos + sizes[iField] > mBuffer.size() || !mGood ) {
+      fail( "unexpected end of the checkpoint" );
+      return nullptr;
+    }
+    fields[iField] = &mBuffer[mPos];
+    mPos += sizes[iField];
+  }
+  /// The fields are copied with memcpy, so no alignment is needed
+  StHbtTrack *track = new StHbtTrack();
+  StHbtBinaryEventFormat::read( fields, 0, track );
+  return track;
+}
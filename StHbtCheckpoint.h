@@ -0,0 +1,105 @@
+/**
+ * Description: Checkpoint of the analysis state for resumable jobs.
+ *
+ * StHbtCheckpoint is a flat binary buffer that the manager, the analyses
+ * and the cuts append their state to (histogram contents, counters and,
+ * optionally, the mixing buffers) and read it back from in the same order.
+ * The buffer is saved to a local file through a temporary file and a
+ * rename, so a job killed while writing never leaves a truncated
+ * checkpoint behind: the previous one stays valid.
+ *
+ * Histograms are stored by content (bin contents, sum of weight squares,
+ * number of entries and statistics) and restored into the histograms of
+ * the freshly configured analysis, which must therefore have the same
+ * names and binning as the ones that were saved. Correlation functions
+ * store their content themselves (StHbtCorrFctn::writeCheckpoint).
+ *
+ * Tracks of the mixing buffers are stored field by field with the track
+ * field list of StHbtBinaryEventFormat. The header keeps the number and
+ * the total size of the track fields, and a checkpoint written with a
+ * different list is rejected on load.
+ */
+
+#ifndef StHbtCheckpoint_h
+#define StHbtCheckpoint_h
+
+/// C++ headers
+#include <vector>
+#include <string>
+#include <cstring>
+
+/// Forward declarations
+class TH1;
+class TList;
+class StHbtTrack;
+
+//_________________
+class StHbtCheckpoint {
+
+ public:
+  /// Default constructor
+  StHbtCheckpoint();
+  /// Destructor
+  ~StHbtCheckpoint()                              { /* empty */ }
+
+  /// Start a new checkpoint (clears the buffer and writes the file header)
+  void beginWrite();
+  /// Save the buffer to the file (via fileName.tmp and rename)
+  bool save(const char* fileName) const;
+  /// Load the file and check the header. Returns false if the file does
+  /// not exist or is not a checkpoint
+  bool load(const char* fileName);
+
+  /// Store mixing buffers as well (read back from the file on load)
+  void setWithMixingBuffers(const bool& with)     { mWithMixingBuffers = with; }
+  bool withMixingBuffers() const                  { return mWithMixingBuffers; }
+
+  /// False after a read past the end or a mismatch
+  bool good() const                               { return mGood; }
+  /// Size of the checkpoint in bytes
+  unsigned long long size() const                 { return mBuffer.size(); }
+
+  /**
+   * Writing
+   **/
+  template <class T> void write(const T& value)   { writeBytes( &value, sizeof(T) ); }
+  void writeBytes(const void* data, const unsigned long long& bytes);
+  void writeString(const std::string& str);
+  /// Bin contents, sum of weight squares, entries and statistics
+  void writeHistogram(const TH1* hist);
+  /// All histograms of the list (other objects are ignored)
+  void writeHistograms(TList* list);
+  /// Stored fields of the track (hidden info is not stored)
+  void writeTrack(const StHbtTrack* track);
+
+  /**
+   * Reading (in the order of writing). Each method returns false and
+   * clears good() on a mismatch
+   **/
+  template <class T> bool read(T& value)          { return readBytes( &value, sizeof(T) ); }
+  bool readBytes(void* data, const unsigned long long& bytes);
+  bool readString(std::string& str);
+  /// Replace the content of hist with the stored one. The name and the
+  /// number of bins must match
+  bool readHistogram(TH1* hist);
+  bool readHistograms(TList* list);
+  /// New track with the stored fields
+  StHbtTrack* readTrack();
+
+ private:
+  /// Mark the checkpoint as bad and print the message
+  bool fail(const char* message);
+  /// Number and total size of the stored track fields
+  static void trackLayout(unsigned int& nFields, unsigned int& bytes);
+
+  /// Checkpoint data
+  std::vector<char> mBuffer;
+  /// Read position
+  unsigned long long mPos;
+  /// Mixing buffers are stored
+  bool mWithMixingBuffers;
+  /// No errors so far
+  bool mGood;
+};
+
+#endif // #define StHbtCheckpoint_h
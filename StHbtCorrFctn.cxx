@@ -7,6 +7,7 @@
  */
 
 #include "StHbtCorrFctn.h"
+#include "StHbtCheckpoint.h"
 
 //_________________
 StHbtCorrFctn::StHbtCorrFctn() :
@@ -60,3 +61,18 @@ void StHbtCorrFctn::addFirstParticle(StHbtParticle* /* part */, bool /* isMixing
 void StHbtCorrFctn::addSecondParticle(StHbtParticle* /* part */) {
   std::cout << "StHbtCorrFctn::addSecondParticle -- Not implemented" << std::endl;
 }
+
+//_________________
+void StHbtCorrFctn::writeCheckpoint(StHbtCheckpoint& checkpoint) {
+  TList *outputList = getOutputList();
+  checkpoint.writeHistograms( outputList );
+  delete outputList;
+}
+
+//_________________
+bool StHbtCorrFctn::readCheckpoint(StHbtCheckpoint& checkpoint) {
+  TList *outputList = getOutputList();
+  const bool isGood = checkpoint.readHistograms( outputList );
+  delete outputList;
+  return isGood;
+}
@@ -22,6 +22,9 @@
 /// ROOT headers
 #include "TList.h"
 
+/// Forward declarations
+class StHbtCheckpoint;
+
 //_________________
 class StHbtCorrFctn {
   
@@ -60,6 +63,35 @@ class StHbtCorrFctn {
   virtual StHbtCorrFctn* clone()                  { return nullptr; }
   virtual StHbtPairCut* getPairCut()              { return mPairCut; }
 
+  /**
+   * Sharding for parallel pair loops
+   *
+   * createShard() returns a private accumulator with the same binning and
+   * settings that a single worker thread fills through addRealPair(),
+   * addMixedPair() and eventBegin() without any locking. The pair cut is
+   * shared with the shard, so it must be safe to call from several
+   * threads. mergeShard() adds the content of the shard to this
+   * correlation function and resets the shard for reuse; it must not run
+   * concurrently with fills of the shard or of this function (e.g. call it
+   * at eventEnd or finish). The caller owns and deletes the shards.
+   * Correlation functions without sharding return nullptr and must be
+   * filled from one thread only.
+   **/
+  virtual StHbtCorrFctn* createShard()            { return nullptr; }
+  virtual void mergeShard(StHbtCorrFctn*)         { /* no-op */ }
+
+  /**
+   * Checkpointing
+   *
+   * writeCheckpoint() stores the accumulated content and readCheckpoint()
+   * replaces it with the stored one (false on a mismatch). The default
+   * stores the histograms of getOutputList(). Correlation functions that
+   * accumulate pairs outside of their output histograms store the
+   * accumulators, so a checkpoint does not create the output histograms.
+   **/
+  virtual void writeCheckpoint(StHbtCheckpoint& checkpoint);
+  virtual bool readCheckpoint(StHbtCheckpoint& checkpoint);
+
   // The following allows "back-pointing" from the CorrFctn to the "parent" Analysis
   friend class StHbtBaseAnalysis;
   StHbtBaseAnalysis* hbtAnalysis()                { return mBaseAnalysis; }
@@ -6,6 +6,7 @@
 /// StHbtMaker headers
 #include "StHbtCorrFctn3DLCMSSym.h"
 #include "StHbtPairCut.h"
+#include "StHbtCheckpoint.h"
 
 /// ROOT headers
 #include "TH3F.h"
@@ -24,58 +25,49 @@ StHbtCorrFctn3DLCMSSym::StHbtCorrFctn3DLCMSSym(const char* title,
   mDenominator(nullptr),
   mNumeratorW(nullptr),
   mDenominatorW(nullptr),
-  mUseLCMS(true) {
-  /// Default constructor
-  TString hist_title = TString::Format("%s; q_{out} (GeV/c); q_{side} (GeV/c); q_{long} (GeV/c)", title);
-  
-  /// set up numerator
-  mNumerator = new TH3F(TString("Num") + title,
-			hist_title,
-			nbins, -QHi, QHi,
-			nbins, -QHi, QHi,
-			nbins, -QHi, QHi);
-  /// set up denominator
-  mDenominator = new TH3F(TString("Den") + title,
-                          hist_title,
-                          nbins, -QHi, QHi,
-                          nbins, -QHi, QHi,
-                          nbins, -QHi, QHi);
-  
-  /// Weighted by qinv histos
-  /// set up numerator
-  mNumeratorW = new TH3F(TString("NumWqinv") + title,
-                         hist_title,
-                         nbins, -QHi, QHi,
-                         nbins, -QHi, QHi,
-                         nbins, -QHi, QHi);
-
-  /// Set up denominator
-  mDenominatorW = new TH3F(TString("DenWqinv") + title,
-                           hist_title,
-                           nbins, -QHi, QHi,
-                           nbins, -QHi, QHi,
-                           nbins, -QHi, QHi);
-  
-  /// Enable error bar calculation
-  mNumerator->Sumw2();
-  mDenominator->Sumw2();
-  mNumeratorW->Sumw2();
-  mDenominatorW->Sumw2();
+  mNumeratorFill(nullptr),
+  mDenominatorFill(nullptr),
+  mUseLCMS(true),
+  mTitle(title),
+  mNBins(nbins),
+  mQHi(QHi) {
+  /// Default constructor. The TH3F histograms are created when the
+  /// output is requested, pairs are accumulated in the meantime
+  /// Accumulators with the same binning
+  mNumeratorFill = new StHbtDenseHist3D( nbins, -QHi, QHi, nbins, -QHi, QHi, nbins, -QHi, QHi );
+  mDenominatorFill = new StHbtDenseHist3D( *mNumeratorFill );
+}
+
+//_________________
+StHbtCorrFctn3DLCMSSym::StHbtCorrFctn3DLCMSSym() :
+  StHbtCorrFctn(),
+  mNumerator(nullptr), mDenominator(nullptr),
+  mNumeratorW(nullptr), mDenominatorW(nullptr),
+  mNumeratorFill(nullptr), mDenominatorFill(nullptr),
+  mUseLCMS(true), mTitle(), mNBins(0), mQHi(0) {
+  /* empty */
 }
 
 //_________________
 StHbtCorrFctn3DLCMSSym::StHbtCorrFctn3DLCMSSym(const StHbtCorrFctn3DLCMSSym& aCorrFctn):
   StHbtCorrFctn(aCorrFctn),
-  mNumerator( new TH3F(*aCorrFctn.mNumerator) ),
-  mDenominator( new TH3F(*aCorrFctn.mDenominator) ),
-  mNumeratorW( new TH3F(*aCorrFctn.mNumeratorW) ),
-  mDenominatorW( new TH3F(*aCorrFctn.mDenominatorW) ),
-  mUseLCMS( aCorrFctn.mUseLCMS ) {
+  mNumerator(nullptr), mDenominator(nullptr),
+  mNumeratorW(nullptr), mDenominatorW(nullptr),
+  mNumeratorFill( new StHbtDenseHist3D(*aCorrFctn.mNumeratorFill) ),
+  mDenominatorFill( new StHbtDenseHist3D(*aCorrFctn.mDenominatorFill) ),
+  mUseLCMS( aCorrFctn.mUseLCMS ), mTitle( aCorrFctn.mTitle ),
+  mNBins( aCorrFctn.mNBins ), mQHi( aCorrFctn.mQHi ) {
   /// Copy constructor
-  mNumerator->Sumw2();
-  mDenominator->Sumw2();
-  mNumeratorW->Sumw2();
-  mDenominatorW->Sumw2();
+  if ( aCorrFctn.mNumerator ) {
+    mNumerator = new TH3F(*aCorrFctn.mNumerator);
+    mDenominator = new TH3F(*aCorrFctn.mDenominator);
+    mNumeratorW = new TH3F(*aCorrFctn.mNumeratorW);
+    mDenominatorW = new TH3F(*aCorrFctn.mDenominatorW);
+    mNumerator->Sumw2();
+    mDenominator->Sumw2();
+    mNumeratorW->Sumw2();
+    mDenominatorW->Sumw2();
+  }
 }
 
 //_________________
@@ -85,17 +77,31 @@ StHbtCorrFctn3DLCMSSym& StHbtCorrFctn3DLCMSSym::operator=(const StHbtCorrFctn3DL
 
     StHbtCorrFctn::operator=(aCorrFctn);
 
-    *mNumerator = *aCorrFctn.mNumerator;
-    *mDenominator = *aCorrFctn.mDenominator;
-    *mNumeratorW = *aCorrFctn.mNumeratorW;
-    *mDenominatorW = *aCorrFctn.mDenominatorW;
-    
     mUseLCMS = aCorrFctn.mUseLCMS;
+    mTitle = aCorrFctn.mTitle;
+    mNBins = aCorrFctn.mNBins;
+    mQHi = aCorrFctn.mQHi;
 
-    mNumerator->Sumw2();
-    mDenominator->Sumw2();
-    mNumeratorW->Sumw2();
-    mDenominatorW->Sumw2();
+    if ( aCorrFctn.mNumerator ) {
+      createHistograms();
+      *mNumerator = *aCorrFctn.mNumerator;
+      *mDenominator = *aCorrFctn.mDenominator;
+      *mNumeratorW = *aCorrFctn.mNumeratorW;
+      *mDenominatorW = *aCorrFctn.mDenominatorW;
+      mNumerator->Sumw2();
+      mDenominator->Sumw2();
+      mNumeratorW->Sumw2();
+      mDenominatorW->Sumw2();
+    }
+    else if ( mNumerator ) {
+      delete mNumerator;
+      delete mDenominator;
+      delete mNumeratorW;
+      delete mDenominatorW;
+      mNumerator = mDenominator = mNumeratorW = mDenominatorW = nullptr;
+    }
+    *mNumeratorFill = *aCorrFctn.mNumeratorFill;
+    *mDenominatorFill = *aCorrFctn.mDenominatorFill;
   }
 
   return *this;
@@ -108,15 +114,141 @@ StHbtCorrFctn3DLCMSSym::~StHbtCorrFctn3DLCMSSym() {
   delete mDenominator;
   delete mNumeratorW;
   delete mDenominatorW;
+  delete mNumeratorFill;
+  delete mDenominatorFill;
+}
+
+//_________________
+StHbtCorrFctn* StHbtCorrFctn3DLCMSSym::createShard() {
+  StHbtCorrFctn3DLCMSSym *shard = new StHbtCorrFctn3DLCMSSym();
+  shard->mBaseAnalysis = mBaseAnalysis;
+  shard->mPairCut = mPairCut;
+  shard->mUseLCMS = mUseLCMS;
+  shard->mNumeratorFill = mNumeratorFill->cloneEmpty();
+  shard->mDenominatorFill = mDenominatorFill->cloneEmpty();
+  return shard;
+}
+
+//_________________
+void StHbtCorrFctn3DLCMSSym::mergeShard(StHbtCorrFctn* shard) {
+  StHbtCorrFctn3DLCMSSym *cf = dynamic_cast<StHbtCorrFctn3DLCMSSym*>( shard );
+  if ( !cf || cf == this ) {
+    std::cout << "[WARNING] StHbtCorrFctn3DLCMSSym::mergeShard - not a shard of this function"
+	      << std::endl;
+    return;
+  }
+  mNumeratorFill->merge( *cf->mNumeratorFill );
+  mDenominatorFill->merge( *cf->mDenominatorFill );
+}
+
+//_________________
+void StHbtCorrFctn3DLCMSSym::writeCheckpoint(StHbtCheckpoint& checkpoint) {
+  checkpoint.write( (unsigned char)( mNumerator ? 1 : 0 ) );
+  if ( mNumerator ) {
+    checkpoint.writeHistogram( mNumerator );
+    checkpoint.writeHistogram( mDenominator );
+    checkpoint.writeHistogram( mNumeratorW );
+    checkpoint.writeHistogram( mDenominatorW );
+  }
+  mNumeratorFill->writeCheckpoint( checkpoint );
+  mDenominatorFill->writeCheckpoint( checkpoint );
+}
+
+//_________________
+bool StHbtCorrFctn3DLCMSSym::readCheckpoint(StHbtCheckpoint& checkpoint) {
+  unsigned char withHistograms = 0;
+  if ( !checkpoint.read( withHistograms ) ) return false;
+  if ( withHistograms ) {
+    createHistograms();
+    if ( !checkpoint.readHistogram( mNumerator ) ||
+	 !checkpoint.readHistogram( mDenominator ) ||
+	 !checkpoint.readHistogram( mNumeratorW ) ||
+	 !checkpoint.readHistogram( mDenominatorW ) ) return false;
+  }
+  else if ( mNumerator ) {
+    mNumerator->Reset();
+    mDenominator->Reset();
+    mNumeratorW->Reset();
+    mDenominatorW->Reset();
+  }
+  return ( mNumeratorFill->readCheckpoint( checkpoint ) &&
+	   mDenominatorFill->readCheckpoint( checkpoint ) );
+}
+
+//_________________
+void StHbtCorrFctn3DLCMSSym::setFineQRange(const float& qFine) {
+  mNumeratorFill->setFineRange( qFine );
+  mDenominatorFill->setFineRange( qFine );
+}
+
+//_________________
+TH3F* StHbtCorrFctn3DLCMSSym::makeHistogram(const char* prefix) const {
+
+  TString hist_title = TString::Format("%s; q_{out} (GeV/c); q_{side} (GeV/c); q_{long} (GeV/c)",
+				       mTitle.Data());
+  TH3F *hist = new TH3F(TString(prefix) + mTitle,
+			hist_title,
+			mNBins, -mQHi, mQHi,
+			mNBins, -mQHi, mQHi,
+			mNBins, -mQHi, mQHi);
+  /// Enable error bar calculation
+  hist->Sumw2();
+  return hist;
+}
+
+//_________________
+void StHbtCorrFctn3DLCMSSym::createHistograms() {
+
+  if ( mNumerator ) return;
+
+  /// set up numerator
+  mNumerator = makeHistogram("Num");
+  /// set up denominator
+  mDenominator = makeHistogram("Den");
+  
+  /// Weighted by qinv histos
+  mNumeratorW = makeHistogram("NumWqinv");
+  mDenominatorW = makeHistogram("DenWqinv");
+}
+
+//_________________
+void StHbtCorrFctn3DLCMSSym::flushHistograms() {
+  createHistograms();
+  mNumeratorFill->flush( mNumerator, mNumeratorW );
+  mDenominatorFill->flush( mDenominator, mDenominatorW );
 }
 
 //_________________
 void StHbtCorrFctn3DLCMSSym::writeOutHistos() {
   /// Write out all histograms to file
-  mNumerator->Write();
-  mDenominator->Write();
-  mNumeratorW->Write();
-  mDenominatorW->Write();
+  if ( mNumerator ) {
+    flushHistograms();
+    mNumerator->Write();
+    mDenominator->Write();
+    mNumeratorW->Write();
+    mDenominatorW->Write();
+  }
+  else {
+    /// Only one TH3F at a time is in memory
+    writeOutHistogram( "Num", mNumeratorFill, false );
+    writeOutHistogram( "Den", mDenominatorFill, false );
+    writeOutHistogram( "NumWqinv", mNumeratorFill, true );
+    writeOutHistogram( "DenWqinv", mDenominatorFill, true );
+  }
+}
+
+//_________________
+void StHbtCorrFctn3DLCMSSym::writeOutHistogram(const char* prefix, const StHbtDenseHist3D* fill,
+					       const bool& isWeight) const {
+  TH3F *hist = makeHistogram( prefix );
+  if ( isWeight ) {
+    fill->addTo( nullptr, hist );
+  }
+  else {
+    fill->addTo( hist );
+  }
+  hist->Write();
+  delete hist;
 }
 
 //_________________
@@ -124,6 +256,7 @@ TList* StHbtCorrFctn3DLCMSSym::getOutputList() {
   /// Prepare the list of objects to be written to the output
   TList *outputList = new TList();
 
+  flushHistograms();
   outputList->Add(mNumerator);
   outputList->Add(mDenominator);
   outputList->Add(mNumeratorW);
@@ -139,10 +272,16 @@ void StHbtCorrFctn3DLCMSSym::finish() {
 
 //_________________
 StHbtString StHbtCorrFctn3DLCMSSym::report() {
-  /// Construct the report
+  /// Construct the report (the histograms are not created for it)
+  double nNumerator = (double)mNumeratorFill->entries();
+  double nDenominator = (double)mDenominatorFill->entries();
+  if ( mNumerator ) {
+    nNumerator += mNumerator->GetEntries();
+    nDenominator += mDenominator->GetEntries();
+  }
   TString report = "LCMS Frame Bertsch-Pratt 3D Correlation Function Report:\n";
-  report += TString::Format("Number of entries in numerator:\t%E\n", mNumerator->GetEntries());
-  report += TString::Format("Number of entries in denominator:\t%E\n", mDenominator->GetEntries());
+  report += TString::Format("Number of entries in numerator:\t%E\n", nNumerator);
+  report += TString::Format("Number of entries in denominator:\t%E\n", nDenominator);
 
   if (mPairCut) {
     report += "Here is the PairCut specific to this CorrFctn\n";
@@ -162,15 +301,9 @@ void StHbtCorrFctn3DLCMSSym::addRealPair(const StHbtPair* pair) {
     return;
   }
 
-  if (mUseLCMS) {
-    
-    mNumerator->Fill( pair->qOutCMS(), pair->qSideCMS(), pair->qLongCMS(), 1.0);
-    mNumeratorW->Fill( pair->qOutCMS(), pair->qSideCMS(), pair->qLongCMS(), pair->qInv());
-  }
-  else {
-    mNumerator->Fill( pair->qOutPf(), pair->qSidePf(), pair->qLongPf(), 1.0);
-    mNumeratorW->Fill( pair->qOutPf(), pair->qSidePf(), pair->qLongPf(), pair->qInv());
-  }
+  double qOut, qSide, qLong;
+  qComponents( pair, qOut, qSide, qLong );
+  mNumeratorFill->fillCountAndWeight( qOut, qSide, qLong, pair->qInv() );
 }
 
 //____________________________
@@ -181,12 +314,22 @@ void StHbtCorrFctn3DLCMSSym::addMixedPair(const StHbtPair* pair) {
     return;
   }
 
+  double qOut, qSide, qLong;
+  qComponents( pair, qOut, qSide, qLong );
+  mDenominatorFill->fillCountAndWeight( qOut, qSide, qLong, pair->qInv() );
+}
+
+//_________________
+void StHbtCorrFctn3DLCMSSym::qComponents(const StHbtPair* pair, double& qOut,
+					 double& qSide, double& qLong) const {
   if (mUseLCMS) {
-    mDenominator->Fill( pair->qOutCMS(), pair->qSideCMS(), pair->qLongCMS(), 1.0 );
-    mDenominatorW->Fill( pair->qOutCMS(), pair->qSideCMS(), pair->qLongCMS(), pair->qInv());
+    qOut = pair->qOutCMS();
+    qSide = pair->qSideCMS();
+    qLong = pair->qLongCMS();
   }
   else {
-    mDenominator->Fill( pair->qOutPf(), pair->qSidePf(), pair->qLongPf(), 1.0 );
-    mDenominatorW->Fill( pair->qOutPf(), pair->qSidePf(), pair->qLongPf(), pair->qInv());
+    qOut = pair->qOutPf();
+    qSide = pair->qSidePf();
+    qLong = pair->qLongPf();
   }
 }
@@ -1,6 +1,19 @@
 /**
  * Description: 3D correlation function of identical particles
  * in Bertsch-Pratt coordinate system
+ *
+ * Pairs are accumulated in dense histograms (StHbtDenseHist3D) and
+ * transferred to the TH3F histograms when these are requested (the
+ * getters and getOutputList()). The TH3F histograms are only created at
+ * that point, so during the event loop the memory is used only by the
+ * blocks of the accumulators that hold pairs, and the blocks are released
+ * once their content is transferred. writeOutHistos() without the TH3F
+ * histograms builds, writes and deletes them one at a time and keeps the
+ * accumulated pairs.
+ *
+ * setFineQRange() keeps the exact binning only for |q| components below
+ * the given value, and accumulates the pairs further out in groups of
+ * 4x4x4 bins (see StHbtDenseHist3D::setFineRange).
  */
 
 #ifndef StHbtCorrFctn3DLCMSSym_h
@@ -12,6 +25,10 @@ class StHbtPairCut;
 
 /// Include headers
 #include "StHbtCorrFctn.h"
+#include "StHbtDenseHist3D.h"
+
+/// ROOT headers
+#include "TString.h"
 
 //_________________
 class StHbtCorrFctn3DLCMSSym : public StHbtCorrFctn {
@@ -41,22 +58,50 @@ class StHbtCorrFctn3DLCMSSym : public StHbtCorrFctn {
   virtual void finish();
 
   /// Return numerator
-  TH3F* numerator()                    { return mNumerator; }
+  TH3F* numerator()                    { flushHistograms(); return mNumerator; }
   /// Return denominator
-  TH3F* denominator()                  { return mDenominator; }
+  TH3F* denominator()                  { flushHistograms(); return mDenominator; }
   /// Return numerator weighed by qinv
-  TH3F* numeratorW()                   { return mNumeratorW; }
+  TH3F* numeratorW()                   { flushHistograms(); return mNumeratorW; }
   /// Return denominator weighed by qinv
-  TH3F* denominatorW()                 { return mDenominatorW; }
+  TH3F* denominatorW()                 { flushHistograms(); return mDenominatorW; }
 
   void writeOutHistos();
   virtual TList* getOutputList();
 
   void setUseLCMS(bool useLCMS)        { mUseLCMS = useLCMS; }
   int  getUseLCMS()                    { return mUseLCMS; }
+  /// Exact bins only for |qOut|, |qSide|, |qLong| below qFine (<= 0 - all
+  /// bins, default). Must be set before the first pair
+  void setFineQRange(const float& qFine);
   virtual StHbtCorrFctn* clone() const { return new StHbtCorrFctn3DLCMSSym( *this ); }
 
+  /// Shard with empty accumulators only (no TH3F histograms)
+  virtual StHbtCorrFctn* createShard();
+  /// Add the pairs of the shard and reset it
+  virtual void mergeShard(StHbtCorrFctn* shard);
+
+  /// Checkpoint of the accumulators (and of the TH3F histograms if they
+  /// were already created)
+  virtual void writeCheckpoint(StHbtCheckpoint& checkpoint);
+  virtual bool readCheckpoint(StHbtCheckpoint& checkpoint);
+
  private:
+
+  /// Empty correlation function used for shards
+  StHbtCorrFctn3DLCMSSym();
+
+  /// New TH3F histogram with the binning of the function
+  TH3F* makeHistogram(const char* prefix) const;
+  /// Create the TH3F histograms (if not yet created)
+  void createHistograms();
+  /// Build the histogram from the accumulator, write and delete it
+  void writeOutHistogram(const char* prefix, const StHbtDenseHist3D* fill,
+			 const bool& isWeight) const;
+  /// Transfer the accumulated pairs to the TH3F histograms
+  void flushHistograms();
+  /// q components of the pair in LCMS or PRF
+  void qComponents(const StHbtPair* pair, double& qOut, double& qSide, double& qLong) const;
   
   /// Numerator
   TH3F* mNumerator;
@@ -67,11 +112,21 @@ class StHbtCorrFctn3DLCMSSym : public StHbtCorrFctn {
   /// Qinv-weighted denominator
   TH3F* mDenominatorW;
 
+  /// Accumulators of the histograms above: counts and qinv weights of
+  /// the numerator (denominator) are filled with one bin lookup
+  StHbtDenseHist3D* mNumeratorFill;    //!
+  StHbtDenseHist3D* mDenominatorFill;  //!
+
   /// False - use PRF, True - use LCMS
   bool mUseLCMS;
 
+  /// Title and binning of the histograms
+  TString mTitle;
+  int mNBins;
+  float mQHi;
+
 #ifdef __ROOT__
-  ClassDef(StHbtCorrFctn3DLCMSSym, 1);
+  ClassDef(StHbtCorrFctn3DLCMSSym, 2);
 #endif
 };
 
@@ -11,10 +11,12 @@
 #include "PhysicalConstants.h"
 
 /// C++ headers
-#include <cstdio>
-#include <cassert>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <cmath>
 
 /// ROOT headers
 #include "TMath.h"
@@ -24,13 +26,11 @@ ClassImp(StHbtCoulomb)
 #endif
 
 //_________________
-StHbtCoulomb::StHbtCoulomb() : mFile(""), mRadius(-1.), mZ1Z2(1.), mEta{}, mCoulomb{}, mNLines(0) {
+StHbtCoulomb::StHbtCoulomb() : mFile(""), mRadius(-1.), mZ1Z2(1.), mCacheFile(), mTable(),
+  mRadiusIndex(-1), mRadiusFraction(0),
+  mNOutOfRange(0), mNWrongSign(0), mNNoTable(0) {
   
   mFile = "/afs/rhic.bnl.gov/star/hbt/coul/StHbtCorrectionFiles/correctionpp.dat";
-  if (!mFile) {
-    std::cout << " No file, dummy!" << std::endl;
-    assert(0);
-  }
   std::cout << "StHbtCoulomb::StHbtCoulomb() - You have 1 default Coulomb correction!" << std::endl;
 }
 
@@ -39,7 +39,9 @@ StHbtCoulomb::StHbtCoulomb(const char* readFile, const double& radius, const dou
   mFile( readFile ),
   mRadius( radius ),
   mZ1Z2( charge ),
-  mNLines( 0 ) {
+  mCacheFile(), mTable(),
+  mRadiusIndex( -1 ), mRadiusFraction( 0 ),
+  mNOutOfRange( 0 ), mNWrongSign( 0 ), mNNoTable( 0 ) {
 
   /// Constructor with parameters
   createLookupTable( mRadius );
@@ -51,10 +53,11 @@ StHbtCoulomb::StHbtCoulomb(const StHbtCoulomb& copy) :
   mFile( copy.mFile ),
   mRadius( copy.mRadius ),
   mZ1Z2( copy.mZ1Z2 ),
-  mNLines( 0 ) {
+  mCacheFile( copy.mCacheFile ), mTable( copy.mTable ),
+  mRadiusIndex( copy.mRadiusIndex ), mRadiusFraction( copy.mRadiusFraction ),
+  mNOutOfRange( 0 ), mNWrongSign( 0 ), mNNoTable( 0 ) {
 
-  /// Copy constructor
-  createLookupTable( mRadius );
+  /// Copy constructor: the table is shared
 }
 
 //_________________
@@ -64,8 +67,10 @@ StHbtCoulomb& StHbtCoulomb::operator=(const StHbtCoulomb& copy) {
     mFile = copy.mFile;
     mRadius = copy.mRadius;
     mZ1Z2 = copy.mZ1Z2;
-
-    createLookupTable( mRadius );
+    mCacheFile = copy.mCacheFile;
+    mTable = copy.mTable;
+    mRadiusIndex = copy.mRadiusIndex;
+    mRadiusFraction = copy.mRadiusFraction;
   }
 
   return *this;
@@ -88,12 +93,22 @@ void StHbtCoulomb::setRadius(const double& radius) {
 void StHbtCoulomb::setFile(const char* readFile) {
   std::cout << " StHbtCoulomb::setFile() " << std::endl;
   mFile = readFile;
+  mTable.reset();
   /// Create new lookup table since file has changed
   if ( mRadius>0.0 ) {
     createLookupTable( mRadius );
   }
 }
 
+//_________________
+void StHbtCoulomb::setCacheFile(const char* cacheFile) {
+  mCacheFile = ( cacheFile ) ? cacheFile : "";
+  mTable.reset();
+  if ( mRadius>0.0 ) {
+    createLookupTable( mRadius );
+  }
+}
+
 //_________________
 void StHbtCoulomb::setChargeProduct(const double& charge) {
   std::cout << " StHbtCoulomb::setChargeProduct() " << std::endl;
@@ -105,287 +120,190 @@ void StHbtCoulomb::setChargeProduct(const double& charge) {
     else {
       mFile = "/afs/rhic.bnl.gov/star/hbt/coul/StHbtCorrectionFiles/correctionpm.dat";
     }
+    mTable.reset();
     createLookupTable(mRadius);
   }
 }
 
+//_________________
+void StHbtCoulomb::resetCounters() {
+  mNOutOfRange = 0;
+  mNWrongSign = 0;
+  mNNoTable = 0;
+}
+
 //_________________
 void StHbtCoulomb::createLookupTable(const double& radius) {
-  /// Read radii from mFile
-  /// Create array(pair) of linear interpolation between radii
-  std::cout << " StHbtCoulomb::createLookupTable() " << std::endl;
+  /// The file is read only once, afterwards only the radius interval
+  /// for the interpolation between radii is looked up
+  mRadiusIndex = -1;
+  mRadiusFraction = 0;
 
   if (radius<0.0) {
-    std::cout << " StHbtCoulomb::createLookupTable -> NEGATIVE RADIUS " << std::endl;
+    std::cout << "[ERROR] StHbtCoulomb::createLookupTable -> NEGATIVE RADIUS " << std::endl;
     std::cout << "  call StHbtCoulomb::setRadius(r) with positive r " << std::endl;
-    std::cerr << " StHbtCoulomb::createLookupTable -> NEGATIVE RADIUS " << std::endl;
-    std::cerr << "  call StHbtCoulomb::setRadius(r) with positive r " << std::endl;
-    assert(0);
-  }
-  
-  std::ifstream mystream(mFile);
-  if ( !mystream ) {
-    std::cout << "Could not open file" << std::endl;
-    assert(0);
-  }
-  else {
-    std::cout << "Input correction file opened" << std::endl;
+    return;
   }
 
-  static char tempstring[2001];
-  static float radii[2000];
-  static int NRadii = 0;
-  NRadii = 0;
-  
-  if (!mystream.getline(tempstring,2000)) {
-    std::cout << "Could not read radii from file" << std::endl;
-    assert(0);
-  }
-  
-  for (unsigned int ii=0; ii<strlen(tempstring); ii++) {
-    while (tempstring[ii]==' ') ii++;
-    sscanf(&tempstring[ii++],"%f",&radii[++NRadii]);
-    while ( tempstring[ii]!=' ' && (ii)<strlen(tempstring) )ii++;
-  }
-  
-  std::cout << " Read " << NRadii << " radii from file" << std::endl;
-
-  static double LowRadius = -1.0;
-  static double HighRadius = -1.0;
-  static int LowIndex = 0;
-  LowRadius = -1.0;
-  HighRadius = -1.0;
-  LowIndex = 0;
-  for(int iii=1; iii<=NRadii-1; iii++) { // Loop to one less than #radii
-    if ( radius >= radii[iii] && radius <= radii[iii+1] ) {
-      LowRadius = radii[iii];
-      HighRadius = radii[iii+1];
-      LowIndex = iii;
+  if ( !mTable ) {
+    mTable = StHbtCoulombTable::table( mFile, mCacheFile );
+    if ( !mTable ) {
+      std::cout << "[ERROR] StHbtCoulomb::createLookupTable - no correction table from "
+		<< mFile << std::endl;
+      return;
     }
   }
-  if ( (LowRadius < 0.0) || (HighRadius < 0.0) ) {
-    std::cout << "StHbtCoulomb::createLookupTable --> Problem interpolating radius" << std::endl;
-    std::cout << "  Check range of radii in lookup file...." << std::endl;
-    std::cerr << "StHbtCoulomb::createLookupTable --> Problem interpolating radius" << std::endl;
-    std::cerr << "  Check range of radii in lookup file...." << std::endl;
-    assert(0);
-  }
 
-  static double corr[100];           // array of corrections ... must be > NRadii
-  mNLines = 0;
-  static double tempEta = 0;
-  tempEta = 0;
-  while (mystream >> tempEta) {
-    for (int i=1; i<=NRadii; i++) {
-      mystream >> corr[i];
-    }
-    static double LowCoulomb = 0;
-    static double HighCoulomb = 0;
-    static double nCorr = 0;
-    LowCoulomb = corr[LowIndex];
-    HighCoulomb = corr[LowIndex+1];
-    nCorr = ( (radius-LowRadius)*HighCoulomb+(HighRadius-radius)*LowCoulomb )/(HighRadius-LowRadius);
-      mEta[mNLines] = tempEta;     // Eta
-      mCoulomb[mNLines] = nCorr;   // Interpolated Coulomb correction for radius
-      mNLines++;
+  if ( !mTable->radiusBracket( radius, mRadiusIndex, mRadiusFraction ) ) {
+    std::cout << "[ERROR] StHbtCoulomb::createLookupTable --> Problem interpolating radius" << std::endl;
+    std::cout << "  Check range of radii in lookup file...." << std::endl;
+    mRadiusIndex = -1;
   }
-  mystream.close();
-  std::cout << "Lookup Table is created with " << mNLines << " points" << std::endl;
 }
 
 //_________________
-double StHbtCoulomb::coulombCorrect(const double& eta) {
-  /// Interpolates in eta
-  if (mRadius < 0.0) {
-    std::cout << "StHbtCoulomb::coulombCorrect(eta) --> Trying to correct for negative radius!" << std::endl;
-    std::cerr << "StHbtCoulomb::coulombCorrect(eta) --> Trying to correct for negative radius!" << std::endl;
-    assert(0);
+double StHbtCoulomb::correct(const double& eta, const int& index,
+			     const double& fraction) const {
+  if ( index < 0 ) {
+    mNNoTable++;
+    return 1.;
   }
-  static int middle=0;
-  middle=int( (mNLines-1)/2 );
-  if (eta*mEta[middle]<0.0) {
-    std::cout << "StHbtCoulomb::coulombCorrect(eta) --> eta: " << eta
-	      << " has wrong sign for data file! " << std::endl;
-    std::cerr << "StHbtCoulomb::coulombCorrect(eta) --> eta: " << eta
-	      << " has wrong sign for data file! " << std::endl;
-    assert(0);
+  if ( eta * mTable->etaSign() < 0. ) {
+    mNWrongSign++;
+    return 1.;
   }
-
-  static double Corr = 0;
-  Corr = -1.0;
-  
-  if ( (eta>mEta[0]) && (mEta[0]>0.0) ) {
-    Corr = mCoulomb[0];
-    return (Corr);
+  /// NaN is clamped as well
+  if ( !( eta >= mTable->etaLow() ) ) {
+    mNOutOfRange++;
+    return mTable->value( mTable->etaLow(), index, fraction );
   }
-  if ( (eta<mEta[mNLines-1]) && (mEta[mNLines-1]<0.0) ) {
-    Corr = mCoulomb[mNLines-1];
-    return (Corr);
+  if ( eta > mTable->etaHigh() ) {
+    mNOutOfRange++;
+    return mTable->value( mTable->etaHigh(), index, fraction );
   }
-  // This is a binary search for the bracketing pair of data points
-  static int high = 0;
-  static int low = 0;
-  static int width = 0;
-  high = mNLines-1;
-  low = 0;
-  width = high-low;
-  middle = int(width/2.0); // Was instantiated above
-  while (middle > 0) {
-    if (mEta[low+middle] < eta) {
-      // eta is in the 1st half
-      high-=middle;
-      width = high-low;
-      middle = int(width/2.0);
-    }
-    else {
-      // eta is in the 2nd half
-      low+=middle;
-      width = high-low;
-      middle = int(width/2.0);
-    }
+  return mTable->value( eta, index, fraction );
+}
+
+//_________________
+double StHbtCoulomb::coulombCorrect(const double& eta) const {
+  /// Interpolates in eta
+  return correct( eta, mRadiusIndex, mRadiusFraction );
+}
+
+//_________________
+void StHbtCoulomb::coulombCorrect(const double* eta, double* correction,
+				  const unsigned int& n) const {
+  if ( mRadiusIndex < 0 ) {
+    std::fill( correction, correction + n, 1. );
+    mNNoTable += n;
+    return;
   }
-  // Make sure we found the right one
-  if ( (mEta[low] >= eta) && (eta >= mEta[low+1]) ) {
-    static double LowEta = 0;
-    static double HighEta = 0;    
-    static double LowCoulomb = 0;
-    static double HighCoulomb = 0;
-    LowEta = mEta[low];
-    HighEta = mEta[low+1];    
-    LowCoulomb = mCoulomb[low];
-    HighCoulomb = mCoulomb[low+1];
-    //      cout << LowEta << " *** Eta *** " << HighEta << endl;
-    //      cout << LowCoulomb << " *** Coulomb *** " << HighCoulomb << endl;
-    Corr = ( (eta-LowEta)*HighCoulomb+(HighEta-eta)*LowCoulomb )/(HighEta-LowEta);
+
+  const double etaSign = mTable->etaSign();
+  const double etaLow = mTable->etaLow();
+  const double etaHigh = mTable->etaHigh();
+  unsigned long long nOutOfRange = 0;
+  unsigned long long nWrongSign = 0;
+  for ( unsigned int i=0; i<n; i++ ) {
+    const bool wrongSign = ( eta[i] * etaSign < 0. );
+    double clamped = ( eta[i] >= etaLow ) ? eta[i] : etaLow;
+    clamped = ( clamped <= etaHigh ) ? clamped : etaHigh;
+    nWrongSign += wrongSign;
+    nOutOfRange += ( !wrongSign && clamped != eta[i] );
+    correction[i] = wrongSign ? 1. : mTable->value( clamped, mRadiusIndex, mRadiusFraction );
   }
-  if (Corr<0.0) {
-    std::cout << "StHbtCoulomb::coulombCorrect(eta) --> No correction" << std::endl;
-    std::cout << "  Check range of eta in file: Input eta  " << eta << std::endl;
-    std::cerr << "StHbtCoulomb::coulombCorrect(eta) --> No correction" << std::endl;
-    std::cerr << "  Check range of eta in file: Input eta  " << eta << std::endl;
-    assert(0);
-  } 
-  return (Corr);
+  mNOutOfRange += nOutOfRange;
+  mNWrongSign += nWrongSign;
 }
 
 //_________________
 double StHbtCoulomb::coulombCorrect(const double& eta,
-				    const double& radius) {
-  /// Checks radii ... input radius and mRadius
-  /// Calls createLookupTable if neccessary
-  /// Interpolate(linear) between etas in the created lookup table
-
-  if (radius < 0.0) {
-    if (mRadius < 0.0) {
-      // Both radii are negative
-      std::cout << "StHbtCoulomb::coulombCorrect(eta,r) --> input and member radii are negative!" << std::endl;
-      std::cerr << "StHbtCoulomb::coulombCorrect(eta,r) --> input and member radii are negative!" << std::endl;
-      assert(0);
-    }
+				    const double& radius) const {
+  /// Bilinear interpolation in eta and radius. A negative radius means
+  /// the radius of the object. The object is not changed
+
+  if ( radius < 0.0 || radius == mRadius ) {
+    return coulombCorrect( eta );
   }
-  else {
-    // radius > 0.0
-    if (radius == mRadius) {
-      // Both radii are positive and equal
-      //      cout << "Radii are the same!!!" << endl;
-    }
-    else {
-      // Both radii are positive but not equal
-      mRadius = radius;
-      createLookupTable(mRadius);
-    }
+
+  int index = -1;
+  double fraction = 0;
+  if ( mTable && !mTable->radiusBracket( radius, index, fraction ) ) {
+    index = -1;
   }
+  return correct( eta, index, fraction );
+}
 
-  // Interpolate in eta
-  return ( coulombCorrect(eta) );
+//_________________
+inline double StHbtCoulomb::eta(const double& px1, const double& py1, const double& pz1,
+				const double& e1, const double& px2, const double& py2,
+				const double& pz2, const double& e2) const {
+  /// The velocities in the pair rest frame are v1* = k*/E1* and
+  /// v2* = -k*/E2* with Ei* = (P.pi)/M, so the velocity difference is
+  /// dv = k* M^3 / ( (P.p1) (P.p2) ). k* is half of the length of the
+  /// relative four-momentum q taken orthogonal to P:
+  /// 4 k*^2 = (P.q)^2 / M^2 - q^2, where P.q = P.p1 - P.p2
+  const double pX = px1 + px2;
+  const double pY = py1 + py2;
+  const double pZ = pz1 + pz2;
+  const double pE = e1 + e2;
+  const double mInvSqr = pE * pE - pX * pX - pY * pY - pZ * pZ;
+  const double pp1 = pE * e1 - pX * px1 - pY * py1 - pZ * pz1;
+  const double pp2 = pE * e2 - pX * px2 - pY * py2 - pZ * pz2;
+  const double qX = px1 - px2;
+  const double qY = py1 - py2;
+  const double qZ = pz1 - pz2;
+  const double qE = e1 - e2;
+  const double qSqr = qE * qE - qX * qX - qY * qY - qZ * qZ;
+  const double pq = pp1 - pp2;
+  /// Rounding may give a slightly negative k*^2 for k* = 0: then eta is
+  /// infinite (clamped to the table), as the rotation code gave it
+  const double kStarSqr4 = std::max( pq * pq / mInvSqr - qSqr, 0. );
+  const double dv = 0.5 * std::sqrt( kStarSqr4 ) * mInvSqr * std::sqrt( mInvSqr ) / ( pp1 * pp2 );
+
+  return ( mZ1Z2 * fine_structure_const / dv );
 }
 
 //_________________
-double StHbtCoulomb::eta(const StHbtPair* pair) {
-  static double px1,py1,pz1,px2,py2,pz2;
-  static double px1new,py1new,pz1new;
-  static double px2new,py2new,pz2new;
-  static double vx1cms,vy1cms,vz1cms;
-  static double vx2cms,vy2cms,vz2cms;
-  static double VcmsX,VcmsY,VcmsZ;
-  static double dv = 0.0;
-  static double e1,e2,e1new,e2new;
-  static double psi,theta;
-  static double beta,gamma;
-  static double VcmsXnew;
-
-  px1 = pair->track1()->px();
-  py1 = pair->track1()->py();
-  pz1 = pair->track1()->pz();
-  e1 = pair->track1()->e();
-  px2 = pair->track2()->px();
-  py2 = pair->track2()->py();
-  pz2 = pair->track2()->pz();
-  e2 = pair->track2()->e();
-  
-  VcmsX = ( px1+px2 ) / ( e1+e2 );
-  VcmsY = ( py1+py2 ) / ( e1+e2 );
-  VcmsZ = ( pz1+pz2 ) / ( e1+e2 );
-  /// Rotate Vcms to x-direction
-  psi = TMath::ATan( VcmsY / VcmsX );
-  VcmsXnew = VcmsX * TMath::Cos(psi) + VcmsY * TMath::Sin( psi );
-  VcmsX = VcmsXnew;
-  theta = TMath::ATan( VcmsZ / VcmsX );
-  VcmsXnew = VcmsX * TMath::Cos( theta) + VcmsZ * TMath::Sin( theta );
-  VcmsX = VcmsXnew;
-  /// Gamma and Beta
-  beta = VcmsX;
-  gamma = 1. / TMath::Sqrt( 1.0 - beta * beta );
-
-  /// Rotate p1 and p2 to new frame
-  px1new = px1 * TMath::Cos( psi ) + py1 * TMath::Sin( psi );
-  py1new = -px1 * TMath::Sin( psi ) + py1 * TMath::Cos( psi );
-  px1 = px1new;
-  px1new = px1 * TMath::Cos( theta ) + pz1 * TMath::Sin( theta );
-  pz1new = -px1 * TMath::Sin( theta ) + pz1 * TMath::Cos( theta );
-  px1 = px1new;
-  py1 = py1new;
-  pz1 = pz1new;
-
-  px2new = px2 * TMath::Cos( psi ) + py2 * TMath::Sin( psi );
-  py2new = -px2 * TMath::Sin( psi ) + py2 * TMath::Cos( psi );
-  px2 = px2new;
-  px2new = px2 * TMath::Cos( theta ) + pz2 * TMath::Sin( theta );
-  pz2new = -px2 * TMath::Sin( theta ) + pz2 * TMath::Cos( theta );
-  px2 = px2new;
-  py2 = py2new;
-  pz2 = pz2new;
-
-  /// Lorentz transform the x component and energy
-  e1new = gamma * e1 - gamma * beta * px1;
-  px1new = -gamma * beta * e1 + gamma * px1;
-  e2new = gamma * e2 - gamma * beta * px2;
-  px2new = -gamma * beta * e2 + gamma * px2;
-  px1 = px1new;
-  px2 = px2new;
-
-  /// New velocities
-  vx1cms = px1 / e1new;
-  vy1cms = py1 / e1new;
-  vz1cms = pz1 / e1new;
-  vx2cms = px2 / e2new;
-  vy2cms = py2 / e2new;
-  vz2cms = pz2 / e2new;
-
-  /// Velocity difference in CMS frame
-  dv = TMath::Sqrt( ( vx1cms - vx2cms ) * ( vx1cms - vx2cms ) +
-		    ( vy1cms - vy2cms ) * ( vy1cms - vy2cms ) +
-		    ( vz1cms - vz2cms ) * ( vz1cms - vz2cms ) );
-
-  return ( mZ1Z2 * fine_structure_const / (dv) );
+double StHbtCoulomb::eta(const StHbtPair* pair) const {
+  const TLorentzVector p1 = pair->track1()->fourMomentum();
+  const TLorentzVector p2 = pair->track2()->fourMomentum();
+  return eta( p1.Px(), p1.Py(), p1.Pz(), p1.E(), p2.Px(), p2.Py(), p2.Pz(), p2.E() );
+}
+
+//_________________
+void StHbtCoulomb::coulombCorrect(const StHbtPair* const* pairs, double* correction,
+				  const unsigned int& n) const {
+  /// Eta of all pairs first, then the table lookups in place
+  for ( unsigned int i=0; i<n; i++ ) {
+    correction[i] = eta( pairs[i] );
+  }
+  coulombCorrect( correction, correction, n );
+}
+
+//_________________
+void StHbtCoulomb::coulombCorrect(const double* kStar, const double* mInv,
+				  const double& mass1, const double& mass2,
+				  double* correction, const unsigned int& n) const {
+  /// With Ei* = (M^2 + mi^2 - mj^2) / 2M the velocity difference in the
+  /// pair rest frame is dv = 4 k* M^3 / ( (M^2 + m1^2 - m2^2) (M^2 + m2^2 - m1^2) )
+  const double massDiffSqr = mass1 * mass1 - mass2 * mass2;
+  const double etaScale = 0.25 * mZ1Z2 * fine_structure_const;
+  for ( unsigned int i=0; i<n; i++ ) {
+    const double mInvSqr = mInv[i] * mInv[i];
+    correction[i] = etaScale * ( mInvSqr + massDiffSqr ) * ( mInvSqr - massDiffSqr ) /
+      ( kStar[i] * mInvSqr * mInv[i] );
+  }
+  coulombCorrect( correction, correction, n );
 }
 
 //_________________
 TH1D* StHbtCoulomb::correctionHistogram(const double& mass1, const double& mass2, const int& nBins, 
 					const double& low, const double& high) {
   if ( mass1!=mass2 ) {
-    std::cout << "Masses not equal ... try again.  No histogram created." << std::endl;
-    assert(0);
+    std::cout << "[ERROR] StHbtCoulomb::correctionHistogram - masses not equal ... try again. "
+	      << "No histogram created." << std::endl;
+    return nullptr;
   }
   TH1D* correction = new TH1D("correction", "Coulomb correction", nBins, low, high);
   const double reducedMass = mass1 * mass2 / ( mass1 + mass2 );
@@ -395,7 +313,6 @@ TH1D* StHbtCoulomb::correctionHistogram(const double& mass1, const double& mass2
   for (int ii=1; ii<=nBins; ii++) {
     qInv = correction->GetBinCenter(ii);
     eta = 2.0 * mZ1Z2 * reducedMass * fine_structure_const / ( qInv );
-    coulombCorrect( eta );
     correction->Fill( qInv, coulombCorrect( eta, mRadius ) );
   }
 
@@ -455,5 +372,6 @@ double StHbtCoulomb::coulombCorrect( const double& mass,   const double& charge,
   mZ1Z2 = charge;
   const double reducedMass = 0.5 * mass; // must be same mass particles
   double eta = 2.0 * mZ1Z2 * reducedMass * fine_structure_const / ( qInv );
-  return coulombCorrect( eta, mRadius );
+  createLookupTable( mRadius );
+  return coulombCorrect( eta );
 }
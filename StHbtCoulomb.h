@@ -4,13 +4,35 @@
  *  1. Reads in the dat from a file
  *  2. Performs a linear interpolation in R and creates any array of interpolations
  *  3. Interpolates in eta and returns the Coulomb correction to user
+ *
+ * The file is read once into a table of all radii (StHbtCoulombTable),
+ * shared by all objects that use the same file, and the correction is a
+ * bilinear interpolation in eta and radius between the points of the
+ * file, as the original lookup table gave it. Changing
+ * the radius does not read the file again, and lookups for other radii
+ * than the current one do not change the object. Lookups may be done
+ * from several threads. An optional binary cache (setCacheFile) avoids
+ * parsing the ASCII file at startup.
+ * Eta of a pair is found from the relative velocity in the pair rest
+ * frame, which is written in terms of Lorentz invariants of the two
+ * four-momenta, so no rotation or boost is needed. The batch methods
+ * return the weights of many pairs at once.
+ * Eta outside of the table is clamped to the nearest table entry, eta
+ * of the wrong sign and lookups without a table return 1 (no
+ * correction); both are counted instead of stopping the job.
  */
 
 #ifndef StHbtCoulomb_HH
 #define StHbtCoulomb_HH
 
+/// C++ headers
+#include <atomic>
+#include <memory>
+#include <string>
+
 /// StHbtMaker headers
 #include "StHbtPair.h"
+#include "StHbtCoulombTable.h"
 
 /// ROOT headers
 #include "TH1D.h"
@@ -35,15 +57,27 @@ class StHbtCoulomb {
   void setRadius(const double& radius);
   void setFile(const char *readFile);
   void setChargeProduct(const double& charge);
+  /// Binary cache of the correction table (empty - no cache)
+  void setCacheFile(const char *cacheFile);
 
   /// Getters
   double radius()    { return mRadius; }
   /// These have different names so eta/Qinv don't confuse the compiler
-  double coulombCorrect(const double& eta);
-  double coulombCorrect(const double& eta, const double& radius);
-  double coulombCorrect(const StHbtPair* pair)
+  double coulombCorrect(const double& eta) const;
+  double coulombCorrect(const double& eta, const double& radius) const;
+  double coulombCorrect(const StHbtPair* pair) const
   { return coulombCorrect( eta( pair ) ); }
-  double coulombCorrect(const StHbtPair* pair, const double& radius)
+  /// Corrections for n values of eta (eta and correction may be the same array)
+  void coulombCorrect(const double* eta, double* correction, const unsigned int& n) const;
+  /// Corrections for n pairs
+  void coulombCorrect(const StHbtPair* const* pairs, double* correction,
+		      const unsigned int& n) const;
+  /// Corrections for n pairs of particles with masses mass1 and mass2
+  /// from the relative momentum k* and the invariant mass of each pair
+  void coulombCorrect(const double* kStar, const double* mInv,
+		      const double& mass1, const double& mass2,
+		      double* correction, const unsigned int& n) const;
+  double coulombCorrect(const StHbtPair* pair, const double& radius) const
   { return coulombCorrect( eta(pair), radius ); }
   double coulombCorrect(const double& mass,
 			const double& charge,
@@ -58,24 +92,43 @@ class StHbtCoulomb {
   TH1D* correctionHistogram(const TH1D*, const double);
   TH3D* correctionHistogram(const TH3D*, const double);
 #endif
+
+  /// Number of lookups with eta outside of the table (clamped), with eta
+  /// of the wrong sign and without a valid table or with the radius
+  /// outside of the table (both not corrected)
+  unsigned long long numberOfOutOfRange() const   { return mNOutOfRange; }
+  unsigned long long numberOfWrongSign() const    { return mNWrongSign; }
+  unsigned long long numberOfNoTable() const      { return mNNoTable; }
+  void resetCounters();
   
  private:
   /// Calculates eta
-  double eta(const StHbtPair* pair);
-  /// Creates look-up table
+  double eta(const StHbtPair* pair) const;
+  /// Eta of two particles from their four-momenta
+  double eta(const double& px1, const double& py1, const double& pz1, const double& e1,
+	     const double& px2, const double& py2, const double& pz2, const double& e2) const;
+  /// Get the table of the file and the radius interval of the radius
   void createLookupTable(const double& radius);
+  /// Correction for the radius interval (index < 0 - no correction)
+  double correct(const double& eta, const int& index, const double& fraction) const;
   /// File to interpolate corrections from    
   const char* mFile;
   /// Radius from previous iteration
   double mRadius;
   /// Charge product of particles
   double mZ1Z2;
-  /// Interpolated Coulomb correction table
-  double mEta[1000];
-  /// Interpolated Coulomb correction table
-  double mCoulomb[1000];
-  /// Number of Eta's in lookup-table
-  int mNLines;                                   
+  /// Binary cache of the table
+  std::string mCacheFile;
+  /// Shared correction table of the file
+  std::shared_ptr<const StHbtCoulombTable> mTable; //!
+  /// Radius interval of mRadius in the table (-1 if outside)
+  int mRadiusIndex;
+  double mRadiusFraction;
+
+  /// Lookup counters
+  mutable std::atomic<unsigned long long> mNOutOfRange; //!
+  mutable std::atomic<unsigned long long> mNWrongSign;  //!
+  mutable std::atomic<unsigned long long> mNNoTable;    //!
 
 #ifdef __ROOT__
   ClassDef(StHbtCoulomb, 0)
@@ -0,0 +1,283 @@
+/**
+ * Description: Coulomb correction table in eta and radius
+ */
+
+/// C++ headers
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+/// StHbtMaker headers
+#include "StHbtCoulombTable.h"
+
+static const char kCoulombCacheMagic[8] = { 'S', 'T', 'H', 'B', 'T', 'C', 'O', 'U' };
+static const unsigned int kCoulombCacheVersion = 2;
+
+//_________________
+StHbtCoulombTable::StHbtCoulombTable() : mRadii(), mEta(), mCorr(), mEtaLo(0), mEtaHi(0),
+					 mEtaSign(1.), mGrid(), mGridInvStep(0) {
+  /* empty */
+}
+
+//_________________
+std::shared_ptr<const StHbtCoulombTable> StHbtCoulombTable::table(const std::string& file,
+								  const std::string& cacheFile) {
+  static std::mutex registryMutex;
+  static std::map< std::string, std::shared_ptr<const StHbtCoulombTable> > registry;
+
+  std::lock_guard<std::mutex> lock( registryMutex );
+  const std::string key = file + '\n' + cacheFile;
+  std::map< std::string, std::shared_ptr<const StHbtCoulombTable> >::const_iterator iter =
+    registry.find( key );
+  if ( iter != registry.end() ) return iter->second;
+
+  /// Size and modification time identify the version of the ASCII file
+  long long fileSize = -1;
+  long long fileTime = -1;
+  struct stat fileStat;
+  if ( stat( file.c_str(), &fileStat ) == 0 ) {
+    fileSize = fileStat.st_size;
+    fileTime = fileStat.st_mtime;
+  }
+
+  std::shared_ptr<StHbtCoulombTable> newTable = std::make_shared<StHbtCoulombTable>();
+  bool isGood = !cacheFile.empty() && newTable->readCache( cacheFile.c_str(), fileSize, fileTime );
+  if ( !isGood ) {
+    isGood = newTable->readFile( file.c_str() );
+    if ( isGood && !cacheFile.empty() ) {
+      newTable->writeCache( cacheFile.c_str(), fileSize, fileTime );
+    }
+  }
+  if ( !isGood ) return nullptr;
+
+  registry[key] = newTable;
+  return newTable;
+}
+
+//_________________
+bool StHbtCoulombTable::readFile(const char* file) {
+
+  mRadii.clear();
+  mEta.clear();
+  mCorr.clear();
+  mGrid.clear();
+
+  std::ifstream in( file );
+  if ( !in ) {
+    std::cout << "[ERROR] StHbtCoulombTable::readFile - could not open file " << file << std::endl;
+    return false;
+  }
+
+  /// Radii
+  std::string line;
+  if ( !std::getline( in, line ) ) {
+    std::cout << "[ERROR] StHbtCoulombTable::readFile - could not read radii from file "
+	      << file << std::endl;
+    return false;
+  }
+  std::istringstream radiiStream( line );
+  double tempRadius = 0;
+  while ( radiiStream >> tempRadius ) {
+    mRadii.push_back( tempRadius );
+  }
+  const int nRadii = mRadii.size();
+  if ( nRadii < 2 ) {
+    std::cout << "[ERROR] StHbtCoulombTable::readFile - at least two radii are needed in "
+	      << file << std::endl;
+    return false;
+  }
+
+  /// Rows: eta and the corrections for each radius
+  std::vector<double> eta;
+  std::vector<double> corr;
+  double tempEta = 0;
+  while ( in >> tempEta ) {
+    eta.push_back( tempEta );
+    for ( int iRadius=0; iRadius<nRadii; iRadius++ ) {
+      double tempCorr = 0;
+      in >> tempCorr;
+      corr.push_back( tempCorr );
+    }
+  }
+  in.close();
+  const int nLines = eta.size();
+  if ( nLines < 2 ) {
+    std::cout << "[ERROR] StHbtCoulombTable::readFile - too few points in " << file << std::endl;
+    return false;
+  }
+
+  /// Lines in increasing eta
+  std::vector< std::pair<double, int> > order( nLines );
+  for ( int iLine=0; iLine<nLines; iLine++ ) {
+    order[iLine] = std::make_pair( eta[iLine], iLine );
+  }
+  std::sort( order.begin(), order.end() );
+  mEtaLo = order.front().first;
+  mEtaHi = order.back().first;
+  mEtaSign = ( eta[ (nLines-1) / 2 ] < 0 ) ? -1. : 1.;
+  if ( !( mEtaHi > mEtaLo ) ) {
+    std::cout << "[ERROR] StHbtCoulombTable::readFile - empty eta range in " << file << std::endl;
+    return false;
+  }
+
+  /// Columns of each radius
+  mEta.resize( nLines );
+  mCorr.resize( nRadii * nLines );
+  for ( int iLine=0; iLine<nLines; iLine++ ) {
+    mEta[iLine] = order[iLine].first;
+    const double *lineCorr = &corr[ order[iLine].second * nRadii ];
+    for ( int iRadius=0; iRadius<nRadii; iRadius++ ) {
+      mCorr[ iRadius * nLines + iLine ] = lineCorr[iRadius];
+    }
+  }
+  buildGrid();
+
+  std::cout << "StHbtCoulombTable::readFile - " << nLines << " lines and " << nRadii
+	    << " radii read from " << file << std::endl;
+  return true;
+}
+
+//_________________
+void StHbtCoulombTable::buildGrid() {
+
+  /// Grid step not larger than the smallest (non-zero) eta interval
+  const int nEta = mEta.size();
+  double minStep = 0;
+  for ( int i=0; i<nEta-1; i++ ) {
+    const double step = mEta[i+1] - mEta[i];
+    if ( step > 0 && ( minStep == 0 || step < minStep ) ) minStep = step;
+  }
+  const double nPoints = ( mEtaHi - mEtaLo ) / minStep + 1;
+  const int nGrid = ( nPoints < kMaxGridPoints ) ? (int)nPoints + 1 : (int)kMaxGridPoints;
+  mGridInvStep = nGrid / ( mEtaHi - mEtaLo );
+
+  /// Interval [mEta[i], mEta[i+1]] that contains the start of each grid step
+  mGrid.resize( nGrid );
+  int i = 0;
+  for ( int iGrid=0; iGrid<nGrid; iGrid++ ) {
+    const double gridEta = mEtaLo + iGrid / mGridInvStep;
+    while ( i < nEta - 2 && mEta[i+1] <= gridEta ) i++;
+    mGrid[iGrid] = i;
+  }
+}
+
+//_________________
+bool StHbtCoulombTable::readCache(const char* cacheFile, const long long& fileSize,
+				  const long long& fileTime) {
+
+  std::ifstream in( cacheFile, std::ios::in | std::ios::binary );
+  if ( !in ) return false;
+
+  char magic[8];
+  unsigned int version = 0;
+  long long size = 0;
+  long long time = 0;
+  int nRadii = 0;
+  in.read( magic, sizeof(magic) );
+  in.read( reinterpret_cast<char*>( &version ), sizeof(version) );
+  in.read( reinterpret_cast<char*>( &size ), sizeof(size) );
+  in.read( reinterpret_cast<char*>( &time ), sizeof(time) );
+  if ( !in || std::memcmp( magic, kCoulombCacheMagic, sizeof(magic) ) != 0 ||
+       version != kCoulombCacheVersion ) {
+    std::cout << "[WARNING] StHbtCoulombTable::readCache - " << cacheFile
+	      << " is not a Coulomb table cache" << std::endl;
+    return false;
+  }
+  /// The cache is used alone if the ASCII file is not available
+  if ( fileSize >= 0 && ( size != fileSize || time != fileTime ) ) {
+    std::cout << "StHbtCoulombTable::readCache - " << cacheFile << " is out of date" << std::endl;
+    return false;
+  }
+
+  int nEta = 0;
+  in.read( reinterpret_cast<char*>( &nRadii ), sizeof(nRadii) );
+  in.read( reinterpret_cast<char*>( &nEta ), sizeof(nEta) );
+  in.read( reinterpret_cast<char*>( &mEtaLo ), sizeof(mEtaLo) );
+  in.read( reinterpret_cast<char*>( &mEtaHi ), sizeof(mEtaHi) );
+  in.read( reinterpret_cast<char*>( &mEtaSign ), sizeof(mEtaSign) );
+  if ( !in || nRadii < 2 || nEta < 2 || !( mEtaHi > mEtaLo ) ) {
+    std::cout << "[WARNING] StHbtCoulombTable::readCache - corrupted cache " << cacheFile << std::endl;
+    return false;
+  }
+  mRadii.resize( nRadii );
+  mEta.resize( nEta );
+  mCorr.resize( nRadii * nEta );
+  in.read( reinterpret_cast<char*>( mRadii.data() ), nRadii * sizeof(double) );
+  in.read( reinterpret_cast<char*>( mEta.data() ), nEta * sizeof(double) );
+  in.read( reinterpret_cast<char*>( mCorr.data() ), mCorr.size() * sizeof(double) );
+  if ( !in ) {
+    std::cout << "[WARNING] StHbtCoulombTable::readCache - truncated cache " << cacheFile << std::endl;
+    mRadii.clear();
+    mEta.clear();
+    mCorr.clear();
+    return false;
+  }
+  buildGrid();
+
+  std::cout << "StHbtCoulombTable::readCache - table read from " << cacheFile << std::endl;
+  return true;
+}
+
+//_________________
+bool StHbtCoulombTable::writeCache(const char* cacheFile, const long long& fileSize,
+				   const long long& fileTime) const {
+
+  /// Written to a temporary file and renamed, so readers never see a
+  /// partial cache
+  const std::string tmpName = std::string( cacheFile ) + ".tmp";
+  std::ofstream out( tmpName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+  if ( !out ) {
+    std::cout << "[WARNING] StHbtCoulombTable::writeCache - can not open file: " << tmpName << std::endl;
+    return false;
+  }
+
+  const int nRadii = mRadii.size();
+  const int nEta = mEta.size();
+  out.write( kCoulombCacheMagic, sizeof(kCoulombCacheMagic) );
+  out.write( reinterpret_cast<const char*>( &kCoulombCacheVersion ), sizeof(kCoulombCacheVersion) );
+  out.write( reinterpret_cast<const char*>( &fileSize ), sizeof(fileSize) );
+  out.write( reinterpret_cast<const char*>( &fileTime ), sizeof(fileTime) );
+  out.write( reinterpret_cast<const char*>( &nRadii ), sizeof(nRadii) );
+  out.write( reinterpret_cast<const char*>( &nEta ), sizeof(nEta) );
+  out.write( reinterpret_cast<const char*>( &mEtaLo ), sizeof(mEtaLo) );
+  out.write( reinterpret_cast<const char*>( &mEtaHi ), sizeof(mEtaHi) );
+  out.write( reinterpret_cast<const char*>( &mEtaSign ), sizeof(mEtaSign) );
+  out.write( reinterpret_cast<const char*>( mRadii.data() ), nRadii * sizeof(double) );
+  out.write( reinterpret_cast<const char*>( mEta.data() ), nEta * sizeof(double) );
+  out.write( reinterpret_cast<const char*>( mCorr.data() ), mCorr.size() * sizeof(double) );
+  out.close();
+  if ( !out ) {
+    std::cout << "[WARNING] StHbtCoulombTable::writeCache - can not write file: " << tmpName << std::endl;
+    std::remove( tmpName.c_str() );
+    return false;
+  }
+  if ( std::rename( tmpName.c_str(), cacheFile ) != 0 ) {
+    std::cout << "[WARNING] StHbtCoulombTable::writeCache - can not rename " << tmpName
+	      << " to " << cacheFile << std::endl;
+    std::remove( tmpName.c_str() );
+    return false;
+  }
+  return true;
+}
+
+//_________________
+bool StHbtCoulombTable::radiusBracket(const double& r, int& index, double& fraction) const {
+  /// The last interval that contains r is used (as the original lookup did)
+  index = -1;
+  for ( int iRadius=0; iRadius<(int)mRadii.size()-1; iRadius++ ) {
+    if ( r >= mRadii[iRadius] && r <= mRadii[iRadius+1] ) index = iRadius;
+  }
+  if ( index < 0 ) {
+    fraction = 0;
+    return false;
+  }
+  const double width = mRadii[index+1] - mRadii[index];
+  fraction = ( width > 0 ) ? ( r - mRadii[index] ) / width : 0.;
+  return true;
+}
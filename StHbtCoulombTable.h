@@ -0,0 +1,116 @@
+/**
+ * Description: Coulomb correction table in eta and radius
+ *
+ * StHbtCoulombTable holds the whole content of a Coulomb correction file:
+ * the eta points and the corrections for all radii of the file. The
+ * correction for any eta and radius within the table is the bilinear
+ * interpolation between the points of the file. The eta interval is found
+ * without searching: a uniform grid with steps not larger than the
+ * smallest eta interval of the file keeps the interval of each grid
+ * point, and eta is at most one interval above it.
+ *
+ * Tables are read once per file by table() and shared read-only among all
+ * StHbtCoulomb objects (analyses, threads) that use the same file. With
+ * a cache file the table is stored in binary form after the first read
+ * and later taken from the cache as long as the size and modification
+ * time of the ASCII file are unchanged.
+ *
+ * The ASCII file has the radii in the first line followed by lines with
+ * eta and the corrections for each radius.
+ */
+
+#ifndef StHbtCoulombTable_h
+#define StHbtCoulombTable_h
+
+/// C++ headers
+#include <vector>
+#include <string>
+#include <memory>
+
+//_________________
+class StHbtCoulombTable {
+
+ public:
+  /// Default constructor (empty table)
+  StHbtCoulombTable();
+  /// Destructor
+  ~StHbtCoulombTable()                          { /* empty */ }
+
+  /// Shared table of the file. The cache file is optional. Returns
+  /// nullptr if neither the cache nor the file could be read
+  static std::shared_ptr<const StHbtCoulombTable> table(const std::string& file,
+							const std::string& cacheFile = "");
+
+  /// Read the ASCII correction file
+  bool readFile(const char* file);
+  /// Read and write the binary cache. The size and modification time of
+  /// the ASCII file are stored to check that the cache is up to date
+  bool readCache(const char* cacheFile, const long long& fileSize, const long long& fileTime);
+  bool writeCache(const char* cacheFile, const long long& fileSize, const long long& fileTime) const;
+
+  /**
+   * Getters
+   **/
+  bool empty() const                            { return mCorr.empty(); }
+  unsigned int numberOfRadii() const            { return mRadii.size(); }
+  double radius(const unsigned int& i) const    { return mRadii[i]; }
+  unsigned int numberOfEtaPoints() const        { return mEta.size(); }
+  double etaLow() const                         { return mEtaLo; }
+  double etaHigh() const                        { return mEtaHi; }
+  /// Sign of eta in the table (+1 for like-sign, -1 for unlike-sign pairs)
+  double etaSign() const                        { return mEtaSign; }
+
+  /// Lower radius of the interval that contains r and the weight of the
+  /// upper one. False if r is outside of the radii of the table
+  bool radiusBracket(const double& r, int& index, double& fraction) const;
+  /// Correction at eta in [etaLow, etaHigh], interpolated between the
+  /// radii index and index + 1 with the weight fraction of the upper one
+  double value(const double& eta, const int& index, const double& fraction) const;
+
+ private:
+
+  /// Maximal number of points of the interval grid
+  enum { kMaxGridPoints = 1 << 16 };
+
+  /// Fill the interval grid from the eta points
+  void buildGrid();
+
+  /// Radii of the table
+  std::vector<double> mRadii;
+  /// Eta points in increasing order
+  std::vector<double> mEta;
+  /// Corrections: the values at all eta points for each radius
+  std::vector<double> mCorr;
+  /// Range and sign of eta
+  double mEtaLo;
+  double mEtaHi;
+  double mEtaSign;
+  /// Uniform grid in eta: lower point of the interval of each grid point
+  std::vector<int> mGrid;
+  double mGridInvStep;
+};
+
+//_________________
+inline double StHbtCoulombTable::value(const double& eta, const int& index,
+				       const double& fraction) const {
+  const int nEta = mEta.size();
+  const int nGrid = mGrid.size();
+  int iGrid = (int)( ( eta - mEtaLo ) * mGridInvStep );
+  if ( iGrid < 0 ) iGrid = 0;
+  if ( iGrid > nGrid - 1 ) iGrid = nGrid - 1;
+  int i = mGrid[iGrid];
+  /// Grid steps are not larger than the intervals: usually at most one
+  /// more point (the loops also cover rounding and capped grids)
+  while ( i < nEta - 2 && eta > mEta[i+1] ) i++;
+  while ( i > 0 && eta < mEta[i] ) i--;
+  const double lowEta = mEta[i];
+  const double highEta = mEta[i+1];
+  const double f = ( highEta > lowEta ) ? ( eta - lowEta ) / ( highEta - lowEta ) : 0.;
+  const double *low = &mCorr[ index * nEta + i ];
+  const double *high = low + nEta;
+  const double lowValue = low[0] + f * ( low[1] - low[0] );
+  const double highValue = high[0] + f * ( high[1] - high[0] );
+  return lowValue + fraction * ( highValue - lowValue );
+}
+
+#endif // #define StHbtCoulombTable_h
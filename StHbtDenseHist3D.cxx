@@ -0,0 +1,439 @@
+/**
+ * Description: Dense 3D histogram used to accumulate correlation functions.
+ */
+
+/// C++ headers
+#include <iostream>
+#include <algorithm>
+
+/// StHbtMaker headers
+#include "StHbtCheckpoint.h"
+#include "StHbtDenseHist3D.h"
+
+/// ROOT headers
+#include "TH3.h"
+
+//_________________
+StHbtDenseHist3D::Content::Content() : mCounts(), mCarry(), mSums(), mEntries(0),
+				       mCells(), mEntriesW(0) {
+  std::fill( mStats, mStats + 11, 0. );
+  std::fill( mStatsW, mStatsW + 11, 0. );
+}
+
+//_________________
+void StHbtDenseHist3D::Content::release() {
+  mCounts.release();
+  std::map<int, unsigned long long>().swap( mCarry );
+  mSums.release();
+  mCells.release();
+  std::fill( mStats, mStats + 11, 0. );
+  std::fill( mStatsW, mStatsW + 11, 0. );
+  mEntries = 0;
+  mEntriesW = 0;
+}
+
+//_________________
+StHbtDenseHist3D::StHbtDenseHist3D(const int& nBinsX, const double& xLo, const double& xHi,
+				   const int& nBinsY, const double& yLo, const double& yHi,
+				   const int& nBinsZ, const double& zLo, const double& zHi) :
+  mStrideY(0), mStrideZ(0), mNCells(0), mNBlocksTotal(1), mFineRange(0),
+  mCoarse(), mContent() {
+
+  const int nBins[3] = { nBinsX, nBinsY, nBinsZ };
+  const double lo[3] = { xLo, yLo, zLo };
+  const double hi[3] = { xHi, yHi, zHi };
+  for ( int iAxis=0; iAxis<3; iAxis++ ) {
+    mNBins[iAxis] = nBins[iAxis];
+    mLo[iAxis] = lo[iAxis];
+    mHi[iAxis] = hi[iAxis];
+    mInvWidth[iAxis] = ( hi[iAxis] > lo[iAxis] ) ? nBins[iAxis] / ( hi[iAxis] - lo[iAxis] ) : 0.;
+  }
+  mStrideY = mNBins[0] + 2;
+  mStrideZ = mStrideY * ( mNBins[1] + 2 );
+  mNCells = mStrideZ * ( mNBins[2] + 2 );
+
+  /// Blocks along each axis: underflow layer, blocks of kBlockEdge bins
+  /// (the last one may be smaller) and overflow layer
+  int stride = 1;
+  for ( int iAxis=0; iAxis<3; iAxis++ ) {
+    const int n = mNBins[iAxis];
+    mBlockFirst[iAxis].push_back( 0 );
+    mBlockEdge[iAxis].push_back( 1 );
+    for ( int first=1; first<=n; first+=kBlockEdge ) {
+      mBlockFirst[iAxis].push_back( first );
+      mBlockEdge[iAxis].push_back( std::min( (int)kBlockEdge, n + 1 - first ) );
+    }
+    mBlockFirst[iAxis].push_back( n + 1 );
+    mBlockEdge[iAxis].push_back( 1 );
+    mNBlocks[iAxis] = mBlockFirst[iAxis].size();
+
+    mAxisBins[iAxis].resize( n + 2 );
+    for ( int iBlock=0; iBlock<mNBlocks[iAxis]; iBlock++ ) {
+      for ( int iInner=0; iInner<mBlockEdge[iAxis][iBlock]; iInner++ ) {
+	AxisBin &bin = mAxisBins[iAxis][ mBlockFirst[iAxis][iBlock] + iInner ];
+	bin.mBlock = iBlock * stride;
+	bin.mInner = iInner;
+	bin.mEdge = mBlockEdge[iAxis][iBlock];
+      }
+    }
+    stride *= mNBlocks[iAxis];
+  } //for ( int iAxis=0; iAxis<3; iAxis++ )
+  mNBlocksTotal = stride;
+}
+
+//_________________
+void StHbtDenseHist3D::setFineRange(const double& range) {
+
+  if ( entries() > 0 ) {
+    std::cout << "[ERROR] StHbtDenseHist3D::setFineRange - the histogram is already filled"
+	      << std::endl;
+    return;
+  }
+  reset();
+  mFineRange = ( range > 0 ) ? range : 0.;
+  mCoarse.clear();
+  if ( mFineRange <= 0 ) return;
+
+  /// A block inside the axis ranges is coarse if it does not overlap the
+  /// fine box along at least one axis
+  mCoarse.assign( mNBlocksTotal, 0 );
+  for ( int iBlock=0; iBlock<mNBlocksTotal; iBlock++ ) {
+    int first[3], edge[3];
+    blockBins( iBlock, first, edge );
+    bool isCoarse = false;
+    bool isHalo = false;
+    for ( int iAxis=0; iAxis<3; iAxis++ ) {
+      if ( first[iAxis] == 0 || first[iAxis] > mNBins[iAxis] ) {
+	isHalo = true;
+	break;
+      }
+      const double width = ( mHi[iAxis] - mLo[iAxis] ) / mNBins[iAxis];
+      const double low = mLo[iAxis] + ( first[iAxis] - 1 ) * width;
+      const double high = low + edge[iAxis] * width;
+      if ( low >= mFineRange || high <= -mFineRange ) isCoarse = true;
+    }
+    mCoarse[iBlock] = ( isCoarse && !isHalo ) ? 1 : 0;
+  } //for ( int iBlock=0; iBlock<mNBlocksTotal; iBlock++ )
+}
+
+//_________________
+void StHbtDenseHist3D::blockBins(const int& block, int* first, int* edge) const {
+  const int index[3] = { block % mNBlocks[0], ( block / mNBlocks[0] ) % mNBlocks[1],
+			 block / ( mNBlocks[0] * mNBlocks[1] ) };
+  for ( int iAxis=0; iAxis<3; iAxis++ ) {
+    first[iAxis] = mBlockFirst[iAxis][ index[iAxis] ];
+    edge[iAxis] = mBlockEdge[iAxis][ index[iAxis] ];
+  }
+}
+
+//_________________
+int StHbtDenseHist3D::blockCells(const int& block) const {
+  if ( !mCoarse.empty() && mCoarse[block] ) return 1;
+  int first[3], edge[3];
+  blockBins( block, first, edge );
+  return edge[0] * edge[1] * edge[2];
+}
+
+//_________________
+unsigned long long StHbtDenseHist3D::entries() const {
+  return mContent.mEntries;
+}
+
+//_________________
+unsigned int StHbtDenseHist3D::numberOfAllocatedBlocks() const {
+  const Content &s = mContent;
+  return s.mCounts.mNBlocks + s.mSums.mNBlocks + s.mCells.mNBlocks;
+}
+
+//_________________
+unsigned long long StHbtDenseHist3D::memoryUsage() const {
+  const Content &s = mContent;
+  return s.mCounts.memoryUsage() + s.mSums.memoryUsage() + s.mCells.memoryUsage() +
+    s.mCarry.size() * ( sizeof(int) + sizeof(unsigned long long) );
+}
+
+//_________________
+void StHbtDenseHist3D::reset() {
+  mContent.release();
+}
+
+//_________________
+StHbtDenseHist3D* StHbtDenseHist3D::cloneEmpty() const {
+  StHbtDenseHist3D *hist = new StHbtDenseHist3D( mNBins[0], mLo[0], mHi[0],
+						 mNBins[1], mLo[1], mHi[1],
+						 mNBins[2], mLo[2], mHi[2] );
+  hist->setFineRange( mFineRange );
+  return hist;
+}
+
+//_________________
+template <class T>
+void StHbtDenseHist3D::mergeBlocks(BlockArray<T>& target, const BlockArray<T>& source,
+				   std::map<int, unsigned long long>* carry) {
+  if ( source.empty() ) return;
+  for ( int iBlock=0; iBlock<mNBlocksTotal; iBlock++ ) {
+    const int start = source.mStart[iBlock];
+    if ( start < 0 ) continue;
+    const int nCells = blockCells( iBlock );
+    const int targetStart = target.index( iBlock, 0, nCells, mNBlocksTotal );
+    for ( int iOffset=0; iOffset<nCells; iOffset++ ) {
+      if ( addCell( target.at( targetStart + iOffset ), source.at( start + iOffset ) ) && carry ) {
+	(*carry)[ iBlock * kBlockCells + iOffset ] += ( 1ULL << 32 );
+      }
+    }
+  } //for ( int iBlock=0; iBlock<mNBlocksTotal; iBlock++ )
+}
+
+//_________________
+void StHbtDenseHist3D::mergeContent(Content& target, const Content& source) {
+  mergeBlocks( target.mCounts, source.mCounts, &target.mCarry );
+  for ( std::map<int, unsigned long long>::const_iterator iter = source.mCarry.begin();
+	iter != source.mCarry.end(); ++iter ) {
+    target.mCarry[ iter->first ] += iter->second;
+  }
+  mergeBlocks( target.mSums, source.mSums, nullptr );
+  mergeBlocks( target.mCells, source.mCells, nullptr );
+  for ( int iStat=0; iStat<11; iStat++ ) {
+    target.mStats[iStat] += source.mStats[iStat];
+    target.mStatsW[iStat] += source.mStatsW[iStat];
+  }
+  target.mEntries += source.mEntries;
+  target.mEntriesW += source.mEntriesW;
+}
+
+//_________________
+void StHbtDenseHist3D::merge(StHbtDenseHist3D& other) {
+
+  if ( &other == this || other.entries() == 0 ) return;
+  if ( other.mNCells != mNCells || other.mFineRange != mFineRange ) {
+    std::cout << "[ERROR] StHbtDenseHist3D::merge - binning does not match: "
+	      << other.mNCells << " cells instead of " << mNCells << std::endl;
+    return;
+  }
+
+  mergeContent( mContent, other.mContent );
+  other.reset();
+}
+
+//_________________
+bool StHbtDenseHist3D::checkBinning(const TH3* hist) const {
+  if ( hist->GetNcells() != mNCells ) {
+    std::cout << "[ERROR] StHbtDenseHist3D::addTo - binning of " << hist->GetName()
+	      << " does not match: " << hist->GetNcells() << " cells instead of "
+	      << mNCells << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//_________________
+void StHbtDenseHist3D::addTo(TH3* hist, TH3* weightHist) const {
+
+  if ( ( !hist && !weightHist ) || entries() == 0 ) return;
+  if ( hist && !checkBinning( hist ) ) return;
+  if ( weightHist && !checkBinning( weightHist ) ) return;
+
+  /// Statistics and entries are restored after the bin contents
+  double stats[TH1::kNstat];
+  std::fill( stats, stats + TH1::kNstat, 0. );
+  double nEntries = 0;
+  double *sumw2 = nullptr;
+  if ( hist ) {
+    hist->GetStats( stats );
+    nEntries = hist->GetEntries();
+    if ( hist->GetSumw2N() > 0 ) sumw2 = hist->GetSumw2()->GetArray();
+  }
+
+  double statsW[TH1::kNstat];
+  std::fill( statsW, statsW + TH1::kNstat, 0. );
+  double nEntriesW = 0;
+  double *sumw2W = nullptr;
+  if ( weightHist ) {
+    weightHist->GetStats( statsW );
+    nEntriesW = weightHist->GetEntries();
+    if ( weightHist->GetSumw2N() > 0 ) sumw2W = weightHist->GetSumw2()->GetArray();
+  }
+
+  const Content &s = mContent;
+
+  /// Only the allocated blocks are visited
+  for ( int iBlock=0; iBlock<mNBlocksTotal; iBlock++ ) {
+
+    const int countStart = ( !hist || s.mCounts.empty() ) ? -1 : s.mCounts.mStart[iBlock];
+    const int sumStart = ( !hist || s.mSums.empty() ) ? -1 : s.mSums.mStart[iBlock];
+    const int cellStart = s.mCells.empty() ? -1 : s.mCells.mStart[iBlock];
+    if ( countStart < 0 && sumStart < 0 && cellStart < 0 ) continue;
+
+    int first[3], edge[3];
+    blockBins( iBlock, first, edge );
+    const bool isCoarse = ( !mCoarse.empty() && mCoarse[iBlock] );
+    /// Content of a coarse block is shared uniformly by its bins
+    const double share = isCoarse ? 1. / ( edge[0] * edge[1] * edge[2] ) : 1.;
+
+    for ( int iz=0; iz<edge[2]; iz++ ) {
+      for ( int iy=0; iy<edge[1]; iy++ ) {
+	for ( int ix=0; ix<edge[0]; ix++ ) {
+	  const int bin = ( first[0] + ix ) + mStrideY * ( first[1] + iy ) +
+	    mStrideZ * ( first[2] + iz );
+	  const int iOffset = isCoarse ? 0 : ix + edge[0] * ( iy + edge[1] * iz );
+
+	  if ( countStart >= 0 ) {
+	    unsigned long long nCount = s.mCounts.at( countStart + iOffset );
+	    if ( !s.mCarry.empty() ) {
+	      std::map<int, unsigned long long>::const_iterator iter =
+		s.mCarry.find( iBlock * kBlockCells + iOffset );
+	      if ( iter != s.mCarry.end() ) nCount += iter->second;
+	    }
+	    if ( nCount != 0 ) {
+	      const double count = share * nCount;
+	      hist->AddBinContent( bin, count );
+	      if ( sumw2 ) sumw2[bin] += count;
+	    }
+	  }
+
+	  if ( sumStart >= 0 ) {
+	    const WeightSum &c = s.mSums.at( sumStart + iOffset );
+	    if ( c.mSumW != 0 || c.mSumW2 != 0 ) {
+	      hist->AddBinContent( bin, share * c.mSumW );
+	      if ( sumw2 ) sumw2[bin] += share * c.mSumW2;
+	    }
+	  }
+
+	  if ( cellStart >= 0 ) {
+	    const Cell &c = s.mCells.at( cellStart + iOffset );
+	    if ( c.mCount == 0 ) continue;
+	    if ( hist ) {
+	      const double count = share * c.mCount;
+	      hist->AddBinContent( bin, count );
+	      if ( sumw2 ) sumw2[bin] += count;
+	    }
+	    if ( weightHist ) {
+	      weightHist->AddBinContent( bin, share * c.mSumW );
+	      if ( sumw2W ) sumw2W[bin] += share * c.mSumW2;
+	    }
+	  }
+	} //for ( int ix=0; ix<edge[0]; ix++ )
+      } //for ( int iy=0; iy<edge[1]; iy++ )
+    } //for ( int iz=0; iz<edge[2]; iz++ )
+  } //for ( int iBlock=0; iBlock<mNBlocksTotal; iBlock++ )
+
+  for ( int iStat=0; iStat<11; iStat++ ) {
+    stats[iStat] += s.mStats[iStat];
+    statsW[iStat] += s.mStatsW[iStat];
+  }
+  nEntries += s.mEntries;
+  nEntriesW += s.mEntriesW;
+
+  if ( hist ) {
+    hist->PutStats( stats );
+    hist->SetEntries( nEntries );
+  }
+  if ( weightHist ) {
+    weightHist->PutStats( statsW );
+    weightHist->SetEntries( nEntriesW );
+  }
+}
+
+//_________________
+void StHbtDenseHist3D::flush(TH3* hist, TH3* weightHist) {
+  if ( ( !hist && !weightHist ) || entries() == 0 ) return;
+  addTo( hist, weightHist );
+  reset();
+}
+
+//_________________
+template <class T>
+void StHbtDenseHist3D::writeBlocks(StHbtCheckpoint& checkpoint, const BlockArray<T>& blocks) const {
+  checkpoint.write( blocks.mNBlocks );
+  if ( blocks.empty() ) return;
+  for ( int iBlock=0; iBlock<mNBlocksTotal; iBlock++ ) {
+    const int start = blocks.mStart[iBlock];
+    if ( start < 0 ) continue;
+    checkpoint.write( iBlock );
+    checkpoint.writeBytes( &blocks.at( start ), blockCells( iBlock ) * sizeof(T) );
+  }
+}
+
+//_________________
+template <class T>
+bool StHbtDenseHist3D::readBlocks(StHbtCheckpoint& checkpoint, BlockArray<T>& blocks) {
+  unsigned int nBlocks = 0;
+  if ( !checkpoint.read( nBlocks ) ) return false;
+  for ( unsigned int iBlock=0; iBlock<nBlocks; iBlock++ ) {
+    int block = -1;
+    if ( !checkpoint.read( block ) ) return false;
+    if ( block < 0 || block >= mNBlocksTotal ||
+	 ( !blocks.empty() && blocks.mStart[block] >= 0 ) ) {
+      std::cout << "[ERROR] StHbtDenseHist3D::readCheckpoint - bad block " << block << std::endl;
+      return false;
+    }
+    const int nCells = blockCells( block );
+    const int start = blocks.index( block, 0, nCells, mNBlocksTotal );
+    if ( !checkpoint.readBytes( &blocks.at( start ), nCells * sizeof(T) ) ) return false;
+  }
+  return true;
+}
+
+//_________________
+void StHbtDenseHist3D::writeCheckpoint(StHbtCheckpoint& checkpoint) const {
+
+  /// Binning and content
+  checkpoint.write( mNCells );
+  checkpoint.write( mFineRange );
+  const Content &s = mContent;
+  checkpoint.writeBytes( s.mStats, sizeof(s.mStats) );
+  checkpoint.write( s.mEntries );
+  checkpoint.writeBytes( s.mStatsW, sizeof(s.mStatsW) );
+  checkpoint.write( s.mEntriesW );
+  writeBlocks( checkpoint, s.mCounts );
+  writeBlocks( checkpoint, s.mSums );
+  writeBlocks( checkpoint, s.mCells );
+  checkpoint.write( (unsigned int)s.mCarry.size() );
+  for ( std::map<int, unsigned long long>::const_iterator iter = s.mCarry.begin();
+	iter != s.mCarry.end(); ++iter ) {
+    checkpoint.write( iter->first );
+    checkpoint.write( iter->second );
+  }
+}
+
+//_________________
+bool StHbtDenseHist3D::readCheckpoint(StHbtCheckpoint& checkpoint) {
+
+  reset();
+  int nCells = 0;
+  double fineRange = 0;
+  if ( !checkpoint.read( nCells ) || !checkpoint.read( fineRange ) ) return false;
+  if ( nCells != mNCells || fineRange != mFineRange ) {
+    std::cout << "[ERROR] StHbtDenseHist3D::readCheckpoint - binning does not match: "
+	      << nCells << " cells and fine range " << fineRange << " instead of "
+	      << mNCells << " and " << mFineRange << std::endl;
+    return false;
+  }
+
+  Content &s = mContent;
+  if ( !checkpoint.readBytes( s.mStats, sizeof(s.mStats) ) ||
+       !checkpoint.read( s.mEntries ) ||
+       !checkpoint.readBytes( s.mStatsW, sizeof(s.mStatsW) ) ||
+       !checkpoint.read( s.mEntriesW ) ||
+       !readBlocks( checkpoint, s.mCounts ) ||
+       !readBlocks( checkpoint, s.mSums ) ||
+       !readBlocks( checkpoint, s.mCells ) ) {
+    reset();
+    return false;
+  }
+  unsigned int nCarry = 0;
+  if ( !checkpoint.read( nCarry ) ) {
+    reset();
+    return false;
+  }
+  for ( unsigned int iCarry=0; iCarry<nCarry; iCarry++ ) {
+    int key = 0;
+    unsigned long long carry = 0;
+    if ( !checkpoint.read( key ) || !checkpoint.read( carry ) ) {
+      reset();
+      return false;
+    }
+    s.mCarry[key] = carry;
+  }
+  return true;
+}
@@ -0,0 +1,361 @@
+/**
+ * Description: Dense 3D histogram used to accumulate correlation functions.
+ *
+ * StHbtDenseHist3D is a fill-only accumulator for the 3D numerators and
+ * denominators. Bins are found with precomputed inverse bin widths (no
+ * axis objects, no virtual calls), unit-weight fills increment 32-bit
+ * integer counters (a counter that wraps around carries into a small
+ * map) and weighted fills accumulate double sums of weights and of
+ * squared weights. Sums of squared weights are only kept for the
+ * weighted fills: for unit weights they equal the counts.
+ *
+ * The bins are stored in blocks of 4x4x4 neighbouring bins. The under-
+ * and overflow bins of each axis form separate layers of blocks (one bin
+ * thick), so they do not occupy the space of 4x4x4 blocks. A block is
+ * allocated on the first fill inside it, from pages of 256 kB, so the
+ * storage grows without reallocating the filled blocks and regions
+ * without pairs cost only an entry in the block table.
+ *
+ * With setFineRange(r) only the blocks that overlap the box
+ * |x|, |y|, |z| <= r (and the under- and overflow layers) are kept bin by
+ * bin. Each of the other blocks is a single cell: the fills of its bins
+ * are summed, and the sum is spread uniformly over the bins of the block
+ * when the content is transferred to a TH3 (entries and statistics stay
+ * exact). Far from the origin this costs up to 64 times less memory, at
+ * the price of the resolution there. By default all bins are exact.
+ *
+ * fillCountAndWeight() accumulates a pair of histograms that share the
+ * binning, such as a numerator and its qinv-weighted copy: the count and
+ * the sums of weights are kept next to each other in one cell, so both
+ * are updated with a single bin lookup and a single cache line. This
+ * content is transferred by addTo(hist, weightHist) and flush(hist,
+ * weightHist): counts to hist and weights to weightHist.
+ *
+ * The histogram is not thread-safe: threads fill their own copies
+ * (cloneEmpty(), as the correlation function shards do), which are added
+ * with merge(). addTo() adds the content to a ROOT TH3 (bins, sum of
+ * weight squares, entries and statistics, as TH3::Fill would have
+ * produced them) and keeps it, so the histograms can be built and written
+ * one at a time. flush() adds the content and releases the memory of the
+ * accumulator.
+ *
+ * Bins follow the ROOT global bin numbering including under- and
+ * overflows, so the histogram must have the same binning as the TH3.
+ */
+
+#ifndef StHbtDenseHist3D_h
+#define StHbtDenseHist3D_h
+
+/// C++ headers
+#include <vector>
+#include <map>
+
+/// Forward declarations
+class TH3;
+class StHbtCheckpoint;
+
+//_________________
+class StHbtDenseHist3D {
+
+ public:
+  /// Constructor with the binning of the three axes
+  StHbtDenseHist3D(const int& nBinsX, const double& xLo, const double& xHi,
+		   const int& nBinsY, const double& yLo, const double& yHi,
+		   const int& nBinsZ, const double& zLo, const double& zHi);
+  /// Destructor
+  ~StHbtDenseHist3D()                           { /* empty */ }
+
+  /// Keep the bins exact only in the blocks that overlap |x|, |y|, |z| <= range
+  /// (range <= 0 - everywhere, default). Must be called before the first fill
+  void setFineRange(const double& range);
+  double fineRange() const                      { return mFineRange; }
+
+  /// Global bin of the point (ROOT numbering, including under/overflows)
+  int findBin(const double& x, const double& y, const double& z) const
+  { return axisBin( x, 0 ) + mStrideY * axisBin( y, 1 ) + mStrideZ * axisBin( z, 2 ); }
+
+  /// Fill with unit weight
+  void fill(const double& x, const double& y, const double& z);
+  /// Fill with weight w
+  void fill(const double& x, const double& y, const double& z, const double& w);
+  /// Fill the count with unit weight and the weight histogram with w
+  void fillCountAndWeight(const double& x, const double& y, const double& z,
+			  const double& w);
+
+  /// New histogram with the same binning and settings and no content
+  StHbtDenseHist3D* cloneEmpty() const;
+  /// Add the content of other (same binning) and reset other
+  void merge(StHbtDenseHist3D& other);
+
+  /// Add the content to the histograms and keep it. Either histogram may
+  /// be nullptr: counts and weighted fills go to hist, the weights of
+  /// fillCountAndWeight() to weightHist
+  void addTo(TH3* hist, TH3* weightHist = nullptr) const;
+  /// Add the content to the histograms and reset the accumulator
+  void flush(TH3* hist, TH3* weightHist = nullptr);
+  /// Remove the content and release the memory
+  void reset();
+
+  /// Store the content in the checkpoint / replace it with the stored one
+  void writeCheckpoint(StHbtCheckpoint& checkpoint) const;
+  bool readCheckpoint(StHbtCheckpoint& checkpoint);
+
+  /// Number of fills since the last flush
+  unsigned long long entries() const;
+  /// Number of bins including under- and overflows
+  int numberOfCells() const                     { return mNCells; }
+  /// Number of allocated blocks and bytes used by the content
+  unsigned int numberOfAllocatedBlocks() const;
+  unsigned long long memoryUsage() const;
+
+ private:
+
+  /// Blocks of up to kBlockEdge^3 bins. Pages of up to kPageBytes bytes
+  /// are large enough to be mapped by malloc, so the memory of the
+  /// released pages returns to the system
+  enum { kBlockShift = 2, kBlockEdge = 1 << kBlockShift,
+	 kBlockCells = kBlockEdge * kBlockEdge * kBlockEdge,
+	 kPageBytes = 1 << 18 };
+
+  /// Sums of the weighted fills
+  struct WeightSum {
+    double mSumW;
+    double mSumW2;
+    WeightSum() : mSumW(0), mSumW2(0) { /* empty */ }
+  };
+
+  /// Cell of fillCountAndWeight()
+  struct Cell {
+    unsigned long long mCount;
+    double mSumW;
+    double mSumW2;
+    Cell() : mCount(0), mSumW(0), mSumW2(0) { /* empty */ }
+  };
+
+  /// Cells stored block by block in pages. The block table is created on
+  /// the first fill and a block on the first fill inside it
+  template <class T> struct BlockArray {
+    enum { kPageCells = kPageBytes / sizeof(T) };
+    /// Start of each block (-1 if not allocated)
+    std::vector<int> mStart;
+    /// Pages of kPageCells cells (a block never spans two pages)
+    std::vector< std::vector<T> > mPages;
+    /// Number of used cells including the unused ends of the pages
+    int mSize;
+    /// Number of allocated blocks
+    unsigned int mNBlocks;
+    BlockArray() : mStart(), mPages(), mSize(0), mNBlocks(0) { /* empty */ }
+    bool empty() const                          { return mStart.empty(); }
+    T& at(const int& index)
+    { return mPages[ (unsigned int)index / kPageCells ][ (unsigned int)index % kPageCells ]; }
+    const T& at(const int& index) const
+    { return mPages[ (unsigned int)index / kPageCells ][ (unsigned int)index % kPageCells ]; }
+    /// Index of the cell, the block of nCells cells is allocated if needed
+    int index(const int& block, const int& offset, const int& nCells, const int& nBlocks) {
+      if ( mStart.empty() ) mStart.assign( nBlocks, -1 );
+      int &start = mStart[block];
+      if ( start < 0 ) {
+	if ( mSize % kPageCells + nCells > kPageCells ) {
+	  mSize = ( mSize / kPageCells + 1 ) * kPageCells;
+	}
+	if ( ( mSize + nCells - 1 ) / kPageCells >= (int)mPages.size() ) {
+	  mPages.push_back( std::vector<T>( kPageCells ) );
+	}
+	start = mSize;
+	mSize += nCells;
+	mNBlocks++;
+      }
+      return start + offset;
+    }
+    /// Release the memory
+    void release() {
+      std::vector<int>().swap( mStart );
+      std::vector< std::vector<T> >().swap( mPages );
+      mSize = 0;
+      mNBlocks = 0;
+    }
+    unsigned long long memoryUsage() const {
+      return mStart.capacity() * sizeof(int) + mPages.size() * kPageCells * sizeof(T);
+    }
+  };
+
+  /// Content of the histogram
+  struct Content {
+    /// Unit-weight counts and the carries of the counters that wrapped
+    /// around (key: block * kBlockCells + offset)
+    BlockArray<unsigned int> mCounts;
+    std::map<int, unsigned long long> mCarry;
+    /// Sum of weights and of squared weights of the weighted fills
+    BlockArray<WeightSum> mSums;
+    /// TH3 statistics: sumw, sumw2, sumwx, sumwx2, sumwy, sumwy2,
+    /// sumwxy, sumwz, sumwz2, sumwxz, sumwyz (in-range fills only)
+    double mStats[11];
+    /// Number of fills
+    unsigned long long mEntries;
+    /// Cells, weight statistics and number of fills of fillCountAndWeight()
+    BlockArray<Cell> mCells;
+    double mStatsW[11];
+    unsigned long long mEntriesW;
+    Content();
+    /// Remove the content and release the memory
+    void release();
+  };
+
+  /// Position of a bin along an axis: axis contribution to the block
+  /// index, coordinate inside the block and block size along the axis
+  struct AxisBin {
+    int mBlock;
+    int mInner;
+    int mEdge;
+  };
+
+  /// Bin on the axis (0 - underflow, n+1 - overflow, NaN - underflow)
+  int axisBin(const double& v, const int& axis) const {
+    if ( !( v >= mLo[axis] ) ) return 0;
+    const double t = ( v - mLo[axis] ) * mInvWidth[axis];
+    return ( t < mNBins[axis] ) ? ( (int)t + 1 ) : ( mNBins[axis] + 1 );
+  }
+  /// Block of the bins, position of the bin in the block and number of
+  /// cells of the block (a coarse block is a single cell)
+  void locate(const int& bx, const int& by, const int& bz,
+	      int& block, int& offset, int& nCells) const {
+    const AxisBin &ax = mAxisBins[0][bx];
+    const AxisBin &ay = mAxisBins[1][by];
+    const AxisBin &az = mAxisBins[2][bz];
+    block = ax.mBlock + ay.mBlock + az.mBlock;
+    if ( !mCoarse.empty() && mCoarse[block] ) {
+      offset = 0;
+      nCells = 1;
+    }
+    else {
+      offset = ax.mInner + ax.mEdge * ( ay.mInner + ay.mEdge * az.mInner );
+      nCells = ax.mEdge * ay.mEdge * az.mEdge;
+    }
+  }
+  /// First bin and number of bins of the block along each axis
+  void blockBins(const int& block, int* first, int* edge) const;
+  /// Number of cells of the block
+  int blockCells(const int& block) const;
+  /// True if the bins are not under- or overflows
+  bool inRange(const int& bx, const int& by, const int& bz) const {
+    return ( bx > 0 && bx <= mNBins[0] && by > 0 && by <= mNBins[1] &&
+	     bz > 0 && bz <= mNBins[2] );
+  }
+  /// Print an error and return false if the histogram binning differs
+  bool checkBinning(const TH3* hist) const;
+  /// Accumulate the statistics of an in-range fill
+  void addStats(double* stats, const double& x, const double& y, const double& z,
+		const double& w) const;
+  /// Add the content of source to target
+  void mergeContent(Content& target, const Content& source);
+  template <class T> void mergeBlocks(BlockArray<T>& target, const BlockArray<T>& source,
+				      std::map<int, unsigned long long>* carry);
+  /// Add the content of cell c to cell t. Returns true if a 32-bit
+  /// counter wrapped around
+  static bool addCell(unsigned int& t, const unsigned int& c)
+  { const unsigned int sum = t + c; const bool wrapped = ( sum < t ); t = sum; return wrapped; }
+  static bool addCell(WeightSum& t, const WeightSum& c)
+  { t.mSumW += c.mSumW; t.mSumW2 += c.mSumW2; return false; }
+  static bool addCell(Cell& t, const Cell& c)
+  { t.mCount += c.mCount; t.mSumW += c.mSumW; t.mSumW2 += c.mSumW2; return false; }
+  /// Checkpoint of the blocks of an array
+  template <class T> void writeBlocks(StHbtCheckpoint& checkpoint, const BlockArray<T>& blocks) const;
+  template <class T> bool readBlocks(StHbtCheckpoint& checkpoint, BlockArray<T>& blocks);
+
+  /// Binning
+  int mNBins[3];
+  double mLo[3];
+  double mHi[3];
+  double mInvWidth[3];
+  int mStrideY;
+  int mStrideZ;
+  int mNCells;
+  /// Block layout: number of blocks along each axis and in total, position
+  /// of each bin and first bin and size of each block along each axis
+  int mNBlocks[3];
+  int mNBlocksTotal;
+  std::vector<AxisBin> mAxisBins[3];
+  std::vector<int> mBlockFirst[3];
+  std::vector<int> mBlockEdge[3];
+  /// Range of the exact bins and the blocks outside it (empty if none)
+  double mFineRange;
+  std::vector<unsigned char> mCoarse;
+
+  /// Content
+  Content mContent;
+};
+
+//_________________
+inline void StHbtDenseHist3D::addStats(double* stats, const double& x, const double& y,
+				       const double& z, const double& w) const {
+  stats[0] += w;
+  stats[1] += w * w;
+  stats[2] += w * x;
+  stats[3] += w * x * x;
+  stats[4] += w * y;
+  stats[5] += w * y * y;
+  stats[6] += w * x * y;
+  stats[7] += w * z;
+  stats[8] += w * z * z;
+  stats[9] += w * x * z;
+  stats[10] += w * y * z;
+}
+
+//_________________
+inline void StHbtDenseHist3D::fill(const double& x, const double& y, const double& z) {
+  Content &s = mContent;
+  const int bx = axisBin( x, 0 );
+  const int by = axisBin( y, 1 );
+  const int bz = axisBin( z, 2 );
+  int iBlock, iOffset, nCells;
+  locate( bx, by, bz, iBlock, iOffset, nCells );
+  unsigned int &count = s.mCounts.at( s.mCounts.index( iBlock, iOffset, nCells, mNBlocksTotal ) );
+  if ( ++count == 0 ) {
+    s.mCarry[ iBlock * kBlockCells + iOffset ] += ( 1ULL << 32 );
+  }
+  s.mEntries++;
+  if ( inRange( bx, by, bz ) ) {
+    addStats( s.mStats, x, y, z, 1. );
+  }
+}
+
+//_________________
+inline void StHbtDenseHist3D::fill(const double& x, const double& y, const double& z,
+				   const double& w) {
+  Content &s = mContent;
+  const int bx = axisBin( x, 0 );
+  const int by = axisBin( y, 1 );
+  const int bz = axisBin( z, 2 );
+  int iBlock, iOffset, nCells;
+  locate( bx, by, bz, iBlock, iOffset, nCells );
+  WeightSum &c = s.mSums.at( s.mSums.index( iBlock, iOffset, nCells, mNBlocksTotal ) );
+  c.mSumW += w;
+  c.mSumW2 += w * w;
+  s.mEntries++;
+  if ( inRange( bx, by, bz ) ) {
+    addStats( s.mStats, x, y, z, w );
+  }
+}
+
+//_________________
+inline void StHbtDenseHist3D::fillCountAndWeight(const double& x, const double& y,
+						 const double& z, const double& w) {
+  Content &s = mContent;
+  const int bx = axisBin( x, 0 );
+  const int by = axisBin( y, 1 );
+  const int bz = axisBin( z, 2 );
+  int iBlock, iOffset, nCells;
+  locate( bx, by, bz, iBlock, iOffset, nCells );
+  Cell &c = s.mCells.at( s.mCells.index( iBlock, iOffset, nCells, mNBlocksTotal ) );
+  c.mCount++;
+  c.mSumW += w;
+  c.mSumW2 += w * w;
+  s.mEntries++;
+  s.mEntriesW++;
+  if ( inRange( bx, by, bz ) ) {
+    addStats( s.mStats, x, y, z, 1. );
+    addStats( s.mStatsW, x, y, z, w );
+  }
+}
+
+#endif // #define StHbtDenseHist3D_h
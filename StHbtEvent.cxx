@@ -6,6 +6,9 @@
  * to the cuts of the various active Analyses.
  */
 
+/// C++ headers
+#include <utility>
+
 /// StHbtMaker headers
 //Infrastructure
 #include "StHbtEvent.h"
@@ -32,7 +35,8 @@ StHbtEvent::StHbtEvent() :
   mZdcCoincidenceRate(0), mBbcCoincidenceRate(0), mSphericity(-1), mSphericity2(-1),
   mEventPlaneAngle( 0 ), mEventPlaneResolution( 0 ), mCent16(-1),
   mPrimaryVertexPositionX(-999), mPrimaryVertexPositionY(-999), mPrimaryVertexPositionZ(-999),
-  mVpdVz(0), mRanking(-1e5), mL3TriggerAlgorithm{} {
+  mVpdVz(0), mRanking(-1e5), mL3TriggerAlgorithm{}, mOwnsTracks(true),
+  mTrackBatchValid(false) {
 
   if( !mTriggerIds.empty() ) mTriggerIds.clear();
   
@@ -45,46 +49,11 @@ StHbtEvent::StHbtEvent() :
 
 //___________________
 StHbtEvent::StHbtEvent(const StHbtEvent& ev, StHbtTrackCut* tCut, StHbtV0Cut* vCut, 
-		       StHbtXiCut* xCut, StHbtKinkCut* kCut) { 
+		       StHbtXiCut* xCut, StHbtKinkCut* kCut) :
+  mOwnsTracks(true), mTrackBatchValid(false) { 
 
   /// Copy constructor with track and v0 cuts
-  mEventNumber = ev.mEventNumber;
-  mRunNumber = ev.mRunNumber;
-  mMagneticField = ev.mMagneticField;
-
-  mRefMult = ev.mRefMult;
-  mRefMultPos = ev.mRefMultPos;
-  mRefMultCorr = ev.mRefMultCorr;
-  mRefMultCorrWeight = ev.mRefMultCorrWeight;
-  mRefMult2 = ev.mRefMult2;
-  mRefMult2Pos = ev.mRefMult2Pos;
-  mGRefMult = ev.mGRefMult;
-  mGRefMultPos = ev.mGRefMultPos;
-  mBTofTrayMultiplicity = ev.mBTofTrayMultiplicity;
-  mNBTOFMatch = ev.mNBTOFMatch;
-  mNBEMCMatch = ev.mNBEMCMatch;
-  mNumberOfPrimaryTracks = ev.mNumberOfPrimaryTracks;
-  mNumberOfGlobalTracks = ev.mNumberOfGlobalTracks;
-  mZdcSumAdcEast = ev.mZdcSumAdcEast;
-  mZdcSumAdcWest = ev.mZdcSumAdcWest;
-  mZdcCoincidenceRate = ev.mZdcCoincidenceRate;
-  mBbcCoincidenceRate = ev.mBbcCoincidenceRate;
-
-  mSphericity = ev.mSphericity;
-  mSphericity2 = ev.mSphericity2;
-  mEventPlaneAngle = ev.mEventPlaneAngle;
-  mEventPlaneResolution = ev.mEventPlaneResolution;
-  mCent16 = ev.mCent16;
-
-  mPrimaryVertexPositionX = ev.mPrimaryVertexPositionX;
-  mPrimaryVertexPositionY = ev.mPrimaryVertexPositionY;
-  mPrimaryVertexPositionZ = ev.mPrimaryVertexPositionZ;
-  mVpdVz = ev.mVpdVz;
-  mRanking = ev.mRanking;
-  mTriggerIds = ev.mTriggerIds;
-  for(int i=0; i<4; i++) {
-    mL3TriggerAlgorithm[i] = ev.mL3TriggerAlgorithm[i];
-  }
+  copyHeader( ev );
   
   /// Create empty collections
   mTrackCollection = new StHbtTrackCollection;
@@ -92,10 +61,13 @@ StHbtEvent::StHbtEvent(const StHbtEvent& ev, StHbtTrackCut* tCut, StHbtV0Cut* vC
   mXiCollection = new StHbtXiCollection;
   mKinkCollection = new StHbtKinkCollection;
   
-  /// Copy tracks from one collection to the another one
+  /// Copy tracks from one collection to the another one. The cut
+  /// is evaluated in batch and the mask is shared with the analyses
+  const StHbtSelectionMask *trackMask = tCut ? &ev.trackSelection( tCut ) : nullptr;
+  unsigned int iTrk = 0;
   for ( StHbtTrackIterator tIter=ev.mTrackCollection->begin();
-	tIter!=ev.mTrackCollection->end(); tIter++) {
-    if ( !tCut || tCut->pass(*tIter) ) {
+	tIter!=ev.mTrackCollection->end(); tIter++, iTrk++) {
+    if ( !trackMask || (*trackMask)[iTrk] ) {
       StHbtTrack* trackCopy = new StHbtTrack(**tIter);
       mTrackCollection->push_back(trackCopy);
     }
@@ -129,6 +101,74 @@ StHbtEvent::StHbtEvent(const StHbtEvent& ev, StHbtTrackCut* tCut, StHbtV0Cut* vC
   }
 }
 
+//___________________
+StHbtEvent::StHbtEvent(StHbtEvent&& ev, StHbtTrackCut* tCut, StHbtV0Cut* vCut,
+		       StHbtXiCut* xCut, StHbtKinkCut* kCut) :
+  mTrackCollection( ev.mTrackCollection ), mV0Collection( ev.mV0Collection ),
+  mXiCollection( ev.mXiCollection ), mKinkCollection( ev.mKinkCollection ),
+  mOwnsTracks( ev.mOwnsTracks ), mTrackBatchValid(false) {
+
+  /// Move constructor with cuts
+  copyHeader( ev );
+
+  /// The columnar view and the selection masks describe the moved tracks
+  mTrackBatch = std::move( ev.mTrackBatch );
+  mTrackBatchValid = ev.mTrackBatchValid;
+  mTrackSelections.swap( ev.mTrackSelections );
+
+  /// Leave the source with empty collections
+  ev.mTrackCollection = new StHbtTrackCollection;
+  ev.mV0Collection = new StHbtV0Collection;
+  ev.mXiCollection = new StHbtXiCollection;
+  ev.mKinkCollection = new StHbtKinkCollection;
+  ev.mOwnsTracks = true;
+  ev.mTrackBatch.clear();
+  ev.mTrackBatchValid = false;
+
+  filterInPlace( tCut, vCut, xCut, kCut );
+}
+
+//_________________
+void StHbtEvent::copyHeader(const StHbtEvent& ev) {
+  mEventNumber = ev.mEventNumber;
+  mRunNumber = ev.mRunNumber;
+  mMagneticField = ev.mMagneticField;
+
+  mRefMult = ev.mRefMult;
+  mRefMultPos = ev.mRefMultPos;
+  mRefMultCorr = ev.mRefMultCorr;
+  mRefMultCorrWeight = ev.mRefMultCorrWeight;
+  mRefMult2 = ev.mRefMult2;
+  mRefMult2Pos = ev.mRefMult2Pos;
+  mGRefMult = ev.mGRefMult;
+  mGRefMultPos = ev.mGRefMultPos;
+  mBTofTrayMultiplicity = ev.mBTofTrayMultiplicity;
+  mNBTOFMatch = ev.mNBTOFMatch;
+  mNBEMCMatch = ev.mNBEMCMatch;
+  mNumberOfPrimaryTracks = ev.mNumberOfPrimaryTracks;
+  mNumberOfGlobalTracks = ev.mNumberOfGlobalTracks;
+  mZdcSumAdcEast = ev.mZdcSumAdcEast;
+  mZdcSumAdcWest = ev.mZdcSumAdcWest;
+  mZdcCoincidenceRate = ev.mZdcCoincidenceRate;
+  mBbcCoincidenceRate = ev.mBbcCoincidenceRate;
+
+  mSphericity = ev.mSphericity;
+  mSphericity2 = ev.mSphericity2;
+  mEventPlaneAngle = ev.mEventPlaneAngle;
+  mEventPlaneResolution = ev.mEventPlaneResolution;
+  mCent16 = ev.mCent16;
+
+  mPrimaryVertexPositionX = ev.mPrimaryVertexPositionX;
+  mPrimaryVertexPositionY = ev.mPrimaryVertexPositionY;
+  mPrimaryVertexPositionZ = ev.mPrimaryVertexPositionZ;
+  mVpdVz = ev.mVpdVz;
+  mRanking = ev.mRanking;
+  mTriggerIds = ev.mTriggerIds;
+  for(int i=0; i<4; i++) {
+    mL3TriggerAlgorithm[i] = ev.mL3TriggerAlgorithm[i];
+  }
+}
+
 //_________________
 StHbtEvent& StHbtEvent::operator=(const StHbtEvent& ev) {
 
@@ -175,7 +215,7 @@ StHbtEvent& StHbtEvent::operator=(const StHbtEvent& ev) {
     if( mTrackCollection ) {
       for( StHbtTrackIterator iter=mTrackCollection->begin();
 	   iter!=mTrackCollection->end(); iter++ ) {
-	delete *iter;
+	if ( mOwnsTracks ) delete *iter;
       }
       mTrackCollection->clear();
     }
@@ -216,7 +256,9 @@ StHbtEvent& StHbtEvent::operator=(const StHbtEvent& ev) {
       mXiCollection = new StHbtXiCollection;
     }
 
-    /// Copy collections
+    /// Copy collections (the copies are owned)
+    mOwnsTracks = true;
+    mTrackBatchValid = false;
     for (StHbtTrackIterator iIter=ev.mTrackCollection->begin();
 	 iIter!=ev.mTrackCollection->end(); iIter++) {
       StHbtTrack *trackCopy = new StHbtTrack( **iIter );
@@ -251,7 +293,7 @@ StHbtEvent::~StHbtEvent() {
   /// Remove track collection
   for (StHbtTrackIterator iter=mTrackCollection->begin();
        iter!=mTrackCollection->end();iter++){
-    delete *iter;
+    if ( mOwnsTracks ) delete *iter;
   }
   mTrackCollection->clear();
   delete mTrackCollection;
@@ -281,6 +323,135 @@ StHbtEvent::~StHbtEvent() {
   delete mKinkCollection;
 }
 
+//___________________
+void StHbtEvent::filterInPlace(StHbtTrackCut* tCut, StHbtV0Cut* vCut,
+			       StHbtXiCut* xCut, StHbtKinkCut* kCut) {
+
+  if ( tCut ) {
+    /// Take the mask by value: it is dropped with the batch below
+    const StHbtSelectionMask trackMask = trackSelection( tCut );
+    unsigned int iTrk = 0;
+    for ( StHbtTrackIterator iter=mTrackCollection->begin();
+	  iter!=mTrackCollection->end(); iTrk++ ) {
+      if ( trackMask[iTrk] ) {
+	iter++;
+      }
+      else {
+	if ( mOwnsTracks ) delete *iter;
+	iter = mTrackCollection->erase( iter );
+      }
+    }
+    if ( mTrackCollection->size() != trackMask.size() ) {
+      invalidateTrackBatch();
+    }
+  } //if ( tCut )
+
+  if ( vCut ) {
+    for ( StHbtV0Iterator iter=mV0Collection->begin(); iter!=mV0Collection->end(); ) {
+      if ( vCut->pass( *iter ) ) {
+	iter++;
+      }
+      else {
+	delete *iter;
+	iter = mV0Collection->erase( iter );
+      }
+    }
+  } //if ( vCut )
+
+  if ( xCut ) {
+    for ( StHbtXiIterator iter=mXiCollection->begin(); iter!=mXiCollection->end(); ) {
+      if ( xCut->pass( *iter ) ) {
+	iter++;
+      }
+      else {
+	delete *iter;
+	iter = mXiCollection->erase( iter );
+      }
+    }
+  } //if ( xCut )
+
+  if ( kCut ) {
+    for ( StHbtKinkIterator iter=mKinkCollection->begin(); iter!=mKinkCollection->end(); ) {
+      if ( kCut->pass( *iter ) ) {
+	iter++;
+      }
+      else {
+	delete *iter;
+	iter = mKinkCollection->erase( iter );
+      }
+    }
+  } //if ( kCut )
+}
+
+//___________________
+void StHbtEvent::clear() {
+
+  mEventNumber = 0;
+  mRunNumber = 0;
+  mMagneticField = 0;
+  mRefMult = 0;
+  mRefMultPos = 0;
+  mRefMultCorr = 0;
+  mRefMultCorrWeight = 0;
+  mRefMult2 = 0;
+  mRefMult2Pos = 0;
+  mGRefMult = 0;
+  mGRefMultPos = 0;
+  mBTofTrayMultiplicity = 0;
+  mNBTOFMatch = 0;
+  mNBEMCMatch = 0;
+  mNumberOfPrimaryTracks = 0;
+  mNumberOfGlobalTracks = 0;
+  mZdcSumAdcEast = 0;
+  mZdcSumAdcWest = 0;
+  mZdcCoincidenceRate = 0;
+  mBbcCoincidenceRate = 0;
+  mSphericity = -1;
+  mSphericity2 = -1;
+  mEventPlaneAngle = 0;
+  mEventPlaneResolution = 0;
+  mCent16 = -1;
+  mPrimaryVertexPositionX = -999;
+  mPrimaryVertexPositionY = -999;
+  mPrimaryVertexPositionZ = -999;
+  mVpdVz = 0;
+  mRanking = -1e5;
+  mTriggerIds.clear();
+  for(int i=0; i<4; i++) {
+    mL3TriggerAlgorithm[i] = 0;
+  }
+
+  for ( StHbtTrackIterator iter=mTrackCollection->begin();
+	iter!=mTrackCollection->end(); iter++ ) {
+    if ( mOwnsTracks ) delete *iter;
+  }
+  mTrackCollection->clear();
+  mOwnsTracks = true;
+
+  for ( StHbtV0Iterator iter=mV0Collection->begin();
+	iter!=mV0Collection->end(); iter++ ) {
+    delete *iter;
+  }
+  mV0Collection->clear();
+
+  for ( StHbtXiIterator iter=mXiCollection->begin();
+	iter!=mXiCollection->end(); iter++ ) {
+    delete *iter;
+  }
+  mXiCollection->clear();
+
+  for ( StHbtKinkIterator iter=mKinkCollection->begin();
+	iter!=mKinkCollection->end(); iter++ ) {
+    delete *iter;
+  }
+  mKinkCollection->clear();
+
+  /// Batch columns keep their capacity
+  mTrackBatch.clear();
+  mTrackBatchValid = false;
+  mTrackSelections.clear();
+}
+
 //___________________
 void StHbtEvent::rotateZ(const double& angle) {
 
@@ -295,6 +466,7 @@ void StHbtEvent::rotateZ(const double& angle) {
   std::cout << " StHbtEvent::rotateZ(const double angle) - angle="
 	    << angle << " rad    ";
   std::cout << angle / degree << " deg " << std::endl;
+  mTrackBatchValid = false;
   for ( iter=mTrackCollection->begin(); iter!=mTrackCollection->end(); iter++ ) {
     
     p = (*iter)->p();
@@ -321,6 +493,34 @@ void StHbtEvent::rotateZ(const double& angle) {
   }
 }
 
+//_________________
+const StHbtTrackBatch& StHbtEvent::trackBatch() const {
+  if ( !mTrackBatchValid ) {
+    mTrackBatch.fill( mTrackCollection );
+    mTrackBatchValid = true;
+    mTrackSelections.clear();
+  }
+  return mTrackBatch;
+}
+
+//_________________
+const StHbtSelectionMask& StHbtEvent::trackSelection(StHbtTrackCut* cut) const {
+
+  const StHbtTrackBatch& batch = trackBatch();
+
+  /// Only a few cuts are used per event: linear search is enough
+  for ( unsigned int iSel=0; iSel<mTrackSelections.size(); iSel++ ) {
+    if ( mTrackSelections[iSel].first == cut ) {
+      cut->countBatch( mTrackSelections[iSel].second );
+      return mTrackSelections[iSel].second;
+    }
+  }
+
+  mTrackSelections.push_back( std::make_pair( cut, StHbtSelectionMask() ) );
+  cut->passBatch( batch, mTrackSelections.back().second );
+  return mTrackSelections.back().second;
+}
+
 //_________________
 bool StHbtEvent::isTrigger(const unsigned int& id) const {
   return std::find(mTriggerIds.begin(), mTriggerIds.end(), id) != mTriggerIds.end();
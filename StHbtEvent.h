@@ -11,6 +11,8 @@
 
 /// C++ headers
 #include <vector>
+#include <deque>
+#include <utility>
 
 /// ROOT headers
 #include "TVector3.h"
@@ -19,6 +21,7 @@
 /// HbtMaker headers
 #include "StHbtTypes.h"
 #include "StHbtTrackCollection.h"
+#include "StHbtTrackBatch.h"
 #include "StHbtV0Collection.h"
 #include "StHbtXiCollection.h"
 #include "StHbtKinkCollection.h"
@@ -38,6 +41,11 @@ class StHbtEvent {
   /// Copy constructor
   StHbtEvent(const StHbtEvent& ev, StHbtTrackCut* track=0, StHbtV0Cut* v0=0,
 	     StHbtXiCut* xi=0, StHbtKinkCut* kink=0);
+  /// Move constructor with cuts. Takes over the collections of ev (which
+  /// is left with empty ones) and removes the objects that fail the cuts,
+  /// so the passing tracks, V0s, Xis and kinks are kept without cloning
+  StHbtEvent(StHbtEvent&& ev, StHbtTrackCut* track=0, StHbtV0Cut* v0=0,
+	     StHbtXiCut* xi=0, StHbtKinkCut* kink=0);
   /// Copy constructor
   StHbtEvent& operator=(const StHbtEvent& event);
   /// Destructor
@@ -45,6 +53,15 @@ class StHbtEvent {
   
   /// Perform rotation
   void rotateZ(const double& angle);
+  /// Delete the tracks, V0s, Xis and kinks that fail the cuts (a null
+  /// cut keeps the whole collection). Tracks are selected with
+  /// trackSelection(), so the mask is shared with the analyses
+  void filterInPlace(StHbtTrackCut* track=0, StHbtV0Cut* v0=0,
+		     StHbtXiCut* xi=0, StHbtKinkCut* kink=0);
+  /// Reset the header to the default values and delete all tracks, V0s,
+  /// Xis and kinks. Collections are kept, so the event can be refilled
+  /// (used by StHbtEventPool)
+  void clear();
 
   /**
    * Getters
@@ -90,7 +107,7 @@ class StHbtEvent {
   float vpdVzDiff() const                      { return ( primaryVertex().Z() - vpdVz() ); }
   float ranking() const                        { return mRanking; }
 
-  std::vector<unsigned int> triggerIds() const { return mTriggerIds; }
+  const std::vector<unsigned int>& triggerIds() const { return mTriggerIds; }
   bool isTrigger(const unsigned int& word) const;
   unsigned int l3TriggerAlgorithm(const unsigned int& i) const { return mL3TriggerAlgorithm[i]; }
 
@@ -98,6 +115,24 @@ class StHbtEvent {
   StHbtV0Collection *v0Collection() const       { return mV0Collection; }
   StHbtXiCollection *xiCollection() const       { return mXiCollection; }
   StHbtKinkCollection *kinkCollection() const   { return mKinkCollection; }
+
+  /// False if the tracks are views owned by someone else (e.g. tracks
+  /// over a memory-mapped file) and must not be deleted with the event
+  bool ownsTracks() const                       { return mOwnsTracks; }
+
+  /// Columnar view of the track collection used by the batched track cuts.
+  /// It is built on the first request and reused by all analyses. Call
+  /// invalidateTrackBatch() if the track collection is modified afterwards.
+  const StHbtTrackBatch& trackBatch() const;
+  void invalidateTrackBatch()                   { mTrackBatchValid = false; }
+  /// Selection mask of the cut over trackBatch(). The cut is evaluated with
+  /// passBatch() on the first request only, and the mask is shared by all
+  /// users of the same cut object for this event (writers, analyses).
+  /// Each request adds the mask to the cut counters (countBatch), so the
+  /// counters are incremented once per user as with pass().
+  /// The returned reference stays valid until the track batch is rebuilt
+  /// or the event is reset (requests for other cuts do not move it).
+  const StHbtSelectionMask& trackSelection(StHbtTrackCut* cut) const;
   
   /**
    * Setters
@@ -151,6 +186,12 @@ class StHbtEvent {
   void addTriggerId(const unsigned int& id);
   void setL3TriggerAlgorithm(const unsigned int& i, const unsigned int& t)
   { mL3TriggerAlgorithm[i] = t; }
+  /// Set to false if the tracks added to the collection are not owned by
+  /// the event. Copies made from the event always own their tracks
+  void setOwnsTracks(const bool& owns)          { mOwnsTracks = owns; }
+
+  /// Direct access to the stored fields for the columnar binary format
+  friend class StHbtBinaryEventFormat;
 
  private:
 
@@ -201,6 +242,19 @@ class StHbtEvent {
   StHbtV0Collection* mV0Collection;
   StHbtXiCollection* mXiCollection;
   StHbtKinkCollection* mKinkCollection;
+
+  /// Copy header (everything except collections) from ev
+  void copyHeader(const StHbtEvent& ev);
+
+  /// Tracks are deleted with the event
+  bool mOwnsTracks;                    //!
+
+  /// Columnar track view (built on demand)
+  mutable StHbtTrackBatch mTrackBatch; //!
+  mutable bool mTrackBatchValid;       //!
+  /// Selection masks of the track cuts over mTrackBatch (a deque keeps
+  /// the masks in place when a new cut is added)
+  mutable std::deque< std::pair<StHbtTrackCut*, StHbtSelectionMask> > mTrackSelections; //!
 };
 
 #endif // StHbtEvent_h
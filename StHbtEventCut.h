@@ -12,9 +12,11 @@
 /// Forward declarations
 class StHbtEvent;
 class StHbtBaseAnalysis;
+class StHbtCheckpoint;
 
 /// StHbtMaker headers
 #include "StHbtCutMonitorHandler.h"
+#include "StHbtEventPreFilter.h"
 #include "StHbtString.h"
 
 /// ROOT headers
@@ -61,6 +63,17 @@ class StHbtEventCut : public StHbtCutMonitorHandler {
   /// Default clone
   virtual StHbtEventCut* clone()         { return nullptr; }
 
+  /// Express the cut (or a looser version of it) as windows on the event
+  /// header, so that the reader can reject events before building their
+  /// collections. Return false if the cut can not be expressed this way:
+  /// the reader then accepts all events (default)
+  virtual bool fillPreFilterClause(StHbtEventPreFilter::Clause&) const { return false; }
+
+  /// Save and restore the internal state (e.g. counters) of the cut for
+  /// checkpointing. Histograms of the cut monitors are stored by the analysis
+  virtual void writeCheckpoint(StHbtCheckpoint&) const { /* no-op */ }
+  virtual bool readCheckpoint(StHbtCheckpoint&)        { return true; }
+
   /// The following allows "back-pointing" from the CorrFctn
   ///to the "parent" Analysis
   friend class StHbtBaseAnalysis;
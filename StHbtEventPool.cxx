@@ -0,0 +1,120 @@
+/**
+ * Description: Pool of recycled StHbtEvent and StHbtTrack objects.
+ */
+
+/// StHbtMaker headers
+#include "StHbtEvent.h"
+#include "StHbtTrack.h"
+#include "StHbtEventPool.h"
+
+//_________________
+StHbtEventPool::StHbtEventPool(const unsigned int& maxEvents,
+			       const unsigned int& maxTracks) :
+  mEvents(), mTracks(), mMaxEvents(maxEvents), mMaxTracks(maxTracks),
+  mNEventsCreated(0), mNEventsReused(0), mNTracksCreated(0), mNTracksReused(0) {
+  mEvents.reserve( mMaxEvents );
+}
+
+//_________________
+StHbtEventPool::~StHbtEventPool() {
+  for ( unsigned int iEvent=0; iEvent<mEvents.size(); iEvent++ ) {
+    delete mEvents[iEvent];
+  }
+  mEvents.clear();
+  for ( unsigned int iTrack=0; iTrack<mTracks.size(); iTrack++ ) {
+    delete mTracks[iTrack];
+  }
+  mTracks.clear();
+}
+
+//_________________
+StHbtEvent* StHbtEventPool::acquireEvent() {
+  {
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( !mEvents.empty() ) {
+      StHbtEvent *event = mEvents.back();
+      mEvents.pop_back();
+      mNEventsReused++;
+      return event;
+    }
+    mNEventsCreated++;
+  }
+  return new StHbtEvent();
+}
+
+//_________________
+StHbtTrack* StHbtEventPool::acquireTrack() {
+  {
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( !mTracks.empty() ) {
+      StHbtTrack *track = mTracks.back();
+      mTracks.pop_back();
+      mNTracksReused++;
+      return track;
+    }
+    mNTracksCreated++;
+  }
+  return new StHbtTrack();
+}
+
+//_________________
+void StHbtEventPool::releaseTrack(StHbtTrack* track) {
+  if ( !track ) return;
+
+  /// Reset outside of the lock
+  *track = StHbtTrack();
+
+  {
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( mTracks.size() < mMaxTracks ) {
+      mTracks.push_back( track );
+      return;
+    }
+  }
+  delete track;
+}
+
+//_________________
+void StHbtEventPool::releaseEvent(StHbtEvent* event) {
+  if ( !event ) return;
+
+  /// Take the tracks out of the event first, so that clear()
+  /// deletes only V0s, Xis and kinks. Tracks not owned by the
+  /// event are only unlinked
+  StHbtTrackCollection *tracks = event->trackCollection();
+  if ( !event->ownsTracks() ) {
+    tracks->clear();
+  }
+  const StHbtTrack defaultTrack;
+  for ( StHbtTrackIterator iter=tracks->begin(); iter!=tracks->end(); iter++ ) {
+    **iter = defaultTrack;
+  }
+
+  std::vector<StHbtTrack*> overflow;
+  {
+    std::lock_guard<std::mutex> lock( mMutex );
+    for ( StHbtTrackIterator iter=tracks->begin(); iter!=tracks->end(); iter++ ) {
+      if ( mTracks.size() < mMaxTracks ) {
+	mTracks.push_back( *iter );
+      }
+      else {
+	overflow.push_back( *iter );
+      }
+    }
+  }
+  tracks->clear();
+  for ( unsigned int iTrack=0; iTrack<overflow.size(); iTrack++ ) {
+    delete overflow[iTrack];
+  }
+
+  event->clear();
+
+  {
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( mEvents.size() < mMaxEvents ) {
+      mEvents.push_back( event );
+      return;
+    }
+  }
+  delete event;
+}
@@ -0,0 +1,72 @@
+/**
+ * Description: Pool of recycled StHbtEvent and StHbtTrack objects.
+ *
+ * Readers acquire events and tracks from the pool instead of creating them
+ * with new, and the manager releases processed events back to it instead
+ * of deleting them. A released event gives its tracks back to the track
+ * pool, its header is reset to the default values and its collections are
+ * emptied (the columnar track batch keeps its capacity), so the next event
+ * is filled without allocating the event, the collections or the tracks.
+ * V0s, Xis and kinks are deleted as before.
+ *
+ * Acquire and release may be called from different threads (e.g. with
+ * StHbtPrefetchReader): the pool is protected by a mutex.
+ */
+
+#ifndef StHbtEventPool_h
+#define StHbtEventPool_h
+
+/// C++ headers
+#include <vector>
+#include <mutex>
+
+/// Forward declarations
+class StHbtEvent;
+class StHbtTrack;
+
+//_________________
+class StHbtEventPool {
+
+ public:
+  /// Constructor. Keeps at most maxEvents events and maxTracks tracks,
+  /// the objects released above these limits are deleted
+  StHbtEventPool(const unsigned int& maxEvents = 8, const unsigned int& maxTracks = 50000);
+  /// Destructor. Deletes all pooled objects
+  ~StHbtEventPool();
+
+  /// Return an event with the default header and empty collections
+  StHbtEvent* acquireEvent();
+  /// Return a track with default values
+  StHbtTrack* acquireTrack();
+  /// Give the event and all its tracks back to the pool
+  void releaseEvent(StHbtEvent* event);
+  /// Give the track back to the pool
+  void releaseTrack(StHbtTrack* track);
+
+  /// Number of objects created by the pool and number of reused ones
+  unsigned long nEventsCreated() const   { return mNEventsCreated; }
+  unsigned long nEventsReused() const    { return mNEventsReused; }
+  unsigned long nTracksCreated() const   { return mNTracksCreated; }
+  unsigned long nTracksReused() const    { return mNTracksReused; }
+
+ private:
+  /// Not copyable: the pool owns its objects
+  StHbtEventPool(const StHbtEventPool&);
+  StHbtEventPool& operator=(const StHbtEventPool&);
+
+  /// Free objects
+  std::vector<StHbtEvent*> mEvents;
+  std::vector<StHbtTrack*> mTracks;
+  /// Limits
+  unsigned int mMaxEvents;
+  unsigned int mMaxTracks;
+  /// Statistics
+  unsigned long mNEventsCreated;
+  unsigned long mNEventsReused;
+  unsigned long mNTracksCreated;
+  unsigned long mNTracksReused;
+  /// Protects the free lists
+  std::mutex mMutex;
+};
+
+#endif // #define StHbtEventPool_h
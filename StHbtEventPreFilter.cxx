@@ -0,0 +1,106 @@
+/**
+ * Description: Event-level predicate evaluated by the reader on header
+ *              quantities before any track collection is built.
+ */
+
+/// C++ headers
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+/// StHbtMaker headers
+#include "StHbtEventPreFilter.h"
+
+/// ROOT headers
+#include "TString.h"
+
+//_________________
+StHbtEventPreFilter::Clause::Clause() : mVertXShift(0), mVertYShift(0) {
+  mRefMult[0] = std::numeric_limits<int>::min();
+  mRefMult[1] = std::numeric_limits<int>::max();
+  mVertZPos[0] = mVertRPos[0] = mVpdVzDiff[0] = -std::numeric_limits<float>::max();
+  mVertZPos[1] = mVertRPos[1] = mVpdVzDiff[1] = std::numeric_limits<float>::max();
+}
+
+//_________________
+bool StHbtEventPreFilter::Clause::pass(const unsigned int& runNumber,
+				       const std::vector<unsigned int>& triggerIds,
+				       const int& refMult,
+				       const float& vx, const float& vy, const float& vz,
+				       const float& vpdVzDiff) const {
+
+  /// The cheapest and most selective windows go first
+  if ( vz < mVertZPos[0] || vz > mVertZPos[1] ) return false;
+  if ( refMult < mRefMult[0] || refMult > mRefMult[1] ) return false;
+  if ( vpdVzDiff < mVpdVzDiff[0] || vpdVzDiff > mVpdVzDiff[1] ) return false;
+
+  const float vtxR = std::sqrt( (vx - mVertXShift) * (vx - mVertXShift) +
+				(vy - mVertYShift) * (vy - mVertYShift) );
+  if ( vtxR < mVertRPos[0] || vtxR > mVertRPos[1] ) return false;
+
+  if ( std::binary_search( mBadRuns.begin(), mBadRuns.end(), (int)runNumber ) ) return false;
+
+  if ( mTriggerIds.empty() ) return true;
+  for ( unsigned int iIter=0; iIter<triggerIds.size(); iIter++ ) {
+    if ( std::binary_search( mTriggerIds.begin(), mTriggerIds.end(), triggerIds[iIter] ) ) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//_________________
+StHbtEventPreFilter::StHbtEventPreFilter() : mClauses(), mAcceptAll(false) {
+  /* empty */
+}
+
+//_________________
+StHbtEventPreFilter::Clause& StHbtEventPreFilter::addClause() {
+  mClauses.push_back( Clause() );
+  return mClauses.back();
+}
+
+//_________________
+void StHbtEventPreFilter::reset() {
+  mClauses.clear();
+  mAcceptAll = false;
+}
+
+//_________________
+bool StHbtEventPreFilter::pass(const unsigned int& runNumber,
+			       const std::vector<unsigned int>& triggerIds,
+			       const int& refMult,
+			       const float& vx, const float& vy, const float& vz,
+			       const float& vpdVzDiff) const {
+  if ( !isActive() ) return true;
+  for ( unsigned int iClause=0; iClause<mClauses.size(); iClause++ ) {
+    if ( mClauses[iClause].pass( runNumber, triggerIds, refMult,
+				 vx, vy, vz, vpdVzDiff ) ) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//_________________
+StHbtString StHbtEventPreFilter::report() const {
+  TString report;
+  if ( !isActive() ) {
+    report += "Event pre-filter: accepts all events\n";
+  }
+  else {
+    report += TString::Format( "Event pre-filter: %u clause(s)\n",
+			       (unsigned int)mClauses.size() );
+    for ( unsigned int iClause=0; iClause<mClauses.size(); iClause++ ) {
+      const Clause& c = mClauses[iClause];
+      report += TString::Format( " [%u] refMult: %d - %d vz: %4.2f - %4.2f vr: %4.2f - %4.2f",
+				 iClause, c.mRefMult[0], c.mRefMult[1],
+				 c.mVertZPos[0], c.mVertZPos[1],
+				 c.mVertRPos[0], c.mVertRPos[1] );
+      report += TString::Format( " triggers: %u bad runs: %u\n",
+				 (unsigned int)c.mTriggerIds.size(),
+				 (unsigned int)c.mBadRuns.size() );
+    }
+  }
+  return StHbtString( (const char *)report );
+}
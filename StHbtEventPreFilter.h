@@ -0,0 +1,102 @@
+/**
+ * Description: Event-level predicate evaluated by the reader on header
+ *              quantities before any track collection is built.
+ *
+ * The filter is an OR of clauses, one clause per analysis. Each clause is
+ * an AND of windows on the event header: run number (bad runs), trigger
+ * ids, reference multiplicity, primary vertex position and (Vz - VpdVz).
+ * An event that fails every clause can not pass any of the analysis event
+ * cuts, so the reader may skip it without building tracks, V0s, Xis and
+ * kinks. The filter is only a superset of the event cuts: every event that
+ * passes it is still checked by the full event cut of each analysis.
+ *
+ * A filter without clauses accepts every event. A filter marked with
+ * acceptAll() also accepts every event (used when at least one analysis
+ * has an event cut that can not be expressed on the header).
+ */
+
+#ifndef StHbtEventPreFilter_h
+#define StHbtEventPreFilter_h
+
+/// C++ headers
+#include <vector>
+
+/// StHbtMaker headers
+#include "StHbtString.h"
+
+//_________________
+class StHbtEventPreFilter {
+
+ public:
+
+  /// Conjunction of header windows of one analysis. Default windows
+  /// accept every event
+  struct Clause {
+    /// Default constructor
+    Clause();
+
+    /// Set min and max reference multiplicity
+    void setRefMult(const int& lo, const int& hi)         { mRefMult[0] = lo; mRefMult[1] = hi; }
+    /// Set min and max z-position of the primary vertex
+    void setVertZPos(const float& lo, const float& hi)    { mVertZPos[0] = lo; mVertZPos[1] = hi; }
+    /// Set min and max radial position of the primary vertex measured
+    /// from the point (xShift, yShift)
+    void setVertRPos(const float& lo, const float& hi,
+		     const float& xShift, const float& yShift)
+    { mVertRPos[0] = lo; mVertRPos[1] = hi; mVertXShift = xShift; mVertYShift = yShift; }
+    /// Set min and max (Vz - VpdVz)
+    void setVpdVzDiff(const float& lo, const float& hi)   { mVpdVzDiff[0] = lo; mVpdVzDiff[1] = hi; }
+    /// Triggers to select (any trigger if empty). The list must be sorted
+    void setTriggerIds(const std::vector<unsigned int>& ids) { mTriggerIds = ids; }
+    /// Runs to reject. The list must be sorted
+    void setBadRuns(const std::vector<int>& runs)         { mBadRuns = runs; }
+
+    /// True if the header falls within all windows
+    bool pass(const unsigned int& runNumber, const std::vector<unsigned int>& triggerIds,
+	      const int& refMult, const float& vx, const float& vy, const float& vz,
+	      const float& vpdVzDiff) const;
+
+    int mRefMult[2];
+    float mVertZPos[2];
+    float mVertRPos[2];
+    float mVertXShift;
+    float mVertYShift;
+    float mVpdVzDiff[2];
+    std::vector<unsigned int> mTriggerIds;
+    std::vector<int> mBadRuns;
+  };
+
+  /// Default constructor (accepts every event)
+  StHbtEventPreFilter();
+  /// Default destructor
+  ~StHbtEventPreFilter()                                  { /* empty */ }
+
+  /// Add new clause (one per analysis) and return reference to it
+  Clause& addClause();
+  /// Make the filter accept every event
+  void acceptAll()                                        { mAcceptAll = true; }
+  /// Remove all clauses and the accept-all flag
+  void reset();
+
+  /// False if the filter accepts every event
+  bool isActive() const                     { return !mAcceptAll && !mClauses.empty(); }
+  /// Number of clauses
+  unsigned int numberOfClauses() const      { return mClauses.size(); }
+
+  /// True if at least one clause accepts the header
+  bool pass(const unsigned int& runNumber, const std::vector<unsigned int>& triggerIds,
+	    const int& refMult, const float& vx, const float& vy, const float& vz,
+	    const float& vpdVzDiff) const;
+
+  /// Short description of the filter
+  StHbtString report() const;
+
+ private:
+
+  /// Clauses (ORed)
+  std::vector<Clause> mClauses;
+  /// Accept every event
+  bool mAcceptAll;
+};
+
+#endif // #define StHbtEventPreFilter_h
@@ -6,6 +6,8 @@
 
 /// StHbtMaker headers
 #include "StHbtEvent.h"
+#include "StHbtTrack.h"
+#include "StHbtEventPool.h"
 #include "StHbtEventCut.h"
 #include "StHbtTrackCut.h"
 #include "StHbtV0Cut.h"
@@ -20,7 +22,8 @@ ClassImp(StHbtEventReader)
 //_________________
 StHbtEventReader::StHbtEventReader() : mEventCut(nullptr),
   mTrackCut(nullptr),   mV0Cut(nullptr), mXiCut(nullptr), mKinkCut(nullptr),
-  mReaderStatus(0), mDebug(1) {
+  mReaderStatus(0), mDebug(1), mEventPool(nullptr), mPreFilter(),
+  mNEventsPreFiltered(0) {
   /* no-op */
 }
 
@@ -28,10 +31,16 @@ StHbtEventReader::StHbtEventReader() : mEventCut(nullptr),
 StHbtEventReader::StHbtEventReader(const StHbtEventReader &copy) :
   mEventCut( copy.mEventCut ), mTrackCut( copy.mTrackCut ),
   mV0Cut( copy.mV0Cut ), mXiCut( copy.mXiCut ), mKinkCut( copy.mKinkCut ),
-  mReaderStatus( copy.mReaderStatus ), mDebug( copy.mDebug ) {
+  mReaderStatus( copy.mReaderStatus ), mDebug( copy.mDebug ),
+  mEventPool( nullptr ), mPreFilter( copy.mPreFilter ), mNEventsPreFiltered( 0 ) {
   /* no-op */
 }
 
+//_________________
+StHbtEventReader::~StHbtEventReader() {
+  delete mEventPool;
+}
+
 //_________________
 StHbtEventReader& StHbtEventReader::operator=(const StHbtEventReader& aReader) {
 
@@ -43,6 +52,8 @@ StHbtEventReader& StHbtEventReader::operator=(const StHbtEventReader& aReader) {
     mKinkCut  = aReader.mKinkCut;
     mReaderStatus = aReader.mReaderStatus;
     mDebug = aReader.mDebug;
+    mPreFilter = aReader.mPreFilter;
+    mNEventsPreFiltered = 0;
   }
 
   return *this;
@@ -87,6 +98,8 @@ StHbtString StHbtEventReader::report() {
   else {
     temp += "NONE";
   }
+  temp += "\n---> ";
+  temp += mPreFilter.report();
   temp += "\n";
   return temp;
 }
@@ -143,3 +156,58 @@ StHbtKinkCut* StHbtEventReader::kinkCut() {
 }
 
 
+
+//_________________
+bool StHbtEventReader::passPreFilter(const unsigned int& runNumber,
+				     const std::vector<unsigned int>& triggerIds,
+				     const int& refMult,
+				     const float& vx, const float& vy, const float& vz,
+				     const float& vpdVzDiff) {
+  if ( mPreFilter.pass( runNumber, triggerIds, refMult, vx, vy, vz, vpdVzDiff ) ) {
+    return true;
+  }
+  mNEventsPreFiltered++;
+  return false;
+}
+
+//_________________
+void StHbtEventReader::enableEventPool(const unsigned int& maxEvents,
+				       const unsigned int& maxTracks) {
+  delete mEventPool;
+  mEventPool = new StHbtEventPool( maxEvents, maxTracks );
+}
+
+//_________________
+void StHbtEventReader::releaseHbtEvent(StHbtEvent* event) {
+  if ( mEventPool ) {
+    mEventPool->releaseEvent( event );
+  }
+  else {
+    delete event;
+  }
+}
+
+//_________________
+unsigned int StHbtEventReader::skipEvents(const unsigned int& nEvents) {
+  unsigned int nSkipped = 0;
+  while ( nSkipped < nEvents ) {
+    StHbtEvent *event = returnHbtEvent();
+    if ( !event ) {
+      if ( status() ) break;
+      continue;
+    }
+    releaseHbtEvent( event );
+    nSkipped++;
+  }
+  return nSkipped;
+}
+
+//_________________
+StHbtEvent* StHbtEventReader::newHbtEvent() {
+  return mEventPool ? mEventPool->acquireEvent() : new StHbtEvent();
+}
+
+//_________________
+StHbtTrack* StHbtEventReader::newHbtTrack() {
+  return mEventPool ? mEventPool->acquireTrack() : new StHbtTrack();
+}
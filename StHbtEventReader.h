@@ -9,9 +9,12 @@
 
 /// C++ headers
 #include <iostream>
+#include <vector>
 
 /// Forward declarations
 class StHbtEvent;
+class StHbtTrack;
+class StHbtEventPool;
 class StHbtEventCut;
 class StHbtTrackCut;
 class StHbtV0Cut;
@@ -20,6 +23,7 @@ class StHbtKinkCut;
 
 /// StHbtMaker headers
 #include "StHbtString.h"
+#include "StHbtEventPreFilter.h"
 
 //_________________
 class StHbtEventReader {
@@ -48,9 +52,10 @@ class StHbtEventReader {
   
   /// Destructor
   ///
-  /// No members are deleted - it is up to the entity creating the cuts to
-  /// delete them after the event reader has run its course
-  virtual ~StHbtEventReader()  { /* no-op */ }
+  /// No cuts are deleted - it is up to the entity creating the cuts to
+  /// delete them after the event reader has run its course. The event
+  /// pool (if enabled) is owned by the reader and deleted
+  virtual ~StHbtEventReader();
 
   /// Concrete subclasses MUST implement this method, which creates the StHbtEvent
   virtual StHbtEvent* returnHbtEvent() =0;
@@ -70,6 +75,23 @@ class StHbtEventReader {
   
   virtual void finish()         { /*no-op*/ }
 
+  /// Give the processed event back to the reader. StHbtManager calls it
+  /// instead of deleting the event: the event is returned to the event pool
+  /// if the pool is enabled and deleted otherwise
+  virtual void releaseHbtEvent(StHbtEvent* event);
+
+  /// Read and release the next nEvents events (null returns with status 0
+  /// are not counted). Used to resume a job from a checkpoint. Returns the
+  /// number of events skipped, smaller than nEvents at the end of input
+  virtual unsigned int skipEvents(const unsigned int& nEvents);
+
+  /// Recycle events and tracks instead of creating and deleting them for
+  /// every event. Readers that create their events and tracks with
+  /// newHbtEvent() and newHbtTrack() benefit from it, others are unaffected
+  void enableEventPool(const unsigned int& maxEvents = 8,
+		       const unsigned int& maxTracks = 50000);
+  StHbtEventPool* eventPool()   { return mEventPool; }
+
   /// StHbtManager looks at this for guidance if it gets null pointer from ReturnHbtEvent
   int status()                  { return mReaderStatus; } 
 
@@ -85,6 +107,23 @@ class StHbtEventReader {
   virtual StHbtXiCut*    xiCut();
   virtual StHbtKinkCut*  kinkCut();
 
+  /**
+   * Event pre-filter (predicate pushdown)
+   *
+   * StHbtManager::init() hands the union of the event cuts of all analyses
+   * to the reader via setPreFilter(). A reader that supports it reads the
+   * event header first, calls passPreFilter() and, if it returns false,
+   * skips the event without building the track, V0, Xi and kink
+   * collections: returnHbtEvent() then returns nullptr and leaves the
+   * status at 0 (try again), exactly as for events rejected by the
+   * reader's own cuts. Readers that ignore the pre-filter keep working
+   * unchanged, since each analysis still applies its full event cut.
+   **/
+  virtual void setPreFilter(const StHbtEventPreFilter& filter) { mPreFilter = filter; }
+  const StHbtEventPreFilter& preFilter() const                 { return mPreFilter; }
+  /// Number of events rejected by the pre-filter
+  unsigned int nEventsPreFiltered() const                      { return mNEventsPreFiltered; }
+
   /**
    * Controls the amount of debug information printed.
    * The code indicates which functions should print debug statements:
@@ -113,6 +152,25 @@ class StHbtEventReader {
   int mReaderStatus;
   int mDebug;
 
+  /// Check the event header against the pre-filter and count rejections
+  bool passPreFilter(const unsigned int& runNumber,
+		     const std::vector<unsigned int>& triggerIds,
+		     const int& refMult,
+		     const float& vx, const float& vy, const float& vz,
+		     const float& vpdVzDiff);
+
+  /// New (or recycled, if the pool is enabled) event and track
+  StHbtEvent* newHbtEvent();
+  StHbtTrack* newHbtTrack();
+
+  /// Pool of recycled events and tracks (owned, not copied)
+  StHbtEventPool *mEventPool;                       //!
+
+  /// Union of the event cuts of all analyses
+  StHbtEventPreFilter mPreFilter;                   //!
+  /// Number of events rejected by the pre-filter
+  unsigned int mNEventsPreFiltered;                 //!
+
 #ifdef __ROOT__
   ClassDef(StHbtEventReader,0)
 #endif
@@ -61,6 +61,17 @@ StHbtHelix::StHbtHelix(const StHbtHelix &h) {
   mSinPhase = h.mSinPhase;
 }
 
+//_________________
+StHbtHelix::StHbtHelix(const StHbtHelixParameters& helix) :
+  mSingularity(helix.mSingularity),
+  mOrigin(helix.mOriginX, helix.mOriginY, helix.mOriginZ),
+  mDipAngle(helix.mDipAngle), mCurvature(helix.mCurvature),
+  mPhase(helix.mPhase), mH(helix.mH),
+  mCosDipAngle(helix.mCosDipAngle), mSinDipAngle(helix.mSinDipAngle),
+  mCosPhase(helix.mCosPhase), mSinPhase(helix.mSinPhase) {
+  /*no-op*/
+}
+
 //_________________
 StHbtHelix::~StHbtHelix() { /* noop */ };
 
@@ -180,118 +191,211 @@ double StHbtHelix::fudgePathLength(const TVector3& p) const {
 }
 
 //_________________
-double StHbtHelix::distance(const TVector3& p, bool scanPeriods) const {
-  return ( this->at( pathLength(p,scanPeriods) )-p ).Mag();
+double StHbtHelix::pathLength(const StHbtHelixParameters& helix,
+			      const double& x, const double& y) {
+  
+  double dx = x-helix.mOriginX;
+  double dy = y-helix.mOriginY;
+
+  if (helix.mSingularity) {
+    return (dy*helix.mCosPhase - dx*helix.mSinPhase)/helix.mCosDipAngle;
+  }
+  else {
+    return atan2(dy*helix.mCosPhase - dx*helix.mSinPhase,
+		 1/helix.mCurvature + dx*helix.mCosPhase + dy*helix.mSinPhase)/
+      (helix.mH*helix.mCurvature*helix.mCosDipAngle);
+  }
 }
 
 //_________________
-double StHbtHelix::pathLength(const TVector3& p, bool scanPeriods) const {
-  
+StHbtHelixParameters StHbtHelix::parameters() const {
+  StHbtHelixParameters helix;
+  helix.mOriginX = mOrigin.x();
+  helix.mOriginY = mOrigin.y();
+  helix.mOriginZ = mOrigin.z();
+  helix.mCurvature = mCurvature;
+  helix.mDipAngle = mDipAngle;
+  helix.mPhase = mPhase;
+  helix.mCosDipAngle = mCosDipAngle;
+  helix.mSinDipAngle = mSinDipAngle;
+  helix.mCosPhase = mCosPhase;
+  helix.mSinPhase = mSinPhase;
+  helix.mXCenter = xcenter();
+  helix.mYCenter = ycenter();
+  helix.mH = mH;
+  helix.mSingularity = mSingularity;
+  return helix;
+}
+
+//_________________
+double StHbtHelix::pathLength(const StHbtHelixParameters& helix,
+			      const double& x, const double& y, const double& z,
+			      bool scanPeriods) {
+
   //
-  //  Returns the path length at the distance of closest 
-  //  approach between the helix and point p. 
+  //  Returns the path length at the distance of closest
+  //  approach between the helix and the point.
   //  For the case of B=0 (straight line) the path length
   //  can be calculated analytically. For B>0 there is
   //  unfortunately no easy solution to the problem.
   //  Here we use the Newton method to find the root of the
-  //  referring equation. The 'fudgePathLength' serves
+  //  referring equation. The dca in the xy-plane serves
   //  as a starting value.
   //
-  
-  double s;
-  double dx = p.x()-mOrigin.x();
-  double dy = p.y()-mOrigin.y();
-  double dz = p.z()-mOrigin.z();
+  double dx = x-helix.mOriginX;
+  double dy = y-helix.mOriginY;
+  double dz = z-helix.mOriginZ;
 
-  if (mSingularity) {
-    s = mCosDipAngle*(mCosPhase*dy-mSinPhase*dx) +
-      mSinDipAngle*dz;
+  if (helix.mSingularity) {
+    return ( helix.mCosDipAngle*(helix.mCosPhase*dy - helix.mSinPhase*dx) +
+	     helix.mSinDipAngle*dz );
   }
-  else {
-#ifndef ST_NO_NUMERIC_LIMITS
-    {
-      using namespace units;
-#endif
-      const double MaxPrecisionNeeded = micrometer;
-      const int    MaxIterations      = 100;
 
-      //
-      // The math is taken from Maple with C(expr,optimized) and
-      // some hand-editing. It is not very nice but efficient.
-      //
-      double t34 = mCurvature*mCosDipAngle*mCosDipAngle;
-      double t41 = mSinDipAngle*mSinDipAngle;
-      double t6, t7, t11, t12, t19;
-      
-      //
-      // Get a first guess by using the dca in 2D. Since
-      // in some extreme cases we might be off by n periods
-      // we add (subtract) periods in case we get any closer.
-      // 
-      s = fudgePathLength(p);
+  const double MaxPrecisionNeeded = micrometer;
+  const int    MaxIterations      = kMaxIterations;
 
-      if (scanPeriods) {
-      
-	double ds = period();
-	int    j;
-	int jmin = 0;
-	double d;
-	double dmin = ( at(s) - p).Mag() ;
-      
-	for(j=1; j<MaxIterations; j++) {
-	  d = ( at(s+j*ds) - p ).Mag();
-	  if ( d  < dmin) {
-	    dmin = d;
-	    jmin = j;
-	  }
-	  else {
-	    break;
-	  }
-	} //for(j=1; j<MaxIterations; j++)
-      
-	for(j=-1; -j<MaxIterations; j--) {
-	  d = ( at(s+j*ds ) - p ).Mag() ;
-	  if ( d < dmin) {
-	    dmin = d;
-	    jmin = j;
-	  }
-	  else {
-	    break;
-	  }
-	} //for(j=-1; -j<MaxIterations; j--)
-      
-	if (jmin) {
-	  s += jmin*ds;
-	}
-      } //if (scanPeriods)
-	    
-      //
-      // Newtons method:
-      // Stops after MaxIterations iterations or if the required
-      // precision is obtained. Whatever comes first.
-      //
-      double sOld = s;
-      for (int i=0; i<MaxIterations; i++) {
-	t6  = mPhase+s*mH*mCurvature*mCosDipAngle;
-	t7  = cos(t6);
-	t11 = dx-(1/mCurvature)*(t7-mCosPhase);
-	t12 = sin(t6);
-	t19 = dy-(1/mCurvature)*(t12-mSinPhase);
-	s  -= (t11*t12*mH*mCosDipAngle-t19*t7*mH*mCosDipAngle -
-	       (dz-s*mSinDipAngle)*mSinDipAngle)/
-	  (t12*t12*mCosDipAngle*mCosDipAngle+t11*t7*t34 +
-	   t7*t7*mCosDipAngle*mCosDipAngle +
-	   t19*t12*t34+t41);
-	if (fabs(sOld-s) < MaxPrecisionNeeded) break;
-	sOld = s;
-      } //for (int i=0; i<MaxIterations; i++)
-#ifndef ST_NO_NUMERIC_LIMITS
+  //
+  // Get a first guess by using the dca in 2D. Since
+  // in some extreme cases we might be off by n periods
+  // we add (subtract) periods in case we get any closer.
+  //
+  double s = pathLength(helix, x, y);
+  double hx, hy, hz;
+
+  if (scanPeriods) {
+
+    double ds = fabs(2*M_PI/(helix.mH*helix.mCurvature*helix.mCosDipAngle));
+    int j;
+    int jmin = 0;
+    double d;
+    at(helix, s, hx, hy, hz);
+    double dmin = ::sqrt( (hx-x)*(hx-x) + (hy-y)*(hy-y) + (hz-z)*(hz-z) );
+
+    for(j=1; j<MaxIterations; j++) {
+      at(helix, s+j*ds, hx, hy, hz);
+      d = ::sqrt( (hx-x)*(hx-x) + (hy-y)*(hy-y) + (hz-z)*(hz-z) );
+      if ( d < dmin ) {
+	dmin = d;
+	jmin = j;
+      }
+      else {
+	break;
+      }
+    } //for(j=1; j<MaxIterations; j++)
+
+    for(j=-1; -j<MaxIterations; j--) {
+      at(helix, s+j*ds, hx, hy, hz);
+      d = ::sqrt( (hx-x)*(hx-x) + (hy-y)*(hy-y) + (hz-z)*(hz-z) );
+      if ( d < dmin ) {
+	dmin = d;
+	jmin = j;
+      }
+      else {
+	break;
+      }
+    } //for(j=-1; -j<MaxIterations; j--)
+
+    if (jmin) {
+      s += jmin*ds;
     }
-#endif
-  } //else
+  } //if (scanPeriods)
+
+  //
+  // Newtons method:
+  // Stops after MaxIterations iterations or if the required
+  // precision is obtained. Whatever comes first.
+  // The math is taken from Maple with C(expr,optimized) and
+  // some hand-editing. It is not very nice but efficient.
+  //
+  double t34 = helix.mCurvature*helix.mCosDipAngle*helix.mCosDipAngle;
+  double t41 = helix.mSinDipAngle*helix.mSinDipAngle;
+  double t6, t7, t11, t12, t19;
+  double sOld = s;
+  for (int i=0; i<MaxIterations; i++) {
+    t6  = helix.mPhase+s*helix.mH*helix.mCurvature*helix.mCosDipAngle;
+    t7  = cos(t6);
+    t11 = dx-(1/helix.mCurvature)*(t7-helix.mCosPhase);
+    t12 = sin(t6);
+    t19 = dy-(1/helix.mCurvature)*(t12-helix.mSinPhase);
+    s  -= (t11*t12*helix.mH*helix.mCosDipAngle-t19*t7*helix.mH*helix.mCosDipAngle -
+	   (dz-s*helix.mSinDipAngle)*helix.mSinDipAngle)/
+      (t12*t12*helix.mCosDipAngle*helix.mCosDipAngle+t11*t7*t34 +
+       t7*t7*helix.mCosDipAngle*helix.mCosDipAngle +
+       t19*t12*t34+t41);
+    if (fabs(sOld-s) < MaxPrecisionNeeded) break;
+    sOld = s;
+  } //for (int i=0; i<MaxIterations; i++)
+  return s;
+}
+
+//_________________
+double StHbtHelix::distance(const StHbtHelixParameters& helix,
+			    const double& x, const double& y, const double& z,
+			    bool scanPeriods) {
+  double hx, hy, hz;
+  at(helix, pathLength(helix, x, y, z, scanPeriods), hx, hy, hz);
+  return ::sqrt( (hx-x)*(hx-x) + (hy-y)*(hy-y) + (hz-z)*(hz-z) );
+}
+
+//_________________
+double StHbtHelix::fastPathLength(const StHbtHelixParameters& helix,
+				  const double& x, const double& y, const double& z) {
+
+  if (helix.mSingularity) {
+    return pathLength(helix, x, y, z, false);
+  }
+
+  //
+  //  The dca in 2D moved to the turn that is closest in z: for a point
+  //  near the circle all turns have the same distance in the xy-plane,
+  //  which is where the period scan ends as well
+  //
+  double s = pathLength(helix, x, y);
+  double ds = fabs(2*M_PI/(helix.mH*helix.mCurvature*helix.mCosDipAngle));
+  double pitch = ds*helix.mSinDipAngle;
+  if (pitch != 0) {
+    s += ds*::floor( (z - helix.mOriginZ - s*helix.mSinDipAngle)/pitch + 0.5 );
+  }
+
+  //
+  //  Fixed number of Newton steps on the projection of the vector from
+  //  the point to the helix on the direction of the helix
+  //
+  double rate = helix.mH*helix.mCurvature*helix.mCosDipAngle;
+  double t34 = helix.mCurvature*helix.mCosDipAngle*helix.mCosDipAngle;
+  for (int i=0; i<kFastIterations; i++) {
+    double phase = helix.mPhase + s*rate;
+    double cosPhase = cos(phase);
+    double sinPhase = sin(phase);
+    double ddx = helix.mXCenter + cosPhase/helix.mCurvature - x;
+    double ddy = helix.mYCenter + sinPhase/helix.mCurvature - y;
+    double ddz = helix.mOriginZ + s*helix.mSinDipAngle - z;
+    double g = ( helix.mH*helix.mCosDipAngle*(ddy*cosPhase - ddx*sinPhase) +
+		 ddz*helix.mSinDipAngle );
+    double gPrime = 1. - t34*(ddx*cosPhase + ddy*sinPhase);
+    s -= g/gPrime;
+  }
   return s;
 }
 
+//_________________
+double StHbtHelix::fastDistance(const StHbtHelixParameters& helix,
+				const double& x, const double& y, const double& z) {
+  double hx, hy, hz;
+  at(helix, fastPathLength(helix, x, y, z), hx, hy, hz);
+  return ::sqrt( (hx-x)*(hx-x) + (hy-y)*(hy-y) + (hz-z)*(hz-z) );
+}
+
+//_________________
+double StHbtHelix::distance(const TVector3& p, bool scanPeriods) const {
+  return ( this->at( pathLength(p,scanPeriods) )-p ).Mag();
+}
+
+//_________________
+double StHbtHelix::pathLength(const TVector3& p, bool scanPeriods) const {
+  return pathLength( parameters(), p.x(), p.y(), p.z(), scanPeriods );
+}
+
 //_________________
 double StHbtHelix::period() const {
   if (mSingularity) {
@@ -6,6 +6,11 @@
  * with straight tracks, i.e. with zero curvature. This represents only 
  * the mathematical model of a helix. See the SCL user guide for more details.
  *
+ * StHbtHelixParameters keeps the parameters of a helix in plain form
+ * (with the circle centre), so that they can be stored per particle. The
+ * static methods on them find the distance of closest approach to a point
+ * without building helix objects; the methods on StHbtHelix use them.
+ *
  */
 
 #ifndef StHbtHelix_h
@@ -33,6 +38,29 @@ using std::swap;
 using std::max;
 #endif
 
+//_________________
+struct StHbtHelixParameters {
+  /// Starting point
+  double mOriginX;
+  double mOriginY;
+  double mOriginZ;
+  /// Curvature (1/R), dip angle and phase with their cosines and sines
+  double mCurvature;
+  double mDipAngle;
+  double mPhase;
+  double mCosDipAngle;
+  double mSinDipAngle;
+  double mCosPhase;
+  double mSinPhase;
+  /// Centre of the circle in the xy-plane (0 for a straight line)
+  double mXCenter;
+  double mYCenter;
+  /// -sign(q*B)
+  int mH;
+  /// True for a straight line
+  bool mSingularity;
+};
+
 //_________________
 class StHbtHelix {
  public:
@@ -48,6 +76,9 @@ class StHbtHelix {
   /// Copy constructor
   StHbtHelix(const StHbtHelix&);
 
+  /// Constructor from the parameters in plain form (no recomputation)
+  explicit StHbtHelix(const StHbtHelixParameters& helix);
+
   /// Assignment operator (will use the one, provided by compiler)
   /// StHbtHelix& operator=(const StHbtHelix&);
   
@@ -104,6 +135,33 @@ class StHbtHelix {
   
   /// minimal distance between point and helix
   double distance(const TVector3& p, bool scanPeriods = true) const;    
+
+  /// Parameters in plain form
+  StHbtHelixParameters parameters() const;
+
+  /// Position on the helix at path length s
+  static void at(const StHbtHelixParameters& helix, const double& s,
+		 double& x, double& y, double& z);
+  /// Path length at the dca in the xy-plane to the point (x, y)
+  static double pathLength(const StHbtHelixParameters& helix,
+			   const double& x, const double& y);
+  /// Path length at the dca to the point (pathLength(const TVector3&, bool)
+  /// uses it)
+  static double pathLength(const StHbtHelixParameters& helix,
+			   const double& x, const double& y, const double& z,
+			   bool scanPeriods = true);
+  /// Minimal distance between the point and the helix
+  static double distance(const StHbtHelixParameters& helix,
+			 const double& x, const double& y, const double& z,
+			 bool scanPeriods = true);
+  /// Path length at the dca to the point with a fixed cost: the turn
+  /// closest in z to the point (instead of the period scan) followed by
+  /// kFastIterations Newton steps. Same result as pathLength() for points
+  /// close to the helix in the xy-plane
+  static double fastPathLength(const StHbtHelixParameters& helix,
+			       const double& x, const double& y, const double& z);
+  static double fastDistance(const StHbtHelixParameters& helix,
+			     const double& x, const double& y, const double& z);
     
   /// checks for valid parametrization
   bool valid(double world = 1.e+5) const { return !bad(world); }
@@ -113,6 +171,9 @@ class StHbtHelix {
   virtual void moveOrigin(double s);
   
   static const double NoSolution;
+
+  /// Newton steps of the dca to a point: at most and in fastPathLength
+  enum { kMaxIterations = 100, kFastIterations = 4 };
     
  protected:
   
@@ -197,6 +258,20 @@ inline TVector3 StHbtHelix::at(double s) const { return TVector3(x(s), y(s), z(s
 inline TVector3 StHbtHelix::cat(double s) const { return TVector3(cx(s), cy(s), cz(s)); }
 inline double StHbtHelix::pathLength(double X, double Y) const { return fudgePathLength(TVector3(X, Y, 0)); }
 
+inline void StHbtHelix::at(const StHbtHelixParameters& helix, const double& s,
+			   double& x, double& y, double& z) {
+  if (helix.mSingularity) {
+    x = helix.mOriginX - s*helix.mCosDipAngle*helix.mSinPhase;
+    y = helix.mOriginY + s*helix.mCosDipAngle*helix.mCosPhase;
+  }
+  else {
+    const double phase = helix.mPhase + s*helix.mH*helix.mCurvature*helix.mCosDipAngle;
+    x = helix.mXCenter + cos(phase)/helix.mCurvature;
+    y = helix.mYCenter + sin(phase)/helix.mCurvature;
+  }
+  z = helix.mOriginZ + s*helix.mSinDipAngle;
+}
+
 inline int StHbtHelix::bad(double WorldSize) const {
 
   int ierr;
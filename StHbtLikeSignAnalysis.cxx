@@ -106,6 +106,7 @@ void StHbtLikeSignAnalysis::processEvent(const StHbtEvent* hbtEvent) {
   mEventCut->fillCutMonitor(hbtEvent, tmpPassEvent);
   if (tmpPassEvent) {
     mNeventsProcessed++;
+    mPairIndex = 0;
     std::cout << "StHbtLikeSignAnalysis::processEvent() - " << hbtEvent->trackCollection()->size();
     std::cout << " #track=" << hbtEvent->trackCollection()->size();
     /// OK, analysis likes the event-- build a pico event from it,
@@ -135,6 +136,7 @@ void StHbtLikeSignAnalysis::processEvent(const StHbtEvent* hbtEvent) {
     /// We only ever need ONE pair, and we can just keep changing internal pointers
     /// this should help speed things up
       StHbtPair* ThePair = new StHbtPair;
+      ThePair->setRandomKey( mRandomSeed );
       
       StHbtParticleIterator PartIter1;
       StHbtParticleIterator PartIter2;
@@ -168,6 +170,7 @@ void StHbtLikeSignAnalysis::processEvent(const StHbtEvent* hbtEvent) {
 	ThePair->setTrack1(*PartIter1);
 	for (PartIter2 = StartInnerLoop; PartIter2!=EndInnerLoop; PartIter2++) {
 	  ThePair->setTrack2(*PartIter2);
+	  ThePair->setRandomCounter( mNeventsProcessed, mPairIndex++ );
 	  /// The following lines have to be uncommented if you want pairCutMonitors
 	  /// they are not in for speed reasons
 	  /// bool tmpPassPair = mPairCut->Pass(ThePair);
@@ -198,6 +201,7 @@ void StHbtLikeSignAnalysis::processEvent(const StHbtEvent* hbtEvent) {
 	nextIter++;
 	for ( PartIter2 = nextIter; PartIter2!=EndOuterLoop; PartIter2++) {
 	  ThePair->setTrack2(*PartIter2);
+	  ThePair->setRandomCounter( mNeventsProcessed, mPairIndex++ );
 	  /// The following lines have to be uncommented if you want pairCutMonitors
 	  /// they are not in for speed reasons
 	  /// bool tmpPassPair = mPairCut->Pass(ThePair);
@@ -225,6 +229,7 @@ void StHbtLikeSignAnalysis::processEvent(const StHbtEvent* hbtEvent) {
 	nextIter++;
 	for (PartIter2 = nextIter; PartIter2!=EndInnerLoop; PartIter2++) {
 	  ThePair->setTrack2(*PartIter2);
+	  ThePair->setRandomCounter( mNeventsProcessed, mPairIndex++ );
 	  /// The following lines have to be uncommented if you want pairCutMonitors
 	  /// they are not in for speed reasons
 	  /// bool tmpPassPair = mPairCut->Pass(ThePair);
@@ -272,6 +277,7 @@ void StHbtLikeSignAnalysis::processEvent(const StHbtEvent* hbtEvent) {
 	    ThePair->setTrack1(*PartIter1);
 	    for (PartIter2=StartInnerLoop; PartIter2!=EndInnerLoop; PartIter2++) {
 	      ThePair->setTrack2(*PartIter2);
+	      ThePair->setRandomCounter( mNeventsProcessed, mPairIndex++ );
 	      // testing...	      cout << "ThePair defined... going to pair cut... ";
 	      if ( mPairCut->pass(ThePair) ) {
 		// testing...		cout << " ThePair passed PairCut... ";
@@ -12,7 +12,9 @@
 #pragma link C++ class StHbtPairCut+;
 #pragma link C++ class StHbtCorrFctn+;
 #pragma link C++ class StHbtCorrFctn3DLCMSSym+;
+#pragma link C++ class StHbtQ3CorrFctn+;
 #pragma link C++ class yunoBPLCMSFrame3DCorrFctnKt+;
+#pragma link C++ class StHbtBinnedCorrFctn3D+;
 #pragma link C++ class yunoBPLCMSFrame3DCorrFctnKt_th+;
 #pragma link C++ class StHbtCoulomb+;
 #pragma link C++ class StHbtCutMonitor+;
@@ -25,6 +27,8 @@
 #pragma link C++ class StHbtBasicEventCut+;
 #pragma link C++ class StHbtBasicTrackCut+;
 #pragma link C++ class StHbtBasicPairCut+;
+#pragma link C++ class StHbtBinaryEventReader+;
+#pragma link C++ class StHbtBinaryEventWriter+;
 //#pragma link C++ class StHbtFsiWeight+;
 #pragma link C++ class StHbtKink+;
 #pragma link C++ class StHbtLikeSignAnalysis+;
@@ -36,11 +40,13 @@
 #pragma link C++ class StHbtEventCut+;
 #pragma link C++ class StHbtPicoEventCollectionVectorHideAway+;
 #pragma link C++ class StHbtPicoEvent+;
+#pragma link C++ class StHbtPrefetchReader+;
 #pragma link C++ class StHbtReactionPlaneAnalysis+;
 #pragma link C++ class StHbtSmearPair+;
 //#pragma link C++ class StHbtThPair+;
 #pragma link C++ class StHbtTrack+;
 #pragma link C++ class StHbtTriplet+;
+#pragma link C++ class StHbtTripletAnalysis+;
 #pragma link C++ class StHbtV0+;
 #pragma link C++ class StHbtVertexAnalysis+;
 #pragma link C++ class StHbtVertexMultAnalysis;
@@ -48,6 +54,7 @@
 //#pragma link C++ class TpcLocalTransform+;
 
 /// StarClassLibrary adopted classes
+#pragma link C++ struct StHbtHelixParameters+;
 #pragma link C++ class StHbtHelix+;
 #pragma link C++ class StHbtPhysicalHelix+;
 
@@ -8,6 +8,9 @@
 
 /// StHbtMaker headers
 #include "StHbtManager.h"
+#include "StHbtEventCut.h"
+#include "StHbtPrefetchReader.h"
+#include "StHbtCheckpoint.h"
 
 #ifdef __ROOT__
 ClassImp(StHbtManager)
@@ -15,7 +18,9 @@ ClassImp(StHbtManager)
 
 //_________________
 StHbtManager::StHbtManager() : mAnalysisCollection(nullptr),
-  mEventReader(nullptr), mEventWriterCollection(nullptr) {
+  mEventReader(nullptr), mEventWriterCollection(nullptr), mUsePreFilter(true),
+  mPrefetchEvents(0), mCheckpointFile(), mCheckpointEvents(0),
+  mCheckpointMixingBuffers(false), mNEventsProcessed(0) {
   
   mAnalysisCollection = new StHbtAnalysisCollection;
   mEventWriterCollection = new StHbtEventWriterCollection;
@@ -25,7 +30,13 @@ StHbtManager::StHbtManager() : mAnalysisCollection(nullptr),
 StHbtManager::StHbtManager(const StHbtManager &copy) :
   mAnalysisCollection( new StHbtAnalysisCollection ),
   mEventReader( copy.mEventReader ),
-  mEventWriterCollection( new StHbtEventWriterCollection ) {
+  mEventWriterCollection( new StHbtEventWriterCollection ),
+  mUsePreFilter( copy.mUsePreFilter ),
+  mPrefetchEvents( copy.mPrefetchEvents ),
+  mCheckpointFile( copy.mCheckpointFile ),
+  mCheckpointEvents( copy.mCheckpointEvents ),
+  mCheckpointMixingBuffers( copy.mCheckpointMixingBuffers ),
+  mNEventsProcessed( 0 ) {
   
   StHbtAnalysisIterator AnalysisIter;
   for(AnalysisIter = copy.mAnalysisCollection->begin();
@@ -47,6 +58,12 @@ StHbtManager& StHbtManager::operator=(const StHbtManager& man) {
   if ( this != &man ) {
     
     mEventReader = man.mEventReader;
+    mUsePreFilter = man.mUsePreFilter;
+    mPrefetchEvents = man.mPrefetchEvents;
+    mCheckpointFile = man.mCheckpointFile;
+    mCheckpointEvents = man.mCheckpointEvents;
+    mCheckpointMixingBuffers = man.mCheckpointMixingBuffers;
+    mNEventsProcessed = 0;
 
     /// Clean collections
     StHbtAnalysisIterator analysisIter;
@@ -123,6 +140,13 @@ int StHbtManager::init() {
   readerMessage += "*** *** *** *** *** *** *** *** *** *** *** *** \n";
   /// EventReader
   if (mEventReader) {
+    /// The wrapper owns the original reader from now on
+    if ( mPrefetchEvents > 0 && !dynamic_cast<StHbtPrefetchReader*>( mEventReader ) ) {
+      mEventReader = new StHbtPrefetchReader( mEventReader, mPrefetchEvents );
+    }
+    if ( mUsePreFilter ) {
+      mEventReader->setPreFilter( buildPreFilter() );
+    }
     if ( mEventReader->init("r",readerMessage) ) {
       std::cout << " StHbtManager::init() - Reader initialization failed " << std::endl;
       return 1;
@@ -148,9 +172,120 @@ int StHbtManager::init() {
       } //if ( (*EventWriterIter)->Init("w",writerMessage) )
     } //if (*EventWriterIter)
   }
+
+  /// Resume from the last checkpoint
+  mNEventsProcessed = 0;
+  if ( !mCheckpointFile.empty() ) {
+    return restoreCheckpoint();
+  }
   return 0;
 }
 
+//_________________
+void StHbtManager::setCheckpoint(const char* fileName, const unsigned int& nEvents,
+				 const bool& mixingBuffers) {
+  mCheckpointFile = fileName ? fileName : "";
+  mCheckpointEvents = nEvents;
+  mCheckpointMixingBuffers = mixingBuffers;
+}
+
+//_________________
+bool StHbtManager::writeCheckpoint() {
+
+  if ( mCheckpointFile.empty() ) return false;
+
+  StHbtCheckpoint checkpoint;
+  checkpoint.setWithMixingBuffers( mCheckpointMixingBuffers );
+  checkpoint.beginWrite();
+  checkpoint.write( mNEventsProcessed );
+  checkpoint.write( (unsigned int)mAnalysisCollection->size() );
+
+  StHbtAnalysisIterator analysisIter;
+  for ( analysisIter = mAnalysisCollection->begin();
+	analysisIter != mAnalysisCollection->end(); analysisIter++ ) {
+    (*analysisIter)->writeCheckpoint( checkpoint );
+  }
+
+  return checkpoint.save( mCheckpointFile.c_str() );
+}
+
+//_________________
+int StHbtManager::restoreCheckpoint() {
+
+  StHbtCheckpoint checkpoint;
+  if ( !checkpoint.load( mCheckpointFile.c_str() ) ) {
+    if ( checkpoint.size() == 0 ) {
+      /// No checkpoint yet: fresh start
+      return 0;
+    }
+    std::cout << "[ERROR] StHbtManager::init - bad checkpoint file: "
+	      << mCheckpointFile << std::endl;
+    return 1;
+  }
+
+  unsigned int nEvents = 0;
+  unsigned int nAnalyses = 0;
+  if ( !checkpoint.read( nEvents ) || !checkpoint.read( nAnalyses ) ||
+       nAnalyses != mAnalysisCollection->size() ) {
+    std::cout << "[ERROR] StHbtManager::init - checkpoint " << mCheckpointFile
+	      << " does not match the number of analyses" << std::endl;
+    return 1;
+  }
+
+  StHbtAnalysisIterator analysisIter;
+  for ( analysisIter = mAnalysisCollection->begin();
+	analysisIter != mAnalysisCollection->end(); analysisIter++ ) {
+    if ( !(*analysisIter)->readCheckpoint( checkpoint ) ) {
+      /// No events are skipped: the job stops instead of losing them
+      std::cout << "[ERROR] StHbtManager::init - can not restore the analyses from "
+		<< mCheckpointFile << ", refusing to resume" << std::endl;
+      return 1;
+    }
+  }
+
+  /// Skip the events that are already accounted for
+  if ( mEventReader && nEvents > 0 ) {
+    const unsigned int nSkipped = mEventReader->skipEvents( nEvents );
+    if ( nSkipped != nEvents ) {
+      std::cout << "[WARNING] StHbtManager::init - only " << nSkipped << " of "
+		<< nEvents << " checkpointed events found in the input" << std::endl;
+    }
+  }
+  mNEventsProcessed = nEvents;
+
+  std::cout << "StHbtManager::init - resumed from " << mCheckpointFile << " after "
+	    << nEvents << " events" << std::endl;
+  return 0;
+}
+
+//_________________
+StHbtEventPreFilter StHbtManager::buildPreFilter() {
+
+  /// One clause per analysis: an event is read in full if at least
+  /// one analysis may accept it
+  StHbtEventPreFilter filter;
+
+  /// Event writers need every event
+  if ( !mEventWriterCollection->empty() ) {
+    filter.acceptAll();
+    return filter;
+  }
+
+  StHbtAnalysisIterator analysisIter;
+  for ( analysisIter = mAnalysisCollection->begin();
+	analysisIter != mAnalysisCollection->end(); analysisIter++ ) {
+    StHbtEventCut *eventCut = (*analysisIter)->eventCut();
+    StHbtEventPreFilter::Clause clause;
+    if ( !eventCut || !eventCut->fillPreFilterClause( clause ) ) {
+      filter.acceptAll();
+      return filter;
+    }
+    filter.addClause() = clause;
+  } //for ( analysisIter = mAnalysisCollection->begin(); ...
+
+  return filter;
+}
+
 //_________________
 void StHbtManager::finish() {
   
@@ -248,7 +383,7 @@ int StHbtManager::processEvent() {
 
   /// Process a single event by reading it and passing it to each
   /// analysis and event writer
-  /// NOTE - this ReturnHbtEvent makes a *new* StHbtEvent - delete it when done!
+  /// NOTE - this ReturnHbtEvent makes a *new* StHbtEvent - release it when done!
   StHbtEvent* currentHbtEvent = mEventReader->returnHbtEvent();
 
   //added by gnigmat
@@ -290,10 +425,17 @@ int StHbtManager::processEvent() {
     (*AnalysisIter)->processEvent(currentHbtEvent);
   } 
 
+  /// Give the event back to the reader (recycled or deleted there)
   if (currentHbtEvent) {
-    delete currentHbtEvent;
+    mEventReader->releaseHbtEvent( currentHbtEvent );
     currentHbtEvent = nullptr;
   }
+
+  /// Periodic checkpoint
+  mNEventsProcessed++;
+  if ( mCheckpointEvents > 0 && ( mNEventsProcessed % mCheckpointEvents ) == 0 ) {
+    writeCheckpoint();
+  }
   
 #ifdef STHBRDEBUG
   cout << "StHbtManager::processEvent() - return to caller ... " << endl;
@@ -31,6 +31,9 @@
 #include "StHbtEventReader.h"
 #include "StHbtEventWriter.h"
 
+/// C++ headers
+#include <string>
+
 //_________________
 class StHbtManager{
 
@@ -51,7 +54,9 @@ class StHbtManager{
   StHbtAnalysisCollection *analysisCollection()        { return mAnalysisCollection; }
   /// Access to the n-th analysis within Collection
   StHbtBaseAnalysis       *analysis(int n);  
-  void addAnalysis(StHbtBaseAnalysis *analysis)        { mAnalysisCollection->push_back(analysis); }
+  /// Add the analysis. Its index is the default seed of its random decisions
+  void addAnalysis(StHbtBaseAnalysis *analysis)
+  { analysis->setDefaultRandomSeed( mAnalysisCollection->size() ); mAnalysisCollection->push_back(analysis); }
 
   /// Return pointer to the Collection of event writers
   StHbtEventWriterCollection* eventWriterCollection()  { return mEventWriterCollection; }
@@ -63,6 +68,30 @@ class StHbtManager{
   StHbtEventReader* eventReader()                      { return mEventReader; }
   void setEventReader(StHbtEventReader* reader)        { mEventReader = reader; }
 
+  /// Hand the union of the analysis event cuts to the reader in init()
+  /// (true by default). See StHbtEventReader::setPreFilter
+  void setUsePreFilter(const bool& use)                { mUsePreFilter = use; }
+  /// Build the event pre-filter from the event cuts of all analyses
+  StHbtEventPreFilter buildPreFilter();
+  /// Read up to nEvents events ahead on a background thread (0 - off,
+  /// default). The reader is wrapped into StHbtPrefetchReader in init()
+  void setPrefetchEvents(const unsigned int& nEvents)  { mPrefetchEvents = nEvents; }
+
+  /// Save the state of all analyses (histograms, counters and, if
+  /// mixingBuffers is true, the mixing buffers) to fileName every nEvents
+  /// processed events. If the file exists at init(), the analyses are
+  /// restored from it and the events processed before are skipped, so a
+  /// killed job resumes where the last checkpoint was written. The
+  /// analyses must be configured exactly as in the original job, and
+  /// init() fails (no events are skipped) if any of them can not be
+  /// restored
+  void setCheckpoint(const char* fileName, const unsigned int& nEvents,
+		     const bool& mixingBuffers = false);
+  /// Write the checkpoint now
+  bool writeCheckpoint();
+  /// Number of events processed (including the ones before the restart)
+  unsigned int nEventsProcessed() const                { return mNEventsProcessed; }
+
   /// Calls `init()` on all owned EventWriters
   ///
   /// Returns 0 for success, 1 for failure.
@@ -76,10 +105,24 @@ class StHbtManager{
   StHbtString report(); //!
 
  private:
+
+  /// Restore the analyses from the checkpoint file and skip the events
+  /// that were processed. Returns 1 on error
+  int restoreCheckpoint();
   
   StHbtAnalysisCollection* mAnalysisCollection;
   StHbtEventReader*        mEventReader;
   StHbtEventWriterCollection* mEventWriterCollection;
+  /// Push event cuts down to the reader
+  bool mUsePreFilter;
+  /// Number of events to read ahead
+  unsigned int mPrefetchEvents;
+  /// Checkpoint file, period (0 - off) and mixing buffer flag
+  std::string mCheckpointFile;
+  unsigned int mCheckpointEvents;
+  bool mCheckpointMixingBuffers;
+  /// Events passed to the analyses
+  unsigned int mNEventsProcessed;
   
 #ifdef __ROOT__
   ClassDef(StHbtManager, 0)
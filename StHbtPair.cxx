@@ -17,13 +17,6 @@
 /// ROOT headers
 #include "TMath.h"
 
-float StHbtPair::mMaxDuInner = 0.8f;
-float StHbtPair::mMaxDzInner = 3.0f;
-float StHbtPair::mMaxDuOuter = 1.4f;
-float StHbtPair::mMaxDzOuter = 3.2f;
-float StHbtPair::mTpcRadiusMin = 60.f;   //[cm]
-float StHbtPair::mTpcRadiusMax = 190.f;  //[cm]
-
 //_________________
 StHbtPair::StHbtPair() :
   mTrack1( nullptr ),
@@ -61,9 +54,11 @@ StHbtPair::StHbtPair() :
   mClosestRowAtDCAV0PosV0Pos(0),
   mMergingParNotCalculatedV0NegV0Neg(0),
   mFracOfMergedRowV0NegV0Neg(0),
-  mClosestRowAtDCAV0NegV0Neg(0) {
-  /// Default constructor
-  setDefaultHalfFieldMergingPar();
+  mClosestRowAtDCAV0NegV0Neg(0),
+  mRandomKey(0), mRandomEvent(0), mRandomPair(0),
+  mRandomCounterSet(false), mRandomWordsValid(false), mRandomWords{} {
+  /// Default constructor. The merging parameters are those of the
+  /// TPC geometry of the particles
 }
 
 //_________________
@@ -103,10 +98,10 @@ StHbtPair::StHbtPair(StHbtParticle* a, StHbtParticle* b) :
   mClosestRowAtDCAV0PosV0Pos(0),
   mMergingParNotCalculatedV0NegV0Neg(0),
   mFracOfMergedRowV0NegV0Neg(0),
-  mClosestRowAtDCAV0NegV0Neg(0) {
-
+  mClosestRowAtDCAV0NegV0Neg(0),
+  mRandomKey(0), mRandomEvent(0), mRandomPair(0),
+  mRandomCounterSet(false), mRandomWordsValid(false), mRandomWords{} {
   /// Construct pair from two particles
-  setDefaultHalfFieldMergingPar();
 }
 
 //_________________
@@ -146,7 +141,10 @@ StHbtPair::StHbtPair(const StHbtPair& pair) :
   mClosestRowAtDCAV0PosV0Pos(pair.mClosestRowAtDCAV0PosV0Pos),
   mMergingParNotCalculatedV0NegV0Neg(pair.mMergingParNotCalculatedV0NegV0Neg),
   mFracOfMergedRowV0NegV0Neg(pair.mFracOfMergedRowV0NegV0Neg),
-  mClosestRowAtDCAV0NegV0Neg(pair.mClosestRowAtDCAV0NegV0Neg) {
+  mClosestRowAtDCAV0NegV0Neg(pair.mClosestRowAtDCAV0NegV0Neg),
+  mRandomKey(pair.mRandomKey), mRandomEvent(pair.mRandomEvent),
+  mRandomPair(pair.mRandomPair), mRandomCounterSet(pair.mRandomCounterSet),
+  mRandomWordsValid(false), mRandomWords{} {
   /* no-op */
 }
 
@@ -198,6 +196,12 @@ StHbtPair& StHbtPair::operator=(const StHbtPair& pair) {
     mMergingParNotCalculatedV0NegV0Neg = pair.mMergingParNotCalculatedV0NegV0Neg;
     mFracOfMergedRowV0NegV0Neg = pair.mFracOfMergedRowV0NegV0Neg;
     mClosestRowAtDCAV0NegV0Neg = pair.mClosestRowAtDCAV0NegV0Neg;    
+
+    mRandomKey = pair.mRandomKey;
+    mRandomEvent = pair.mRandomEvent;
+    mRandomPair = pair.mRandomPair;
+    mRandomCounterSet = pair.mRandomCounterSet;
+    mRandomWordsValid = false;
   }
 
   return *this;
@@ -210,29 +214,26 @@ StHbtPair::~StHbtPair() {
 
 //_________________
 void StHbtPair::setDefaultHalfFieldMergingPar() {
-  mMaxDuInner = 3;
-  mMaxDzInner = 4.;
-  mMaxDuOuter = 4.;
-  mMaxDzOuter = 6.;
+  StHbtTpcGeometry geometry( StHbtTpcGeometry::current() );
+  geometry.setDefaultHalfFieldMergingPar();
+  StHbtTpcGeometry::setCurrent( geometry );
 }
 
 //_________________
 void StHbtPair::setDefaultFullFieldMergingPar() {
   /// Default TPC merging parameters for the STAR TPC
-  mMaxDuInner = 0.8;
-  mMaxDzInner = 3.;
-  mMaxDuOuter = 1.4;
-  mMaxDzOuter = 3.2;
+  StHbtTpcGeometry geometry( StHbtTpcGeometry::current() );
+  geometry.setDefaultFullFieldMergingPar();
+  StHbtTpcGeometry::setCurrent( geometry );
 }
 
 //_________________
 void StHbtPair::setMergingPar(float aMaxDuInner, float aMaxDzInner,
 			      float aMaxDuOuter, float aMaxDzOuter) {
-  mMaxDuInner = aMaxDuInner;
-  mMaxDzInner = aMaxDzInner;
-  mMaxDuOuter = aMaxDuOuter;
-  mMaxDzOuter = aMaxDzOuter;
-};
+  StHbtTpcGeometry geometry( StHbtTpcGeometry::current() );
+  geometry.setMergingPar( aMaxDuInner, aMaxDzInner, aMaxDuOuter, aMaxDzOuter );
+  StHbtTpcGeometry::setCurrent( geometry );
+}
 
 //_________________
 double StHbtPair::emissionAngle() const {
@@ -250,7 +251,7 @@ void StHbtPair::qYKPCMS(double& qP, double& qT, double& q0) const {
   /// Calculate momentum difference in source rest frame (= lab frame)
 
   /// Random ordering of the particles
-  TLorentzVector l = ( ( rand() / (double)RAND_MAX ) > 0.50 ?
+  TLorentzVector l = ( randomChoice( kRandomOrderYKP ) ?
 		       ( mTrack1->fourMomentum() - mTrack2->fourMomentum() ) :
 		       ( mTrack2->fourMomentum() - mTrack1->fourMomentum() ) );
   /// Fill momentum differences into return variables
@@ -261,58 +262,93 @@ void StHbtPair::qYKPCMS(double& qP, double& qT, double& q0) const {
 
 //_________________
 void StHbtPair::qYKPLCMS(double& qP, double& qT, double& q0) const {
-
   /// Yano-Koonin-Podgoretskii Parametrisation in LCMS
-  /// Calculate momentum difference in LCMS : frame where pz1 + pz2 = 0
-  TLorentzVector l1 = mTrack1->fourMomentum();
-  TLorentzVector l2 = mTrack2->fourMomentum();
-
-  /// Determine beta to LCMS
-  double betaZ = fourMomentumSum().Pz() / fourMomentumSum().Energy() ;
-
-  /// Boost in the correct direction
-  if ( betaZ > 0 ) { betaZ = -betaZ; }
-
-  /// Boost particles along the beam into a frame with velocity beta
-  l1.Boost( 0., 0., betaZ );
-  l2.Boost( 0., 0., betaZ );
-  
-  /// Caculate the momentum difference with random ordering of the particle
-  TLorentzVector l = ( ( rand() / (double)RAND_MAX ) > 0.5 ?
-		       ( l1 - l2 ) : ( l2 - l1 ) );
+  /// with random ordering of the particles
+  qYKPLCMS( mTrack1->fourMomentum(), mTrack2->fourMomentum(),
+	    randomChoice( kRandomOrderYKP ), qP, qT, q0 );
+}
 
-  /// Fill momentum differences into return variables
-  qP = l.Z() ;
-  qT = l.Vect().Perp() ;
-  q0 = l.Energy() ;
+//_________________
+void StHbtPair::qYKPLCMS(const TLorentzVector& p1, const TLorentzVector& p2, const bool& order,
+			 double& qP, double& qT, double& q0) {
+
+  /// Calculate momentum difference in LCMS : frame where pz1 + pz2 = 0.
+  /// The boost along the beam is linear, so the difference q = p1 - p2
+  /// is boosted directly: qz' = gamma (qz + beta q0), q0' = gamma (q0 + beta qz)
+  /// with gamma = E / sqrt(E^2 - Pz^2) of the pair sum (Pz, E).
+  /// The boost is done in the direction of negative z
+  const double pZ = TMath::Abs( p1.Pz() + p2.Pz() );
+  const double pE = p1.E() + p2.E();
+  const double invMtZ = 1. / TMath::Sqrt( pE * pE - pZ * pZ );
+
+  const double qX = p1.Px() - p2.Px();
+  const double qY = p1.Py() - p2.Py();
+  const double qZ = p1.Pz() - p2.Pz();
+  const double qE = p1.E() - p2.E();
+
+  /// Caculate the momentum difference with the given ordering of the particles
+  const double sign = ( order ? invMtZ : -invMtZ );
+  qP = sign * ( pE * qZ - pZ * qE );
+  qT = TMath::Sqrt( qX * qX + qY * qY );
+  q0 = sign * ( pE * qE - pZ * qZ );
 }
 
 //_________________
 void StHbtPair::qYKPPF(double& qP, double& qT, double& q0) const {
+  /// Yano-Koonin-Podgoretskii Parametrisation in pair rest frame
+  /// with random ordering of the particles
+  qYKPPF( mTrack1->fourMomentum(), mTrack2->fourMomentum(),
+	  randomChoice( kRandomOrderYKP ), qP, qT, q0 );
+}
+
+//_________________
+void StHbtPair::qYKPPF(const TLorentzVector& p1, const TLorentzVector& p2, const bool& order,
+		       double& qP, double& qT, double& q0) {
 
-  /// Yano-Koonin-Podgoretskii Parametrisation in pair rest fram
   /// Calculate momentum difference in pair rest frame :
-  /// frame where (pz1 + pz2, py1 + py2, px1 + px2) = (0,0,0)
-  TLorentzVector l1 = mTrack1->fourMomentum() ;
-  TLorentzVector l2 = mTrack2->fourMomentum() ;
-
-  /// Calculate beta in each direction
-  double betaX = -fourMomentumSum().Px() / fourMomentumSum().Energy();
-  double betaY = -fourMomentumSum().Py() / fourMomentumSum().Energy();
-  double betaZ = -fourMomentumSum().Pz() / fourMomentumSum().Energy();
-  
-  /// Boost particles  
-  l1.Boost( betaX, betaY, betaZ ) ;
-  l2.Boost( betaX, betaY, betaZ ) ;
+  /// frame where (pz1 + pz2, py1 + py2, px1 + px2) = (0,0,0).
+  /// With the pair sum (P, E) and M^2 = E^2 - P^2 the boost of q = p1 - p2 is
+  /// q0' = ( E q0 - P.q ) / M and q' = q + ( P.q / (E + M) - q0 ) P / M
+  const double pX = p1.Px() + p2.Px();
+  const double pY = p1.Py() + p2.Py();
+  const double pZ = p1.Pz() + p2.Pz();
+  const double pE = p1.E() + p2.E();
+  const double qX = p1.Px() - p2.Px();
+  const double qY = p1.Py() - p2.Py();
+  const double qZ = p1.Pz() - p2.Pz();
+  const double qE = p1.E() - p2.E();
+
+  const double mInv = TMath::Sqrt( pE * pE - pX * pX - pY * pY - pZ * pZ );
+  const double pq = pX * qX + pY * qY + pZ * qZ;
+  const double eM = pE + mInv;
+  const double invDenom = 1. / ( eM * mInv );
+  const double scale = ( pq - qE * eM ) * invDenom;
+
+  /// Caculate the momentum difference with the given ordering of the particles
+  const double sign = ( order ? 1. : -1. );
+  const double qXPf = qX + scale * pX;
+  const double qYPf = qY + scale * pY;
+  qP = sign * ( qZ + scale * pZ );
+  qT = TMath::Sqrt( qXPf * qXPf + qYPf * qYPf );
+  q0 = sign * ( pE * qE - pq ) * eM * invDenom;
+}
 
-  /// Caculate the momentum difference with random ordering of the particle
-  TLorentzVector l = ( ( rand() / (double)RAND_MAX ) > 0.50 ?
-		       ( l1 - l2 ) : ( l2 - l1 ) );
+//_________________
+void StHbtPair::qYKPLCMS(const StHbtPair* const* pairs, double* qP, double* qT,
+			 double* q0, const unsigned int& n) {
+  for ( unsigned int i=0; i<n; i++ ) {
+    qYKPLCMS( pairs[i]->mTrack1->fourMomentum(), pairs[i]->mTrack2->fourMomentum(),
+	      pairs[i]->randomChoice( kRandomOrderYKP ), qP[i], qT[i], q0[i] );
+  }
+}
 
-  /// Fill momentum differences into return variables
-  qP = l.Z();
-  qT = l.Vect().Perp();
-  q0 = l.Energy();
+//_________________
+void StHbtPair::qYKPPF(const StHbtPair* const* pairs, double* qP, double* qT,
+		       double* q0, const unsigned int& n) {
+  for ( unsigned int i=0; i<n; i++ ) {
+    qYKPPF( pairs[i]->mTrack1->fourMomentum(), pairs[i]->mTrack2->fourMomentum(),
+	    pairs[i]->randomChoice( kRandomOrderYKP ), qP[i], qT[i], q0[i] );
+  }
 }
 
 //_________________
@@ -542,41 +578,65 @@ double StHbtPair::nominalTpcAverageSeparation() const {
 //_________________
 double StHbtPair::kStarFlipped() const {
   /// Estimation of kStar with the flipped sign
-  TLorentzVector tP1 = mTrack1->fourMomentum();
+  return kStarFlipped( mTrack1->fourMomentum(), mTrack2->fourMomentum() );
+}
 
-  /// Flip the sign
-  TVector3 qwe = mTrack1->p();
-  qwe *= -1.; // flip it
-  tP1.SetVect(qwe);
-  
-  TLorentzVector tSum = ( tP1 + mTrack2->fourMomentum() );
-  TVector3 tGammaBeta = ( 1. / tSum.M() ) * tSum.Vect(); 
-  double   tGamma = tSum.E() / tSum.M();
-  TVector3 tLongMom  = ( ( tP1.Vect() * tGammaBeta ) /
-			 ( tGammaBeta * tGammaBeta ) ) * tGammaBeta;
-  /// Constructor TLorentzVector( TVector3, double )
-  TLorentzVector tK( ( tP1.Vect() + (tGamma - 1.) * tLongMom - tP1.E() * tGammaBeta ),
-		     ( tGamma * tP1.E() - tP1.Vect() * tGammaBeta ) );
-
-  return tK.Vect().Mag();
+//_________________
+double StHbtPair::kStarFlipped(const TLorentzVector& p1, const TLorentzVector& p2) {
+  /// k* of the first particle with the flipped momentum and the second one.
+  /// k* is half of the length of the relative four-momentum q taken
+  /// orthogonal to the pair sum P: 4 k*^2 = (P.q)^2 / M^2 - q^2
+  const double pX = p2.Px() - p1.Px();
+  const double pY = p2.Py() - p1.Py();
+  const double pZ = p2.Pz() - p1.Pz();
+  const double pE = p1.E() + p2.E();
+  const double qX = -p1.Px() - p2.Px();
+  const double qY = -p1.Py() - p2.Py();
+  const double qZ = -p1.Pz() - p2.Pz();
+  const double qE = p1.E() - p2.E();
+
+  const double mInvSqr = pE * pE - pX * pX - pY * pY - pZ * pZ;
+  const double pq = pE * qE - pX * qX - pY * qY - pZ * qZ;
+  const double qSqr = qE * qE - qX * qX - qY * qY - qZ * qZ;
+  const double kStarSqr4 = pq * pq / mInvSqr - qSqr;
+
+  return ( kStarSqr4 > 0. ) ? 0.5 * TMath::Sqrt( kStarSqr4 ) : 0.;
 }
 
 //_________________
 double StHbtPair::cvkFlipped() const {
   /// CVK with sign flipped
-  TLorentzVector tP1 = mTrack1->fourMomentum();
-  TVector3 qwe = tP1.Vect();
-  qwe *= -1.; // flip it
-  tP1.SetVect(qwe);
-  
-  TLorentzVector tSum = ( tP1 + mTrack2->fourMomentum() );
-  TVector3 tGammaBeta = ( 1. / tSum.M() ) * tSum.Vect(); 
-  double   tGamma = tSum.E() / tSum.M();
-  TVector3 tLongMom  = ( ( tP1.Vect() * tGammaBeta ) /
-			 ( tGammaBeta * tGammaBeta ) ) * tGammaBeta;
-  TLorentzVector tK( ( tP1.Vect() + ( tGamma-1. ) * tLongMom - tP1.E() * tGammaBeta ),
-		     ( tGamma * tP1.E() - tP1.Vect() * tGammaBeta ) );
-  return ( tGammaBeta * (1. / tGamma) * tK.Vect() );
+  return cvkFlipped( mTrack1->fourMomentum(), mTrack2->fourMomentum() );
+}
+
+//_________________
+double StHbtPair::cvkFlipped(const TLorentzVector& p1, const TLorentzVector& p2) {
+  /// Pair velocity times k* of the first particle with the flipped
+  /// momentum: beta.k* = ( E (p1.P) - E1 P^2 ) / ( M E ), where (P, E) is
+  /// the pair sum and p1.P the product of the three-momenta
+  const double pX = p2.Px() - p1.Px();
+  const double pY = p2.Py() - p1.Py();
+  const double pZ = p2.Pz() - p1.Pz();
+  const double pE = p1.E() + p2.E();
+  const double pSqr = pX * pX + pY * pY + pZ * pZ;
+  const double mInv = TMath::Sqrt( pE * pE - pSqr );
+  const double p1P = -( p1.Px() * pX + p1.Py() * pY + p1.Pz() * pZ );
+
+  return ( ( pE * p1P - p1.E() * pSqr ) / ( mInv * pE ) );
+}
+
+//_________________
+void StHbtPair::kStarFlipped(const StHbtPair* const* pairs, double* kStar, const unsigned int& n) {
+  for ( unsigned int i=0; i<n; i++ ) {
+    kStar[i] = kStarFlipped( pairs[i]->mTrack1->fourMomentum(), pairs[i]->mTrack2->fourMomentum() );
+  }
+}
+
+//_________________
+void StHbtPair::cvkFlipped(const StHbtPair* const* pairs, double* cvk, const unsigned int& n) {
+  for ( unsigned int i=0; i<n; i++ ) {
+    cvk[i] = cvkFlipped( pairs[i]->mTrack1->fourMomentum(), pairs[i]->mTrack2->fourMomentum() );
+  }
 }
 
 //_________________
@@ -607,7 +667,7 @@ double StHbtPair::qInvRandomFlippedXY() const {
   TLorentzVector tP1 = mTrack1->fourMomentum();
   TLorentzVector tP2 = mTrack1->fourMomentum();
 
-  if ( rand()/(double)RAND_MAX > 0.50 ) { 
+  if ( randomChoice( kRandomFlipXY ) ) {
     tP1.SetX(-1. * tP1.X() );
     tP1.SetY(-1. * tP1.Y() );
   }
@@ -635,7 +695,7 @@ double StHbtPair::qInvRandomFlippedXYZ() const {
   TLorentzVector tP1 = mTrack1->fourMomentum();
   TLorentzVector tP2 = mTrack2->fourMomentum();
 
-  if ( rand()/(double)RAND_MAX > 0.50 ) { 
+  if ( randomChoice( kRandomFlipXYZ ) ) {
     tP1.SetX( -1.* tP1.X() );
     tP1.SetY( -1.* tP1.Y() );
     tP1.SetZ( -1.* tP1.Z() );
@@ -792,7 +852,7 @@ void StHbtPair::calcNonIdParGlobal() const{
 }
 
 //_________________
-double StHbtPair::dcaInsideTpc() const {
+double StHbtPair::dcaInsideTpc(const bool& isFast) const {
   /// DCA inside TPC
   double tMinDist = nominalTpcEntranceSeparation();
   double tExit = nominalTpcExitSeparation();
@@ -800,54 +860,48 @@ double StHbtPair::dcaInsideTpc() const {
   double tInsideDist;
   //tMinDist = 999.;
 
-  double rMin = 60.;
-  double rMax = 190.;
-  StHbtPhysicalHelix tHelix1 = mTrack1->helix();
-  StHbtPhysicalHelix tHelix2 = mTrack2->helix();
+  double rMin = mTrack1->geometry().pairRadiusMin();
+  double rMax = mTrack1->geometry().pairRadiusMax();
+  /// Helix parameters are kept by the particles
+  const StHbtHelixParameters& tHelix1 = mTrack1->helixParameters();
+  const StHbtHelixParameters& tHelix2 = mTrack2->helixParameters();
   // --- One is a line and other one a helix
   //if (tHelix1.mSingularity != tHelix2.mSingularity) return -999.;
   // --- 2 lines : don't care right now
   //if (tHelix1.mSingularity)  return -999.;
   // --- 2 helix
-  double dx = tHelix2.xcenter() - tHelix1.xcenter();
-  double dy = tHelix2.ycenter() - tHelix1.ycenter();
+  double dx = tHelix2.mXCenter - tHelix1.mXCenter;
+  double dy = tHelix2.mYCenter - tHelix1.mYCenter;
   double dd = TMath::Sqrt( dx * dx + dy * dy );
-  double r1 = 1 / tHelix1.curvature();
-  double r2 = 1 / tHelix2.curvature();
+  double r1 = 1 / tHelix1.mCurvature;
+  double r2 = 1 / tHelix2.mCurvature;
   double cosAlpha = ( r1 * r1 + dd * dd - r2 * r2 ) / ( 2 * r1 * dd );
-    
-  double x, y, r;
-  double s;
+
   if ( TMath::Abs( cosAlpha ) < 1. ) {
-    /// Two solutions
-    double sinAlpha = TMath::Sin( TMath::ACos( cosAlpha ) );
-    x = tHelix1.xcenter() + r1 * ( cosAlpha * dx - sinAlpha * dy ) / dd;
-    y = tHelix1.ycenter() + r1 * ( sinAlpha * dx + cosAlpha * dy) / dd;
-    r = TMath::Sqrt( x * x + y * y );
-    if( ( r > rMin ) && ( r < rMax ) && 
-	TMath::Abs( TMath::ATan2( y, x) -
-		    mTrack1->nominalTpcEntrancePoint().Phi() ) < 0.5 ) {
-      /// first solution inside
-      s = tHelix1.pathLength(x, y);
-      tInsideDist = tHelix2.distance( tHelix1.at(s) );
-      if ( tInsideDist < tMinDist ) {
-	tMinDist = tInsideDist;
-      }
-    }
-    else { 
-      x = tHelix1.xcenter() + r1 * ( cosAlpha * dx + sinAlpha * dy) / dd;
-      y = tHelix1.ycenter() + r1 * ( cosAlpha * dy - sinAlpha * dx) / dd;
-      r = TMath::Sqrt( x * x + y * y );
-      if( ( r > rMin ) && ( r < rMax ) &&
-	  TMath::Abs( TMath::ATan2( y, x ) - mTrack1->nominalTpcEntrancePoint().Phi() ) < 0.5 ) {
-	/// second solution inside
-        s = tHelix1.pathLength( x, y );
-        tInsideDist = tHelix2.distance( tHelix1.at(s) );
-        if ( tInsideDist < tMinDist ) {
+    /// Two solutions. A solution is used if it is within 0.5 rad
+    /// in phi from the TPC entrance point of the first track
+    double sinAlpha = TMath::Sqrt( 1. - cosAlpha * cosAlpha );
+    double entrancePhi = mTrack1->nominalTpcEntrancePoint().Phi();
+    for ( int iSolution=0; iSolution<2; iSolution++ ) {
+      double sign = ( iSolution == 0 ) ? 1. : -1.;
+      double x = tHelix1.mXCenter + r1 * ( cosAlpha * dx - sign * sinAlpha * dy ) / dd;
+      double y = tHelix1.mYCenter + r1 * ( sign * sinAlpha * dx + cosAlpha * dy ) / dd;
+      double r = TMath::Sqrt( x * x + y * y );
+      if ( ( r > rMin ) && ( r < rMax ) &&
+	   TMath::Abs( TMath::ATan2( y, x ) - entrancePhi ) < 0.5 ) {
+	double s = StHbtHelix::pathLength( tHelix1, x, y );
+	double hx, hy, hz;
+	StHbtHelix::at( tHelix1, s, hx, hy, hz );
+	tInsideDist = ( isFast ?
+			StHbtHelix::fastDistance( tHelix2, hx, hy, hz ) :
+			StHbtHelix::distance( tHelix2, hx, hy, hz ) );
+	if ( tInsideDist < tMinDist ) {
 	  tMinDist = tInsideDist;
 	}
+	/// The second solution is checked only if the first is outside
+	break;
       }
-    } //else
+    } //for ( int iSolution=0; iSolution<2; iSolution++ )
   } //if ( TMath::Abs( cosAlpha ) < 1. )
   return tMinDist;
 }
@@ -863,26 +917,25 @@ void StHbtPair::calcMergingPar() const {
   mWeightedAvSep =0.;
   double tDist;
   double tDistMax = 200.;
-  for ( int ti=0; ti < mTrack1->mNumberOfPadrows ; ti++ ) {
+  const StHbtTpcGeometry& geometry = mTrack1->geometry();
+  const int nRows = geometry.numberOfPadrows();
+  const int *sect1 = mTrack1->sect();
+  const int *sect2 = mTrack2->sect();
+  const float *u1 = mTrack1->u();
+  const float *u2 = mTrack2->u();
+  const float *z1 = mTrack1->z();
+  const float *z2 = mTrack2->z();
+  for ( int ti=0; ti < nRows ; ti++ ) {
     
-    if ( ( mTrack1->sect()[ti] == mTrack2->sect()[ti] ) &&
-	 mTrack1->sect()[ti] != -1 ) {
-      tDu = TMath::Abs( mTrack1->u()[ti] - mTrack2->u()[ti] );
-      tDz = TMath::Abs( mTrack1->z()[ti] - mTrack2->z()[ti] );
+    if ( ( sect1[ti] == sect2[ti] ) && sect1[ti] != -1 ) {
+      tDu = TMath::Abs( u1[ti] - u2[ti] );
+      tDz = TMath::Abs( z1[ti] - z2[ti] );
       tN++;
-      
-      if ( ti<13 ) {
-	mFracOfMergedRow += ( tDu<mMaxDuInner && tDz<mMaxDzInner );
-	tDist = TMath::Sqrt( tDu * tDu / mMaxDuInner / mMaxDuInner +
-			     tDz * tDz / mMaxDzInner / mMaxDzInner );
-	//mFracOfMergedRow += (tDu<mMaxDuInner && tDz<mMaxDzInner);
-      }
-      else {
-	mFracOfMergedRow += ( tDu<mMaxDuOuter && tDz<mMaxDzOuter );
-	tDist = TMath::Sqrt( tDu * tDu / mMaxDuOuter / mMaxDuOuter+
-			     tDz * tDz / mMaxDzOuter / mMaxDzOuter );
-	//mFracOfMergedRow += (tDu<mMaxDuOuter && tDz<mMaxDzOuter);
-      }
+
+      /// Merging parameters of the inner or outer sector of the row
+      mFracOfMergedRow += ( tDu<geometry.maxDu(ti) && tDz<geometry.maxDz(ti) );
+      tDist = TMath::Sqrt( tDu * tDu * geometry.invMaxDu2(ti) +
+			   tDz * tDz * geometry.invMaxDz2(ti) );
       
       if ( tDist<tDistMax ) {
 	mClosestRowAtDCA = ti+1;
@@ -890,7 +943,7 @@ void StHbtPair::calcMergingPar() const {
       }
       mWeightedAvSep += tDist;
     }
-  } // for ( int ti=0; ti < mTrack1->mNumberOfPadrows ; ti++ )
+  } // for ( int ti=0; ti < nRows ; ti++ )
 
   if ( tN>0 ) {
     mWeightedAvSep /= tN;
@@ -1081,23 +1134,19 @@ void StHbtPair::calcMergingParFctn( short* tmpMergingParNotCalculatedFctn,
   double tDistMax = 100000000.;
 
   /// Loop over padrows
-  for(int ti=0 ; ti<mTrack1->mNumberOfPadrows ; ti++) {
+  const StHbtTpcGeometry& geometry = mTrack1->geometry();
+  const int nRows = geometry.numberOfPadrows();
+  for(int ti=0 ; ti<nRows ; ti++) {
     
     if( tmpSect1[ti]==tmpSect2[ti] && tmpSect1[ti]!=-1 ) {
       tDu = fabs(tmpU1[ti]-tmpU2[ti]);
       tDz = fabs(tmpZ1[ti]-tmpZ2[ti]);
       tN++;
-      
-      if ( ti < 13 ) {
-	*tmpFracOfMergedRow += ( tDu<mMaxDuInner && tDz<mMaxDzInner );
-	tDist = TMath::Sqrt( tDu * tDu / mMaxDuInner / mMaxDuInner +
-			     tDz * tDz / mMaxDzInner / mMaxDzInner );
-      }
-      else {
-	*tmpFracOfMergedRow += ( tDu < mMaxDuOuter && tDz < mMaxDzOuter );
-	tDist = TMath::Sqrt( tDu * tDu / mMaxDuOuter / mMaxDuOuter +
-			     tDz * tDz / mMaxDzOuter / mMaxDzOuter );
-      }
+
+      /// Merging parameters of the inner or outer sector of the row
+      *tmpFracOfMergedRow += ( tDu < geometry.maxDu(ti) && tDz < geometry.maxDz(ti) );
+      tDist = TMath::Sqrt( tDu * tDu * geometry.invMaxDu2(ti) +
+			   tDz * tDz * geometry.invMaxDz2(ti) );
 
       if ( tDist < tDistMax ) {
 	mClosestRowAtDCA = ti+1;
@@ -1105,7 +1154,7 @@ void StHbtPair::calcMergingParFctn( short* tmpMergingParNotCalculatedFctn,
       }
       //mWeightedAvSep += tDist; // now, wrong but not used
     }	
-  } // for(int ti=0 ; ti<mTrack1->mNumberOfPadrows ; ti++)
+  } // for(int ti=0 ; ti<nRows ; ti++)
 
   if ( tN > 0 ) {
     //mWeightedAvSep /= tN;
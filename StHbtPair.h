@@ -20,6 +20,7 @@
 /// StHbtMaker headers
 #include "StHbtParticle.h"
 #include "StHbtTypes.h"
+#include "StHbtRandom.h"
 
 /// ROOT headers
 #include "TVector3.h"
@@ -106,6 +107,11 @@ class StHbtPair {
   void qYKPLCMS(double& qP, double& qT, double& q0) const ;
   // pair rest frame
   void qYKPPF(double& qP, double& qT, double& q0) const ;
+  /// The same for n pairs (closed-form boosts, no temporary four-vectors)
+  static void qYKPLCMS(const StHbtPair* const* pairs, double* qP, double* qT,
+		       double* q0, const unsigned int& n);
+  static void qYKPPF(const StHbtPair* const* pairs, double* qP, double* qT,
+		     double* q0, const unsigned int& n);
 
   double quality() const;
 
@@ -159,6 +165,9 @@ class StHbtPair {
   double kStarFlipped() const;
   double cvk() const             { if(mNonIdParNotCalculated) { calcNonIdPar(); } return mCVK; }
   double cvkFlipped() const;
+  /// kStarFlipped and cvkFlipped of n pairs
+  static void kStarFlipped(const StHbtPair* const* pairs, double* kStar, const unsigned int& n);
+  static void cvkFlipped(const StHbtPair* const* pairs, double* cvk, const unsigned int& n);
   /// XY-plane rotation
   double qInvFlippedXY() const;
   double qInvRandomFlippedXY() const;
@@ -185,7 +194,11 @@ class StHbtPair {
   double kaonPionPairProbability() const
   { return (mTrack1->track()->pidProbKaon()) * (mTrack2->track()->pidProbPion()); }
 
-  double dcaInsideTpc() const;
+  /// Distance of the second track from the crossing of the tracks in the
+  /// xy-plane inside the TPC (or the nominal entrance/exit separation if
+  /// it is smaller). Uses the helix parameters kept by the tracks. With
+  /// isFast the distance is StHbtHelix::fastDistance (fixed cost for pair cuts)
+  double dcaInsideTpc(const bool& isFast = false) const;
   double quality2() const;
 
   double kStarGlobal() const
@@ -286,10 +299,28 @@ class StHbtPair {
   void setTrack1(const StHbtParticle* trkPtr) { mTrack1=(StHbtParticle*)trkPtr; resetParCalculated(); }
   void setTrack2(const StHbtParticle* trkPtr) { mTrack2=(StHbtParticle*)trkPtr; resetParCalculated(); }
 
-  void setMergingPar(float aMaxDuInner, float aMaxDzInner,
-		     float aMaxDuOuter, float aMaxDzOuter);
-  void setDefaultHalfFieldMergingPar();
-  void setDefaultFullFieldMergingPar();
+  /// Deprecated: the merging parameters belong to the TPC geometry, set
+  /// them there and call StHbtTpcGeometry::setCurrent(). These forward to
+  /// it: a copy of the current geometry with the new parameters becomes
+  /// current (and is kept until the end of the program) and is used only
+  /// for the particles made afterwards. Call them once at initialisation
+  static void setMergingPar(float aMaxDuInner, float aMaxDzInner,
+			    float aMaxDuOuter, float aMaxDzOuter);
+  static void setDefaultHalfFieldMergingPar();
+  static void setDefaultFullFieldMergingPar();
+
+  /// Random decisions of the pair (particle order of the YKP momenta and
+  /// the flipped particle of qInvRandomFlipped*) are counter-based: the
+  /// analysis sets its seed as the key and the event and pair numbers as
+  /// the counter of each pair, so they do not depend on the pairing order
+  /// or the thread. Without a counter the decisions are taken from the
+  /// random stream of the thread. setTrack1/2 clear the counter, so it is
+  /// set after the tracks
+  void setRandomKey(const unsigned long long& key)
+  { mRandomKey = key; mRandomWordsValid = false; }
+  void setRandomCounter(const unsigned long long& event, const unsigned long long& pair)
+  { mRandomEvent = event; mRandomPair = pair; mRandomCounterSet = true; mRandomWordsValid = false; }
+  void clearRandomCounter()                     { mRandomCounterSet = false; }
 
 private:
 
@@ -341,12 +372,8 @@ private:
   mutable float mFracOfMergedRowV0NegV0Neg;
   mutable float mClosestRowAtDCAV0NegV0Neg;
 
-  static float mMaxDuInner;
-  static float mMaxDzInner;
-  static float mMaxDuOuter;
-  static float mMaxDzOuter;
-  static float mTpcRadiusMin;   //[cm]
-  static float mTpcRadiusMax;   //[cm]
+  /// The merging parameters and the pad rows are taken from the
+  /// geometry of the first particle
   void calcMergingPar() const;
 
   void calcMergingParFctn(short* tmpMergingParNotCalculatedFctn,
@@ -356,13 +383,47 @@ private:
 			  float* tmpFracOfMergedRow,
 			  float* tmpClosestRowAtDCA) const;
 
+  /// Closed forms of the YKP momentum differences and of the flipped
+  /// k* and cvk (the boosts are written with the pair sums and differences)
+  static void qYKPLCMS(const TLorentzVector& p1, const TLorentzVector& p2, const bool& order,
+		       double& qP, double& qT, double& q0);
+  static void qYKPPF(const TLorentzVector& p1, const TLorentzVector& p2, const bool& order,
+		     double& qP, double& qT, double& q0);
+  static double kStarFlipped(const TLorentzVector& p1, const TLorentzVector& p2);
+  static double cvkFlipped(const TLorentzVector& p1, const TLorentzVector& p2);
+
+  /// Random decisions (each uses its own word of the random block)
+  enum { kRandomOrderYKP = 0, kRandomFlipXY = 1, kRandomFlipXYZ = 2 };
+  /// True with probability 1/2
+  bool randomChoice(const int& decision) const;
+
+  unsigned long long mRandomKey;
+  unsigned long long mRandomEvent;
+  unsigned long long mRandomPair;
+  bool mRandomCounterSet;
+  mutable bool mRandomWordsValid;
+  mutable unsigned int mRandomWords[4];
+
   void resetParCalculated() {
     mNonIdParNotCalculated=1; mNonIdParNotCalculatedGlobal=1;
     mMergingParNotCalculated=1; mMergingParNotCalculatedTrkV0Pos=1;
     mMergingParNotCalculatedTrkV0Neg=1; mMergingParNotCalculatedV0PosV0Pos=1;
     mMergingParNotCalculatedV0NegV0Pos=1; mMergingParNotCalculatedV0PosV0Neg=1;
     mMergingParNotCalculatedV0NegV0Neg=1;
+    mRandomCounterSet=false;
   }
 };
 
+//_________________
+inline bool StHbtPair::randomChoice(const int& decision) const {
+  if ( !mRandomCounterSet ) {
+    return ( StHbtRandom::threadGenerator().next() & 0x80000000U ) != 0;
+  }
+  if ( !mRandomWordsValid ) {
+    StHbtRandom::block( mRandomKey, mRandomPair, mRandomEvent, mRandomWords );
+    mRandomWordsValid = true;
+  }
+  return ( mRandomWords[decision] & 0x80000000U ) != 0;
+}
+
 #endif // #define StHbtPair_h
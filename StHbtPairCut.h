@@ -12,6 +12,7 @@
 
 /// Forward declaration
 class StHbtBaseAnalysis;
+class StHbtCheckpoint;
 
 /// StHbtMaker headers
 #include "StHbtString.h"
@@ -48,6 +49,11 @@ class StHbtPairCut : public StHbtCutMonitorHandler {
   virtual void eventEnd(const StHbtEvent*)   { /* no-op */ }
   virtual StHbtPairCut* clone()              { return nullptr; }
 
+  /// Save and restore the internal state (e.g. counters) of the cut for
+  /// checkpointing. Histograms of the cut monitors are stored by the analysis
+  virtual void writeCheckpoint(StHbtCheckpoint&) const { /* no-op */ }
+  virtual bool readCheckpoint(StHbtCheckpoint&)        { return true; }
+
   /// The following allows "back-pointing" from the CorrFctn
   /// to the "parent" Analysis
   friend class StHbtBaseAnalysis;
@@ -5,6 +5,7 @@
 /// StHbtMaker headers
 #include "StHbtParticle.h"
 #include "math_constants.h"
+#include "TpcLocalTransform.h"
 
 /// ROOT headers
 #include "TMath.h"
@@ -21,25 +22,7 @@ float StHbtParticle::mPrimPmPar2= 0.;
 float StHbtParticle::mPrimPpPar0= 0.;
 float StHbtParticle::mPrimPpPar1= 0.;
 float StHbtParticle::mPrimPpPar2= 0.;
-
-float StHbtParticle::mInnerTpcRadius  = 50.f;   //[cm]
-float StHbtParticle::mOuterTpcRadius = 200.f;   //[cm]
-float StHbtParticle::mTpcHalfLength  = 200.f;   //[cm]
-float StHbtParticle::tRowRadius[mNumberOfPadrows] = { 60, 64.8,69.6,74.4,79.2,84,88.8,93.6,98.8, 
-						      104,109.2,114.4,119.6,127.195,129.195,131.195,
-						      133.195,135.195,137.195,139.195,141.195,
-						      143.195,145.195,147.195,149.195,151.195,
-						      153.195,155.195,157.195,159.195,161.195,
-						      163.195,165.195,167.195,169.195,171.195,
-						      173.195,175.195,177.195,179.195,181.195,
-						      183.195,185.195,187.195,189.195 };
-
-//_________________
-int TpcLocalTransform( TVector3& xgl, 
-		       int& iSector, 
-		       int& iPadrow, 
-		       float& xlocal,
-		       double& ttPhi );
+const StHbtHelixParameters StHbtParticle::mNoHelixParameters = {};
 
 //_________________
 StHbtParticle::StHbtParticle() :
@@ -54,6 +37,7 @@ StHbtParticle::StHbtParticle() :
   mTpcTrackExitPointX(0),
   mTpcTrackExitPointY(0),
   mTpcTrackExitPointZ(0),
+  mGeometry( &StHbtTpcGeometry::current() ),
   mNominalPosSampleX{}, mNominalPosSampleY{}, mNominalPosSampleZ{},
   mTpcV0NegPosSampleX(nullptr),
   mTpcV0NegPosSampleY(nullptr),
@@ -123,6 +107,7 @@ StHbtParticle::StHbtParticle(const StHbtParticle &part) :
   mTpcTrackExitPointX(part.mTpcTrackExitPointX),
   mTpcTrackExitPointY(part.mTpcTrackExitPointY),
   mTpcTrackExitPointZ(part.mTpcTrackExitPointZ),
+  mGeometry(part.mGeometry),
   mTpcV0NegPosSampleX(nullptr),
   mTpcV0NegPosSampleY(nullptr),
   mTpcV0NegPosSampleZ(nullptr),
@@ -324,6 +309,7 @@ StHbtParticle& StHbtParticle::operator=(const StHbtParticle& part) {
     mTpcTrackExitPointX = part.mTpcTrackExitPointX;
     mTpcTrackExitPointY = part.mTpcTrackExitPointY;
     mTpcTrackExitPointZ = part.mTpcTrackExitPointZ;
+    mGeometry = part.mGeometry;
 
     memcpy( mNominalPosSampleX, part.mNominalPosSampleX, sizeof(mNominalPosSampleX) );
     memcpy( mNominalPosSampleY, part.mNominalPosSampleY, sizeof(mNominalPosSampleY) );
@@ -531,6 +517,7 @@ StHbtParticle::StHbtParticle(const StHbtTrack* const hbtTrack, const double& mas
   mTpcTrackExitPointX(0),
   mTpcTrackExitPointY(0),
   mTpcTrackExitPointZ(0),
+  mGeometry( &StHbtTpcGeometry::current() ),
   mNominalPosSampleX{},
   mNominalPosSampleY{},
   mNominalPosSampleZ{},
@@ -564,7 +551,7 @@ StHbtParticle::StHbtParticle(const StHbtTrack* const hbtTrack, const double& mas
   /// i.e. in order to remove merged tracks.
   /// This also implies, that all tracks originate from (0,0,0)
 
-  StHbtPhysicalHelix helix = hbtTrack->helix();
+  StHbtPhysicalHelix helix( mTrack->helixParameters() );
   TVector3 pVtx( 0., 0., 0. );
   TVector3 sVtx( 0., 0., 0. );
   TVector3 entrancePoint(0, 0, 0);
@@ -608,6 +595,7 @@ StHbtParticle::StHbtParticle(const StHbtV0* const hbtV0,
   mEnergy( TMath::Sqrt( hbtV0->ptot2V0() + mass*mass ) ),
   mTpcTrackEntrancePointX(0), mTpcTrackEntrancePointY(0), mTpcTrackEntrancePointZ(0),
   mTpcTrackExitPointX(0), mTpcTrackExitPointY(0), mTpcTrackExitPointZ(0),
+  mGeometry( &StHbtTpcGeometry::current() ),
   mNominalPosSampleX{}, mNominalPosSampleY{}, mNominalPosSampleZ{},
   mTpcV0NegPosSampleX(nullptr), mTpcV0NegPosSampleY(nullptr), mTpcV0NegPosSampleZ(nullptr),
   mZ{}, mU{}, mSect{}, mV0NegZ(nullptr), mV0NegU(nullptr), mV0NegSect(nullptr),
@@ -696,6 +684,7 @@ StHbtParticle::StHbtParticle(const StHbtKink* const hbtKink,
   mTpcTrackExitPointX(0),
   mTpcTrackExitPointY(0),
   mTpcTrackExitPointZ(0),
+  mGeometry( &StHbtTpcGeometry::current() ),
   mNominalPosSampleX{},
   mNominalPosSampleY{},
   mNominalPosSampleZ{},
@@ -744,6 +733,7 @@ StHbtParticle::StHbtParticle(const StHbtXi* const hbtXi, const double& mass) :
   mTpcTrackExitPointX(0),
   mTpcTrackExitPointY(0),
   mTpcTrackExitPointZ(0),
+  mGeometry( &StHbtTpcGeometry::current() ),
   mNominalPosSampleX{},
   mNominalPosSampleY{},
   mNominalPosSampleZ{},
@@ -840,6 +830,7 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
   h    = tHelix->h();
   
   StHbtHelix hel(curv, dip, phase, ZeroVec, h);
+  const StHbtTpcGeometry& geometry = *mGeometry;
 
   std::pair< double, double > candidates;
   /// This is how much length to go to leave through sides of TPC
@@ -848,12 +839,12 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
   double endLength;
   
   /// Figure out how far to go to leave through side...
-  candidates = hel.pathLength( mTpcHalfLength );
+  candidates = hel.pathLength( geometry.tpcHalfLength() );
   sideLength = (candidates.first > 0) ? candidates.first : candidates.second;
 
-  static TVector3 WestEnd( 0., 0., mTpcHalfLength  );
-  static TVector3 EastEnd( 0., 0., -mTpcHalfLength );
-  static TVector3 EndCapNormal( 0., 0., 1.0);
+  TVector3 WestEnd( 0., 0., geometry.tpcHalfLength() );
+  TVector3 EastEnd( 0., 0., -geometry.tpcHalfLength() );
+  static const TVector3 EndCapNormal( 0., 0., 1.0);
 
   endLength = hel.pathLength( WestEnd, EndCapNormal);
   if (endLength < 0.0) {
@@ -872,7 +863,7 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
   *tmpTpcExitPoint = hel.at( firstExitLength );
 
   /// Finally, calculate the position at which the track crosses the inner field cage
-  candidates = hel.pathLength( mInnerTpcRadius );
+  candidates = hel.pathLength( geometry.innerTpcRadius() );
 
   sideLength = (candidates.first > 0) ? candidates.first : candidates.second;
 
@@ -914,19 +905,18 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
   /// separation of these N
   /// Grigory Nigmatkulov: For the future measurements N was changed
   /// to mNumberOfPoints and the *magic numbers* were changed to the
-  /// mInnerTpcRadius and mOuterTpcRadius
+  /// radii of the field cages. The sample radii are tabulated by the geometry
   int irad = 0;
-  candidates = hel.pathLength( mInnerTpcRadius );
-  float step  = (mOuterTpcRadius - mInnerTpcRadius) / ( mNumberOfPoints - 1 ) ;
+  candidates = hel.pathLength( geometry.sampleRadius( 0 ) );
   sideLength = (candidates.first > 0) ? candidates.first : candidates.second;
 
   /// Declare and initialize variable outside the loop
-  float radius = mInnerTpcRadius;
+  float radius = geometry.sampleRadius( 0 );
   
   /// Loop over radii
   while( irad<mNumberOfPoints && !std::isnan( sideLength ) ) {
 
-    radius = mInnerTpcRadius + irad * step;
+    radius = geometry.sampleRadius( irad );
     candidates = hel.pathLength( radius );
     sideLength = (candidates.first > 0) ? candidates.first : candidates.second;
     tmpPosSample[irad] = hel.at(sideLength);
@@ -947,8 +937,7 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
     irad++;
 
     if ( irad<mNumberOfPoints ) {
-      float radius = mInnerTpcRadius + irad*step;
-      candidates = hel.pathLength(radius);
+      candidates = hel.pathLength( geometry.sampleRadius( irad ) );
       sideLength = (candidates.first > 0) ? candidates.first : candidates.second;
     }
   } //while( irad<11 && !std::isnan(sideLength) )
@@ -958,20 +947,16 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
   for (int i=irad; i<11; i++) {
     tmpPosSample[i] = TVector3(-9999.,-9999.,-9999);
   }
-  /*
-    /// Lets see if it will work out and move it to the protected area
-  static float tRowRadius[mNumberOfPadrows] = {60,64.8,69.6,74.4,79.2,84,88.8,93.6,98.8, 
-					       104,109.2,114.4,119.6,127.195,129.195,131.195,
-					       133.195,135.195,137.195,139.195,141.195,
-					       143.195,145.195,147.195,149.195,151.195,
-					       153.195,155.195,157.195,159.195,161.195,
-					       163.195,165.195,167.195,169.195,171.195,
-					       173.195,175.195,177.195,179.195,181.195,
-					       183.195,185.195,187.195,189.195};
-  */
+  /// Pad rows beyond those of the geometry are not used
+  const int tNRows = geometry.numberOfPadrows();
+  for ( int tj=tNRows; tj<mNumberOfPadrows; tj++ ) {
+    tmpZ[tj] = 0.;
+    tmpU[tj] = 0.;
+    tmpSect[tj] = -1;
+  }
 
   int tRow,tSect,tOutOfBound;
-  double tLength,tPhi;
+  double tLength,tPhi,tCos,tSin;
   float tU;
   TVector3 tPoint(0,0,0);
   TVector3 tn(0,0,0);
@@ -979,7 +964,7 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
   int ti = 0;
   
   /// Test to enter the loop
-  candidates =  hel.pathLength(tRowRadius[ti]);
+  candidates =  hel.pathLength( geometry.rowRadius(ti) );
   tLength = (candidates.first > 0) ? candidates.first : candidates.second;
 
   if ( std::isnan(tLength) ) {
@@ -993,9 +978,9 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
   } //if ( std::isnan(tLength) )
 
   /// Start iteration over all padrows
-  while( ti<mNumberOfPadrows && !std::isnan(tLength) ) {
+  while( ti<tNRows && !std::isnan(tLength) ) {
 
-    candidates =  hel.pathLength(tRowRadius[ti]);
+    candidates =  hel.pathLength( geometry.rowRadius(ti) );
     tLength = (candidates.first > 0) ? candidates.first : candidates.second;
 
     if ( std::isnan(tLength) ) {
@@ -1009,7 +994,7 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
 
     tPoint = hel.at(tLength);
     /// Find which sector it is on
-    TpcLocalTransform( tPoint, tmpSect[ti], tRow, tU, tPhi );
+    TpcLocalTransform( geometry, tPoint, tmpSect[ti], tRow, tU, tPhi );
 
     if ( std::isnan(tmpSect[ti]) ) {
       std::cout << "***ERROR tmpSect" << std::endl; 
@@ -1025,10 +1010,12 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
     }
 
     /// calculate crossing plane
-    tn.SetX( TMath::Cos(tPhi) );
-    tn.SetY( TMath::Sin(tPhi) );
-    tr.SetX( tRowRadius[ti] * TMath::Cos(tPhi) );
-    tr.SetY( tRowRadius[ti] * TMath::Sin(tPhi) );
+    tCos = geometry.sectorCos( tmpSect[ti] );
+    tSin = geometry.sectorSin( tmpSect[ti] );
+    tn.SetX( tCos );
+    tn.SetY( tSin );
+    tr.SetX( geometry.rowRadius(ti) * tCos );
+    tr.SetY( geometry.rowRadius(ti) * tSin );
 
     /// Find crossing point
     tLength = hel.pathLength(tr,tn); 
@@ -1042,7 +1029,7 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
 
     tPoint = hel.at(tLength);
     tmpZ[ti] = tPoint.z();
-    tOutOfBound = TpcLocalTransform( tPoint, tSect, tRow, tmpU[ti],  tPhi );
+    tOutOfBound = TpcLocalTransform( geometry, tPoint, tSect, tRow, tmpU[ti], tPhi, ti+1 );
     if ( std::isnan(tSect) ) {
       std::cout << "***ERROR tSect 2" << std::endl; 
     }
@@ -1066,10 +1053,12 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
       if( tmpSect[ti] != tSect ) {
 
 	/// Try again on the other sector
-	tn.SetX( TMath::Cos(tPhi) );
-	tn.SetY( TMath::Sin(tPhi) );
-	tr.SetX( tRowRadius[ti] * TMath::Cos(tPhi) );
-	tr.SetY( tRowRadius[ti] * TMath::Sin(tPhi) );
+	tCos = geometry.sectorCos( tSect );
+	tSin = geometry.sectorSin( tSect );
+	tn.SetX( tCos );
+	tn.SetY( tSin );
+	tr.SetX( geometry.rowRadius(ti) * tCos );
+	tr.SetY( geometry.rowRadius(ti) * tSin );
 
 	/// find crossing point
 	tLength = hel.pathLength(tr,tn);
@@ -1083,7 +1072,7 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
 
 	tmpZ[ti] = tPoint.z();
 	tmpSect[ti] = tSect;
-	tOutOfBound = TpcLocalTransform( tPoint, tSect, tRow, tmpU[ti], tPhi);
+	tOutOfBound = TpcLocalTransform( geometry, tPoint, tSect, tRow, tmpU[ti], tPhi, ti+1 );
 
 	if ( std::isnan(tSect) ) {
 	  std::cout << "***ERROR tSect 3" << std::endl; 
@@ -1124,20 +1113,20 @@ void StHbtParticle::calculateTpcExitAndEntrancePoints(StHbtPhysicalHelix* tHelix
     /// If padrow ti not reached all other beyond are not reached
     /// in this case set sector to -1
     if ( tmpSect[ti] == -1 ) {
-      for (int tj=ti; tj<mNumberOfPadrows; tj++) {
+      for (int tj=ti; tj<tNRows; tj++) {
 	tmpSect[tj] = -1;
-	ti=mNumberOfPadrows;
+	ti=tNRows;
       }
     } //if ( tmpSect[ti] == -1 )
 
     /// Increment padrow
     ti++;
     
-    if ( ti<mNumberOfPadrows ) {
-      candidates =  hel.pathLength(tRowRadius[ti]);
+    if ( ti<tNRows ) {
+      candidates =  hel.pathLength( geometry.rowRadius(ti) );
       tLength = (candidates.first > 0) ? candidates.first : candidates.second;
-    } //if ( ti<mNumberOfPadrows )
-  } //while( ti<mNumberOfPadrows && !std::isnan(tLength) )
+    } //if ( ti<tNRows )
+  } //while( ti<tNRows && !std::isnan(tLength) )
 }
 
 //_________________
@@ -9,6 +9,7 @@
 #include "StHbtXi.h"
 #include "StHbtHiddenInfo.h"
 #include "StHbtPhysicalHelix.h"
+#include "StHbtTpcGeometry.h"
 
 /// ROOT headers
 #include "TLorentzVector.h"
@@ -36,13 +37,12 @@ class StHbtParticle {
   ~StHbtParticle();
 
 
-  /// Information important for the track merging estimation
-  static float mInnerTpcRadius;  //[cm]
-  static float mOuterTpcRadius;  //[cm]
-  static float mTpcHalfLength;   //[cm]
-  static const unsigned short mNumberOfPoints = 11;
-  static const unsigned short mNumberOfPadrows = 45;
-  static float tRowRadius[mNumberOfPadrows];
+  /// Information important for the track merging estimation. The TPC
+  /// dimensions and pad rows are given by the geometry of the particle,
+  /// mNumberOfPadrows is the size of the pad row arrays (rows beyond
+  /// those of the geometry have sector -1)
+  static const unsigned short mNumberOfPoints = StHbtTpcGeometry::kNumberOfPoints;
+  static const unsigned short mNumberOfPadrows = StHbtTpcGeometry::kMaxNumberOfPadrows;
 
   /**
    * Getters
@@ -74,7 +74,13 @@ class StHbtParticle {
   { return TVector3( mPrimaryVertexX, mPrimaryVertexY, mPrimaryVertexZ ); }
 
   /// StHbtTrack information
-  StHbtPhysicalHelix helix() const         { return mTrack ? mTrack->helix() : StHbtPhysicalHelix(); }
+  StHbtPhysicalHelix helix() const         { return StHbtPhysicalHelix( helixParameters() ); }
+  /// Parameters of the track helix (all zero if not a track). The track
+  /// computes them when the particle is constructed
+  const StHbtHelixParameters& helixParameters() const
+  { return mTrack ? mTrack->helixParameters() : mNoHelixParameters; }
+  /// TPC geometry the particle was made with
+  const StHbtTpcGeometry& geometry() const { return *mGeometry; }
   unsigned int topologyMap(const unsigned int& word) const { return mTrack ? mTrack->topologyMap(word) : 0; }
   unsigned short nHits() const             { return mTrack ? mTrack->nHits() : 0; }
   unsigned short numberOfHits() const      { return nHits(); }
@@ -283,6 +289,10 @@ class StHbtParticle {
   float mTpcTrackExitPointX;
   float mTpcTrackExitPointY;
   float mTpcTrackExitPointZ;
+  /// Helix parameters of the particles without a track
+  static const StHbtHelixParameters mNoHelixParameters;
+  /// TPC geometry (current geometry at construction, not owned)
+  const StHbtTpcGeometry* mGeometry;
   
   /// Calculated track positions at each mNumberOfPoints
   float mNominalPosSampleX[mNumberOfPoints];
@@ -21,6 +21,7 @@
 
 /// Forward declaration
 class StHbtBaseAnalysis;
+class StHbtCheckpoint;
 
 //_________________
 class StHbtParticleCut : public StHbtCutMonitorHandler {
@@ -48,6 +49,11 @@ class StHbtParticleCut : public StHbtCutMonitorHandler {
   virtual void eventEnd(const StHbtEvent*)     { /* no-op */ }
   virtual StHbtParticleCut* clone()            { return nullptr; }
 
+  /// Save and restore the internal state (e.g. counters) of the cut for
+  /// checkpointing. Histograms of the cut monitors are stored by the analysis
+  virtual void writeCheckpoint(StHbtCheckpoint&) const { /* no-op */ }
+  virtual bool readCheckpoint(StHbtCheckpoint&)        { return true; }
+
   virtual StHbtParticleType type() = 0;
 
   /// The following allows "back-pointing" from the CorrFctn
@@ -29,6 +29,8 @@ class StHbtPhysicalHelix : public StHbtHelix {
   /// Constructor with Curvature, dip angle, phase, origin, h
   StHbtPhysicalHelix(double, double, double,
 		     const TVector3&, Int_t h=-1);
+  /// Constructor from the parameters in plain form (no recomputation)
+  explicit StHbtPhysicalHelix(const StHbtHelixParameters& helix) : StHbtHelix(helix) { /* empty */ }
   /// Destructor
   ~StHbtPhysicalHelix();
 
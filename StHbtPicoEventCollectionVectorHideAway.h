@@ -41,6 +41,11 @@ class StHbtPicoEventCollectionVectorHideAway {
   StHbtPicoEventCollection* picoEventCollection(int, int, int);
   StHbtPicoEventCollection* picoEventCollection(double x, double y=0, double z=0);
 
+  /// Number of bins and the collection of the bin (nullptr if out of range)
+  int numberOfBins() const                { return mBinsTot; }
+  StHbtPicoEventCollection* binCollection(const int& bin)
+  { return ( bin >= 0 && bin < mBinsTot ) ? mCollectionVector[bin] : nullptr; }
+
   unsigned int binXNumber(double x) const { return (int)floor( (x - mMinX) / mStepX ); }
   unsigned int binYNumber(double y) const { return (int)floor( (y - mMinY) / mStepY ); }
   unsigned int binZNumber(double z) const { return (int)floor( (z - mMinZ) / mStepZ ); }
@@ -0,0 +1,253 @@
+/**
+ * Description: Event reader wrapper that reads ahead on a background thread.
+ */
+
+/// C++ headers
+#include <cstdio>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/// StHbtMaker headers
+#include "StHbtEvent.h"
+#include "StHbtPrefetchReader.h"
+
+#ifdef __ROOT__
+ClassImp(StHbtPrefetchReader)
+#endif
+
+//_________________
+struct StHbtPrefetchReader::Queue {
+
+  /// Result of one returnHbtEvent() call of the wrapped reader
+  struct Entry {
+    StHbtEvent *event;
+    int status;
+  };
+
+  Queue() : stopRequested(false), finished(false) { /* empty */ }
+
+  std::deque<Entry> entries;
+  std::mutex mutex;
+  /// Signalled when an entry is added or the reading is finished
+  std::condition_variable notEmpty;
+  /// Signalled when an entry is taken or stop is requested
+  std::condition_variable notFull;
+  std::thread thread;
+  /// Set by the consumer to stop the reading thread
+  bool stopRequested;
+  /// Set by the reading thread when the wrapped reader reported non-zero status
+  bool finished;
+  /// Status returned after the queue has been drained
+  int lastStatus;
+
+  /// Reading thread loop
+  void run(StHbtEventReader *reader, const unsigned int nEvents) {
+    while ( true ) {
+      {
+	std::unique_lock<std::mutex> lock( mutex );
+	notFull.wait( lock, [&] { return stopRequested || entries.size() < nEvents; } );
+	if ( stopRequested ) break;
+      }
+
+      /// Read outside of the lock so that the consumer is not blocked
+      Entry entry;
+      entry.event = reader->returnHbtEvent();
+      entry.status = entry.event ? 0 : reader->status();
+
+      std::lock_guard<std::mutex> lock( mutex );
+      entries.push_back( entry );
+      if ( entry.status != 0 ) {
+	/// EOF or error: nothing more to read
+	finished = true;
+	lastStatus = entry.status;
+	notEmpty.notify_one();
+	break;
+      }
+      notEmpty.notify_one();
+    } //while ( true )
+  }
+};
+
+//_________________
+StHbtPrefetchReader::StHbtPrefetchReader() :
+  StHbtEventReader(), mReader(nullptr), mNEvents(2), mQueue(nullptr) {
+  /* empty */
+}
+
+//_________________
+StHbtPrefetchReader::StHbtPrefetchReader(StHbtEventReader* reader,
+					 const unsigned int& nEvents) :
+  StHbtEventReader(), mReader(reader), mNEvents( ( nEvents > 0 ) ? nEvents : 1 ),
+  mQueue(nullptr) {
+  if ( mReader ) {
+    mDebug = mReader->debug();
+  }
+}
+
+//_________________
+StHbtPrefetchReader::~StHbtPrefetchReader() {
+  stop();
+  delete mReader;
+}
+
+//_________________
+void StHbtPrefetchReader::stop() {
+
+  if ( !mQueue ) return;
+
+  {
+    std::lock_guard<std::mutex> lock( mQueue->mutex );
+    mQueue->stopRequested = true;
+  }
+  mQueue->notFull.notify_all();
+  if ( mQueue->thread.joinable() ) {
+    mQueue->thread.join();
+  }
+
+  /// Events read ahead but not consumed
+  while ( !mQueue->entries.empty() ) {
+    releaseHbtEvent( mQueue->entries.front().event );
+    mQueue->entries.pop_front();
+  }
+
+  delete mQueue;
+  mQueue = nullptr;
+}
+
+//_________________
+int StHbtPrefetchReader::init(const char* ReadWrite, StHbtString& Message) {
+
+  if ( !mReader ) {
+    std::cout << "[ERROR] StHbtPrefetchReader::init - no reader to wrap" << std::endl;
+    mReaderStatus = 1;
+    return 1;
+  }
+
+  /// Wrapped reader is initialized on the calling thread
+  int iReturn = mReader->init( ReadWrite, Message );
+  if ( iReturn ) {
+    mReaderStatus = mReader->status();
+    return iReturn;
+  }
+
+  stop();
+  mQueue = new Queue();
+  mQueue->lastStatus = 0;
+  mQueue->thread = std::thread( &Queue::run, mQueue, mReader, mNEvents );
+
+  if ( mDebug ) {
+    std::cout << "StHbtPrefetchReader::init - reading ahead " << mNEvents
+	      << " event(s) on a background thread" << std::endl;
+  }
+  return 0;
+}
+
+//_________________
+StHbtEvent* StHbtPrefetchReader::returnHbtEvent() {
+
+  if ( !mReader ) {
+    mReaderStatus = 1;
+    return nullptr;
+  }
+
+  /// Not initialized: behave as the wrapped reader
+  if ( !mQueue ) {
+    StHbtEvent *event = mReader->returnHbtEvent();
+    mReaderStatus = mReader->status();
+    return event;
+  }
+
+  std::unique_lock<std::mutex> lock( mQueue->mutex );
+  mQueue->notEmpty.wait( lock, [&] { return !mQueue->entries.empty() || mQueue->finished; } );
+
+  if ( mQueue->entries.empty() ) {
+    /// Reading finished and all results were consumed
+    mReaderStatus = mQueue->lastStatus;
+    return nullptr;
+  }
+
+  Queue::Entry entry = mQueue->entries.front();
+  mQueue->entries.pop_front();
+  lock.unlock();
+  mQueue->notFull.notify_one();
+
+  mReaderStatus = entry.status;
+  return entry.event;
+}
+
+//_________________
+void StHbtPrefetchReader::finish() {
+  stop();
+  if ( mReader ) {
+    mReader->finish();
+  }
+}
+
+//_________________
+StHbtString StHbtPrefetchReader::report() {
+  StHbtString temp = "\n This is StHbtPrefetchReader reporting";
+  char ctemp[100];
+  sprintf( ctemp, "\n---> Number of events to read ahead: %u", mNEvents );
+  temp += ctemp;
+  temp += "\n---> Wrapped reader: ";
+  if ( mReader ) {
+    temp += mReader->report();
+  }
+  else {
+    temp += "NONE\n";
+  }
+  return temp;
+}
+
+//_________________
+int StHbtPrefetchReader::writeHbtEvent(StHbtEvent* event) {
+  return mReader ? mReader->writeHbtEvent( event ) : 0;
+}
+
+//_________________
+void StHbtPrefetchReader::releaseHbtEvent(StHbtEvent* event) {
+  if ( mReader ) {
+    mReader->releaseHbtEvent( event );
+  }
+  else {
+    delete event;
+  }
+}
+
+//_________________
+void StHbtPrefetchReader::setEventCut(StHbtEventCut* ecut) {
+  StHbtEventReader::setEventCut( ecut );
+  if ( mReader ) mReader->setEventCut( ecut );
+}
+
+//_________________
+void StHbtPrefetchReader::setTrackCut(StHbtTrackCut* pcut) {
+  StHbtEventReader::setTrackCut( pcut );
+  if ( mReader ) mReader->setTrackCut( pcut );
+}
+
+//_________________
+void StHbtPrefetchReader::setV0Cut(StHbtV0Cut* pcut) {
+  StHbtEventReader::setV0Cut( pcut );
+  if ( mReader ) mReader->setV0Cut( pcut );
+}
+
+//_________________
+void StHbtPrefetchReader::setXiCut(StHbtXiCut* pcut) {
+  StHbtEventReader::setXiCut( pcut );
+  if ( mReader ) mReader->setXiCut( pcut );
+}
+
+//_________________
+void StHbtPrefetchReader::setKinkCut(StHbtKinkCut* pcut) {
+  StHbtEventReader::setKinkCut( pcut );
+  if ( mReader ) mReader->setKinkCut( pcut );
+}
+
+//_________________
+void StHbtPrefetchReader::setPreFilter(const StHbtEventPreFilter& filter) {
+  StHbtEventReader::setPreFilter( filter );
+  if ( mReader ) mReader->setPreFilter( filter );
+}
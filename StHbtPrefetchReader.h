@@ -0,0 +1,85 @@
+/**
+ * Description: Event reader wrapper that reads ahead on a background thread.
+ *
+ * StHbtPrefetchReader wraps any StHbtEventReader and calls its
+ * returnHbtEvent() on a separate thread, keeping up to K read-ahead
+ * results in a bounded queue. The manager consumes them with the usual
+ * returnHbtEvent()/status() calls, so I/O, decompression and StHbtEvent
+ * construction overlap with the pair loops of the analyses.
+ *
+ * Every call of the wrapped reader is queued together with the status
+ * it reported, including nullptr results: a nullptr with status 0 (try
+ * again) is passed to the manager as is, and a non-zero status (EOF or
+ * error) stops reading ahead. The sequence seen by the manager is the
+ * same as without the wrapper. Existing readers need no change, but they
+ * must not be used from another thread between init() and finish().
+ *
+ * The wrapper owns the wrapped reader and deletes it in its destructor.
+ */
+
+#ifndef StHbtPrefetchReader_h
+#define StHbtPrefetchReader_h
+
+/// StHbtMaker headers
+#include "StHbtEventReader.h"
+
+//_________________
+class StHbtPrefetchReader : public StHbtEventReader {
+
+ public:
+  /// Default constructor
+  StHbtPrefetchReader();
+  /// Wrap the reader and read ahead up to nEvents events
+  StHbtPrefetchReader(StHbtEventReader* reader, const unsigned int& nEvents = 2);
+  /// Destructor. Stops the reading thread and deletes the wrapped reader
+  virtual ~StHbtPrefetchReader();
+
+  /// Initialize the wrapped reader and start the reading thread
+  virtual int init(const char* ReadWrite, StHbtString& Message);
+  /// Return the next read-ahead event (or the wrapped reader's nullptr).
+  /// Without init() the wrapped reader is called directly
+  virtual StHbtEvent* returnHbtEvent();
+  /// Stop the reading thread, drop the queued events and finish
+  /// the wrapped reader
+  virtual void finish();
+  virtual StHbtString report();
+  virtual int writeHbtEvent(StHbtEvent* event);
+  /// Processed events are given back to the wrapped reader
+  virtual void releaseHbtEvent(StHbtEvent* event);
+
+  /// Cuts and the pre-filter are forwarded to the wrapped reader
+  virtual void setEventCut(StHbtEventCut* ecut);
+  virtual void setTrackCut(StHbtTrackCut* pcut);
+  virtual void setV0Cut(StHbtV0Cut* pcut);
+  virtual void setXiCut(StHbtXiCut* pcut);
+  virtual void setKinkCut(StHbtKinkCut* pcut);
+  virtual void setPreFilter(const StHbtEventPreFilter& filter);
+
+  /// Return the wrapped reader
+  StHbtEventReader* reader()                  { return mReader; }
+  /// Number of results read ahead (at least 1). Used at init()
+  void setNumberOfEvents(const unsigned int& n) { mNEvents = ( n > 0 ) ? n : 1; }
+  unsigned int numberOfEvents() const         { return mNEvents; }
+
+ private:
+  /// Not copyable: the thread and the queue can not be shared
+  StHbtPrefetchReader(const StHbtPrefetchReader&);
+  StHbtPrefetchReader& operator=(const StHbtPrefetchReader&);
+
+  /// Stop and join the reading thread, delete queued events
+  void stop();
+
+  /// Wrapped reader (owned)
+  StHbtEventReader *mReader;
+  /// Maximal number of queued results
+  unsigned int mNEvents;
+  /// Thread, queue and synchronization (defined in the source file)
+  struct Queue;
+  Queue *mQueue;                              //!
+
+#ifdef __ROOT__
+  ClassDef(StHbtPrefetchReader, 0)
+#endif
+};
+
+#endif // #define StHbtPrefetchReader_h
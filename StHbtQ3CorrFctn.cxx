@@ -0,0 +1,114 @@
+/**
+ * Description: Three-particle correlation function in Q3
+ */
+
+/// StHbtMaker headers
+#include "StHbtQ3CorrFctn.h"
+
+/// ROOT headers
+#include "TH1D.h"
+
+#ifdef __ROOT__
+ClassImp(StHbtQ3CorrFctn);
+#endif
+
+//_________________
+StHbtQ3CorrFctn::StHbtQ3CorrFctn(const char* title, const int& nBins,
+				 const float& q3Lo, const float& q3Hi) :
+  StHbtCorrFctn(),
+  mNumerator(nullptr),
+  mDenominator(nullptr) {
+
+  TString hist_title = TString::Format("%s; Q_{3} (GeV/c); Entries", title);
+  mNumerator = new TH1D( TString("Num") + title, hist_title, nBins, q3Lo, q3Hi );
+  mDenominator = new TH1D( TString("Den") + title, hist_title, nBins, q3Lo, q3Hi );
+  /// Enable error bar calculation
+  mNumerator->Sumw2();
+  mDenominator->Sumw2();
+}
+
+//_________________
+StHbtQ3CorrFctn::StHbtQ3CorrFctn(const StHbtQ3CorrFctn& c) :
+  StHbtCorrFctn(c),
+  mNumerator( new TH1D( *c.mNumerator ) ),
+  mDenominator( new TH1D( *c.mDenominator ) ) {
+  /* empty */
+}
+
+//_________________
+StHbtQ3CorrFctn& StHbtQ3CorrFctn::operator=(const StHbtQ3CorrFctn& c) {
+  if ( this != &c ) {
+    StHbtCorrFctn::operator=( c );
+    *mNumerator = *c.mNumerator;
+    *mDenominator = *c.mDenominator;
+  }
+  return *this;
+}
+
+//_________________
+StHbtQ3CorrFctn::~StHbtQ3CorrFctn() {
+  delete mNumerator;
+  delete mDenominator;
+}
+
+//_________________
+StHbtCorrFctn* StHbtQ3CorrFctn::createShard() {
+  /// Empty copies that are not registered in the current directory
+  StHbtQ3CorrFctn *shard = new StHbtQ3CorrFctn( *this );
+  shard->mNumerator->SetDirectory( nullptr );
+  shard->mDenominator->SetDirectory( nullptr );
+  shard->mNumerator->Reset();
+  shard->mDenominator->Reset();
+  return shard;
+}
+
+//_________________
+void StHbtQ3CorrFctn::mergeShard(StHbtCorrFctn* shard) {
+  StHbtQ3CorrFctn *cf = dynamic_cast<StHbtQ3CorrFctn*>( shard );
+  if ( !cf || cf == this ) {
+    std::cout << "[WARNING] StHbtQ3CorrFctn::mergeShard - not a shard of this function"
+	      << std::endl;
+    return;
+  }
+  mNumerator->Add( cf->mNumerator );
+  mDenominator->Add( cf->mDenominator );
+  cf->mNumerator->Reset();
+  cf->mDenominator->Reset();
+}
+
+//_________________
+void StHbtQ3CorrFctn::addRealTriplet(const StHbtTriplet* triplet) {
+  mNumerator->Fill( triplet->qInv() );
+}
+
+//_________________
+void StHbtQ3CorrFctn::addMixedTriplet(const StHbtTriplet* triplet) {
+  mDenominator->Fill( triplet->qInv() );
+}
+
+//_________________
+void StHbtQ3CorrFctn::finish() {
+  /* empty */
+}
+
+//_________________
+void StHbtQ3CorrFctn::writeOutHistos() {
+  mNumerator->Write();
+  mDenominator->Write();
+}
+
+//_________________
+TList* StHbtQ3CorrFctn::getOutputList() {
+  TList *outputList = new TList();
+  outputList->Add( mNumerator );
+  outputList->Add( mDenominator );
+  return outputList;
+}
+
+//_________________
+StHbtString StHbtQ3CorrFctn::report() {
+  TString report = "Q3 Three-Particle Correlation Function Report:\n";
+  report += TString::Format("Number of entries in numerator:\t%E\n", mNumerator->GetEntries());
+  report += TString::Format("Number of entries in denominator:\t%E\n", mDenominator->GetEntries());
+  return StHbtString( (const char *)report );
+}
@@ -0,0 +1,66 @@
+/**
+ * Description: Three-particle correlation function in Q3
+ *
+ * Numerator and denominator of Q3 = sqrt( q12^2 + q23^2 + q31^2 ) filled
+ * with the real and mixed triplets of StHbtTripletAnalysis. Shards for
+ * the threads of the triplet loop have their own (unregistered)
+ * histograms, which are added to the histograms of the function.
+ */
+
+#ifndef StHbtQ3CorrFctn_h
+#define StHbtQ3CorrFctn_h
+
+/// Forward declarations
+class TH1D;
+
+/// StHbtMaker headers
+#include "StHbtCorrFctn.h"
+
+/// ROOT headers
+#include "TString.h"
+
+//_________________
+class StHbtQ3CorrFctn : public StHbtCorrFctn {
+
+ public:
+  /// Constructor with the title and the Q3 binning
+  StHbtQ3CorrFctn(const char* title, const int& nBins, const float& q3Lo, const float& q3Hi);
+  /// Copy constructor
+  StHbtQ3CorrFctn(const StHbtQ3CorrFctn& copy);
+  /// Assignment operator
+  StHbtQ3CorrFctn& operator=(const StHbtQ3CorrFctn& copy);
+  /// Destructor
+  virtual ~StHbtQ3CorrFctn();
+
+  virtual StHbtString report();
+  virtual void addRealTriplet(const StHbtTriplet* triplet);
+  virtual void addMixedTriplet(const StHbtTriplet* triplet);
+  /// Pairs are not used
+  virtual void addRealPair(const StHbtPair*)         { /* no-op */ }
+  virtual void addMixedPair(const StHbtPair*)        { /* no-op */ }
+  virtual void finish();
+
+  /// Return numerator and denominator
+  TH1D* numerator()                                  { return mNumerator; }
+  TH1D* denominator()                                { return mDenominator; }
+
+  void writeOutHistos();
+  virtual TList* getOutputList();
+
+  virtual StHbtCorrFctn* clone()                     { return new StHbtQ3CorrFctn( *this ); }
+  virtual StHbtCorrFctn* createShard();
+  virtual void mergeShard(StHbtCorrFctn* shard);
+
+ private:
+
+  /// Numerator
+  TH1D* mNumerator;
+  /// Denominator
+  TH1D* mDenominator;
+
+#ifdef __ROOT__
+  ClassDef(StHbtQ3CorrFctn, 1)
+#endif
+};
+
+#endif // #define StHbtQ3CorrFctn_h
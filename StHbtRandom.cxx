@@ -0,0 +1,17 @@
+/**
+ * Description: counter-based random numbers (Philox4x32-10)
+ */
+
+/// C++ headers
+#include <atomic>
+
+/// StHbtMaker headers
+#include "StHbtRandom.h"
+
+//_________________
+StHbtRandom& StHbtRandom::threadGenerator() {
+  /// Each thread gets the next stream
+  static std::atomic<unsigned long long> nextStream( 0 );
+  thread_local StHbtRandom generator( 0x5374486274526E64ULL, nextStream++ );
+  return generator;
+}
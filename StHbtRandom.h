@@ -0,0 +1,97 @@
+/**
+ * Description: counter-based random numbers (Philox4x32-10)
+ *
+ * StHbtRandom produces random numbers as a function of a 64-bit key and a
+ * 128-bit counter: block() maps (key, counter) to four independent 32-bit
+ * words with the Philox4x32-10 bijection (Salmon et al., SC'11). There is
+ * no hidden state and no locking, so the numbers of a given (key,
+ * counter) are the same in every thread and in every run. The analysis
+ * uses its seed as the key and the event and pair numbers as the counter,
+ * which makes per-pair random decisions reproducible under any pairing
+ * order or threading.
+ *
+ * An StHbtRandom object is a sequential stream: the counter is (stream,
+ * position) and the words of consecutive blocks are returned one by one.
+ * threadGenerator() returns a stream of the calling thread (different
+ * streams for different threads) for code without a natural counter.
+ */
+
+#ifndef StHbtRandom_h
+#define StHbtRandom_h
+
+//_________________
+class StHbtRandom {
+
+ public:
+  /// Stream of the key
+  StHbtRandom(const unsigned long long& key = 0, const unsigned long long& stream = 0) :
+    mKey(key), mStream(stream), mPosition(0), mWord(4), mBuffer{} { /* empty */ }
+  /// Destructor
+  ~StHbtRandom()                                { /* empty */ }
+
+  /// Four random words of the counter (counterLow, counterHigh) and key
+  static void block(const unsigned long long& key, const unsigned long long& counterLow,
+		    const unsigned long long& counterHigh, unsigned int* words);
+
+  /// Next random word of the stream
+  unsigned int next() {
+    if ( mWord == 4 ) {
+      block( mKey, mPosition++, mStream, mBuffer );
+      mWord = 0;
+    }
+    return mBuffer[mWord++];
+  }
+  /// Uniform number in [0,1) with 32 random bits
+  double uniform()                              { return next() * ( 1. / 4294967296. ); }
+  /// Uniform number in [0,1) of a random word
+  static double uniform(const unsigned int& word) { return word * ( 1. / 4294967296. ); }
+
+  /// Restart the stream
+  void setKey(const unsigned long long& key)    { mKey = key; mPosition = 0; mWord = 4; }
+  void setStream(const unsigned long long& stream) { mStream = stream; mPosition = 0; mWord = 4; }
+
+  /// Stream of the calling thread (created on the first call of the thread)
+  static StHbtRandom& threadGenerator();
+
+ private:
+  unsigned long long mKey;
+  unsigned long long mStream;
+  unsigned long long mPosition;
+  /// Next unused word of mBuffer (4 if none)
+  unsigned int mWord;
+  unsigned int mBuffer[4];
+};
+
+//_________________
+inline void StHbtRandom::block(const unsigned long long& key, const unsigned long long& counterLow,
+			       const unsigned long long& counterHigh, unsigned int* words) {
+  /// Philox4x32 multipliers and Weyl increments of the key
+  const unsigned long long kM0 = 0xD2511F53ULL;
+  const unsigned long long kM1 = 0xCD9E8D57ULL;
+  const unsigned int kW0 = 0x9E3779B9U;
+  const unsigned int kW1 = 0xBB67AE85U;
+
+  unsigned int c0 = (unsigned int)counterLow;
+  unsigned int c1 = (unsigned int)( counterLow >> 32 );
+  unsigned int c2 = (unsigned int)counterHigh;
+  unsigned int c3 = (unsigned int)( counterHigh >> 32 );
+  unsigned int k0 = (unsigned int)key;
+  unsigned int k1 = (unsigned int)( key >> 32 );
+
+  for ( int iRound=0; iRound<10; iRound++ ) {
+    const unsigned long long p0 = kM0 * c0;
+    const unsigned long long p1 = kM1 * c2;
+    c0 = (unsigned int)( p1 >> 32 ) ^ c1 ^ k0;
+    c1 = (unsigned int)p1;
+    c2 = (unsigned int)( p0 >> 32 ) ^ c3 ^ k1;
+    c3 = (unsigned int)p0;
+    k0 += kW0;
+    k1 += kW1;
+  }
+  words[0] = c0;
+  words[1] = c1;
+  words[2] = c2;
+  words[3] = c3;
+}
+
+#endif // #define StHbtRandom_h
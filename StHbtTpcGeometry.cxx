@@ -0,0 +1,356 @@
+/**
+ * Description: TPC geometry used for the two-track (merging) estimations
+ */
+
+/// C++ headers
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+/// StHbtMaker headers
+#include "StHbtTpcGeometry.h"
+
+/// ROOT headers
+#include "TMath.h"
+
+/// Geometries that were made current (kept until the end of the program)
+static std::mutex gTpcGeometryMutex;
+static std::vector< std::unique_ptr<const StHbtTpcGeometry> > gTpcGeometries;
+static std::atomic<const StHbtTpcGeometry*> gCurrentTpcGeometry( nullptr );
+
+//_________________
+StHbtTpcGeometry::StHbtTpcGeometry() :
+  mInnerTpcRadius(50.f),      //[cm]
+  mOuterTpcRadius(200.f),     //[cm]
+  mTpcHalfLength(200.f),      //[cm]
+  mPairRadiusMin(60.),        //[cm]
+  mPairRadiusMax(190.),       //[cm]
+  mPadPlaneRadiusMin(57.6),   //[cm]
+  mPadWidthInner(0.335),      //[cm]
+  mPadWidthOuter(0.67),       //[cm]
+  mMaxDuInner(3.f), mMaxDzInner(4.f),
+  mMaxDuOuter(4.f), mMaxDzOuter(6.f),
+  mNumberOfPadrows(0), mNumberOfInnerPadrows(0),
+  mRowRadius{}, mRowRadiusMax{}, mNumberOfPads{},
+  mNumberOfSectorsPerSide(0), mSectorPhiUnits{},
+  mSampleRadius{}, mRowHalfWidth{}, mMaxDu{}, mMaxDz{},
+  mInvMaxDu2{}, mInvMaxDz2{}, mSectorPhi{}, mSectorCos{}, mSectorSin{},
+  mSectorAtPhiBin{} {
+
+  /// STAR TPC: 13 inner and 32 outer pad rows
+  static const float tRowRadius[45] = {
+    60, 64.8, 69.6, 74.4, 79.2, 84, 88.8, 93.6, 98.8,
+    104, 109.2, 114.4, 119.6, 127.195, 129.195, 131.195,
+    133.195, 135.195, 137.195, 139.195, 141.195,
+    143.195, 145.195, 147.195, 149.195, 151.195,
+    153.195, 155.195, 157.195, 159.195, 161.195,
+    163.195, 165.195, 167.195, 169.195, 171.195,
+    173.195, 175.195, 177.195, 179.195, 181.195,
+    183.195, 185.195, 187.195, 189.195 };
+  static const int tNPadAtRow[45] = {
+    88, 96, 104, 112, 118, 126, 134, 142, 150, 158, 166, 174, 182,
+    98, 100, 102, 104, 106, 106, 108, 110, 112, 112, 114, 116, 118, 120, 122, 122,
+    124, 126, 128, 128, 130, 132, 134, 136, 138, 138, 140, 142, 144, 144, 144, 144 };
+  /// Phi of the 24 sectors in units of 30 degrees
+  static const double tSectToPhi[24] = {
+    2., 1., 0., 11., 10., 9., 8., 7., 6., 5., 4., 3.,
+    4., 5., 6., 7., 8., 9., 10., 11., 0., 1., 2., 3. };
+
+  /// Upper edges of the rows: 4.8 cm pitch for the first 7 rows, 5.2 cm
+  /// up to the last inner row and 2 cm in the outer sectors
+  std::vector<float> radius( tRowRadius, tRowRadius + 45 );
+  std::vector<float> radiusMax( 45 );
+  std::vector<int> nPads( tNPadAtRow, tNPadAtRow + 45 );
+  float radmax = 62.4;
+  float spacing = 4.8;
+  for ( int iRow=1; iRow<=45; iRow++ ) {
+    if ( iRow == 8 ) {
+      radmax = 96.2;
+      spacing = 5.2;
+    }
+    else if ( iRow == 13 ) {
+      radmax = 126.195;
+      spacing = 2.0;
+    }
+    else if ( iRow > 1 ) {
+      radmax += spacing;
+    }
+    radiusMax[iRow-1] = radmax;
+  }
+  setPadrows( radius, radiusMax, nPads, 13 );
+  setSectorPhi( std::vector<double>( tSectToPhi, tSectToPhi + 24 ) );
+  update();
+}
+
+//_________________
+const StHbtTpcGeometry& StHbtTpcGeometry::current() {
+  const StHbtTpcGeometry* geometry = gCurrentTpcGeometry.load( std::memory_order_acquire );
+  if ( geometry ) return *geometry;
+
+  std::lock_guard<std::mutex> lock( gTpcGeometryMutex );
+  geometry = gCurrentTpcGeometry.load( std::memory_order_acquire );
+  if ( !geometry ) {
+    gTpcGeometries.emplace_back( new StHbtTpcGeometry() );
+    geometry = gTpcGeometries.back().get();
+    gCurrentTpcGeometry.store( geometry, std::memory_order_release );
+  }
+  return *geometry;
+}
+
+//_________________
+bool StHbtTpcGeometry::setCurrent(const StHbtTpcGeometry& geometry) {
+  std::unique_ptr<StHbtTpcGeometry> newGeometry( new StHbtTpcGeometry( geometry ) );
+  if ( !newGeometry->update() ) {
+    std::cout << "[ERROR] StHbtTpcGeometry::setCurrent - invalid geometry, "
+	      << "the current one is kept" << std::endl;
+    return false;
+  }
+  std::lock_guard<std::mutex> lock( gTpcGeometryMutex );
+  gTpcGeometries.emplace_back( std::move( newGeometry ) );
+  gCurrentTpcGeometry.store( gTpcGeometries.back().get(), std::memory_order_release );
+  return true;
+}
+
+//_________________
+bool StHbtTpcGeometry::loadCurrent(const char* file) {
+  StHbtTpcGeometry geometry;
+  if ( !geometry.readFile( file ) ) {
+    return false;
+  }
+  return setCurrent( geometry );
+}
+
+//_________________
+void StHbtTpcGeometry::setPadrows(const std::vector<float>& radius,
+				  const std::vector<float>& radiusMax,
+				  const std::vector<int>& nPads, const int& nInner) {
+  if ( radius.size() != radiusMax.size() || radius.size() != nPads.size() ||
+       radius.size() > kMaxNumberOfPadrows ) {
+    std::cout << "[ERROR] StHbtTpcGeometry::setPadrows - wrong number of pad rows: "
+	      << radius.size() << " " << radiusMax.size() << " " << nPads.size()
+	      << " (at most " << kMaxNumberOfPadrows << ")" << std::endl;
+    mNumberOfPadrows = 0;
+    return;
+  }
+  mNumberOfPadrows = radius.size();
+  mNumberOfInnerPadrows = nInner;
+  for ( int iRow=0; iRow<mNumberOfPadrows; iRow++ ) {
+    mRowRadius[iRow] = radius[iRow];
+    mRowRadiusMax[iRow] = radiusMax[iRow];
+    mNumberOfPads[iRow] = nPads[iRow];
+  }
+}
+
+//_________________
+void StHbtTpcGeometry::setSectorPhi(const std::vector<double>& sectorPhi) {
+  if ( sectorPhi.size() % 2 || sectorPhi.size() > 2 * kMaxSectorsPerSide ) {
+    std::cout << "[ERROR] StHbtTpcGeometry::setSectorPhi - wrong number of sectors: "
+	      << sectorPhi.size() << std::endl;
+    mNumberOfSectorsPerSide = 0;
+    return;
+  }
+  mNumberOfSectorsPerSide = sectorPhi.size() / 2;
+  for ( unsigned int iSect=0; iSect<sectorPhi.size(); iSect++ ) {
+    mSectorPhiUnits[iSect] = sectorPhi[iSect];
+  }
+}
+
+//_________________
+void StHbtTpcGeometry::setMergingPar(const float& maxDuInner, const float& maxDzInner,
+				     const float& maxDuOuter, const float& maxDzOuter) {
+  mMaxDuInner = maxDuInner;
+  mMaxDzInner = maxDzInner;
+  mMaxDuOuter = maxDuOuter;
+  mMaxDzOuter = maxDzOuter;
+}
+
+//_________________
+bool StHbtTpcGeometry::update() {
+
+  if ( mNumberOfPadrows <= 0 || mNumberOfInnerPadrows < 0 ||
+       mNumberOfInnerPadrows > mNumberOfPadrows ) {
+    std::cout << "[ERROR] StHbtTpcGeometry::update - no pad rows or wrong number of inner rows"
+	      << std::endl;
+    return false;
+  }
+  if ( mNumberOfSectorsPerSide <= 0 ) {
+    std::cout << "[ERROR] StHbtTpcGeometry::update - no sectors" << std::endl;
+    return false;
+  }
+  if ( !( mInnerTpcRadius > 0 && mOuterTpcRadius > mInnerTpcRadius && mTpcHalfLength > 0 ) ) {
+    std::cout << "[ERROR] StHbtTpcGeometry::update - wrong TPC dimensions" << std::endl;
+    return false;
+  }
+  if ( !( mMaxDuInner > 0 && mMaxDzInner > 0 && mMaxDuOuter > 0 && mMaxDzOuter > 0 ) ) {
+    std::cout << "[ERROR] StHbtTpcGeometry::update - merging parameters must be positive"
+	      << std::endl;
+    return false;
+  }
+  /// The row search needs increasing upper edges
+  for ( int iRow=0; iRow<mNumberOfPadrows; iRow++ ) {
+    if ( ( iRow > 0 && !( mRowRadiusMax[iRow] > mRowRadiusMax[iRow-1] ) ) ||
+	 mNumberOfPads[iRow] <= 0 ) {
+      std::cout << "[ERROR] StHbtTpcGeometry::update - pad row " << iRow + 1
+		<< ": upper edges must increase and the number of pads be positive"
+		<< std::endl;
+      return false;
+    }
+  }
+
+  /// Radii of the nominal position samples
+  float step = ( mOuterTpcRadius - mInnerTpcRadius ) / ( kNumberOfPoints - 1 );
+  for ( int iPoint=0; iPoint<kNumberOfPoints; iPoint++ ) {
+    mSampleRadius[iPoint] = mInnerTpcRadius + iPoint * step;
+  }
+
+  /// Pad rows
+  for ( int iRow=0; iRow<mNumberOfPadrows; iRow++ ) {
+    bool isInner = ( iRow < mNumberOfInnerPadrows );
+    double padWidth = isInner ? mPadWidthInner : mPadWidthOuter;
+    mRowHalfWidth[iRow] = mNumberOfPads[iRow] * padWidth / 2.;
+    mMaxDu[iRow] = isInner ? mMaxDuInner : mMaxDuOuter;
+    mMaxDz[iRow] = isInner ? mMaxDzInner : mMaxDzOuter;
+    mInvMaxDu2[iRow] = 1. / ( (double)mMaxDu[iRow] * mMaxDu[iRow] );
+    mInvMaxDz2[iRow] = 1. / ( (double)mMaxDz[iRow] * mMaxDz[iRow] );
+  }
+
+  /// Sectors. Each side must cover every phi bin exactly once
+  for ( int iSide=0; iSide<2; iSide++ ) {
+    for ( int iBin=0; iBin<mNumberOfSectorsPerSide; iBin++ ) {
+      mSectorAtPhiBin[iSide][iBin] = 0;
+    }
+  }
+  for ( int iSect=0; iSect<numberOfSectors(); iSect++ ) {
+    mSectorPhi[iSect] = mSectorPhiUnits[iSect] * TMath::Pi() / ( mNumberOfSectorsPerSide / 2. );
+    mSectorCos[iSect] = TMath::Cos( mSectorPhi[iSect] );
+    mSectorSin[iSect] = TMath::Sin( mSectorPhi[iSect] );
+
+    int iSide = ( iSect < mNumberOfSectorsPerSide ) ? 0 : 1;
+    int iBin = (int)mSectorPhiUnits[iSect];
+    if ( iBin != mSectorPhiUnits[iSect] || iBin < 0 || iBin >= mNumberOfSectorsPerSide ||
+	 mSectorAtPhiBin[iSide][iBin] != 0 ) {
+      std::cout << "[ERROR] StHbtTpcGeometry::update - sector " << iSect + 1
+		<< " has a wrong or repeated phi: " << mSectorPhiUnits[iSect] << std::endl;
+      return false;
+    }
+    mSectorAtPhiBin[iSide][iBin] = iSect + 1;
+  }
+  return true;
+}
+
+//_________________
+bool StHbtTpcGeometry::readFile(const char* file) {
+
+  std::ifstream in( file );
+  if ( !in.is_open() ) {
+    std::cout << "[ERROR] StHbtTpcGeometry::readFile - could not open file " << file << std::endl;
+    return false;
+  }
+
+  std::vector<float> radius;
+  std::vector<float> radiusMax;
+  std::vector<int> nPads;
+  int nInner = mNumberOfInnerPadrows;
+  std::string line;
+  int lineNumber = 0;
+  while ( std::getline( in, line ) ) {
+    lineNumber++;
+    std::string::size_type comment = line.find( '#' );
+    if ( comment != std::string::npos ) {
+      line.erase( comment );
+    }
+    std::istringstream values( line );
+    std::string key;
+    if ( !( values >> key ) ) continue;
+
+    bool isGood = true;
+    if ( key == "innerTpcRadius" ) {
+      isGood = static_cast<bool>( values >> mInnerTpcRadius );
+    }
+    else if ( key == "outerTpcRadius" ) {
+      isGood = static_cast<bool>( values >> mOuterTpcRadius );
+    }
+    else if ( key == "tpcHalfLength" ) {
+      isGood = static_cast<bool>( values >> mTpcHalfLength );
+    }
+    else if ( key == "pairRadiusRange" ) {
+      isGood = static_cast<bool>( values >> mPairRadiusMin >> mPairRadiusMax );
+    }
+    else if ( key == "padPlaneRadiusMin" ) {
+      isGood = static_cast<bool>( values >> mPadPlaneRadiusMin );
+    }
+    else if ( key == "padWidth" ) {
+      isGood = static_cast<bool>( values >> mPadWidthInner >> mPadWidthOuter );
+    }
+    else if ( key == "numberOfInnerPadrows" ) {
+      isGood = static_cast<bool>( values >> nInner );
+    }
+    else if ( key == "mergingPar" ) {
+      isGood = static_cast<bool>( values >> mMaxDuInner >> mMaxDzInner
+				  >> mMaxDuOuter >> mMaxDzOuter );
+    }
+    else if ( key == "sectorPhi" ) {
+      std::vector<double> sectorPhi;
+      double phi;
+      while ( values >> phi ) {
+	sectorPhi.push_back( phi );
+      }
+      setSectorPhi( sectorPhi );
+      isGood = ( mNumberOfSectorsPerSide > 0 );
+    }
+    else if ( key == "padrow" ) {
+      float r, rMax;
+      int n;
+      isGood = static_cast<bool>( values >> r >> rMax >> n );
+      radius.push_back( r );
+      radiusMax.push_back( rMax );
+      nPads.push_back( n );
+    }
+    else {
+      std::cout << "[ERROR] StHbtTpcGeometry::readFile - unknown keyword " << key
+		<< " in line " << lineNumber << " of " << file << std::endl;
+      return false;
+    }
+
+    if ( !isGood ) {
+      std::cout << "[ERROR] StHbtTpcGeometry::readFile - could not read values of " << key
+		<< " in line " << lineNumber << " of " << file << std::endl;
+      return false;
+    }
+  } //while ( std::getline( in, line ) )
+
+  if ( radius.empty() ) {
+    /// Keep the pad rows, possibly with another inner/outer boundary
+    mNumberOfInnerPadrows = nInner;
+  }
+  else {
+    setPadrows( radius, radiusMax, nPads, nInner );
+  }
+
+  if ( !update() ) {
+    std::cout << "[ERROR] StHbtTpcGeometry::readFile - invalid geometry in " << file << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//_________________
+void StHbtTpcGeometry::print() const {
+  std::cout << "StHbtTpcGeometry: field cages " << mInnerTpcRadius << " - "
+	    << mOuterTpcRadius << " cm, half length " << mTpcHalfLength << " cm" << std::endl
+	    << "  pair crossing radii " << mPairRadiusMin << " - " << mPairRadiusMax
+	    << " cm, pad plane from " << mPadPlaneRadiusMin << " cm" << std::endl
+	    << "  " << mNumberOfPadrows << " pad rows (" << mNumberOfInnerPadrows
+	    << " inner), " << numberOfSectors() << " sectors" << std::endl
+	    << "  merging parameters du/dz inner " << mMaxDuInner << "/" << mMaxDzInner
+	    << " outer " << mMaxDuOuter << "/" << mMaxDzOuter << std::endl;
+  for ( int iRow=0; iRow<mNumberOfPadrows; iRow++ ) {
+    std::cout << "  padrow " << iRow + 1 << ": radius " << mRowRadius[iRow]
+	      << " upper edge " << mRowRadiusMax[iRow] << " pads " << mNumberOfPads[iRow]
+	      << std::endl;
+  }
+}
@@ -0,0 +1,182 @@
+/**
+ * Description: TPC geometry used for the two-track (merging) estimations
+ *
+ * StHbtTpcGeometry describes the TPC seen by StHbtParticle, StHbtPair and
+ * TpcLocalTransform: the radii of the field cages and the half length,
+ * the radial window of the pair DCA, the pad rows (radius, upper edge
+ * and number of pads), the pad widths of the inner and outer sectors,
+ * the sector layout and the merging parameters. The default geometry is
+ * the STAR TPC before the iTPC upgrade with the half field merging
+ * parameters.
+ *
+ * Everything that is derived from the geometry (radii of the nominal
+ * position samples, half widths of the pad rows, sector rotations, the
+ * sector of each phi bin and the merging parameters of each pad row) is
+ * tabulated by update(), so the per-track and per-pair code only reads
+ * flat tables.
+ *
+ * A geometry can be read from a text file with one keyword per line
+ * followed by its values ('#' starts a comment):
+ *
+ *   innerTpcRadius   50
+ *   outerTpcRadius   200
+ *   tpcHalfLength    200
+ *   pairRadiusRange  60 190
+ *   padPlaneRadiusMin 57.6
+ *   padWidth         0.335 0.67          (inner and outer sectors)
+ *   numberOfInnerPadrows 13
+ *   sectorPhi        2 1 0 11 ... 3      (2 x sectors per side values)
+ *   mergingPar       3 4 4 6             (du, dz inner; du, dz outer)
+ *   padrow           60 62.4 88          (radius, upper edge, pads)
+ *
+ * Keywords that are not given keep the default values. If padrow lines
+ * are present they replace all default pad rows. Sector i is centred at
+ * sectorPhi[i] * 2pi / (sectors per side); sectors of the first half are
+ * at z < 0.
+ *
+ * The geometry used for new particles is the current one. It is set once
+ * at initialisation with setCurrent() or loadCurrent(); particles keep a
+ * pointer to the geometry they were made with and pairs use the geometry
+ * of their first particle. Geometries that were made current are kept
+ * until the end of the program.
+ */
+
+#ifndef StHbtTpcGeometry_h
+#define StHbtTpcGeometry_h
+
+/// C++ headers
+#include <vector>
+
+//_________________
+class StHbtTpcGeometry {
+
+ public:
+  /// Default constructor (STAR TPC)
+  StHbtTpcGeometry();
+  /// Destructor
+  ~StHbtTpcGeometry()                           { /* empty */ }
+
+  /// Number of nominal position samples and maximal number of pad rows
+  /// (the size of the per-particle arrays)
+  enum { kNumberOfPoints = 11, kMaxNumberOfPadrows = 72, kMaxSectorsPerSide = 32 };
+
+  /// Geometry used for new particles
+  static const StHbtTpcGeometry& current();
+  /// Make a copy of the geometry current. Returns false (and keeps the
+  /// current geometry) if the geometry is not valid
+  static bool setCurrent(const StHbtTpcGeometry& geometry);
+  /// Read the file and make the geometry current
+  static bool loadCurrent(const char* file);
+
+  /// Read the text description. Returns false if the file can not be
+  /// read or describes an invalid geometry
+  bool readFile(const char* file);
+  /// Check the parameters and fill the derived tables. Returns false if
+  /// the geometry is not valid
+  bool update();
+  /// Print the geometry
+  void print() const;
+
+  /**
+   * Getters
+   **/
+  float innerTpcRadius() const                  { return mInnerTpcRadius; }
+  float outerTpcRadius() const                  { return mOuterTpcRadius; }
+  float tpcHalfLength() const                   { return mTpcHalfLength; }
+  double pairRadiusMin() const                  { return mPairRadiusMin; }
+  double pairRadiusMax() const                  { return mPairRadiusMax; }
+  double padPlaneRadiusMin() const              { return mPadPlaneRadiusMin; }
+  int numberOfPadrows() const                   { return mNumberOfPadrows; }
+  int numberOfInnerPadrows() const              { return mNumberOfInnerPadrows; }
+  int numberOfSectorsPerSide() const            { return mNumberOfSectorsPerSide; }
+  int numberOfSectors() const                   { return 2 * mNumberOfSectorsPerSide; }
+
+  /// Radius of the nominal position sample (0 - kNumberOfPoints-1)
+  float sampleRadius(const int& iPoint) const   { return mSampleRadius[iPoint]; }
+  /// Radius, upper edge and half width of the pad row (0 - numberOfPadrows-1)
+  float rowRadius(const int& iRow) const        { return mRowRadius[iRow]; }
+  const float* rowRadiusMax() const             { return mRowRadiusMax; }
+  double rowHalfWidth(const int& iRow) const    { return mRowHalfWidth[iRow]; }
+  /// Phi of the centre of the sector (1 - numberOfSectors) and its cos/sin
+  double sectorPhi(const int& sector) const     { return mSectorPhi[sector-1]; }
+  double sectorCos(const int& sector) const     { return mSectorCos[sector-1]; }
+  double sectorSin(const int& sector) const     { return mSectorSin[sector-1]; }
+  /// Sector of the phi bin (0 - numberOfSectorsPerSide-1) at z<0 or z>=0
+  int sector(const bool& positiveZ, const int& phiBin) const
+  { return mSectorAtPhiBin[ positiveZ ? 1 : 0 ][phiBin]; }
+
+  /// Merging parameters of the pad row: maximal du and dz of merged hits
+  /// and their inverse squares
+  float maxDu(const int& iRow) const            { return mMaxDu[iRow]; }
+  float maxDz(const int& iRow) const            { return mMaxDz[iRow]; }
+  double invMaxDu2(const int& iRow) const       { return mInvMaxDu2[iRow]; }
+  double invMaxDz2(const int& iRow) const       { return mInvMaxDz2[iRow]; }
+
+  /**
+   * Setters (call update() afterwards)
+   **/
+  void setTpcRadii(const float& inner, const float& outer)
+  { mInnerTpcRadius = inner; mOuterTpcRadius = outer; }
+  void setTpcHalfLength(const float& halfLength) { mTpcHalfLength = halfLength; }
+  void setPairRadiusRange(const double& rMin, const double& rMax)
+  { mPairRadiusMin = rMin; mPairRadiusMax = rMax; }
+  void setPadPlaneRadiusMin(const double& rMin) { mPadPlaneRadiusMin = rMin; }
+  void setPadWidth(const double& inner, const double& outer)
+  { mPadWidthInner = inner; mPadWidthOuter = outer; }
+  /// Pad rows: radius, upper edge and number of pads of each row. The
+  /// first nInner rows are in the inner sectors
+  void setPadrows(const std::vector<float>& radius, const std::vector<float>& radiusMax,
+		  const std::vector<int>& nPads, const int& nInner);
+  /// Phi of the sector centres in units of 2pi/(sectors per side)
+  void setSectorPhi(const std::vector<double>& sectorPhi);
+  /// Merging parameters of the inner and outer pad rows
+  void setMergingPar(const float& maxDuInner, const float& maxDzInner,
+		     const float& maxDuOuter, const float& maxDzOuter);
+  void setDefaultHalfFieldMergingPar()          { setMergingPar( 3., 4., 4., 6. ); }
+  void setDefaultFullFieldMergingPar()          { setMergingPar( 0.8, 3., 1.4, 3.2 ); }
+
+ private:
+
+  /// Field cages and half length
+  float mInnerTpcRadius;
+  float mOuterTpcRadius;
+  float mTpcHalfLength;
+  /// Radial window of the crossing point in StHbtPair::dcaInsideTpc()
+  double mPairRadiusMin;
+  double mPairRadiusMax;
+  /// Points below this radius are not on a pad row
+  double mPadPlaneRadiusMin;
+  /// Pad widths
+  double mPadWidthInner;
+  double mPadWidthOuter;
+  /// Merging parameters of the inner and outer rows
+  float mMaxDuInner;
+  float mMaxDzInner;
+  float mMaxDuOuter;
+  float mMaxDzOuter;
+
+  /// Pad rows
+  int mNumberOfPadrows;
+  int mNumberOfInnerPadrows;
+  float mRowRadius[kMaxNumberOfPadrows];
+  float mRowRadiusMax[kMaxNumberOfPadrows];
+  int mNumberOfPads[kMaxNumberOfPadrows];
+
+  /// Sectors
+  int mNumberOfSectorsPerSide;
+  double mSectorPhiUnits[2*kMaxSectorsPerSide];
+
+  /// Derived tables
+  float mSampleRadius[kNumberOfPoints];
+  double mRowHalfWidth[kMaxNumberOfPadrows];
+  float mMaxDu[kMaxNumberOfPadrows];
+  float mMaxDz[kMaxNumberOfPadrows];
+  double mInvMaxDu2[kMaxNumberOfPadrows];
+  double mInvMaxDz2[kMaxNumberOfPadrows];
+  double mSectorPhi[2*kMaxSectorsPerSide];
+  double mSectorCos[2*kMaxSectorsPerSide];
+  double mSectorSin[2*kMaxSectorsPerSide];
+  int mSectorAtPhiBin[2][kMaxSectorsPerSide];
+};
+
+#endif // #define StHbtTpcGeometry_h
@@ -18,8 +18,9 @@ StHbtTrack::StHbtTrack() :
   mMap{}, mTofBeta(0),
   mPrimaryPx(0), mPrimaryPy(0), mPrimaryPz(0), mGlobalPx(0), mGlobalPy(0), mGlobalPz(0),
   mDcaX(-999), mDcaY(-999), mDcaZ(-999),
-  mPrimaryVertexX(0), mPrimaryVertexY(0), mPrimaryVertexZ(0),
-  mXfr(0), mYfr(0), mZfr(0), mTfr(0), mPdgId(0) {
+  mPrimaryVertexX(0), mPrimaryVertexY(0), mPrimaryVertexZ(0), mBField(0),
+  mXfr(0), mYfr(0), mZfr(0), mTfr(0), mPdgId(0),
+  mHelix{}, mGHelix{}, mHelixValid(0) {
     
   /// Default constructor
   mHiddenInfo = nullptr;
@@ -56,11 +57,15 @@ StHbtTrack::StHbtTrack(const StHbtTrack& t) {
   mPrimaryVertexX = t.mPrimaryVertexX;
   mPrimaryVertexY = t.mPrimaryVertexY;
   mPrimaryVertexZ = t.mPrimaryVertexZ;
+  mBField = t.mBField;
   mXfr = t.mXfr;
   mYfr = t.mYfr;
   mZfr = t.mZfr;
   mTfr = t.mTfr;
   mPdgId = t.mPdgId;
+  mHelix = t.mHelix;
+  mGHelix = t.mGHelix;
+  mHelixValid = t.mHelixValid;
   
   if ( t.validHiddenInfo() ) {
     mHiddenInfo = t.getHiddenInfo()->clone();
@@ -110,6 +115,9 @@ StHbtTrack& StHbtTrack::operator=(const StHbtTrack& trk) {
     mZfr = trk.mZfr;
     mTfr = trk.mTfr;
     mPdgId = trk.mPdgId;
+    mHelix = trk.mHelix;
+    mGHelix = trk.mGHelix;
+    mHelixValid = trk.mHelixValid;
 
     if(mHiddenInfo) delete mHiddenInfo;
     mHiddenInfo = trk.validHiddenInfo() ? trk.getHiddenInfo()->clone() : nullptr;
@@ -235,17 +243,18 @@ void StHbtTrack::setBeta(const float& beta) {
 }
 
 //_________________
-StHbtPhysicalHelix StHbtTrack::helix() const {
-  return StHbtPhysicalHelix( pMom(), primaryVertex(),
-                            mBField * kilogauss,
-                            static_cast<float>( charge() ) );
-}
-
-//_________________
-StHbtPhysicalHelix StHbtTrack::gHelix() const {
-  return StHbtPhysicalHelix( gMom(), origin(),
-                            mBField * kilogauss,
-                            static_cast<float>( charge() ) );
+void StHbtTrack::fillHelix(const unsigned char& which) const {
+  if ( which == kPrimaryHelix ) {
+    mHelix = StHbtPhysicalHelix( pMom(), primaryVertex(),
+				 mBField * kilogauss,
+				 static_cast<float>( charge() ) ).parameters();
+  }
+  else {
+    mGHelix = StHbtPhysicalHelix( gMom(), origin(),
+				  mBField * kilogauss,
+				  static_cast<float>( charge() ) ).parameters();
+  }
+  mHelixValid |= which;
 }
 
 //_________________
@@ -5,6 +5,13 @@
  * required during femtoscopic analysis. This class is filled with information
  * from the input stream by the reader. A particle has a link back to the Track
  * it was created from, so we do not copy the information.
+ *
+ * The parameters of the primary and global helices are computed on the
+ * first call of helix()/gHelix() (or of helixParameters()) and kept
+ * until a setter changes the momentum, vertex, DCA, charge or magnetic
+ * field. The first call is not thread-safe: StHbtParticle makes it when
+ * it is constructed from the track, and its copy of the track carries
+ * the parameters.
  */
 
 #ifndef StHbtTrack_h
@@ -103,8 +110,13 @@ class StHbtTrack {
   int pdgId() const                { return mPdgId; }
   int pdgCode() const              { return pdgId(); }
 
-  StHbtPhysicalHelix helix() const;
-  StHbtPhysicalHelix gHelix() const;  
+  StHbtPhysicalHelix helix() const      { return StHbtPhysicalHelix( helixParameters() ); }
+  StHbtPhysicalHelix gHelix() const     { return StHbtPhysicalHelix( gHelixParameters() ); }
+  /// Parameters of the primary and global helices
+  const StHbtHelixParameters& helixParameters() const
+  { if ( !( mHelixValid & kPrimaryHelix ) ) fillHelix( kPrimaryHelix ); return mHelix; }
+  const StHbtHelixParameters& gHelixParameters() const
+  { if ( !( mHelixValid & kGlobalHelix ) ) fillHelix( kGlobalHelix ); return mGHelix; }
 
   /**
    * Setters  
@@ -112,7 +124,7 @@ class StHbtTrack {
   
   void setId(const unsigned short& id)   { mId = (unsigned short)id; }
   void setFlag(const short& flag)        { mFlag = flag; }
-  void setNHits(const short& nhits)      { mNHits = (char)nhits;}  //Has to be charge*nHits
+  void setNHits(const short& nhits)      { mNHits = (char)nhits; mHelixValid = 0; }  //Has to be charge*nHits
   void setNHitsPossible(const short& nh) { mNHitsPoss = (unsigned char)nh; }
   void setNHitsDedx(const short& nh)     { mNHitsDedx = (unsigned char)nh; }
   void setChi2(const float& chi2);
@@ -125,32 +137,32 @@ class StHbtTrack {
   void setPidProbPion(const float& prob);
   void setPidProbKaon(const float& prob);
   void setPidProbProton(const float& prob);
-  void setDca(const float& x, const float& y, const float& z) { mDcaX=x; mDcaY=y; mDcaZ=z; }
-  void setDcaX(const float& x)                                { mDcaX=x; }
-  void setDcaY(const float& y)                                { mDcaY=y; }
-  void setDcaZ(const float& z)                                { mDcaZ=z; }
+  void setDca(const float& x, const float& y, const float& z) { mDcaX=x; mDcaY=y; mDcaZ=z; mHelixValid = 0; }
+  void setDcaX(const float& x)                                { mDcaX=x; mHelixValid = 0; }
+  void setDcaY(const float& y)                                { mDcaY=y; mHelixValid = 0; }
+  void setDcaZ(const float& z)                                { mDcaZ=z; mHelixValid = 0; }
   void setP(const float& px, const float& py, const float& pz)
-  { mPrimaryPx=px; mPrimaryPy=py; mPrimaryPz=pz; }
+  { mPrimaryPx=px; mPrimaryPy=py; mPrimaryPz=pz; mHelixValid = 0; }
   void setP(const TVector3& mom)
-  { mPrimaryPx=mom.X(); mPrimaryPy=mom.Y(); mPrimaryPz=mom.Z(); }
-  void setPx(const float& px)                                 { mPrimaryPx=px; }
-  void setPy(const float& py)                                 { mPrimaryPy=py; }
-  void setPz(const float& pz)                                 { mPrimaryPz=pz; }
+  { mPrimaryPx=mom.X(); mPrimaryPy=mom.Y(); mPrimaryPz=mom.Z(); mHelixValid = 0; }
+  void setPx(const float& px)                                 { mPrimaryPx=px; mHelixValid = 0; }
+  void setPy(const float& py)                                 { mPrimaryPy=py; mHelixValid = 0; }
+  void setPz(const float& pz)                                 { mPrimaryPz=pz; mHelixValid = 0; }
   void setGlobalP(const float& px, const float& py, const float& pz)
-  { mGlobalPx=px; mGlobalPy=py; mGlobalPz=pz; }
+  { mGlobalPx=px; mGlobalPy=py; mGlobalPz=pz; mHelixValid = 0; }
   void setGlobalP(const TVector3& mom)
-  { mGlobalPx=mom.X(); mGlobalPy=mom.Y(); mGlobalPz=mom.Z(); }
-  void setGlobalPx(const float& px)                           { mGlobalPx=px; }
-  void setGlobalPy(const float& py)                           { mGlobalPy=py; }
-  void setGlobalPz(const float& pz)                           { mGlobalPz=pz; }
+  { mGlobalPx=mom.X(); mGlobalPy=mom.Y(); mGlobalPz=mom.Z(); mHelixValid = 0; }
+  void setGlobalPx(const float& px)                           { mGlobalPx=px; mHelixValid = 0; }
+  void setGlobalPy(const float& py)                           { mGlobalPy=py; mHelixValid = 0; }
+  void setGlobalPz(const float& pz)                           { mGlobalPz=pz; mHelixValid = 0; }
   void setPrimaryVertex(const float& x, const float& y, const float& z)
-  { mPrimaryVertexX=x; mPrimaryVertexY=y; mPrimaryVertexZ=z; }
+  { mPrimaryVertexX=x; mPrimaryVertexY=y; mPrimaryVertexZ=z; mHelixValid = 0; }
   void setPrimaryVertex(const TVector3& vtx)
-  { mPrimaryVertexX=vtx.X(); mPrimaryVertexY=vtx.Y(); mPrimaryVertexZ=vtx.Z(); }
-  void setPrimaryVertexX(const float& x)                      { mPrimaryVertexX=x; }
-  void setPrimaryVertexY(const float& y)                      { mPrimaryVertexY=y; }
-  void setPrimaryVertexZ(const float& z)                      { mPrimaryVertexZ=z; }
-  void setMagneticField(const float& bField)                  { mBField = bField; }
+  { mPrimaryVertexX=vtx.X(); mPrimaryVertexY=vtx.Y(); mPrimaryVertexZ=vtx.Z(); mHelixValid = 0; }
+  void setPrimaryVertexX(const float& x)                      { mPrimaryVertexX=x; mHelixValid = 0; }
+  void setPrimaryVertexY(const float& y)                      { mPrimaryVertexY=y; mHelixValid = 0; }
+  void setPrimaryVertexZ(const float& z)                      { mPrimaryVertexZ=z; mHelixValid = 0; }
+  void setMagneticField(const float& bField)                  { mBField = bField; mHelixValid = 0; }
   void setBField(const float& bField)                         { setMagneticField(bField); }
   void setTopologyMap(const int word, const unsigned int map) {mMap[word] = map;}
   void setBeta(const float &beta);
@@ -170,6 +182,9 @@ class StHbtTrack {
   StHbtHiddenInfo* getHiddenInfo() const {return mHiddenInfo;}
   /***/
 
+  /// Direct access to the stored fields for the columnar binary format
+  friend class StHbtBinaryEventFormat;
+
  private:
 
   /// Track unique ID
@@ -235,6 +250,13 @@ class StHbtTrack {
   // Fab private : add mutable
   StHbtHiddenInfo* mHiddenInfo; //!
   /***/
+
+  /// Helix parameters computed on first use (bits of mHelixValid)
+  enum { kPrimaryHelix = 1, kGlobalHelix = 2 };
+  void fillHelix(const unsigned char& which) const;
+  mutable StHbtHelixParameters mHelix;    //!
+  mutable StHbtHelixParameters mGHelix;   //!
+  mutable unsigned char mHelixValid;      //!
 };
 
 #endif //#define StHbtTrack_h
@@ -0,0 +1,80 @@
+/**
+ * Description: Columnar (structure-of-arrays) view of the event tracks
+ *
+ * StHbtTrackBatch keeps the track quantities that are used by the track
+ * cuts in contiguous per-column arrays.
+ */
+
+/// StHbtMaker headers
+#include "StHbtTrackBatch.h"
+
+//_________________
+void StHbtTrackBatch::clear() {
+  mTrack.clear();
+  mPt.clear();
+  mPtot.clear();
+  mPz.clear();
+  mDca.clear();
+  mNHits.clear();
+  mNHitsRatio.clear();
+  mNSigmaElectron.clear();
+  mNSigmaPion.clear();
+  mNSigmaKaon.clear();
+  mNSigmaProton.clear();
+  mBeta.clear();
+  mMassSqr.clear();
+  mIsTofTrack.clear();
+  mCharge.clear();
+  mType.clear();
+}
+
+//_________________
+void StHbtTrackBatch::fill(const StHbtTrackCollection* collection) {
+
+  clear();
+  if ( !collection ) return;
+
+  /// Resize all columns once and then fill them in place
+  const unsigned int nTracks = collection->size();
+  mTrack.resize( nTracks );
+  mPt.resize( nTracks );
+  mPtot.resize( nTracks );
+  mPz.resize( nTracks );
+  mDca.resize( nTracks );
+  mNHits.resize( nTracks );
+  mNHitsRatio.resize( nTracks );
+  mNSigmaElectron.resize( nTracks );
+  mNSigmaPion.resize( nTracks );
+  mNSigmaKaon.resize( nTracks );
+  mNSigmaProton.resize( nTracks );
+  mBeta.resize( nTracks );
+  mMassSqr.resize( nTracks );
+  mIsTofTrack.resize( nTracks );
+  mCharge.resize( nTracks );
+  mType.resize( nTracks );
+
+  unsigned int i = 0;
+  for ( StHbtTrackCollection::const_iterator iter = collection->begin();
+	iter != collection->end(); iter++, i++ ) {
+
+    StHbtTrack *t = *iter;
+    const TVector3 mom = t->momentum();
+
+    mTrack[i] = t;
+    mPt[i] = mom.Perp();
+    mPtot[i] = mom.Mag();
+    mPz[i] = mom.Z();
+    mDca[i] = t->gDCA().Mag();
+    mNHits[i] = t->nHits();
+    mNHitsRatio[i] = t->nHitsFit2PossRatio();
+    mNSigmaElectron[i] = t->nSigmaElectron();
+    mNSigmaPion[i] = t->nSigmaPion();
+    mNSigmaKaon[i] = t->nSigmaKaon();
+    mNSigmaProton[i] = t->nSigmaProton();
+    mBeta[i] = t->beta();
+    mMassSqr[i] = t->massSqr();
+    mIsTofTrack[i] = t->isTofTrack() ? 1 : 0;
+    mCharge[i] = (signed char)t->charge();
+    mType[i] = (unsigned char)t->type();
+  } //for ( iter=collection->begin(); ... )
+}
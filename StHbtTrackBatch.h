@@ -0,0 +1,107 @@
+/**
+ * Description: Columnar (structure-of-arrays) view of the event tracks
+ *
+ * StHbtTrackBatch keeps the track quantities that are used by the track
+ * cuts in contiguous per-column arrays (momentum, DCA, number of hits,
+ * nSigma, TOF beta, mass square and charge). This allows the cuts to
+ * evaluate their windows over all tracks of the event at once in simple
+ * loops that the compiler can vectorize. The batch does not own the
+ * tracks: it keeps pointers to the tracks of the collection it was filled
+ * from, so the i-th entry of each column corresponds to track(i).
+ */
+
+#ifndef StHbtTrackBatch_h
+#define StHbtTrackBatch_h
+
+/// C++ headers
+#include <vector>
+
+/// StHbtMaker headers
+#include "StHbtTrack.h"
+#include "StHbtTrackCollection.h"
+
+/// Selection mask: one entry (0 - failed, 1 - passed) per track of the batch
+typedef std::vector<unsigned char> StHbtSelectionMask;
+
+//_________________
+class StHbtTrackBatch {
+
+ public:
+  /// Default constructor
+  StHbtTrackBatch()                         { /* empty */ }
+  /// Copy and move (the user-declared destructor would otherwise
+  /// suppress the moves and make std::move copy the columns)
+  StHbtTrackBatch(const StHbtTrackBatch&) = default;
+  StHbtTrackBatch(StHbtTrackBatch&&) = default;
+  StHbtTrackBatch& operator=(const StHbtTrackBatch&) = default;
+  StHbtTrackBatch& operator=(StHbtTrackBatch&&) = default;
+  /// Default destructor
+  ~StHbtTrackBatch()                        { /* empty */ }
+
+  /// Fill columns from the track collection. Column capacity is kept
+  /// between fills, so refilling the same batch does not reallocate.
+  void fill(const StHbtTrackCollection* collection);
+  /// Remove all entries (keeps the capacity)
+  void clear();
+
+  /**
+   * Getters
+   **/
+  unsigned int size() const                 { return mTrack.size(); }
+  bool empty() const                        { return mTrack.empty(); }
+  StHbtTrack* track(const unsigned int& i) const { return mTrack[i]; }
+
+  /// Momentum of the track (primary if primary, global otherwise)
+  const float* pt() const                   { return mPt.data(); }
+  const float* ptot() const                 { return mPtot.data(); }
+  const float* pz() const                   { return mPz.data(); }
+  /// DCA to the primary vertex (magnitude)
+  const float* dca() const                  { return mDca.data(); }
+  /// Number of fit hits and nHitsFit/nHitsPossible
+  const unsigned short* nHits() const       { return mNHits.data(); }
+  const float* nHitsRatio() const           { return mNHitsRatio.data(); }
+  /// nSigma from the electron, pion, kaon and proton dE/dx bands
+  const float* nSigmaElectron() const       { return mNSigmaElectron.data(); }
+  const float* nSigmaPion() const           { return mNSigmaPion.data(); }
+  const float* nSigmaKaon() const           { return mNSigmaKaon.data(); }
+  const float* nSigmaProton() const         { return mNSigmaProton.data(); }
+  /// TOF information
+  const float* beta() const                 { return mBeta.data(); }
+  const float* massSqr() const              { return mMassSqr.data(); }
+  const unsigned char* isTofTrack() const   { return mIsTofTrack.data(); }
+  /// Charge (+1/-1) and track type (1 - primary, 0 - global)
+  const signed char* charge() const         { return mCharge.data(); }
+  const unsigned char* type() const         { return mType.data(); }
+
+ private:
+
+  /// Links to the tracks (not owned)
+  std::vector<StHbtTrack*> mTrack;
+
+  /// Kinematics
+  std::vector<float> mPt;
+  std::vector<float> mPtot;
+  std::vector<float> mPz;
+  std::vector<float> mDca;
+
+  /// Hits
+  std::vector<unsigned short> mNHits;
+  std::vector<float> mNHitsRatio;
+
+  /// TPC identification
+  std::vector<float> mNSigmaElectron;
+  std::vector<float> mNSigmaPion;
+  std::vector<float> mNSigmaKaon;
+  std::vector<float> mNSigmaProton;
+
+  /// TOF identification
+  std::vector<float> mBeta;
+  std::vector<float> mMassSqr;
+  std::vector<unsigned char> mIsTofTrack;
+
+  /// Charge and type
+  std::vector<signed char> mCharge;
+  std::vector<unsigned char> mType;
+};
+
+#endif // #define StHbtTrackBatch_h
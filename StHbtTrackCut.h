@@ -9,6 +9,7 @@
 /// StHbtMaker headers
 #include "StHbtTypes.h"
 #include "StHbtTrack.h"
+#include "StHbtTrackBatch.h"
 #include "StHbtParticleCut.h"
 
 //_________________
@@ -26,6 +27,14 @@ class StHbtTrackCut : public StHbtParticleCut {
 
   /// Returns true if passed the cut and false if not
   virtual bool pass(const StHbtTrack* track) = 0;
+  /// Evaluate the cut for all tracks of the batch and write the result
+  /// to the mask (one entry per track). The default implementation calls
+  /// pass() for each track, derived cuts may provide a columnar version.
+  virtual void passBatch(const StHbtTrackBatch& batch, StHbtSelectionMask& mask);
+  /// Add a mask made before by passBatch() of this cut (and reused from
+  /// the event cache) to the pass/fail counters. The default does nothing,
+  /// cuts with counters override it
+  virtual void countBatch(const StHbtSelectionMask& /* mask */) { /* no-op */ }
   virtual StHbtParticleType type()     { return hbtTrack; }
   virtual StHbtTrackCut* clone()       { return nullptr; }
 
@@ -43,4 +52,11 @@ inline StHbtTrackCut& StHbtTrackCut::operator=(const StHbtTrackCut& c) {
   return *this;
 }
 
+inline void StHbtTrackCut::passBatch(const StHbtTrackBatch& batch, StHbtSelectionMask& mask) {
+  mask.resize( batch.size() );
+  for ( unsigned int i=0; i<batch.size(); i++ ) {
+    mask[i] = pass( batch.track(i) ) ? 1 : 0;
+  }
+}
+
 #endif // #define StHbtTrackCut_h
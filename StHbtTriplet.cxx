@@ -76,9 +76,7 @@ StHbtTriplet::StHbtTriplet(const StHbtTriplet& trio) :
 
 //_________________
 StHbtTriplet::~StHbtTriplet() {
-  if(mTrack1) delete mTrack1;
-  if(mTrack2) delete mTrack2;
-  if(mTrack3) delete mTrack3;
+  /// The particles belong to the particle collections (as for StHbtPair)
 }
 
 //_________________
@@ -17,11 +17,12 @@ class StHbtTriplet {
  public:
   /// Default constructor
   StHbtTriplet();
-  /// Constructor with three particles
+  /// Constructor with three particles. The particles are not owned (as
+  /// for StHbtPair): they must live as long as the triplet is used
   StHbtTriplet(StHbtParticle*, StHbtParticle*, StHbtParticle*);
-  /// Copy constructor
+  /// Copy constructor (points to the same particles)
   StHbtTriplet(const StHbtTriplet&);
-  // Default destructor
+  /// Default destructor (does not delete the particles)
   ~StHbtTriplet();
 
   // track Gets:
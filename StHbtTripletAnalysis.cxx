@@ -0,0 +1,780 @@
+/**
+ * Description: Analysis that builds particle triplets for three-particle
+ * correlations.
+ */
+
+/// C++ headers
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// StHbtMaker headers
+#include "StHbtTripletAnalysis.h"
+#include "StHbtTriplet.h"
+#include "StHbtCheckpoint.h"
+
+/// ROOT headers
+#include "TMath.h"
+#include "TString.h"
+
+#ifdef __ROOT__
+ClassImp(StHbtTripletAnalysis)
+#endif
+
+/// Defined in StHbtAnalysis.cxx
+extern void fillHbtParticleCollection(StHbtParticleCut*         partCut,
+				      StHbtEvent*               hbtEvent,
+				      StHbtParticleCollection*  partCollection);
+
+//_________________
+struct StHbtTripletAnalysis::Engine {
+
+  /// Pairs of two collections that passed the pair cut and have q^2 below
+  /// the limit (the other pairs can not be part of a triplet)
+  struct PairTable {
+    const StHbtParticleCollection *collection1;
+    const StHbtParticleCollection *collection2;
+    /// Limit of the partner lists
+    double limit;
+    /// True if kept after the event (both collections are in the buffer)
+    bool isKept;
+    /// Partners j of particle i, ascending (only j > i for a collection
+    /// with itself): partner[ first[i], first[i+1] ), and q^2 of the pairs
+    std::vector<unsigned int> first;
+    std::vector<unsigned int> partner;
+    std::vector<double> q2;
+  };
+
+  /// Particles of a triplet kept for the correlation functions without shards
+  struct Triple {
+    StHbtParticle *particle1;
+    StHbtParticle *particle2;
+    StHbtParticle *particle3;
+  };
+
+  /// State of one thread of the triplet loop
+  struct Worker {
+    StHbtTriplet triplet;
+    /// Correlation functions filled directly by the thread (the functions
+    /// themselves or their shards; nullptr - collected instead)
+    std::vector<StHbtCorrFctn*> targets;
+    unsigned long long nTriplets;
+  };
+
+  Engine() : collect(false), nTasks(0), nextTask(0), nRunning(0), generation(0),
+	     stopping(false) { /* empty */ }
+  ~Engine() { reset(); clearTables( true ); }
+
+  /// Correlation functions, their shards (one per thread except the
+  /// calling one) and whether they are sharded
+  std::vector<StHbtCorrFctn*> fctns;
+  std::vector< std::vector<StHbtCorrFctn*> > shards;
+  std::vector<bool> sharded;
+  /// True if some triplets are collected for the calling thread
+  bool collect;
+  std::vector<Worker> workers;
+  /// Collected triplets of each task
+  std::vector< std::vector<Triple> > collected;
+  /// Pair tables of the current event and of the mixing buffer
+  std::vector<PairTable*> tables;
+
+  /// Threads and their synchronization
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  std::condition_variable start;
+  std::condition_variable done;
+  std::function<void(const unsigned int&, Worker&)> job;
+  unsigned int nTasks;
+  std::atomic<unsigned int> nextTask;
+  unsigned int nRunning;
+  unsigned long long generation;
+  bool stopping;
+
+  /// Prepare nThreads threads for the correlation functions
+  void setup(const unsigned int& nThreads, StHbtCorrFctnCollection* fctnCollection) {
+
+    if ( workers.size() == nThreads &&
+	 fctns.size() == fctnCollection->size() &&
+	 std::equal( fctns.begin(), fctns.end(), fctnCollection->begin() ) ) return;
+
+    reset();
+    fctns.assign( fctnCollection->begin(), fctnCollection->end() );
+    shards.assign( nThreads, std::vector<StHbtCorrFctn*>( fctns.size(), nullptr ) );
+    sharded.assign( fctns.size(), nThreads > 1 );
+    collect = false;
+
+    /// A function is sharded only if it returns a shard for every thread
+    for ( unsigned int iFctn=0; iFctn<fctns.size() && nThreads>1; iFctn++ ) {
+      for ( unsigned int iThread=1; iThread<nThreads; iThread++ ) {
+	shards[iThread][iFctn] = fctns[iFctn]->createShard();
+	if ( !shards[iThread][iFctn] ) {
+	  sharded[iFctn] = false;
+	}
+      }
+      if ( !sharded[iFctn] ) {
+	for ( unsigned int iThread=1; iThread<nThreads; iThread++ ) {
+	  delete shards[iThread][iFctn];
+	  shards[iThread][iFctn] = nullptr;
+	}
+	collect = true;
+      }
+    } //for ( unsigned int iFctn=0; iFctn<fctns.size() && nThreads>1; iFctn++ )
+
+    /// The calling thread fills the functions, the others their shards
+    workers.resize( nThreads );
+    for ( unsigned int iThread=0; iThread<nThreads; iThread++ ) {
+      workers[iThread].targets.assign( fctns.size(), nullptr );
+      for ( unsigned int iFctn=0; iFctn<fctns.size(); iFctn++ ) {
+	if ( nThreads == 1 ) {
+	  workers[iThread].targets[iFctn] = fctns[iFctn];
+	}
+	else if ( sharded[iFctn] ) {
+	  workers[iThread].targets[iFctn] = ( iThread == 0 ) ? fctns[iFctn] : shards[iThread][iFctn];
+	}
+      }
+    }
+
+    /// New threads wait for the next job
+    stopping = false;
+    for ( unsigned int iThread=1; iThread<nThreads; iThread++ ) {
+      threads.push_back( std::thread( &Engine::run, this, iThread, generation ) );
+    }
+  }
+
+  /// Stop the threads and delete the shards
+  void reset() {
+    {
+      std::lock_guard<std::mutex> lock( mutex );
+      stopping = true;
+    }
+    start.notify_all();
+    for ( auto &thread : threads ) {
+      thread.join();
+    }
+    threads.clear();
+
+    for ( auto &threadShards : shards ) {
+      for ( auto &shard : threadShards ) {
+	delete shard;
+      }
+    }
+    shards.clear();
+    workers.clear();
+    fctns.clear();
+  }
+
+  /// Run job(task, worker) for all tasks on all threads and wait for the end
+  void execute(const unsigned int& n, const std::function<void(const unsigned int&, Worker&)>& aJob) {
+    if ( threads.empty() ) {
+      for ( unsigned int iTask=0; iTask<n; iTask++ ) {
+	aJob( iTask, workers[0] );
+      }
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock( mutex );
+      job = aJob;
+      nTasks = n;
+      nextTask = 0;
+      nRunning = threads.size();
+      generation++;
+    }
+    start.notify_all();
+    runTasks( workers[0] );
+
+    std::unique_lock<std::mutex> lock( mutex );
+    done.wait( lock, [&] { return nRunning == 0; } );
+  }
+
+  /// Take tasks until there are no more
+  void runTasks(Worker& worker) {
+    unsigned int iTask;
+    while ( ( iTask = nextTask++ ) < nTasks ) {
+      job( iTask, worker );
+    }
+  }
+
+  /// Worker thread loop
+  void run(const unsigned int iThread, unsigned long long seen) {
+    while ( true ) {
+      {
+	std::unique_lock<std::mutex> lock( mutex );
+	start.wait( lock, [&] { return stopping || generation != seen; } );
+	if ( stopping ) return;
+	seen = generation;
+      }
+      runTasks( workers[iThread] );
+
+      std::lock_guard<std::mutex> lock( mutex );
+      if ( --nRunning == 0 ) {
+	done.notify_one();
+      }
+    } //while ( true )
+  }
+
+  /// Pair table of the two collections, made on the first call. Tables
+  /// with isKept are kept after the event until dropTables is called for
+  /// one of the collections
+  const PairTable& pairTable(StHbtParticleCollection* collection1,
+			     StHbtParticleCollection* collection2,
+			     StHbtPairCut* pairCut, const double& limit,
+			     const bool& isKept) {
+
+    for ( const auto &table : tables ) {
+      if ( table->collection1 == collection1 && table->collection2 == collection2 &&
+	   table->limit == limit ) {
+	return *table;
+      }
+    }
+
+    PairTable *table = new PairTable;
+    tables.push_back( table );
+    table->collection1 = collection1;
+    table->collection2 = collection2;
+    table->limit = limit;
+    table->isKept = isKept;
+
+    const bool same = ( collection1 == collection2 );
+    const std::vector<StHbtParticle*> particles1( collection1->begin(), collection1->end() );
+    const std::vector<StHbtParticle*> particles2( collection2->begin(), collection2->end() );
+    const unsigned int n1 = particles1.size();
+    const unsigned int n2 = particles2.size();
+    table->first.assign( n1 + 1, 0 );
+
+    StHbtPair pair;
+    for ( unsigned int i=0; i<n1; i++ ) {
+      pair.setTrack1( particles1[i] );
+      for ( unsigned int j=( same ? i+1 : 0 ); j<n2; j++ ) {
+	pair.setTrack2( particles2[j] );
+	const bool passPair = pairCut->pass( &pair );
+	pairCut->fillCutMonitor( &pair, passPair );
+	if ( !passPair ) continue;
+
+	const double q2 = TMath::Abs( ( particles1[i]->fourMomentum() -
+					particles2[j]->fourMomentum() ).M2() );
+	if ( q2 < limit ) {
+	  table->partner.push_back( j );
+	  table->q2.push_back( q2 );
+	}
+      } //for ( unsigned int j=( same ? i+1 : 0 ); j<n2; j++ )
+      table->first[i+1] = table->partner.size();
+    } //for ( unsigned int i=0; i<n1; i++ )
+
+    return *table;
+  }
+
+  /// Delete the tables of the event (all tables if withKept)
+  void clearTables(const bool& withKept) {
+    std::vector<PairTable*> kept;
+    for ( auto &table : tables ) {
+      if ( table->isKept && !withKept ) {
+	kept.push_back( table );
+      }
+      else {
+	delete table;
+      }
+    }
+    tables.swap( kept );
+  }
+
+  /// Delete the tables of the collections of the pico event
+  void dropTables(StHbtPicoEvent* picoEvent) {
+    const StHbtParticleCollection *collections[3] =
+      { picoEvent->firstParticleCollection(), picoEvent->secondParticleCollection(),
+	picoEvent->thirdParticleCollection() };
+    std::vector<PairTable*> kept;
+    for ( auto &table : tables ) {
+      if ( std::find( collections, collections + 3, table->collection1 ) != collections + 3 ||
+	   std::find( collections, collections + 3, table->collection2 ) != collections + 3 ) {
+	delete table;
+      }
+      else {
+	kept.push_back( table );
+      }
+    }
+    tables.swap( kept );
+  }
+};
+
+//_________________
+StHbtTripletAnalysis::StHbtTripletAnalysis() :
+  StHbtAnalysis(),
+  mThirdParticleCut(nullptr),
+  mQ3Max(0),
+  mNumberOfThreads(1),
+  mNRealTriplets(0),
+  mNMixedTriplets(0),
+  mEngine( new Engine ) {
+  /* empty */
+}
+
+//_________________
+StHbtTripletAnalysis::StHbtTripletAnalysis(const StHbtTripletAnalysis& a) :
+  StHbtAnalysis(a),
+  mThirdParticleCut(nullptr),
+  mQ3Max(a.mQ3Max),
+  mNumberOfThreads(a.mNumberOfThreads),
+  mNRealTriplets(0),
+  mNMixedTriplets(0),
+  mEngine( new Engine ) {
+
+  /// The third cut is cloned only if it differs from the first two
+  if ( a.mThirdParticleCut == a.mFirstParticleCut ) {
+    mThirdParticleCut = mFirstParticleCut;
+  }
+  else if ( a.mThirdParticleCut == a.mSecondParticleCut ) {
+    mThirdParticleCut = mSecondParticleCut;
+  }
+  else if ( a.mThirdParticleCut ) {
+    mThirdParticleCut = a.mThirdParticleCut->clone();
+    if ( !mThirdParticleCut ) {
+      std::cout << "[WARNING] StHbtTripletAnalysis::StHbtTripletAnalysis - "
+		<< "Cannot clone third particle cut!" << std::endl;
+    }
+  }
+  if ( mThirdParticleCut ) {
+    setThirdParticleCut( mThirdParticleCut );
+  }
+}
+
+//_________________
+StHbtTripletAnalysis& StHbtTripletAnalysis::operator=(const StHbtTripletAnalysis& a) {
+
+  if ( this != &a ) {
+
+    /// Delete the own third cut before the base class deletes the others
+    if ( mThirdParticleCut != mFirstParticleCut &&
+	 mThirdParticleCut != mSecondParticleCut ) {
+      delete mThirdParticleCut;
+    }
+    mThirdParticleCut = nullptr;
+    mEngine->reset();
+    mEngine->clearTables( true );
+
+    StHbtAnalysis::operator=( a );
+
+    if ( a.mThirdParticleCut == a.mFirstParticleCut ) {
+      mThirdParticleCut = mFirstParticleCut;
+    }
+    else if ( a.mThirdParticleCut == a.mSecondParticleCut ) {
+      mThirdParticleCut = mSecondParticleCut;
+    }
+    else if ( a.mThirdParticleCut ) {
+      mThirdParticleCut = a.mThirdParticleCut->clone();
+    }
+    if ( mThirdParticleCut ) {
+      setThirdParticleCut( mThirdParticleCut );
+    }
+
+    mQ3Max = a.mQ3Max;
+    mNumberOfThreads = a.mNumberOfThreads;
+    mNRealTriplets = 0;
+    mNMixedTriplets = 0;
+  } //if ( this != &a )
+
+  return *this;
+}
+
+//_________________
+StHbtTripletAnalysis::~StHbtTripletAnalysis() {
+  /// Shards are deleted before the correlation functions
+  delete mEngine;
+  if ( mThirdParticleCut != mFirstParticleCut &&
+       mThirdParticleCut != mSecondParticleCut ) {
+    delete mThirdParticleCut;
+  }
+  mThirdParticleCut = nullptr;
+}
+
+//_________________
+void StHbtTripletAnalysis::setThirdParticleCut(StHbtParticleCut* x) {
+  mThirdParticleCut = x;
+  if ( x ) {
+    x->setAnalysis( (StHbtBaseAnalysis*)this );
+  }
+}
+
+//_________________
+StHbtParticleCut* StHbtTripletAnalysis::thirdCut() const {
+  return ( mThirdParticleCut ? mThirdParticleCut : mSecondParticleCut );
+}
+
+//_________________
+StHbtParticleCollection* StHbtTripletAnalysis::collection(StHbtPicoEvent* picoEvent,
+							  const int& position) const {
+  /// A position with the cut of an earlier position uses its collection
+  switch ( position ) {
+  case 0:
+    return picoEvent->firstParticleCollection();
+  case 1:
+    return ( mSecondParticleCut == mFirstParticleCut ) ?
+      picoEvent->firstParticleCollection() : picoEvent->secondParticleCollection();
+  default:
+    if ( thirdCut() == mSecondParticleCut ) return collection( picoEvent, 1 );
+    if ( thirdCut() == mFirstParticleCut ) return picoEvent->firstParticleCollection();
+    return picoEvent->thirdParticleCollection();
+  }
+}
+
+//_________________
+void StHbtTripletAnalysis::eventBegin(const StHbtEvent* ev) {
+  StHbtAnalysis::eventBegin( ev );
+  if ( thirdCut() != mFirstParticleCut && thirdCut() != mSecondParticleCut ) {
+    thirdCut()->eventBegin( ev );
+  }
+  for ( auto &threadShards : mEngine->shards ) {
+    for ( auto &shard : threadShards ) {
+      if ( shard ) shard->eventBegin( ev );
+    }
+  }
+}
+
+//_________________
+void StHbtTripletAnalysis::eventEnd(const StHbtEvent* ev) {
+  StHbtAnalysis::eventEnd( ev );
+  if ( thirdCut() != mFirstParticleCut && thirdCut() != mSecondParticleCut ) {
+    thirdCut()->eventEnd( ev );
+  }
+}
+
+//_________________
+void StHbtTripletAnalysis::processEvent(const StHbtEvent* hbtEvent) {
+
+  /// We will get a new pico event, if not prevent corr. fctn to access old pico event
+  mPicoEvent = nullptr;
+  addEventProcessed();
+  mPairIndex = 0;
+
+  /// Threads and shards of the correlation functions
+  mEngine->setup( mNumberOfThreads, mCorrFctnCollection );
+
+  /// Startup for EbyE
+  eventBegin( hbtEvent );
+
+  /// Event cut and event cut monitor
+  bool tmpPassEvent = mEventCut->pass( hbtEvent );
+  if ( !tmpPassEvent ) {
+    mEventCut->fillCutMonitor( hbtEvent, tmpPassEvent );
+    eventEnd( hbtEvent );
+    return;
+  }
+
+  /// Fill the collections of the distinct cuts
+  mPicoEvent = new StHbtPicoEvent;
+  fillHbtParticleCollection( mFirstParticleCut, (StHbtEvent*)hbtEvent,
+			     mPicoEvent->firstParticleCollection() );
+  if ( mSecondParticleCut != mFirstParticleCut ) {
+    fillHbtParticleCollection( mSecondParticleCut, (StHbtEvent*)hbtEvent,
+			       mPicoEvent->secondParticleCollection() );
+  }
+  if ( thirdCut() != mFirstParticleCut && thirdCut() != mSecondParticleCut ) {
+    fillHbtParticleCollection( thirdCut(), (StHbtEvent*)hbtEvent,
+			       mPicoEvent->thirdParticleCollection() );
+  }
+
+  if ( mVerbose ) {
+    std::cout << " StHbtTripletAnalysis::processEvent - #particles in First, Second, Third Collections: "
+	      << mPicoEvent->firstParticleCollection()->size() << " "
+	      << mPicoEvent->secondParticleCollection()->size() << " "
+	      << mPicoEvent->thirdParticleCollection()->size() << std::endl;
+  } // if ( mVerbose )
+
+  for ( int iPosition=0; iPosition<3; iPosition++ ) {
+    tmpPassEvent = ( tmpPassEvent &&
+		     collection( mPicoEvent, iPosition )->size() >= mMinSizePartCollection );
+  }
+
+  /// Fill event cut monitor
+  mEventCut->fillCutMonitor( hbtEvent, tmpPassEvent );
+
+  /// Stop here if event did not pass cuts
+  if ( !tmpPassEvent ) {
+    eventEnd( hbtEvent );
+    delete mPicoEvent;
+    mPicoEvent = nullptr;
+    return;
+  }
+
+  /// Real triplets
+  makeTriplets( false, collection( mPicoEvent, 0 ),
+		collection( mPicoEvent, 1 ), collection( mPicoEvent, 2 ) );
+
+  if ( mVerbose ) {
+    std::cout << "StHbtTripletAnalysis::processEvent() - reals done ";
+  }
+
+  /// Mixed triplets: the second and third particles come from two
+  /// different events of the mixing buffer
+  for ( StHbtPicoEventIterator iter2 = mixingBuffer()->begin();
+	iter2 != mixingBuffer()->end(); iter2++ ) {
+    StHbtPicoEventIterator iter3 = iter2;
+    for ( iter3++; iter3 != mixingBuffer()->end(); iter3++ ) {
+      makeTriplets( true, collection( mPicoEvent, 0 ),
+		    collection( *iter2, 1 ), collection( *iter3, 2 ) );
+    }
+  }
+
+  if ( mVerbose ) {
+    std::cout << " - mixed done   " << std::endl;
+  }
+
+  /// Pair tables with the current event are kept for one event only
+  mEngine->clearTables( false );
+
+  /// Merge the shards of the event
+  for ( unsigned int iThread=1; iThread<mEngine->shards.size(); iThread++ ) {
+    for ( unsigned int iFctn=0; iFctn<mEngine->fctns.size(); iFctn++ ) {
+      if ( mEngine->shards[iThread][iFctn] ) {
+	mEngine->fctns[iFctn]->mergeShard( mEngine->shards[iThread][iFctn] );
+      }
+    }
+  }
+
+  /// If mixing buffer is full, delete oldest event
+  if ( mixingBufferFull() ) {
+    mEngine->dropTables( mixingBuffer()->back() );
+    delete mixingBuffer()->back();
+    mixingBuffer()->pop_back();
+  }
+
+  /// Add current event to mixing buffer
+  mixingBuffer()->push_front( mPicoEvent );
+
+  /// Cleanup for EbyE
+  eventEnd( hbtEvent );
+}
+
+//_________________
+void StHbtTripletAnalysis::makeTriplets(const bool& isMixed,
+					StHbtParticleCollection* collection1,
+					StHbtParticleCollection* collection2,
+					StHbtParticleCollection* collection3) {
+
+  if ( collection1->empty() || collection2->empty() || collection3->empty() ) return;
+
+  /// Triplets with Q3 below the limit only contain pairs with q^2 below Q3max^2
+  const double limit = ( mQ3Max > 0 ) ? mQ3Max * mQ3Max : std::numeric_limits<double>::infinity();
+
+  /// The pairs of two events of the mixing buffer are kept for the next events
+  const Engine::PairTable &table12 = mEngine->pairTable( collection1, collection2, mPairCut, limit, false );
+  const Engine::PairTable &table13 = mEngine->pairTable( collection1, collection3, mPairCut, limit, false );
+  const Engine::PairTable &table23 = mEngine->pairTable( collection2, collection3, mPairCut, limit, isMixed );
+  const bool same23 = ( collection2 == collection3 );
+
+  const std::vector<StHbtParticle*> particles1( collection1->begin(), collection1->end() );
+  const std::vector<StHbtParticle*> particles2( collection2->begin(), collection2->end() );
+  const std::vector<StHbtParticle*> particles3( collection3->begin(), collection3->end() );
+
+  const unsigned int nTasks = particles1.size();
+  Engine *engine = mEngine;
+  if ( engine->collect ) {
+    engine->collected.assign( nTasks, std::vector<Engine::Triple>() );
+  }
+  for ( auto &worker : engine->workers ) {
+    worker.nTriplets = 0;
+  }
+
+  /// Triplets of the particle i of the first position
+  auto job = [&]( const unsigned int& i, Engine::Worker& worker ) {
+    for ( unsigned int a=table12.first[i]; a<table12.first[i+1]; a++ ) {
+      const unsigned int j = table12.partner[a];
+      const double q2ij = table12.q2[a];
+
+      const unsigned int *kBegin = table13.partner.data() + table13.first[i];
+      const unsigned int *kEnd = table13.partner.data() + table13.first[i+1];
+      if ( same23 ) {
+	kBegin = std::upper_bound( kBegin, kEnd, j );
+      }
+      /// Partners of j: both lists are ascending, so the search for the
+      /// next k starts at the last position
+      const unsigned int *lBegin = table23.partner.data() + table23.first[j];
+      const unsigned int *lEnd = table23.partner.data() + table23.first[j+1];
+
+      for ( const unsigned int *k = kBegin; k != kEnd; k++ ) {
+	const double q2ijk = q2ij + table13.q2[ k - table13.partner.data() ];
+	if ( !( q2ijk < limit ) ) continue;
+	lBegin = std::lower_bound( lBegin, lEnd, *k );
+	if ( lBegin == lEnd ) break;
+	if ( *lBegin != *k ) continue;
+	const double q2jk = table23.q2[ lBegin - table23.partner.data() ];
+	if ( !( q2ijk + q2jk < limit ) ) continue;
+
+	worker.nTriplets++;
+	worker.triplet.setTrack1( particles1[i] );
+	worker.triplet.setTrack2( particles2[j] );
+	worker.triplet.setTrack3( particles3[*k] );
+	for ( const auto &fctn : worker.targets ) {
+	  if ( !fctn ) continue;
+	  if ( isMixed ) {
+	    fctn->addMixedTriplet( &worker.triplet );
+	  }
+	  else {
+	    fctn->addRealTriplet( &worker.triplet );
+	  }
+	}
+	if ( engine->collect ) {
+	  engine->collected[i].push_back( { particles1[i], particles2[j], particles3[*k] } );
+	}
+      } //for ( const unsigned int *k = kBegin; k != kEnd; k++ )
+    } //for ( unsigned int a=table12.first[i]; a<table12.first[i+1]; a++ )
+  };
+  engine->execute( nTasks, job );
+
+  /// Triplets of the functions without shards in the order of the serial loop
+  if ( engine->collect ) {
+    StHbtTriplet triplet;
+    for ( const auto &tripletsOfTask : engine->collected ) {
+      for ( const auto &triple : tripletsOfTask ) {
+	triplet.setTrack1( triple.particle1 );
+	triplet.setTrack2( triple.particle2 );
+	triplet.setTrack3( triple.particle3 );
+	for ( unsigned int iFctn=0; iFctn<engine->fctns.size(); iFctn++ ) {
+	  if ( engine->sharded[iFctn] ) continue;
+	  if ( isMixed ) {
+	    engine->fctns[iFctn]->addMixedTriplet( &triplet );
+	  }
+	  else {
+	    engine->fctns[iFctn]->addRealTriplet( &triplet );
+	  }
+	}
+      }
+    }
+    engine->collected.clear();
+  } //if ( engine->collect )
+
+  unsigned long long nTriplets = 0;
+  for ( const auto &worker : engine->workers ) {
+    nTriplets += worker.nTriplets;
+  }
+  if ( isMixed ) {
+    mNMixedTriplets += nTriplets;
+  }
+  else {
+    mNRealTriplets += nTriplets;
+  }
+}
+
+//_________________
+void StHbtTripletAnalysis::writeCheckpoint(StHbtCheckpoint& checkpoint) {
+
+  StHbtAnalysis::writeCheckpoint( checkpoint );
+  checkpoint.write( mNRealTriplets );
+  checkpoint.write( mNMixedTriplets );
+
+  if ( thirdCut() == mFirstParticleCut || thirdCut() == mSecondParticleCut ) return;
+  thirdCut()->writeCheckpoint( checkpoint );
+  if ( !checkpoint.withMixingBuffers() ) return;
+
+  /// Third particle collections of the events stored by writeMixingBuffers
+  std::vector<StHbtPicoEventCollection*> buffers;
+  mixingBuffers( buffers );
+  for ( unsigned int iBuf=0; iBuf<buffers.size(); iBuf++ ) {
+
+    bool isStorable = true;
+    for ( StHbtPicoEventIterator iter = buffers[iBuf]->begin();
+	  isStorable && iter != buffers[iBuf]->end(); iter++ ) {
+      StHbtParticleCollection *collection3 = (*iter)->thirdParticleCollection();
+      for ( StHbtParticleIterator pIter = collection3->begin();
+	    pIter != collection3->end(); pIter++ ) {
+	if ( !(*pIter)->track() ) {
+	  isStorable = false;
+	  break;
+	}
+      }
+    } //for ( iter = buffers[iBuf]->begin(); ...
+
+    checkpoint.write( (unsigned int)( isStorable ? buffers[iBuf]->size() : 0 ) );
+    if ( !isStorable ) continue;
+
+    for ( StHbtPicoEventIterator iter = buffers[iBuf]->begin();
+	  iter != buffers[iBuf]->end(); iter++ ) {
+      StHbtParticleCollection *collection3 = (*iter)->thirdParticleCollection();
+      checkpoint.write( (unsigned int)collection3->size() );
+      for ( StHbtParticleIterator pIter = collection3->begin();
+	    pIter != collection3->end(); pIter++ ) {
+	checkpoint.writeTrack( (*pIter)->track() );
+      }
+    } //for ( iter = buffers[iBuf]->begin(); ...
+  } //for ( unsigned int iBuf=0; iBuf<buffers.size(); iBuf++ )
+}
+
+//_________________
+bool StHbtTripletAnalysis::readCheckpoint(StHbtCheckpoint& checkpoint) {
+
+  /// The restored mixing buffer has new particle collections
+  mEngine->clearTables( true );
+  if ( !StHbtAnalysis::readCheckpoint( checkpoint ) ) return false;
+  if ( !checkpoint.read( mNRealTriplets ) || !checkpoint.read( mNMixedTriplets ) ) return false;
+
+  if ( thirdCut() == mFirstParticleCut || thirdCut() == mSecondParticleCut ) return true;
+  if ( !thirdCut()->readCheckpoint( checkpoint ) ) return false;
+  if ( !checkpoint.withMixingBuffers() ) return true;
+
+  std::vector<StHbtPicoEventCollection*> buffers;
+  mixingBuffers( buffers );
+  for ( unsigned int iBuf=0; iBuf<buffers.size(); iBuf++ ) {
+
+    unsigned int nEvents = 0;
+    if ( !checkpoint.read( nEvents ) ) return false;
+
+    /// The events of the buffer in the order of writeCheckpoint (a third
+    /// collection without its event is read and dropped)
+    StHbtPicoEventIterator iter = buffers[iBuf]->begin();
+    for ( unsigned int iEvent=0; iEvent<nEvents; iEvent++ ) {
+      StHbtPicoEvent *picoEvent = nullptr;
+      if ( iter != buffers[iBuf]->end() ) {
+	picoEvent = *iter;
+	iter++;
+      }
+      unsigned int nParticles = 0;
+      if ( !checkpoint.read( nParticles ) ) return false;
+      for ( unsigned int iPart=0; iPart<nParticles; iPart++ ) {
+	StHbtTrack *track = checkpoint.readTrack();
+	if ( !track ) return false;
+	if ( picoEvent ) {
+	  picoEvent->thirdParticleCollection()->push_back( new StHbtParticle( track, thirdCut()->mass() ) );
+	}
+	delete track;
+      }
+    } //for ( unsigned int iEvent=0; iEvent<nEvents; iEvent++ )
+
+    /// Events without their third collection would miss the mixed
+    /// triplets with it: the buffer refills instead
+    if ( nEvents != buffers[iBuf]->size() ) {
+      if ( mVerbose ) {
+	std::cout << "[WARNING] StHbtTripletAnalysis::readCheckpoint - third particles of mixing buffer "
+		  << iBuf << " are not stored, the buffer is emptied" << std::endl;
+      }
+      for ( iter = buffers[iBuf]->begin(); iter != buffers[iBuf]->end(); iter++ ) {
+	delete *iter;
+      }
+      buffers[iBuf]->clear();
+    }
+  } //for ( unsigned int iBuf=0; iBuf<buffers.size(); iBuf++ )
+
+  return true;
+}
+
+//_________________
+StHbtString StHbtTripletAnalysis::report() {
+
+  TString report("-----------\nStHbtTripletAnalysis report:\n");
+  report += TString::Format( "Q3 limit: %E GeV/c (<= 0 - no limit), threads: %d\n",
+			     mQ3Max, mNumberOfThreads );
+  report += TString::Format( "Real triplets: %llu, mixed triplets: %llu\n",
+			     mNRealTriplets, mNMixedTriplets );
+  if ( thirdCut() != mFirstParticleCut && thirdCut() != mSecondParticleCut ) {
+    report += "\nParticle Cuts - Third Particle:\n";
+    report += thirdCut()->report().c_str();
+  }
+  report += "\nNow adding StHbtAnalysis(base) report\n";
+  report += StHbtAnalysis::report().c_str();
+
+  return StHbtString( (const char *)report );
+}
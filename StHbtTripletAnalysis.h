@@ -0,0 +1,124 @@
+/**
+ * Description: Analysis that builds particle triplets for three-particle
+ * correlations.
+ *
+ * Real triplets are made of three particles of the same event. Mixed
+ * triplets are made of one particle of the current event and one
+ * particle of each of two different events of the mixing buffer (1+1+1).
+ * The triplets are passed to addRealTriplet() and addMixedTriplet() of
+ * the correlation functions (pairs are not made). They point to the
+ * particles of the pico events and are valid only during the call.
+ *
+ * The three positions of the triplet are selected by the first, second
+ * and third particle cuts (the third cut defaults to the second one). A
+ * position with the same cut as the position before uses the same
+ * particle collection, and such particles are taken without repetition:
+ * identical pion triplets are made with one cut set as the first and
+ * second particle cut. The third particle cut fills the third particle
+ * collection of the pico event.
+ *
+ * A triplet is made only if all three of its pairs pass the pair cut.
+ * The pair cut is called once for each pair of particles before the
+ * triplet loop, and the pairs that pass it are kept with their
+ * q^2 = |(p1 - p2)^2|. The pairs of two events of the mixing buffer are
+ * kept until one of the events leaves the buffer, so the pair cut (and
+ * its monitor) sees them only once. With setQ3Max() only triplets with
+ * Q3 = sqrt( q12^2 + q23^2 + q31^2 ) < Q3max are made. A pair with q^2 above
+ * Q3max^2 can not be part of such a triplet, so only the pairs below
+ * Q3max are kept and the loop runs over them.
+ *
+ * With setNumberOfThreads(n) the triplets of the particles of the first
+ * position are made on n threads (the calling thread and n-1 workers).
+ * Correlation functions with sharding (StHbtCorrFctn::createShard) are
+ * filled by each thread through its own shards, which are merged at the
+ * end of the event. The triplets for the other correlation functions are
+ * collected and passed on the calling thread in the order of the serial
+ * loop. StHbtQ3CorrFctn is a correlation function for this analysis.
+ *
+ * Checkpoints also store the triplet counters, the counters of the third
+ * particle cut and the third particle collections of the mixing buffer.
+ * The pairs kept for the mixing buffer are not stored (they are made
+ * again after the restart).
+ */
+
+#ifndef StHbtTripletAnalysis_h
+#define StHbtTripletAnalysis_h
+
+/// StHbtMaker headers
+#include "StHbtAnalysis.h"
+
+//_________________
+class StHbtTripletAnalysis : public StHbtAnalysis {
+
+ public:
+  /// Default constructor
+  StHbtTripletAnalysis();
+  /// Copy constructor (the cuts and correlation functions are cloned)
+  StHbtTripletAnalysis(const StHbtTripletAnalysis& copy);
+  /// Assignment operator
+  StHbtTripletAnalysis& operator=(const StHbtTripletAnalysis& copy);
+  /// Destructor
+  virtual ~StHbtTripletAnalysis();
+
+  /// Particle cut of the third position (nullptr - same as the second)
+  void setThirdParticleCut(StHbtParticleCut* x);
+  StHbtParticleCut* thirdParticleCut()                 { return mThirdParticleCut; }
+
+  /// Make only triplets with Q3 below q3Max (q3Max <= 0 - no limit)
+  void setQ3Max(const double& q3Max)                   { mQ3Max = q3Max; }
+  double q3Max() const                                 { return mQ3Max; }
+  /// Number of threads of the triplet loop (including the calling thread)
+  void setNumberOfThreads(const unsigned int& n)       { mNumberOfThreads = ( n > 0 ) ? n : 1; }
+  unsigned int numberOfThreads() const                 { return mNumberOfThreads; }
+
+  /// Numbers of triplets passed to the correlation functions
+  unsigned long long nRealTriplets() const             { return mNRealTriplets; }
+  unsigned long long nMixedTriplets() const            { return mNMixedTriplets; }
+
+  virtual void processEvent(const StHbtEvent*);
+  virtual void eventBegin(const StHbtEvent*);
+  virtual void eventEnd(const StHbtEvent*);
+  virtual StHbtString report();
+
+  /// Checkpoint of the base analysis, the triplet counters and the third
+  /// particles (the pairs kept for the mixing buffer are dropped on restore)
+  virtual void writeCheckpoint(StHbtCheckpoint& checkpoint);
+  virtual bool readCheckpoint(StHbtCheckpoint& checkpoint);
+
+ protected:
+
+  /// Particle cut of the third position
+  StHbtParticleCut* mThirdParticleCut;
+  /// Upper limit of Q3 (<= 0 - no limit)
+  double mQ3Max;
+  /// Number of threads of the triplet loop
+  unsigned int mNumberOfThreads;
+  /// Numbers of triplets passed to the correlation functions
+  unsigned long long mNRealTriplets;
+  unsigned long long mNMixedTriplets;
+
+ private:
+
+  /// Cut of the third position and the collection of the position (0-2)
+  /// of the pico event
+  StHbtParticleCut* thirdCut() const;
+  StHbtParticleCollection* collection(StHbtPicoEvent* picoEvent, const int& position) const;
+
+  /// Make the triplets of the three collections and pass them to the
+  /// correlation functions. Particles of a collection that is used at two
+  /// positions are taken in ascending order
+  void makeTriplets(const bool& isMixed,
+		    StHbtParticleCollection* collection1,
+		    StHbtParticleCollection* collection2,
+		    StHbtParticleCollection* collection3);
+
+  /// Pair tables, worker threads and shards (defined in the source file)
+  struct Engine;
+  Engine *mEngine;                                     //!
+
+#ifdef __ROOT__
+  ClassDef(StHbtTripletAnalysis, 0)
+#endif
+};
+
+#endif // #define StHbtTripletAnalysis_h
@@ -295,6 +295,9 @@ class StHbtV0 {
   bool validHiddenInfo() const                     { return isValidHiddenInfo(); }
   StHbtHiddenInfo* getHiddenInfo() const           { return mHiddenInfo; }
 
+  /// Direct access to the stored fields for the columnar binary format
+  friend class StHbtBinaryEventFormat;
+
  protected:
 
   /// Primary vertex position
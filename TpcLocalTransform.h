@@ -0,0 +1,34 @@
+/**
+ * Description: transformation of a point to the local frame of a TPC sector
+ *
+ * TpcLocalTransform finds the sector and the pad row of a point and its
+ * local coordinate u along the pad row. The row boundaries, the half
+ * widths of the pad rows and the sector rotations are read from the
+ * tables of the TPC geometry (StHbtTpcGeometry), so a call costs one
+ * atan2, a rotation with the tabulated cosine and sine and a binary
+ * search over the row boundaries. When the row of the point is known in
+ * advance (points sampled at the pad row radii) it is passed as a hint
+ * and checked directly. Without a geometry the current one is used.
+ *
+ * Return value: 0 - on a pad row, 1 - below the first row, 2 - beyond the
+ * last row, 3 - outside of the pad row in u
+ */
+
+#ifndef TpcLocalTransform_h
+#define TpcLocalTransform_h
+
+/// StHbtMaker headers
+#include "StHbtTpcGeometry.h"
+
+/// ROOT headers
+#include "TVector3.h"
+
+/// Sector, pad row (from 1), u and phi of the sector centre of aPoint
+int TpcLocalTransform(TVector3& aPoint, int& aSector, int& aRow,
+		      float& aU, double& aPhi);
+/// Same in the given geometry with the expected pad row (from 1, 0 if unknown)
+int TpcLocalTransform(const StHbtTpcGeometry& aGeometry, TVector3& aPoint,
+		      int& aSector, int& aRow, float& aU, double& aPhi,
+		      const int& aRowHint = 0);
+
+#endif // #define TpcLocalTransform_h
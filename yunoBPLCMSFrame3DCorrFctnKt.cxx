@@ -1,4 +1,5 @@
 #include "yunoBPLCMSFrame3DCorrFctnKt.h"
+#include "StHbtCheckpoint.h"
 
 #ifdef __ROOT__
 ClassImp(yunoBPLCMSFrame3DCorrFctnKt)
@@ -23,49 +24,34 @@ yunoBPLCMSFrame3DCorrFctnKt::yunoBPLCMSFrame3DCorrFctnKt(char *title,
   mDeltaRp = (mRpMax-mRpMin)/mNumberRp;
 
   
-  stringstream TitNum,TitDen,TitQinv,TitCurrent;
-  TitNum.str("");TitDen.str("");TitQinv.str("");TitCurrent.str("");
-  TitNum<<title<<"_Num";
-  TitDen<<title<<"_Den";
-  TitQinv<<title<<"_Qinv";
+  /// The TH3F histograms are created when the output is requested
+  mTitle = title;
+  mNQBins = nbins;
+  mQLo = QLo;
+  mQHi = QHi;
 
-  TString hist_title = TString::Format("%s; q_{out} (GeV/c); q_{side} (GeV/c); q_{long} (GeV/c)", title);
-
-  //Histogram loop
-  
   for(int i=0; i<mNumberKt; i++) {
     for(int j = 0; j < mNumberRp; j++) {
-    
-      TitCurrent.str("");
-      TitCurrent << TitNum.str() << "_kt_" << i << "_rp_" << j;
-      mNumerator[i][j] = new TH3F(TitCurrent.str().c_str(),
-				  hist_title,
-				  nbins, QLo, QHi,
-				  nbins, QLo, QHi,
-				  nbins, QLo, QHi);
-      mNumerator[i][j]->Sumw2();
-
-      TitCurrent.str("");
-      TitCurrent << TitDen.str()<< "_kt_" << i << "_rp_" << j;
-      mDenominator[i][j] = new TH3F(TitCurrent.str().c_str(),
-				    hist_title,
-				    nbins, QLo, QHi,
-				    nbins, QLo, QHi,
-				    nbins, QLo, QHi);
-      mDenominator[i][j]->Sumw2();
-
-      TitCurrent.str("");
-      TitCurrent << TitQinv.str()<< "_kt_" << i << "_rp_" << j;
-      mQinvHisto[i][j] = new TH3F(TitCurrent.str().c_str(),
-				  hist_title,
-				  nbins, QLo, QHi,
-				  nbins, QLo, QHi,
-				  nbins, QLo, QHi);
-      mQinvHisto[i][j]->Sumw2();
+      mNumerator[i][j] = nullptr;
+      mDenominator[i][j] = nullptr;
+      mQinvHisto[i][j] = nullptr;
+      mNumeratorFill[i][j] = new StHbtDenseHist3D( nbins, QLo, QHi, nbins, QLo, QHi, nbins, QLo, QHi );
+      mDenominatorFill[i][j] = new StHbtDenseHist3D( *mNumeratorFill[i][j] );
+      mQinvHistoFill[i][j] = new StHbtDenseHist3D( *mNumeratorFill[i][j] );
     }
   }
 }
 
+//_________________
+yunoBPLCMSFrame3DCorrFctnKt::yunoBPLCMSFrame3DCorrFctnKt() :
+  StHbtCorrFctn(), mHbtEvent(nullptr),
+  mNumberKt(0), mNumberRp(0), mKtMin(0), mRpMin(0), mKtMax(0), mRpMax(0),
+  mIndexKt(nullptr), mIndexRp(0), mDeltaKt(0), mDeltaRp(0),
+  angle(0), mRpAngle(0), angleDifference(0),
+  mTitle(), mNQBins(0), mQLo(0), mQHi(0) {
+  /// Only the kt and reaction plane bins are used: arrays stay empty
+}
+
 //_________________
 yunoBPLCMSFrame3DCorrFctnKt::~yunoBPLCMSFrame3DCorrFctnKt() {
   for (int i = 0; i < mNumberKt; i++) {
@@ -73,6 +59,146 @@ yunoBPLCMSFrame3DCorrFctnKt::~yunoBPLCMSFrame3DCorrFctnKt() {
       delete mNumerator[i][j];
       delete mDenominator[i][j];
       delete mQinvHisto[i][j];
+      delete mNumeratorFill[i][j];
+      delete mDenominatorFill[i][j];
+      delete mQinvHistoFill[i][j];
+    }
+  }
+}
+
+//_________________
+StHbtCorrFctn* yunoBPLCMSFrame3DCorrFctnKt::createShard() {
+  yunoBPLCMSFrame3DCorrFctnKt *shard = new yunoBPLCMSFrame3DCorrFctnKt();
+  shard->mBaseAnalysis = mBaseAnalysis;
+  shard->mPairCut = mPairCut;
+  shard->mHbtEvent = mHbtEvent;
+  shard->mNumberKt = mNumberKt;
+  shard->mKtMin = mKtMin;
+  shard->mKtMax = mKtMax;
+  shard->mDeltaKt = mDeltaKt;
+  shard->mNumberRp = mNumberRp;
+  shard->mRpMin = mRpMin;
+  shard->mRpMax = mRpMax;
+  shard->mDeltaRp = mDeltaRp;
+  for (int i = 0; i < mNumberKt; i++) {
+    for (int j = 0; j < mNumberRp; j++) {
+      shard->mNumerator[i][j] = nullptr;
+      shard->mDenominator[i][j] = nullptr;
+      shard->mQinvHisto[i][j] = nullptr;
+      shard->mNumeratorFill[i][j] = mNumeratorFill[i][j]->cloneEmpty();
+      shard->mDenominatorFill[i][j] = mDenominatorFill[i][j]->cloneEmpty();
+      shard->mQinvHistoFill[i][j] = mQinvHistoFill[i][j]->cloneEmpty();
+    }
+  }
+  return shard;
+}
+
+//_________________
+void yunoBPLCMSFrame3DCorrFctnKt::mergeShard(StHbtCorrFctn* shard) {
+  yunoBPLCMSFrame3DCorrFctnKt *cf = dynamic_cast<yunoBPLCMSFrame3DCorrFctnKt*>( shard );
+  if ( !cf || cf == this || cf->mNumberKt != mNumberKt || cf->mNumberRp != mNumberRp ) {
+    std::cout << "[WARNING] yunoBPLCMSFrame3DCorrFctnKt::mergeShard - not a shard of this function"
+	      << std::endl;
+    return;
+  }
+  for (int i = 0; i < mNumberKt; i++) {
+    for (int j = 0; j < mNumberRp; j++) {
+      mNumeratorFill[i][j]->merge( *cf->mNumeratorFill[i][j] );
+      mDenominatorFill[i][j]->merge( *cf->mDenominatorFill[i][j] );
+      mQinvHistoFill[i][j]->merge( *cf->mQinvHistoFill[i][j] );
+    }
+  }
+}
+
+//_________________
+void yunoBPLCMSFrame3DCorrFctnKt::writeCheckpoint(StHbtCheckpoint& checkpoint) {
+  /// The histograms of all bins are created together
+  const bool withHistograms = ( mNumberKt > 0 && mNumberRp > 0 && mNumerator[0][0] );
+  checkpoint.write( (unsigned char)( withHistograms ? 1 : 0 ) );
+  for (int i = 0; i < mNumberKt; i++) {
+    for (int j = 0; j < mNumberRp; j++) {
+      if ( withHistograms ) {
+	checkpoint.writeHistogram( mNumerator[i][j] );
+	checkpoint.writeHistogram( mDenominator[i][j] );
+	checkpoint.writeHistogram( mQinvHisto[i][j] );
+      }
+      mNumeratorFill[i][j]->writeCheckpoint( checkpoint );
+      mDenominatorFill[i][j]->writeCheckpoint( checkpoint );
+      mQinvHistoFill[i][j]->writeCheckpoint( checkpoint );
+    }
+  }
+}
+
+//_________________
+bool yunoBPLCMSFrame3DCorrFctnKt::readCheckpoint(StHbtCheckpoint& checkpoint) {
+  unsigned char withHistograms = 0;
+  if ( !checkpoint.read( withHistograms ) ) return false;
+  /// Creates the missing histograms, the content is replaced below
+  if ( withHistograms ) flushHistograms();
+  for (int i = 0; i < mNumberKt; i++) {
+    for (int j = 0; j < mNumberRp; j++) {
+      if ( withHistograms ) {
+	if ( !checkpoint.readHistogram( mNumerator[i][j] ) ||
+	     !checkpoint.readHistogram( mDenominator[i][j] ) ||
+	     !checkpoint.readHistogram( mQinvHisto[i][j] ) ) return false;
+      }
+      else if ( mNumerator[i][j] ) {
+	mNumerator[i][j]->Reset();
+	mDenominator[i][j]->Reset();
+	mQinvHisto[i][j]->Reset();
+      }
+      if ( !mNumeratorFill[i][j]->readCheckpoint( checkpoint ) ||
+	   !mDenominatorFill[i][j]->readCheckpoint( checkpoint ) ||
+	   !mQinvHistoFill[i][j]->readCheckpoint( checkpoint ) ) return false;
+    }
+  }
+  return true;
+}
+
+//_________________
+void yunoBPLCMSFrame3DCorrFctnKt::setFineQRange(const float& qFine) {
+  for (int i = 0; i < mNumberKt; i++) {
+    for (int j = 0; j < mNumberRp; j++) {
+      mNumeratorFill[i][j]->setFineRange( qFine );
+      mDenominatorFill[i][j]->setFineRange( qFine );
+      mQinvHistoFill[i][j]->setFineRange( qFine );
+    }
+  }
+}
+
+//_________________
+TH3F* yunoBPLCMSFrame3DCorrFctnKt::makeHistogram(const char* kind, const int& ktBin,
+						 const int& rpBin) const {
+
+  stringstream TitCurrent;
+  TitCurrent << mTitle << "_" << kind << "_kt_" << ktBin << "_rp_" << rpBin;
+
+  TString hist_title = TString::Format("%s; q_{out} (GeV/c); q_{side} (GeV/c); q_{long} (GeV/c)",
+				       mTitle.Data());
+  TH3F *hist = new TH3F(TitCurrent.str().c_str(),
+			hist_title,
+			mNQBins, mQLo, mQHi,
+			mNQBins, mQLo, mQHi,
+			mNQBins, mQLo, mQHi);
+  hist->Sumw2();
+  return hist;
+}
+
+//_________________
+void yunoBPLCMSFrame3DCorrFctnKt::flushHistograms() {
+  /// The histograms of a bin are created just before its pairs are
+  /// transferred, so the memory of the accumulators already transferred
+  /// is available for the next ones
+  for (int i = 0; i < mNumberKt; i++) {
+    for (int j = 0; j < mNumberRp; j++) {
+      if ( !mNumerator[i][j] ) {
+	mNumerator[i][j] = makeHistogram("Num", i, j);
+	mDenominator[i][j] = makeHistogram("Den", i, j);
+	mQinvHisto[i][j] = makeHistogram("Qinv", i, j);
+      }
+      mNumeratorFill[i][j]->flush( mNumerator[i][j] );
+      mDenominatorFill[i][j]->flush( mDenominator[i][j] );
+      mQinvHistoFill[i][j]->flush( mQinvHisto[i][j] );
     }
   }
 }
@@ -80,19 +206,45 @@ yunoBPLCMSFrame3DCorrFctnKt::~yunoBPLCMSFrame3DCorrFctnKt() {
 //_________________
 void yunoBPLCMSFrame3DCorrFctnKt::writeOutHistos() {
 
-  for(int i=0; i<mNumberKt; i++) {
-    for(int j = 0; j < mNumberRp; j++) {
-      mNumerator[i][j]->Write();
-      mDenominator[i][j]->Write();
-      mQinvHisto[i][j]->Write();
+  if ( mNumberKt == 0 || mNumberRp == 0 ) return;
+
+  if ( mNumerator[0][0] ) {
+    flushHistograms();
+    for(int i=0; i<mNumberKt; i++) {
+      for(int j = 0; j < mNumberRp; j++) {
+	mNumerator[i][j]->Write();
+	mDenominator[i][j]->Write();
+	mQinvHisto[i][j]->Write();
+      }
     }
   }
+  else {
+    /// Only one TH3F at a time is in memory
+    for(int i=0; i<mNumberKt; i++) {
+      for(int j = 0; j < mNumberRp; j++) {
+	writeOutHistogram( "Num", i, j, mNumeratorFill[i][j] );
+	writeOutHistogram( "Den", i, j, mDenominatorFill[i][j] );
+	writeOutHistogram( "Qinv", i, j, mQinvHistoFill[i][j] );
+      }
+    }
+  }
+}
+
+//_________________
+void yunoBPLCMSFrame3DCorrFctnKt::writeOutHistogram(const char* kind, const int& ktBin,
+						    const int& rpBin,
+						    const StHbtDenseHist3D* fill) const {
+  TH3F *hist = makeHistogram( kind, ktBin, rpBin );
+  fill->addTo( hist );
+  hist->Write();
+  delete hist;
 }
 
 //_________________
 TList* yunoBPLCMSFrame3DCorrFctnKt::getOutputList() {
   /// Prepare the list of objects to be written to the output
   TList *outputList = new TList();
+  flushHistograms();
   for (int i = 0; i < mNumberKt; i++) {
     for (int j = 0; j < mNumberRp; j++) {
 
@@ -133,7 +285,7 @@ void yunoBPLCMSFrame3DCorrFctnKt::addRealPair(const StHbtPair* pair){
       qSide = pair->qSideCMS();
       qLong = pair->qLongCMS();
     }
-    mNumerator[mIndexKt][mIndexRp]->Fill(qOut,qSide,qLong);
+    mNumeratorFill[mIndexKt][mIndexRp]->fill(qOut,qSide,qLong);
   }
 }
 
@@ -165,8 +317,8 @@ void yunoBPLCMSFrame3DCorrFctnKt::addMixedPair(const StHbtPair* pair){
       qLong = pair->qLongCMS();
     }
     
-    mDenominator[mIndexKt][mIndexRp]->Fill(qOut,qSide,qLong,1.0);
-    mQinvHisto[mIndexKt][mIndexRp]->Fill(qOut,qSide,qLong,Qinv);
+    mDenominatorFill[mIndexKt][mIndexRp]->fill(qOut,qSide,qLong);
+    mQinvHistoFill[mIndexKt][mIndexRp]->fill(qOut,qSide,qLong,Qinv);
   }
 }
 void yunoBPLCMSFrame3DCorrFctnKt::eventBegin(const StHbtEvent *event) { mHbtEvent =(StHbtEvent*)event; }
@@ -188,29 +340,27 @@ int yunoBPLCMSFrame3DCorrFctnKt::getRpBin(const StHbtPair* pair) {
 
 
 //_________________
-StHbtString yunoBPLCMSFrame3DCorrFctnKt::report() {
+double yunoBPLCMSFrame3DCorrFctnKt::entries(const TH3F* hist,
+					     const StHbtDenseHist3D* fill) const {
+  return ( hist ? hist->GetEntries() : 0. ) + (double)fill->entries();
+}
 
-  int mNumeratorEntries=0;
-  int mDenominatorEntries=0;
-  int mQinvHistoEntries=0;
+//_________________
+StHbtString yunoBPLCMSFrame3DCorrFctnKt::report() {
 
-  for (int i=0; i<mNumberKt; i++){
-    for(int j = 0; j < mNumberRp; j++) {
-      mNumeratorEntries += (int)mNumerator[i][j]->GetEntries();
-      mDenominatorEntries += (int)mDenominator[i][j]->GetEntries();
-      mQinvHistoEntries += (int)mQinvHisto[i][j]->GetEntries();
-    }
-  }
-    
+  /// The histograms are not created for the report
   string stemp = "yuno LCMS Frame Bertsch-Pratt 3D Correlation Function Report:\n";
   char ctemp[100];
   for(int i=0; i<mNumberKt; i++) {
     for(int j = 0; j < mNumberRp; j++) {
-      sprintf(ctemp,"Number of entries in numerator:\t%E\n",mNumerator[i][j]->GetEntries());
+      sprintf(ctemp,"Number of entries in numerator:\t%E\n",
+	      entries( mNumerator[i][j], mNumeratorFill[i][j] ));
       stemp += ctemp;
-      sprintf(ctemp,"Number of entries in denominator:\t%E\n",mDenominator[i][j]->GetEntries());
+      sprintf(ctemp,"Number of entries in denominator:\t%E\n",
+	      entries( mDenominator[i][j], mDenominatorFill[i][j] ));
       stemp += ctemp;
-      sprintf(ctemp,"Number of entries in Qinv histo:\t%E\n",mQinvHisto[i][j]->GetEntries());
+      sprintf(ctemp,"Number of entries in Qinv histo:\t%E\n",
+	      entries( mQinvHisto[i][j], mQinvHistoFill[i][j] ));
       stemp += ctemp;
     }
   }
@@ -3,6 +3,7 @@
 
 #include "StHbtCorrFctn.h"
 #include "StHbtPairCut.h"
+#include "StHbtDenseHist3D.h"
 
 /// ROOT headers
 #include <TH3F.h>
@@ -37,13 +38,47 @@ class yunoBPLCMSFrame3DCorrFctnKt : public StHbtCorrFctn {
 
   virtual TList* getOutputList();
 
+  /// Exact bins only for |qOut|, |qSide|, |qLong| below qFine (<= 0 - all
+  /// bins, default). Must be set before the first pair
+  void setFineQRange(const float& qFine);
+
+  /// Shard with empty accumulators only (no TH3F histograms).
+  /// eventBegin must be called on the shard as well
+  virtual StHbtCorrFctn* createShard();
+  /// Add the pairs of the shard and reset it
+  virtual void mergeShard(StHbtCorrFctn* shard);
+
+  /// Checkpoint of the accumulators (and of the TH3F histograms if they
+  /// were already created)
+  virtual void writeCheckpoint(StHbtCheckpoint& checkpoint);
+  virtual bool readCheckpoint(StHbtCheckpoint& checkpoint);
+
   StHbtEvent *mHbtEvent;
  private:
 
+  /// Empty correlation function used for shards
+  yunoBPLCMSFrame3DCorrFctnKt();
+
+  /// New TH3F histogram ("Num", "Den" or "Qinv") of the kt and
+  /// reaction plane bin
+  TH3F* makeHistogram(const char* kind, const int& ktBin, const int& rpBin) const;
+  /// Create the missing TH3F histograms and transfer the accumulated pairs
+  void flushHistograms();
+  /// Build the histogram from the accumulator, write and delete it
+  void writeOutHistogram(const char* kind, const int& ktBin, const int& rpBin,
+			 const StHbtDenseHist3D* fill) const;
+  /// Entries of the histogram (if created) and of its accumulator
+  double entries(const TH3F* hist, const StHbtDenseHist3D* fill) const;
+
   TH3F *mNumerator[10][12];
   TH3F *mDenominator[10][12];
   TH3F *mQinvHisto[10][12];
 
+  /// Accumulators of the histograms above (pairs are filled here)
+  StHbtDenseHist3D *mNumeratorFill[10][12];   //!
+  StHbtDenseHist3D *mDenominatorFill[10][12]; //!
+  StHbtDenseHist3D *mQinvHistoFill[10][12];   //!
+
   //for the kt binning:
   int mNumberKt, mNumberRp;
   float mKtMin, mRpMin;
@@ -54,8 +89,13 @@ class yunoBPLCMSFrame3DCorrFctnKt : public StHbtCorrFctn {
 
   double angle, mRpAngle, angleDifference;
 
+  /// Title and q binning of the histograms
+  TString mTitle;
+  int mNQBins;
+  float mQLo, mQHi;
+
 #ifdef __ROOT__
-  ClassDef(yunoBPLCMSFrame3DCorrFctnKt, 1)
+  ClassDef(yunoBPLCMSFrame3DCorrFctnKt, 2)
 #endif
     };
 #endif